@@ -31,6 +31,7 @@ SOURCES += \
     thread_pool.cpp \
     threaded_container.cpp \
     timer.cpp \
+    work_stealing_pool.cpp \
 
 HEADERS += \
     SRC_FIRST.hpp \
@@ -47,6 +48,7 @@ HEADERS += \
     deferred_task.hpp \
     exception.hpp \
     fence_manager.hpp \
+    indexed_heap.hpp \
     internal/message.hpp \
     limited_priority_queue.hpp \
     logging.hpp \
@@ -81,4 +83,5 @@ HEADERS += \
     threaded_list.hpp \
     threaded_priority_queue.hpp \
     timer.hpp \
+    work_stealing_pool.hpp \
     worker_thread.hpp \
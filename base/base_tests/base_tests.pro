@@ -22,6 +22,7 @@ SOURCES += \
   containers_test.cpp \
   deferred_task_test.cpp \
   fence_manager_test.cpp \
+  indexed_heap_test.cpp \
   logging_test.cpp \
   math_test.cpp \
   matrix_test.cpp \
@@ -38,6 +39,7 @@ SOURCES += \
   threaded_list_test.cpp \
   threads_test.cpp \
   timer_test.cpp \
+  work_stealing_pool_test.cpp \
   worker_thread_test.cpp \
 
 HEADERS +=
@@ -0,0 +1,78 @@
+#include "testing/testing.hpp"
+
+#include "base/indexed_heap.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/random.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+UNIT_TEST(IndexedHeap_Smoke)
+{
+  my::IndexedHeap<double> heap(5);
+  TEST(heap.Empty(), ());
+
+  TEST(heap.PushOrDecrease(3, 30.0), ());
+  TEST(heap.PushOrDecrease(1, 10.0), ());
+  TEST(heap.PushOrDecrease(4, 40.0), ());
+  TEST_EQUAL(3, heap.Size(), ());
+  TEST_EQUAL(1, heap.TopId(), ());
+
+  TEST(!heap.PushOrDecrease(4, 50.0), ());
+  TEST(heap.PushOrDecrease(4, 5.0), ());
+  TEST_EQUAL(3, heap.Size(), ());
+  TEST_EQUAL(4, heap.TopId(), ());
+  TEST_EQUAL(5.0, heap.TopPriority(), ());
+
+  heap.Pop();
+  TEST(!heap.Contains(4), ());
+  TEST_EQUAL(1, heap.TopId(), ());
+  heap.Pop();
+  TEST_EQUAL(3, heap.TopId(), ());
+  heap.Pop();
+  TEST(heap.Empty(), ());
+
+  TEST(heap.PushOrDecrease(4, 1.0), ());
+  heap.Reset(2);
+  TEST(heap.Empty(), ());
+  TEST(!heap.Contains(1), ());
+}
+
+UNIT_TEST(IndexedHeap_Random)
+{
+  uint32_t const kMaxId = 1000;
+  mt19937 rng(0);
+  uniform_int_distribution<uint32_t> idDist(0, kMaxId - 1);
+  uniform_int_distribution<uint32_t> priorityDist(0, 100000);
+
+  my::IndexedHeap<uint32_t, 3> heap(kMaxId);
+  vector<uint32_t> best(kMaxId, numeric_limits<uint32_t>::max());
+  for (size_t i = 0; i < 10000; ++i)
+  {
+    uint32_t const id = idDist(rng);
+    uint32_t const priority = priorityDist(rng);
+    TEST_EQUAL(heap.PushOrDecrease(id, priority), priority < best[id], ());
+    best[id] = min(best[id], priority);
+  }
+
+  vector<pair<uint32_t, uint32_t>> expected;
+  for (uint32_t id = 0; id < kMaxId; ++id)
+  {
+    if (best[id] != numeric_limits<uint32_t>::max())
+      expected.emplace_back(best[id], id);
+  }
+  sort(expected.begin(), expected.end());
+
+  vector<pair<uint32_t, uint32_t>> actual;
+  while (!heap.Empty())
+  {
+    actual.emplace_back(heap.TopPriority(), heap.TopId());
+    heap.Pop();
+  }
+  for (size_t i = 1; i < actual.size(); ++i)
+    TEST_LESS_OR_EQUAL(actual[i - 1].first, actual[i].first, (i));
+
+  // Elements with equal priorities may go in any order.
+  sort(actual.begin(), actual.end());
+  TEST_EQUAL(expected, actual, ());
+}
@@ -0,0 +1,66 @@
+#include "testing/testing.hpp"
+
+#include "base/work_stealing_pool.hpp"
+
+#include "std/atomic.hpp"
+#include "std/vector.hpp"
+
+namespace
+{
+struct TestException
+{
+};
+
+void TestAllTasksRun(size_t threadsCount, size_t tasksCount)
+{
+  threads::WorkStealingPool pool(threadsCount);
+  for (size_t batch = 0; batch < 10; ++batch)
+  {
+    vector<atomic<int>> calls(tasksCount);
+    for (auto & c : calls)
+      c = 0;
+
+    pool.ForEach(tasksCount, [&calls](size_t i) { ++calls[i]; });
+
+    for (size_t i = 0; i < tasksCount; ++i)
+      TEST_EQUAL(calls[i], 1, (threadsCount, tasksCount, i));
+  }
+}
+}  // namespace
+
+UNIT_TEST(WorkStealingPool_AllTasksRun)
+{
+  TestAllTasksRun(1 /* threadsCount */, 100 /* tasksCount */);
+  TestAllTasksRun(4 /* threadsCount */, 0 /* tasksCount */);
+  TestAllTasksRun(4 /* threadsCount */, 3 /* tasksCount */);
+  TestAllTasksRun(4 /* threadsCount */, 1000 /* tasksCount */);
+}
+
+UNIT_TEST(WorkStealingPool_Exception)
+{
+  threads::WorkStealingPool pool(4 /* threadsCount */);
+  TEST_EQUAL(pool.GetThreadsCount(), 4, ());
+
+  atomic<int> calls(0);
+  bool thrown = false;
+  try
+  {
+    pool.ForEach(100, [&calls](size_t i)
+    {
+      ++calls;
+      if (i == 10)
+        throw TestException();
+    });
+  }
+  catch (TestException const &)
+  {
+    thrown = true;
+  }
+  TEST(thrown, ());
+  TEST_LESS_OR_EQUAL(calls, 100, ());
+
+  // The pool is usable after an exception.
+  calls = 0;
+  pool.ForEach(100, [&calls](size_t /* i */) { ++calls; });
+  TEST_EQUAL(calls, 100, ());
+}
@@ -61,8 +61,18 @@ namespace bits
     return static_cast<unsigned int>(SELECT1_ERROR);
   }
 
-  // Will be implemented when needed.
-  uint64_t popcount(uint64_t x);
+  inline uint64_t popcount(uint64_t x)
+  {
+#if defined(__GNUC__)
+    return static_cast<uint64_t>(__builtin_popcountll(x));
+#else
+    x -= ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (x * 0x0101010101010101ULL) >> 56;
+#endif
+  }
+
   // Will be implemented when needed.
   uint64_t popcount(uint64_t const * p, uint64_t n);
 
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "base/assert.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/functional.hpp"
+#include "std/limits.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+namespace my
+{
+// D-ary min-heap of (id, priority) pairs with decrease-key support.
+// Ids are small integers in [0, maxId), position of every id in the heap
+// is kept in a flat array, so there is at most one entry per id.
+template <typename TPriority, size_t D = 4, typename TCompare = less<TPriority>>
+class IndexedHeap
+{
+public:
+  static_assert(D >= 2, "Heap arity should be at least 2.");
+
+  explicit IndexedHeap(uint32_t maxId = 0, TCompare compare = TCompare())
+    : m_positions(maxId, kNotInHeap), m_compare(compare)
+  {
+  }
+
+  /// Removes all elements and makes ids [0, maxId) valid.
+  void Reset(uint32_t maxId)
+  {
+    m_heap.clear();
+    m_positions.assign(maxId, kNotInHeap);
+  }
+
+  inline bool Empty() const { return m_heap.empty(); }
+  inline size_t Size() const { return m_heap.size(); }
+
+  inline bool Contains(uint32_t id) const
+  {
+    ASSERT_LESS(id, m_positions.size(), ());
+    return m_positions[id] != kNotInHeap;
+  }
+
+  inline uint32_t TopId() const
+  {
+    ASSERT(!Empty(), ());
+    return m_heap.front().first;
+  }
+
+  inline TPriority const & TopPriority() const
+  {
+    ASSERT(!Empty(), ());
+    return m_heap.front().second;
+  }
+
+  /// Inserts id with priority or decreases priority of id, if it's already in heap.
+  /// @return False if id is in heap with a better or equal priority.
+  bool PushOrDecrease(uint32_t id, TPriority const & priority)
+  {
+    ASSERT_LESS(id, m_positions.size(), ());
+    uint32_t pos = m_positions[id];
+    if (pos == kNotInHeap)
+    {
+      pos = static_cast<uint32_t>(m_heap.size());
+      m_heap.emplace_back(id, priority);
+    }
+    else
+    {
+      if (!m_compare(priority, m_heap[pos].second))
+        return false;
+      m_heap[pos].second = priority;
+    }
+    SiftUp(pos);
+    return true;
+  }
+
+  void Pop()
+  {
+    ASSERT(!Empty(), ());
+    m_positions[m_heap.front().first] = kNotInHeap;
+    if (m_heap.size() > 1)
+    {
+      m_heap.front() = m_heap.back();
+      m_heap.pop_back();
+      m_positions[m_heap.front().first] = 0;
+      SiftDown(0);
+    }
+    else
+    {
+      m_heap.pop_back();
+    }
+  }
+
+private:
+  static uint32_t constexpr kNotInHeap = numeric_limits<uint32_t>::max();
+
+  void SiftUp(uint32_t pos)
+  {
+    pair<uint32_t, TPriority> const e = m_heap[pos];
+    while (pos > 0)
+    {
+      uint32_t const parent = (pos - 1) / D;
+      if (!m_compare(e.second, m_heap[parent].second))
+        break;
+      Place(pos, m_heap[parent]);
+      pos = parent;
+    }
+    Place(pos, e);
+  }
+
+  void SiftDown(uint32_t pos)
+  {
+    pair<uint32_t, TPriority> const e = m_heap[pos];
+    uint32_t const size = static_cast<uint32_t>(m_heap.size());
+    while (true)
+    {
+      uint32_t const first = pos * D + 1;
+      if (first >= size)
+        break;
+
+      uint32_t const last = first + D < size ? first + D : size;
+      uint32_t best = first;
+      for (uint32_t child = first + 1; child < last; ++child)
+      {
+        if (m_compare(m_heap[child].second, m_heap[best].second))
+          best = child;
+      }
+
+      if (!m_compare(m_heap[best].second, e.second))
+        break;
+      Place(pos, m_heap[best]);
+      pos = best;
+    }
+    Place(pos, e);
+  }
+
+  inline void Place(uint32_t pos, pair<uint32_t, TPriority> const & e)
+  {
+    m_heap[pos] = e;
+    m_positions[e.first] = pos;
+  }
+
+  vector<pair<uint32_t, TPriority>> m_heap;
+  vector<uint32_t> m_positions;
+  TCompare m_compare;
+};
+
+template <typename TPriority, size_t D, typename TCompare>
+uint32_t constexpr IndexedHeap<TPriority, D, TCompare>::kNotInHeap;
+}  // namespace my
@@ -0,0 +1,163 @@
+#include "base/work_stealing_pool.hpp"
+
+#include "base/assert.hpp"
+
+namespace threads
+{
+WorkStealingPool::WorkStealingPool(size_t threadsCount)
+{
+  if (threadsCount == 0)
+    threadsCount = 1;
+
+  for (size_t i = 0; i < threadsCount; ++i)
+    m_queues.emplace_back(new Queue());
+
+  // Queue 0 belongs to the calling thread.
+  for (size_t i = 1; i < threadsCount; ++i)
+    m_threads.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+  {
+    lock_guard<mutex> guard(m_mutex);
+    m_stop = true;
+  }
+  m_batchStarted.notify_all();
+
+  for (auto & t : m_threads)
+    t.join();
+}
+
+void WorkStealingPool::ForEach(size_t count, function<void(size_t)> const & fn)
+{
+  if (count == 0)
+    return;
+
+  if (m_threads.empty())
+  {
+    for (size_t i = 0; i < count; ++i)
+      fn(i);
+    return;
+  }
+
+  // Consecutive tasks are given to the same thread.
+  size_t const queuesCount = m_queues.size();
+  for (size_t q = 0; q < queuesCount; ++q)
+  {
+    lock_guard<mutex> guard(m_queues[q]->m_mutex);
+    ASSERT(m_queues[q]->m_tasks.empty(), ());
+    for (size_t i = q * count / queuesCount; i < (q + 1) * count / queuesCount; ++i)
+      m_queues[q]->m_tasks.push_back(i);
+  }
+
+  {
+    lock_guard<mutex> guard(m_mutex);
+    m_fn = &fn;
+    m_exception = exception_ptr();
+    m_failed = false;
+    m_activeWorkers = m_threads.size();
+    ++m_batch;
+  }
+  m_batchStarted.notify_all();
+
+  RunTasks(0);
+
+  exception_ptr exception;
+  {
+    unique_lock<mutex> lock(m_mutex);
+    m_batchFinished.wait(lock, [this]() { return m_activeWorkers == 0; });
+    m_fn = nullptr;
+    exception = m_exception;
+    m_exception = exception_ptr();
+  }
+
+  if (exception)
+    rethrow_exception(exception);
+}
+
+void WorkStealingPool::WorkerLoop(size_t worker)
+{
+  uint64_t batch = 0;
+  while (true)
+  {
+    {
+      unique_lock<mutex> lock(m_mutex);
+      m_batchStarted.wait(lock, [this, batch]() { return m_stop || m_batch != batch; });
+      if (m_stop)
+        return;
+      batch = m_batch;
+    }
+
+    RunTasks(worker);
+
+    {
+      lock_guard<mutex> guard(m_mutex);
+      if (--m_activeWorkers == 0)
+        m_batchFinished.notify_all();
+    }
+  }
+}
+
+void WorkStealingPool::RunTasks(size_t worker)
+{
+  function<void(size_t)> const * fn;
+  {
+    lock_guard<mutex> guard(m_mutex);
+    fn = m_fn;
+  }
+
+  size_t task;
+  while (PopTask(worker, task))
+  {
+    {
+      // Remaining tasks are drained after a failure.
+      lock_guard<mutex> guard(m_mutex);
+      if (m_failed)
+        continue;
+    }
+
+    try
+    {
+      (*fn)(task);
+    }
+    catch (...)
+    {
+      lock_guard<mutex> guard(m_mutex);
+      if (!m_failed)
+      {
+        m_failed = true;
+        m_exception = current_exception();
+      }
+    }
+  }
+}
+
+bool WorkStealingPool::PopTask(size_t worker, size_t & task)
+{
+  {
+    Queue & own = *m_queues[worker];
+    lock_guard<mutex> guard(own.m_mutex);
+    if (!own.m_tasks.empty())
+    {
+      task = own.m_tasks.front();
+      own.m_tasks.pop_front();
+      return true;
+    }
+  }
+
+  size_t const queuesCount = m_queues.size();
+  for (size_t i = 1; i < queuesCount; ++i)
+  {
+    Queue & victim = *m_queues[(worker + i) % queuesCount];
+    lock_guard<mutex> guard(victim.m_mutex);
+    if (!victim.m_tasks.empty())
+    {
+      task = victim.m_tasks.back();
+      victim.m_tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace threads
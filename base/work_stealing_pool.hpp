@@ -0,0 +1,59 @@
+#pragma once
+
+#include "std/condition_variable.hpp"
+#include "std/cstdint.hpp"
+#include "std/deque.hpp"
+#include "std/exception.hpp"
+#include "std/function.hpp"
+#include "std/mutex.hpp"
+#include "std/thread.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
+
+namespace threads
+{
+/// Fork-join pool for short batches of independent tasks. Tasks of a batch
+/// are split between per-thread deques, every thread takes tasks from the front
+/// of its own deque and steals them from the back of other deques when its own
+/// one is empty. The calling thread takes part in the work too.
+class WorkStealingPool
+{
+public:
+  /// @param threadsCount Number of threads including the calling one.
+  explicit WorkStealingPool(size_t threadsCount);
+  ~WorkStealingPool();
+
+  inline size_t GetThreadsCount() const { return m_queues.size(); }
+
+  /// Calls fn(i) for each i in [0, count) and waits for all the calls.
+  /// The first exception thrown by fn is rethrown here, tasks which
+  /// aren't started yet are skipped after it.
+  /// @note ForEach shouldn't be called concurrently.
+  void ForEach(size_t count, function<void(size_t)> const & fn);
+
+private:
+  struct Queue
+  {
+    mutex m_mutex;
+    deque<size_t> m_tasks;
+  };
+
+  void WorkerLoop(size_t worker);
+  void RunTasks(size_t worker);
+  bool PopTask(size_t worker, size_t & task);
+
+  vector<unique_ptr<Queue>> m_queues;
+  vector<thread> m_threads;
+
+  // Guards the fields below.
+  mutex m_mutex;
+  condition_variable m_batchStarted;
+  condition_variable m_batchFinished;
+  function<void(size_t)> const * m_fn = nullptr;
+  uint64_t m_batch = 0;
+  size_t m_activeWorkers = 0;
+  exception_ptr m_exception;
+  bool m_failed = false;
+  bool m_stop = false;
+};
+}  // namespace threads
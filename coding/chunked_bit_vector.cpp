@@ -0,0 +1,205 @@
+#include "coding/chunked_bit_vector.hpp"
+
+#include "base/assert.hpp"
+
+#include "std/algorithm.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+// The same as ChunkedBitVector::kWordsInChunk.
+size_t constexpr kWords = (1 << 16) / 64;
+
+inline uint64_t PopCount64(uint64_t word)
+{
+#if defined(__GNUC__)
+  return static_cast<uint64_t>(__builtin_popcountll(word));
+#else
+  word = word - ((word >> 1) & 0x5555555555555555ULL);
+  word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+  word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (word * 0x0101010101010101ULL) >> 56;
+#endif
+}
+
+// Kernels below compute dst = dst op src for whole chunks.
+// They return false when dst becomes zero.
+#if defined(__SSE2__)
+template <typename TOp>
+bool ApplySSE2(uint64_t * dst, uint64_t const * src, TOp op)
+{
+  __m128i any = _mm_setzero_si128();
+  for (size_t i = 0; i < kWords; i += 2)
+  {
+    __m128i * d = reinterpret_cast<__m128i *>(dst + i);
+    __m128i const s = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + i));
+    __m128i const r = op(_mm_loadu_si128(d), s);
+    _mm_storeu_si128(d, r);
+    any = _mm_or_si128(any, r);
+  }
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xFFFF;
+}
+
+bool AndChunk(uint64_t * dst, uint64_t const * src)
+{
+  return ApplySSE2(dst, src, [](__m128i a, __m128i b) { return _mm_and_si128(a, b); });
+}
+
+void OrChunk(uint64_t * dst, uint64_t const * src)
+{
+  ApplySSE2(dst, src, [](__m128i a, __m128i b) { return _mm_or_si128(a, b); });
+}
+
+bool AndNotChunk(uint64_t * dst, uint64_t const * src)
+{
+  // _mm_andnot_si128(a, b) is ~a & b.
+  return ApplySSE2(dst, src, [](__m128i a, __m128i b) { return _mm_andnot_si128(b, a); });
+}
+#else
+template <typename TOp>
+bool ApplyWords(uint64_t * dst, uint64_t const * src, TOp op)
+{
+  uint64_t any = 0;
+  for (size_t i = 0; i < kWords; ++i)
+  {
+    dst[i] = op(dst[i], src[i]);
+    any |= dst[i];
+  }
+  return any != 0;
+}
+
+bool AndChunk(uint64_t * dst, uint64_t const * src)
+{
+  return ApplyWords(dst, src, [](uint64_t a, uint64_t b) { return a & b; });
+}
+
+void OrChunk(uint64_t * dst, uint64_t const * src)
+{
+  ApplyWords(dst, src, [](uint64_t a, uint64_t b) { return a | b; });
+}
+
+bool AndNotChunk(uint64_t * dst, uint64_t const * src)
+{
+  return ApplyWords(dst, src, [](uint64_t a, uint64_t b) { return a & ~b; });
+}
+#endif
+}  // namespace
+
+ChunkedBitVector::ChunkedBitVector(ChunkedBitVector const & rhs) { *this = rhs; }
+
+ChunkedBitVector & ChunkedBitVector::operator=(ChunkedBitVector const & rhs)
+{
+  if (this == &rhs)
+    return *this;
+
+  m_chunks.clear();
+  m_chunks.resize(rhs.m_chunks.size());
+  for (size_t i = 0; i < rhs.m_chunks.size(); ++i)
+  {
+    if (rhs.m_chunks[i])
+      m_chunks[i].reset(new TChunk(*rhs.m_chunks[i]));
+  }
+  return *this;
+}
+
+void ChunkedBitVector::Set(uint32_t pos)
+{
+  size_t const i = pos >> kLogChunkBits;
+  if (i >= m_chunks.size())
+    m_chunks.resize(i + 1);
+  if (!m_chunks[i])
+  {
+    m_chunks[i].reset(new TChunk);
+    m_chunks[i]->fill(0);
+  }
+
+  uint32_t const bit = pos & ((1 << kLogChunkBits) - 1);
+  (*m_chunks[i])[bit >> 6] |= uint64_t(1) << (bit & 63);
+}
+
+bool ChunkedBitVector::Get(uint32_t pos) const
+{
+  size_t const i = pos >> kLogChunkBits;
+  if (i >= m_chunks.size() || !m_chunks[i])
+    return false;
+
+  uint32_t const bit = pos & ((1 << kLogChunkBits) - 1);
+  return ((*m_chunks[i])[bit >> 6] >> (bit & 63)) & 1;
+}
+
+bool ChunkedBitVector::IsEmpty() const
+{
+  // Chunks are released as soon as they become zero.
+  return m_chunks.empty();
+}
+
+uint64_t ChunkedBitVector::PopCount() const
+{
+  uint64_t count = 0;
+  for (auto const & chunk : m_chunks)
+  {
+    if (!chunk)
+      continue;
+    for (uint64_t word : *chunk)
+      count += PopCount64(word);
+  }
+  return count;
+}
+
+void ChunkedBitVector::And(ChunkedBitVector const & rhs)
+{
+  if (m_chunks.size() > rhs.m_chunks.size())
+    m_chunks.resize(rhs.m_chunks.size());
+
+  for (size_t i = 0; i < m_chunks.size(); ++i)
+  {
+    if (!m_chunks[i])
+      continue;
+    if (!rhs.m_chunks[i] || !AndChunk(m_chunks[i]->data(), rhs.m_chunks[i]->data()))
+      m_chunks[i].reset();
+  }
+  Shrink();
+}
+
+void ChunkedBitVector::Or(ChunkedBitVector const & rhs)
+{
+  if (m_chunks.size() < rhs.m_chunks.size())
+    m_chunks.resize(rhs.m_chunks.size());
+
+  for (size_t i = 0; i < rhs.m_chunks.size(); ++i)
+  {
+    if (!rhs.m_chunks[i])
+      continue;
+    if (!m_chunks[i])
+      m_chunks[i].reset(new TChunk(*rhs.m_chunks[i]));
+    else
+      OrChunk(m_chunks[i]->data(), rhs.m_chunks[i]->data());
+  }
+}
+
+void ChunkedBitVector::AndNot(ChunkedBitVector const & rhs)
+{
+  size_t const n = min(m_chunks.size(), rhs.m_chunks.size());
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (!m_chunks[i] || !rhs.m_chunks[i])
+      continue;
+    if (!AndNotChunk(m_chunks[i]->data(), rhs.m_chunks[i]->data()))
+      m_chunks[i].reset();
+  }
+  Shrink();
+}
+
+void ChunkedBitVector::ToVector(vector<uint32_t> & positions) const
+{
+  ForEach([&positions](uint32_t pos) { positions.push_back(pos); });
+}
+
+void ChunkedBitVector::Shrink()
+{
+  while (!m_chunks.empty() && !m_chunks.back())
+    m_chunks.pop_back();
+}
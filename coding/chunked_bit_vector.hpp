@@ -0,0 +1,79 @@
+#pragma once
+
+#include "std/array.hpp"
+#include "std/cstdint.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
+
+/// Set of 32-bit positions (e.g. feature ids) for fast set operations.
+/// Positions space is split into chunks of 2^16 bits, only chunks with at least
+/// one bit set are allocated, so sparse sets of big ids take little memory.
+/// And/Or/AndNot process whole chunks by 128-bit words (with SSE2) and
+/// iteration skips zero words.
+class ChunkedBitVector
+{
+public:
+  ChunkedBitVector() = default;
+  ChunkedBitVector(ChunkedBitVector const & rhs);
+  ChunkedBitVector(ChunkedBitVector && rhs) = default;
+
+  ChunkedBitVector & operator=(ChunkedBitVector const & rhs);
+  ChunkedBitVector & operator=(ChunkedBitVector && rhs) = default;
+
+  void Set(uint32_t pos);
+  bool Get(uint32_t pos) const;
+
+  bool IsEmpty() const;
+  uint64_t PopCount() const;
+
+  /// In-place set operations: this = this & rhs, this | rhs, this & ~rhs.
+  //@{
+  void And(ChunkedBitVector const & rhs);
+  void Or(ChunkedBitVector const & rhs);
+  void AndNot(ChunkedBitVector const & rhs);
+  //@}
+
+  /// Calls toDo for all the positions in increasing order.
+  template <typename ToDo>
+  void ForEach(ToDo && toDo) const
+  {
+    for (size_t i = 0; i < m_chunks.size(); ++i)
+    {
+      if (!m_chunks[i])
+        continue;
+      TChunk const & chunk = *m_chunks[i];
+      uint32_t const chunkBase = static_cast<uint32_t>(i) << kLogChunkBits;
+      for (uint32_t j = 0; j < kWordsInChunk; ++j)
+      {
+        for (uint64_t word = chunk[j]; word != 0; word &= word - 1)
+          toDo(chunkBase + (j << 6) + NumLoZeroBits64(word));
+      }
+    }
+  }
+
+  /// Appends all the positions in increasing order to positions.
+  void ToVector(vector<uint32_t> & positions) const;
+
+private:
+  static uint32_t constexpr kLogChunkBits = 16;
+  static uint32_t constexpr kWordsInChunk = (1 << kLogChunkBits) / 64;
+
+  using TChunk = array<uint64_t, kWordsInChunk>;
+
+  static inline uint32_t NumLoZeroBits64(uint64_t word)
+  {
+#if defined(__GNUC__)
+    return static_cast<uint32_t>(__builtin_ctzll(word));
+#else
+    uint32_t n = 0;
+    for (; !(word & 1); word >>= 1)
+      ++n;
+    return n;
+#endif
+  }
+
+  // Drops trailing unallocated chunks.
+  void Shrink();
+
+  vector<unique_ptr<TChunk>> m_chunks;
+};
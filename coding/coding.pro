@@ -15,6 +15,7 @@ SOURCES += \
     base64.cpp \
 #    blob_indexer.cpp \
 #    blob_storage.cpp \
+    chunked_bit_vector.cpp \
     compressed_bit_vector.cpp \
 #    compressed_varnum_vector.cpp \
     file_container.cpp \
@@ -48,6 +49,7 @@ HEADERS += \
 #    blob_storage.hpp \
     buffer_reader.hpp \
     byte_stream.hpp \
+    chunked_bit_vector.hpp \
     coder.hpp \
     coder_util.hpp \
     compressed_bit_vector.hpp \
@@ -96,6 +98,7 @@ HEADERS += \
     var_record_reader.hpp \
     var_serial_vector.hpp \
     varint.hpp \
+    varint_batch.hpp \
     varint_misc.hpp \
 #    varint_vector.hpp \
     write_to_sink.hpp \
@@ -0,0 +1,104 @@
+#include "testing/testing.hpp"
+
+#include "coding/chunked_bit_vector.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/iterator.hpp"
+#include "std/random.hpp"
+#include "std/set.hpp"
+#include "std/vector.hpp"
+
+namespace
+{
+vector<uint32_t> ToVector(ChunkedBitVector const & bits)
+{
+  vector<uint32_t> result;
+  bits.ToVector(result);
+  return result;
+}
+
+ChunkedBitVector FromSet(set<uint32_t> const & positions)
+{
+  ChunkedBitVector bits;
+  for (uint32_t pos : positions)
+    bits.Set(pos);
+  return bits;
+}
+
+set<uint32_t> RandomSet(mt19937 & rng, uint32_t maxPos, size_t count)
+{
+  uniform_int_distribution<uint32_t> dist(0, maxPos);
+  set<uint32_t> result;
+  for (size_t i = 0; i < count; ++i)
+    result.insert(dist(rng));
+  return result;
+}
+}  // namespace
+
+UNIT_TEST(ChunkedBitVector_Smoke)
+{
+  ChunkedBitVector bits;
+  TEST(bits.IsEmpty(), ());
+  TEST_EQUAL(bits.PopCount(), 0, ());
+
+  uint32_t const positions[] = {0, 63, 64, 65535, 65536, 1000000, 0xFFFFFFFF};
+  for (uint32_t pos : positions)
+    bits.Set(pos);
+  bits.Set(64);
+
+  TEST(!bits.IsEmpty(), ());
+  TEST_EQUAL(bits.PopCount(), 7, ());
+  for (uint32_t pos : positions)
+    TEST(bits.Get(pos), (pos));
+  TEST(!bits.Get(1), ());
+  TEST(!bits.Get(200000), ());
+  TEST_EQUAL(ToVector(bits), vector<uint32_t>(begin(positions), end(positions)), ());
+}
+
+UNIT_TEST(ChunkedBitVector_SetOperations)
+{
+  mt19937 rng(0);
+  for (uint32_t maxPos : {1000u, 100000u, 3000000u})
+  {
+    set<uint32_t> const a = RandomSet(rng, maxPos, 5000);
+    set<uint32_t> const b = RandomSet(rng, maxPos / 2, 5000);
+
+    vector<uint32_t> expectedAnd, expectedOr, expectedAndNot;
+    set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expectedAnd));
+    set_union(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expectedOr));
+    set_difference(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expectedAndNot));
+
+    ChunkedBitVector const bitsA = FromSet(a);
+    ChunkedBitVector const bitsB = FromSet(b);
+
+    ChunkedBitVector bitsAnd = bitsA;
+    bitsAnd.And(bitsB);
+    TEST_EQUAL(ToVector(bitsAnd), expectedAnd, (maxPos));
+    TEST_EQUAL(bitsAnd.PopCount(), expectedAnd.size(), (maxPos));
+
+    ChunkedBitVector bitsOr = bitsA;
+    bitsOr.Or(bitsB);
+    TEST_EQUAL(ToVector(bitsOr), expectedOr, (maxPos));
+
+    ChunkedBitVector bitsAndNot = bitsA;
+    bitsAndNot.AndNot(bitsB);
+    TEST_EQUAL(ToVector(bitsAndNot), expectedAndNot, (maxPos));
+
+    // Source vectors are left intact.
+    TEST_EQUAL(ToVector(bitsA), vector<uint32_t>(a.begin(), a.end()), (maxPos));
+  }
+}
+
+UNIT_TEST(ChunkedBitVector_BecomesEmpty)
+{
+  ChunkedBitVector a = FromSet({1, 70000, 140000});
+  ChunkedBitVector const b = FromSet({2, 70001});
+
+  ChunkedBitVector c = a;
+  c.And(b);
+  TEST(c.IsEmpty(), ());
+
+  a.AndNot(a);
+  TEST(a.IsEmpty(), ());
+  TEST_EQUAL(a.PopCount(), 0, ());
+}
@@ -16,6 +16,7 @@ SOURCES += ../../testing/testingmain.cpp \
     base64_test.cpp \
     bit_streams_test.cpp \
 #    blob_storage_test.cpp \
+    chunked_bit_vector_test.cpp \
     coder_util_test.cpp \
     compressed_bit_vector_test.cpp \
 #    compressed_varnum_vector_test.cpp \
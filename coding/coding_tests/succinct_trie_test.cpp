@@ -1,16 +1,12 @@
 #include "testing/testing.hpp"
 
+#include "coding/reader.hpp"
 #include "coding/succinct_trie_builder.hpp"
 #include "coding/succinct_trie_reader.hpp"
-#include "coding/trie_builder.hpp"
 #include "coding/trie.hpp"
-#include "coding/reader.hpp"
+#include "coding/trie_builder.hpp"
 #include "coding/writer.hpp"
 
-#include "coding/trie_reader.hpp"
-
-#include "indexer/search_trie.hpp"
-
 #include "base/string_utils.hpp"
 
 #include "std/algorithm.hpp"
@@ -100,24 +96,34 @@ struct SimpleValueList
   vector<uint8_t> m_valueList;
 };
 
-void ReadAllValues(unique_ptr<trie::SuccinctTrieIterator<MemReader, SimpleValueReader,
-                                                         trie::EmptyValueReader>> const & root,
-                   vector<uint8_t> & values)
+using TTrie = trie::SuccinctTrie<SimpleValueReader>;
+using TIterator = TTrie::TIterator;
+
+void ReadAllValues(TIterator const & it, vector<uint8_t> & values)
 {
-  for (size_t i = 0; i < root->NumValues(); ++i)
-    values.push_back(root->GetValue(i));
+  it.ForEachValue([&values](uint8_t v) { values.push_back(v); });
 }
 
-void CollectInSubtree(unique_ptr<trie::SuccinctTrieIterator<MemReader, SimpleValueReader,
-                                                            trie::EmptyValueReader>> const & root,
-                      vector<uint8_t> & collectedValues)
+void CollectInSubtree(TIterator const & it, vector<uint8_t> & collectedValues)
 {
-  ReadAllValues(root, collectedValues);
+  ReadAllValues(it, collectedValues);
+
+  for (uint8_t edge = 0; edge < 2; ++edge)
+  {
+    TIterator child = it;
+    if (child.GoToEdge(edge))
+      CollectInSubtree(child, collectedValues);
+  }
+}
 
-  if (auto l = root->GoToEdge(0))
-    CollectInSubtree(l, collectedValues);
-  if (auto r = root->GoToEdge(1))
-    CollectInSubtree(r, collectedValues);
+template <typename TValueList>
+void BuildTrie(vector<StringsFileEntryMock> & data, vector<uint8_t> & buf)
+{
+  using TWriter = MemWriter<vector<uint8_t>>;
+  TWriter memWriter(buf);
+  trie::BuildSuccinctTrie<TWriter, vector<StringsFileEntryMock>::iterator, trie::EmptyEdgeBuilder,
+                          TValueList>(memWriter, data.begin(), data.end(),
+                                      trie::EmptyEdgeBuilder());
 }
 }  // namespace
 
@@ -131,101 +137,69 @@ namespace trie
 
 UNIT_TEST(SuccinctTrie_Serialization_Smoke1)
 {
-  vector<uint8_t> buf;
-
-  using TWriter = MemWriter<vector<uint8_t>>;
-  TWriter memWriter(buf);
-
   vector<StringsFileEntryMock> data = {StringsFileEntryMock("abacaba", 1)};
-
-  trie::BuildSuccinctTrie<TWriter, vector<StringsFileEntryMock>::iterator, trie::EmptyEdgeBuilder,
-                          EmptyValueList<TWriter>>(memWriter, data.begin(), data.end(),
-                                                   trie::EmptyEdgeBuilder());
-
-  MemReader memReader(buf.data(), buf.size());
-
-  using TEmptyValue = trie::EmptyValueReader::ValueType;
-
-  auto trieRoot =
-      trie::ReadSuccinctTrie(memReader, trie::EmptyValueReader(), trie::EmptyValueReader());
-  TEST(trieRoot, ());
+  vector<uint8_t> buf;
+  BuildTrie<EmptyValueList<MemWriter<vector<uint8_t>>>>(data, buf);
+
+  trie::SuccinctTrie<trie::EmptyValueReader> const trie(buf.data(), buf.size(),
+                                                         trie::EmptyValueReader());
+  auto it = trie.GetRoot();
+  TEST(it.GoToString(strings::MakeUniString("abacaba")), ());
+  size_t count = 0;
+  it.ForEachValue([&count](trie::EmptyValueReader::ValueType) { ++count; });
+  TEST_EQUAL(count, 0, ());
 }
 
 UNIT_TEST(SuccinctTrie_Serialization_Smoke2)
 {
-  vector<uint8_t> buf;
-
-  using TWriter = MemWriter<vector<uint8_t>>;
-  TWriter memWriter(buf);
-
   vector<StringsFileEntryMock> data = {StringsFileEntryMock("abacaba", 1)};
+  vector<uint8_t> buf;
+  BuildTrie<SimpleValueList<MemWriter<vector<uint8_t>>>>(data, buf);
 
-  trie::BuildSuccinctTrie<TWriter, vector<StringsFileEntryMock>::iterator, trie::EmptyEdgeBuilder,
-                          SimpleValueList<TWriter>>(memWriter, data.begin(), data.end(),
-                                                    trie::EmptyEdgeBuilder());
-
-  MemReader memReader(buf.data(), buf.size());
-
-  using TEmptyValue = trie::EmptyValueReader::ValueType;
-
-  auto trieRoot = trie::ReadSuccinctTrie(memReader, SimpleValueReader(), trie::EmptyValueReader());
-  TEST(trieRoot, ());
+  TTrie const trie(buf.data(), buf.size(), SimpleValueReader());
+  vector<uint8_t> values;
+  CollectInSubtree(trie.GetRoot(), values);
+  TEST_EQUAL(values, vector<uint8_t>{1}, ());
 }
 
 UNIT_TEST(SuccinctTrie_Iterator)
 {
-  vector<uint8_t> buf;
-
-  using TWriter = MemWriter<vector<uint8_t>>;
-  TWriter memWriter(buf);
-
   vector<StringsFileEntryMock> data = {StringsFileEntryMock("a", 1), StringsFileEntryMock("b", 2),
                                        StringsFileEntryMock("ab", 3), StringsFileEntryMock("ba", 4),
                                        StringsFileEntryMock("abc", 5)};
   sort(data.begin(), data.end());
+  vector<uint8_t> buf;
+  BuildTrie<SimpleValueList<MemWriter<vector<uint8_t>>>>(data, buf);
 
-  trie::BuildSuccinctTrie<TWriter, vector<StringsFileEntryMock>::iterator, trie::EmptyEdgeBuilder,
-                          SimpleValueList<TWriter>>(memWriter, data.begin(), data.end(),
-                                                    trie::EmptyEdgeBuilder());
-
-  MemReader memReader(buf.data(), buf.size());
-
-  using TEmptyValue = trie::EmptyValueReader::ValueType;
-
-  auto trieRoot = trie::ReadSuccinctTrie(memReader, SimpleValueReader(), trie::EmptyValueReader());
+  TTrie const trie(buf.data(), buf.size(), SimpleValueReader());
 
   vector<uint8_t> collectedValues;
-  CollectInSubtree(trieRoot, collectedValues);
+  CollectInSubtree(trie.GetRoot(), collectedValues);
   sort(collectedValues.begin(), collectedValues.end());
   TEST_EQUAL(collectedValues.size(), 5, ());
   for (size_t i = 0; i < collectedValues.size(); ++i)
     TEST_EQUAL(collectedValues[i], i + 1, ());
+
+  vector<uint8_t> subtreeValues;
+  trie.GetRoot().ForEachValueInSubtree([&subtreeValues](uint8_t v) { subtreeValues.push_back(v); });
+  sort(subtreeValues.begin(), subtreeValues.end());
+  TEST_EQUAL(collectedValues, subtreeValues, ());
 }
 
 UNIT_TEST(SuccinctTrie_MoveToString)
 {
-  vector<uint8_t> buf;
-
-  using TWriter = MemWriter<vector<uint8_t>>;
-  TWriter memWriter(buf);
-
   vector<StringsFileEntryMock> data = {
       StringsFileEntryMock("abcde", 1), StringsFileEntryMock("aaaaa", 2),
       StringsFileEntryMock("aaa", 3), StringsFileEntryMock("aaa", 4)};
   sort(data.begin(), data.end());
+  vector<uint8_t> buf;
+  BuildTrie<SimpleValueList<MemWriter<vector<uint8_t>>>>(data, buf);
 
-  trie::BuildSuccinctTrie<TWriter, vector<StringsFileEntryMock>::iterator, trie::EmptyEdgeBuilder,
-                          SimpleValueList<TWriter>>(memWriter, data.begin(), data.end(),
-                                                    trie::EmptyEdgeBuilder());
-  MemReader memReader(buf.data(), buf.size());
-
-  using TEmptyValue = trie::EmptyValueReader::ValueType;
-
-  auto trieRoot = trie::ReadSuccinctTrie(memReader, SimpleValueReader(), trie::EmptyValueReader());
+  TTrie const trie(buf.data(), buf.size(), SimpleValueReader());
 
   {
-    auto it = trieRoot->GoToString(strings::MakeUniString("a"));
-    TEST(it != nullptr, ());
+    auto it = trie.GetRoot();
+    TEST(it.GoToString(strings::MakeUniString("a")), ());
     vector<uint8_t> expectedValues;
     vector<uint8_t> receivedValues;
     ReadAllValues(it, receivedValues);
@@ -233,8 +207,8 @@ UNIT_TEST(SuccinctTrie_MoveToString)
   }
 
   {
-    auto it = trieRoot->GoToString(strings::MakeUniString("abcde"));
-    TEST(it != nullptr, ());
+    auto it = trie.GetRoot();
+    TEST(it.GoToString(strings::MakeUniString("abcde")), ());
     vector<uint8_t> expectedValues{1};
     vector<uint8_t> receivedValues;
     ReadAllValues(it, receivedValues);
@@ -242,8 +216,8 @@ UNIT_TEST(SuccinctTrie_MoveToString)
   }
 
   {
-    auto it = trieRoot->GoToString(strings::MakeUniString("aaaaa"));
-    TEST(it != nullptr, ());
+    auto it = trie.GetRoot();
+    TEST(it.GoToString(strings::MakeUniString("aaaaa")), ());
     vector<uint8_t> expectedValues{2};
     vector<uint8_t> receivedValues;
     ReadAllValues(it, receivedValues);
@@ -251,8 +225,8 @@ UNIT_TEST(SuccinctTrie_MoveToString)
   }
 
   {
-    auto it = trieRoot->GoToString(strings::MakeUniString("aaa"));
-    TEST(it != nullptr, ());
+    auto it = trie.GetRoot();
+    TEST(it.GoToString(strings::MakeUniString("aaa")), ());
     vector<uint8_t> expectedValues{3, 4};
     vector<uint8_t> receivedValues;
     ReadAllValues(it, receivedValues);
@@ -260,13 +234,64 @@ UNIT_TEST(SuccinctTrie_MoveToString)
   }
 
   {
-    auto it = trieRoot->GoToString(strings::MakeUniString("b"));
-    TEST(it == nullptr, ());
+    auto it = trie.GetRoot();
+    TEST(!it.GoToString(strings::MakeUniString("b")), ());
+    TEST(!it.GoToString(strings::MakeUniString("bbbbb")), ());
+    // Symbols which are not in the encoding.
+    TEST(!it.GoToString(strings::MakeUniString("xyz")), ());
   }
+}
+
+UNIT_TEST(SuccinctTrie_MatchesBruteForce)
+{
+  // Values are indices of the strings, so every string has a distinct value.
+  vector<StringsFileEntryMock> data;
+  for (uint8_t i = 0; i < 200; ++i)
+  {
+    string key;
+    for (uint32_t n = 1 + (i * 7) % 6, x = i; n > 0; --n, x = x * 31 + 17)
+      key.push_back('a' + x % 5);
+    data.emplace_back(key, i);
+  }
+  sort(data.begin(), data.end());
+  vector<uint8_t> buf;
+  BuildTrie<SimpleValueList<MemWriter<vector<uint8_t>>>>(data, buf);
+
+  TTrie const trie(buf.data(), buf.size(), SimpleValueReader());
 
+  for (auto const & e : data)
   {
-    auto it = trieRoot->GoToString(strings::MakeUniString("bbbbb"));
-    TEST(it == nullptr, ());
+    string const key(e.m_key.begin(), e.m_key.end());
+    for (size_t len = 1; len <= key.size(); ++len)
+    {
+      string const prefix = key.substr(0, len);
+
+      vector<uint8_t> expectedFull;
+      vector<uint8_t> expectedPrefix;
+      for (auto const & o : data)
+      {
+        string const s(o.m_key.begin(), o.m_key.end());
+        if (s == prefix)
+          expectedFull.push_back(o.m_value);
+        if (s.compare(0, prefix.size(), prefix) == 0)
+          expectedPrefix.push_back(o.m_value);
+      }
+
+      auto it = trie.GetRoot();
+      TEST(it.GoToString(strings::MakeUniString(prefix)), (prefix));
+
+      vector<uint8_t> full;
+      ReadAllValues(it, full);
+      vector<uint8_t> subtree;
+      it.ForEachValueInSubtree([&subtree](uint8_t v) { subtree.push_back(v); });
+
+      sort(full.begin(), full.end());
+      sort(subtree.begin(), subtree.end());
+      sort(expectedFull.begin(), expectedFull.end());
+      sort(expectedPrefix.begin(), expectedPrefix.end());
+      TEST_EQUAL(full, expectedFull, (prefix));
+      TEST_EQUAL(subtree, expectedPrefix, (prefix));
+    }
   }
 }
 
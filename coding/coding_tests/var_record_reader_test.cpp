@@ -71,3 +71,39 @@ UNIT_TEST(VarRecordReader_Simple)
     TEST_EQUAL(forEachCalls, expectedForEachCalls, ());
   }
 }
+
+UNIT_TEST(MemVarRecordReader_Simple)
+{
+  vector<char> data;
+  {
+    MemWriter<vector<char> > writer(data);
+    WriteVarUint(writer, 3U);
+    writer.Write("abc", 3);
+    WriteVarUint(writer, 200U);
+    writer.Write(string(200, 'x').c_str(), 200);
+    WriteVarUint(writer, 0U);
+  }
+
+  MemVarRecordReader<&VarRecordSizeReaderVarint> recordReader(&data[0], data.size());
+  TEST(recordReader.IsValid(), ());
+
+  char const * record = nullptr;
+  uint32_t size = 0;
+  TEST_EQUAL(4, recordReader.ReadRecord(0, record, size), ());
+  TEST_EQUAL(&data[1], record, ());
+  TEST_EQUAL(string(record, size), "abc", ());
+
+  TEST_EQUAL(206, recordReader.ReadRecord(4, record, size), ());
+  TEST_EQUAL(string(record, size), string(200, 'x'), ());
+
+  TEST_EQUAL(207, recordReader.ReadRecord(206, record, size), ());
+  TEST_EQUAL(0, size, ());
+
+  vector<pair<uint64_t, string> > forEachCalls;
+  recordReader.ForEachRecord(SaveForEachParams(forEachCalls));
+  vector<pair<uint64_t, string> > expectedForEachCalls;
+  expectedForEachCalls.push_back(pair<uint64_t, string>(0, "abc"));
+  expectedForEachCalls.push_back(pair<uint64_t, string>(4, string(200, 'x')));
+  expectedForEachCalls.push_back(pair<uint64_t, string>(206, string()));
+  TEST_EQUAL(forEachCalls, expectedForEachCalls, ());
+}
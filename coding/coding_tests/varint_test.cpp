@@ -2,10 +2,14 @@
 #include "testing/testing.hpp"
 
 #include "coding/byte_stream.hpp"
+#include "coding/varint_batch.hpp"
 
 #include "base/macros.hpp"
 #include "base/stl_add.hpp"
 
+#include "std/limits.hpp"
+#include "std/vector.hpp"
+
 
 namespace
 {
@@ -178,3 +182,72 @@ UNIT_TEST(ReadVarInt64Array)
   }
 }
 
+
+UNIT_TEST(ReadVarInt64Batch)
+{
+  // Runs of one-byte values of different lengths interleaved with long values,
+  // so that long values cross block boundaries at all the positions.
+  vector<int64_t> values;
+  uint32_t seed = 7;
+  for (size_t i = 0; i < 2000; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    uint32_t const r = seed >> 16;
+    if (r % 5 == 0)
+      values.push_back(static_cast<int64_t>(r) << (r % 30));
+    else
+      values.push_back(static_cast<int64_t>(r % 128) - 64);
+  }
+  values.push_back(numeric_limits<int64_t>::max());
+  values.push_back(numeric_limits<int64_t>::min() + 1);
+
+  for (size_t size = 0; size <= values.size(); size += (size < 40 ? 1 : 97))
+  {
+    vector<int64_t> const testValues(values.begin(), values.begin() + size);
+    vector<uint8_t> data;
+    {
+      PushBackByteSink<vector<uint8_t>> dst(data);
+      for (int64_t v : testValues)
+        WriteVarInt(dst, v);
+    }
+    uint8_t const * pBeg = data.data();
+    uint8_t const * pEnd = data.data() + data.size();
+
+    {
+      vector<int64_t> result(data.size());
+      TEST_EQUAL(ReadVarInt64Batch(pBeg, pEnd, result.data()), size, ());
+      result.resize(size);
+      TEST_EQUAL(result, testValues, ("UntilBufferEnd", size));
+    }
+    {
+      vector<int64_t> result(size);
+      TEST_EQUAL(ReadVarInt64Batch(pBeg, size, result.data()), pEnd, ());
+      TEST_EQUAL(result, testValues, ("GivenSize", size));
+    }
+    {
+      vector<uint64_t> expected;
+      ReadVarUint64Array(pBeg, pEnd, MakeBackInsertFunctor(expected));
+      vector<uint64_t> result(data.size());
+      result.resize(ReadVarUint64Batch(pBeg, pEnd, result.data()));
+      TEST_EQUAL(result, expected, (size));
+    }
+  }
+}
+
+UNIT_TEST(ReadVarUint64Batch_Truncated)
+{
+  vector<uint8_t> data(20, 1);
+  data.push_back(0x80);
+
+  vector<uint64_t> result(data.size());
+  bool thrown = false;
+  try
+  {
+    ReadVarUint64Batch(data.data(), data.data() + data.size(), result.data());
+  }
+  catch (ReadVarIntException const &)
+  {
+    thrown = true;
+  }
+  TEST(thrown, ());
+}
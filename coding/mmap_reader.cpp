@@ -87,7 +87,7 @@ MmapReader * MmapReader::CreateSubReader(uint64_t pos, uint64_t size) const
 
 uint8_t * MmapReader::Data() const
 {
-  return m_data->m_memory;
+  return m_data->m_memory + m_offset;
 }
 
 void MmapReader::SetOffsetAndSize(uint64_t offset, uint64_t size)
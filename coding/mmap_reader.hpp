@@ -23,7 +23,8 @@ public:
   virtual void Read(uint64_t pos, void * p, size_t size) const;
   virtual MmapReader * CreateSubReader(uint64_t pos, uint64_t size) const;
 
-  /// Direct file/memory access
+  /// Direct file/memory access.
+  /// @return Pointer to the beginning of this (sub)reader data.
   uint8_t * Data() const;
 
 protected:
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "coding/endianness.hpp"
+#include "coding/write_to_sink.hpp"
+
+#include "base/assert.hpp"
+#include "base/bits.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/cstring.hpp"
+#include "std/vector.hpp"
+
+// Trie format:
+//   -- Serialized Huffman encoding.
+//   -- [varuint] Number of nodes N.
+//   -- [varuint] Number of final nodes F (nodes where key strings end).
+//   -- Zero padding up to a multiple of 8 bytes from the beginning of the trie.
+//   -- Topology of the trie built on Huffman-encoded input strings: RankBitVector of 2N + 1 bits.
+//      Nodes are arranged in the level order and every node gets two bits, the first one
+//      for its left child and the second one for its right child. The bit is set when
+//      the child is present. The bit string is prepended with '1' for a super-root
+//      (the external node representation).
+//   -- Final nodes: RankBitVector of N bits, bit i is set when node i is final.
+//   -- F + 1 uint32 offsets of value lists: values of i-th final node (in the level order)
+//      are stored in [offset[i], offset[i + 1]) of the values buffer. Padded to 8 bytes.
+//   -- Values buffer.
+//
+// Everything after the header is read in place, so a trie in a memory-mapped
+// section is navigated without reading, copying or allocating anything.
+
+namespace trie
+{
+/// Bit vector with constant-time rank, stored as
+///   -- bits packed into little-endian uint64 words;
+///   -- uint32 number of ones before every block of kWordsInBlock words and one more
+///      sample for the end of the vector, padded to 8 bytes.
+class RankBitVector
+{
+public:
+  static uint64_t constexpr kWordsInBlock = 8;
+
+  RankBitVector() : m_words(nullptr), m_samples(nullptr), m_numBits(0) {}
+
+  /// Reads the vector of numBits bits in place from p.
+  /// @return Pointer past the end of the vector.
+  uint8_t const * Map(uint8_t const * p, uint64_t numBits)
+  {
+    m_numBits = numBits;
+    m_words = p;
+    m_samples = p + NumWords(numBits) * sizeof(uint64_t);
+    return p + ByteSize(numBits);
+  }
+
+  uint64_t Size() const { return m_numBits; }
+
+  bool operator[](uint64_t i) const
+  {
+    ASSERT_LESS(i, m_numBits, ());
+    return (Word(i >> 6) >> (i & 63)) & 1;
+  }
+
+  /// @return Number of ones in [0, i).
+  uint64_t Rank(uint64_t i) const
+  {
+    ASSERT_LESS_OR_EQUAL(i, m_numBits, ());
+    uint64_t const w = i >> 6;
+    uint64_t const block = w / kWordsInBlock;
+    uint64_t res = Sample(block);
+    for (uint64_t j = block * kWordsInBlock; j < w; ++j)
+      res += bits::popcount(Word(j));
+    if (i & 63)
+      res += bits::popcount(Word(w) & ((uint64_t(1) << (i & 63)) - 1));
+    return res;
+  }
+
+  static uint64_t NumWords(uint64_t numBits) { return (numBits + 63) / 64; }
+
+  static uint64_t ByteSize(uint64_t numBits)
+  {
+    uint64_t const samplesSize = (NumWords(numBits) / kWordsInBlock + 1) * sizeof(uint32_t);
+    return NumWords(numBits) * sizeof(uint64_t) + (samplesSize + 7) / 8 * 8;
+  }
+
+  template <typename TWriter>
+  static void Write(TWriter & writer, vector<bool> const & bv)
+  {
+    uint64_t const numWords = NumWords(bv.size());
+    vector<uint32_t> samples;
+    samples.reserve(numWords / kWordsInBlock + 1);
+
+    uint32_t ones = 0;
+    for (uint64_t w = 0; w < numWords; ++w)
+    {
+      if (w % kWordsInBlock == 0)
+        samples.push_back(ones);
+
+      uint64_t word = 0;
+      for (uint64_t i = w * 64; i < bv.size() && i < (w + 1) * 64; ++i)
+      {
+        if (bv[i])
+          word |= uint64_t(1) << (i & 63);
+      }
+      ones += static_cast<uint32_t>(bits::popcount(word));
+      WriteToSink(writer, word);
+    }
+    if (numWords % kWordsInBlock == 0)
+      samples.push_back(ones);
+
+    for (uint32_t sample : samples)
+      WriteToSink(writer, sample);
+    if (samples.size() % 2 != 0)
+      WriteToSink(writer, uint32_t(0));
+  }
+
+private:
+  uint64_t Word(uint64_t i) const
+  {
+    uint64_t word;
+    memcpy(&word, m_words + i * sizeof(word), sizeof(word));
+    return SwapIfBigEndian(word);
+  }
+
+  uint32_t Sample(uint64_t i) const
+  {
+    uint32_t sample;
+    memcpy(&sample, m_samples + i * sizeof(sample), sizeof(sample));
+    return SwapIfBigEndian(sample);
+  }
+
+  uint8_t const * m_words;
+  uint8_t const * m_samples;
+  uint64_t m_numBits;
+};
+}  // namespace trie
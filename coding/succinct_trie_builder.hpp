@@ -4,7 +4,9 @@
 #include "coding/byte_stream.hpp"
 #include "coding/huffman.hpp"
 #include "coding/reader.hpp"
+#include "coding/succinct_trie.hpp"
 #include "coding/varint.hpp"
+#include "coding/write_to_sink.hpp"
 #include "coding/writer.hpp"
 
 #include "base/buffer_vector.hpp"
@@ -13,14 +15,10 @@
 
 #include "std/algorithm.hpp"
 #include "std/bind.hpp"
+#include "std/function.hpp"
+#include "std/limits.hpp"
 
-// Trie format:
-//   -- Serialized Huffman encoding.
-//   -- Topology of the trie built on Huffman-encoded input strings [2 bits per node, level-order representation].
-//   -- List of pairs (node id, offset). One pair per final node (i.e. a node where a string ends).
-//      The lists of node ids and offsets are both non-decreasing and are delta-encoded with varuints.
-//   -- Values of final nodes in level-order. The values for final node |id| start at offset |offset|
-//      if there is a pair (id, offset) in the list above.
+// See coding/succinct_trie.hpp for the format description.
 
 namespace trie
 {
@@ -95,49 +93,63 @@ void WriteInLevelOrder(TNode * root, vector<TNode *> & levelOrder)
   }
 }
 
-template <typename TWriter, typename TIter, typename TEdgeBuilder, typename TValueList>
-void BuildSuccinctTrie(TWriter & writer, TIter const beg, TIter const end,
+// Builds the trie from sorted entries, which are passed by forEachSorted(toDo).
+// forEachSorted is called twice: Huffman encoding is built on all the strings first.
+// So the entries may be read from an external storage instead of being kept in memory.
+template <typename TWriter, typename TEntry, typename TEdgeBuilder, typename TValueList,
+          typename TForEachSorted>
+void BuildSuccinctTrie(TWriter & writer, TForEachSorted const & forEachSorted,
                        TEdgeBuilder const & edgeBuilder)
 {
   using TrieChar = uint32_t;
   using TTrieString = buffer_vector<TrieChar, 32>;
   using TNode = Node<TEdgeBuilder, TValueList>;
-  using TEntry = typename TIter::value_type;
+
+  uint64_t const startPos = writer.Pos();
 
   TNode * root = new TNode();
   MY_SCOPE_GUARD(cleanup, bind(&DeleteTrie<TNode>, root));
-  TTrieString prevKey;
-  TEntry prevEntry;
 
-  vector<TEntry> entries;
+  // Calls toDo for all the entries except duplicates.
+  auto const forEachEntry = [&forEachSorted](function<void(TEntry &)> const & toDo)
+  {
+    TTrieString prevKey;
+    TEntry prevEntry;
+    bool isFirst = true;
+    forEachSorted([&](TEntry const & e)
+    {
+      TEntry entry = e;
+      if (!isFirst && entry == prevEntry)
+        return;
+      isFirst = false;
+      TrieChar const * const keyData = entry.GetKeyData();
+      TTrieString key(keyData, keyData + entry.GetKeySize());
+      using namespace std::rel_ops;  // ">=" for keys.
+      CHECK_GREATER_OR_EQUAL(key, prevKey, (key, prevKey));
+      toDo(entry);
+      prevKey.swap(key);
+      prevEntry.Swap(entry);
+    });
+  };
+
   vector<strings::UniString> entryStrings;
-  for (TIter it = beg; it != end; ++it)
+  forEachEntry([&entryStrings](TEntry & entry)
   {
-    TEntry entry = *it;
-    if (it != beg && entry == prevEntry)
-      continue;
     TrieChar const * const keyData = entry.GetKeyData();
-    TTrieString key(keyData, keyData + entry.GetKeySize());
-    using namespace std::rel_ops;  // ">=" for keys.
-    CHECK_GREATER_OR_EQUAL(key, prevKey, (key, prevKey));
-    entries.push_back(entry);
     entryStrings.push_back(strings::UniString(keyData, keyData + entry.GetKeySize()));
-    prevKey.swap(key);
-    prevEntry.Swap(entry);
-  }
+  });
 
   coding::HuffmanCoder huffman;
   huffman.Init(entryStrings);
   huffman.WriteEncoding(writer);
 
-  for (size_t i = 0; i < entries.size(); ++i)
+  size_t i = 0;
+  vector<uint8_t> buf;
+  forEachEntry([&](TEntry & entry)
   {
-    TEntry const & entry = entries[i];
-    auto const & key = entryStrings[i];
-
-    vector<uint8_t> buf;
+    buf.clear();
     MemWriter<vector<uint8_t>> memWriter(buf);
-    uint32_t numBits = huffman.EncodeAndWrite(memWriter, key);
+    uint32_t numBits = huffman.EncodeAndWrite(memWriter, entryStrings[i++]);
 
     MemReader bitEncoding(&buf[0], buf.size());
 
@@ -145,62 +157,65 @@ void BuildSuccinctTrie(TWriter & writer, TIter const beg, TIter const end,
     cur->m_isFinal = true;
     cur->m_valueList.Append(entry.GetValue());
     cur->m_edgeBuilder.AddValue(entry.value_data(), entry.value_size());
-  }
+  });
+  vector<strings::UniString>().swap(entryStrings);
 
   vector<TNode *> levelOrder;
   WriteInLevelOrder(root, levelOrder);
+  uint32_t const numNodes = static_cast<uint32_t>(levelOrder.size());
 
-  {
-    // Trie topology.
-    BitWriter<TWriter> bitWriter(writer);
-    WriteVarUint(writer, levelOrder.size());
-    for (size_t i = 0; i < levelOrder.size(); ++i)
-    {
-      auto const & cur = levelOrder[i];
-      bitWriter.Write(cur->l ? 1 : 0, 1 /* numBits */);
-      bitWriter.Write(cur->r ? 1 : 0, 1 /* numBits */);
-    }
-  }
-
-  vector<uint32_t> finalNodeIds;
-  vector<uint32_t> offsetTable;
+  vector<bool> topology(2 * numNodes + 1);
+  vector<bool> finalNodes(numNodes);
+  vector<uint32_t> offsets;
   vector<uint8_t> valueBuf;
   MemWriter<vector<uint8_t>> valueWriter(valueBuf);
-  for (size_t i = 0; i < levelOrder.size(); ++i)
+
+  topology[0] = true;
+  for (uint32_t id = 0; id < numNodes; ++id)
   {
-    TNode const * node = levelOrder[i];
+    TNode const * node = levelOrder[id];
+    topology[2 * id + 1] = (node->l != nullptr);
+    topology[2 * id + 2] = (node->r != nullptr);
     if (!node->m_isFinal)
       continue;
-    finalNodeIds.push_back(static_cast<uint32_t>(i));
-    offsetTable.push_back(valueWriter.Pos());
+    finalNodes[id] = true;
+    offsets.push_back(static_cast<uint32_t>(valueWriter.Pos()));
     node->m_valueList.Dump(valueWriter);
   }
+  CHECK_LESS_OR_EQUAL(valueBuf.size(), numeric_limits<uint32_t>::max(), ());
+  offsets.push_back(static_cast<uint32_t>(valueBuf.size()));
 
-  WriteVarUint(writer, finalNodeIds.size());
-  for (size_t i = 0; i < finalNodeIds.size(); ++i)
-  {
-    if (i == 0)
-    {
-      WriteVarUint(writer, finalNodeIds[i]);
-      WriteVarUint(writer, offsetTable[i]);
-    }
-    else
-    {
-      WriteVarUint(writer, finalNodeIds[i] - finalNodeIds[i - 1]);
-      WriteVarUint(writer, offsetTable[i] - offsetTable[i - 1]);
-    }
-  }
+  WriteVarUint(writer, numNodes);
+  WriteVarUint(writer, offsets.size() - 1);
+  while ((writer.Pos() - startPos) % 8 != 0)
+    WriteToSink(writer, uint8_t(0));
+
+  RankBitVector::Write(writer, topology);
+  RankBitVector::Write(writer, finalNodes);
+  for (uint32_t offset : offsets)
+    WriteToSink(writer, offset);
+  if (offsets.size() % 2 != 0)
+    WriteToSink(writer, uint32_t(0));
 
   writer.Write(valueBuf.data(), valueBuf.size());
 
-  // todo(@pimenov):
-  // 1. Investigate the possibility of path compression (short edges + lcp table).
-  // 2. It is highly probable that valueList will be only a list of feature ids in our
-  //    future implementations of the search.
-  //    We can then dispose of offsetTable and store finalNodeIds as another bit vector.
-  //    Alternatively (and probably better), we can append a special symbol to all those
-  //    strings that have non-empty value lists. We can then get the leaf number
-  //    of a final node by doing rank0.
+  // todo(@pimenov): Investigate the possibility of path compression (short edges + lcp table).
+}
+
+// Builds the trie from sorted entries in [beg, end). The entries are passed twice,
+// so TIter should be a forward iterator.
+template <typename TWriter, typename TIter, typename TEdgeBuilder, typename TValueList>
+void BuildSuccinctTrie(TWriter & writer, TIter const beg, TIter const end,
+                       TEdgeBuilder const & edgeBuilder)
+{
+  using TEntry = typename TIter::value_type;
+  BuildSuccinctTrie<TWriter, TEntry, TEdgeBuilder, TValueList>(
+      writer, [&beg, &end](function<void(TEntry const &)> const & toDo)
+      {
+        for (TIter it = beg; it != end; ++it)
+          toDo(*it);
+      },
+      edgeBuilder);
 }
 
 }  // namespace trie
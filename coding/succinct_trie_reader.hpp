@@ -1,47 +1,58 @@
 #pragma once
-#include "coding/bit_streams.hpp"
 #include "coding/huffman.hpp"
 #include "coding/reader.hpp"
-#include "coding/trie.hpp"
+#include "coding/succinct_trie.hpp"
 #include "coding/varint.hpp"
 
 #include "base/assert.hpp"
-#include "base/bits.hpp"
 #include "base/macros.hpp"
 #include "base/string_utils.hpp"
 
-#include "std/utility.hpp"
-#include "std/vector.hpp"
-
-#include "3party/succinct/rs_bit_vector.hpp"
+#include "std/algorithm.hpp"
+#include "std/cstdint.hpp"
+#include "std/cstring.hpp"
 
 namespace trie
 {
-// This class is used to read the data that is common to every node
-// of the trie: the trie topology and the offsets into the data buffer.
-// The topology can then be used to navigate the trie and the offsets
-// can be used to extract the values associated with the key strings.
-template <class TReader, class TValueReader, class TEdgeValueReader>
-class TopologyAndOffsets
+template <class TValueReader>
+class SuccinctTrieIterator;
+
+// Succinct trie over a memory block, e.g. a memory-mapped mwm section.
+// The block should outlive the trie and its iterators. Only the Huffman
+// encoding is read into memory, the topology, offsets and values are
+// read in place (see coding/succinct_trie.hpp for the format).
+template <class TValueReader>
+class SuccinctTrie
 {
 public:
   using TValue = typename TValueReader::ValueType;
-  using TEdgeValue = typename TEdgeValueReader::ValueType;
+  using TIterator = SuccinctTrieIterator<TValueReader>;
 
-  TopologyAndOffsets(TReader const & reader, TValueReader const & valueReader,
-                     TEdgeValueReader const & edgeValueReader)
-    : m_reader(reader), m_valueReader(valueReader), m_edgeValueReader(edgeValueReader)
+  SuccinctTrie(void const * data, size_t size, TValueReader const & valueReader)
+    : m_valueReader(valueReader)
   {
-    Parse();
+    uint8_t const * const base = static_cast<uint8_t const *>(data);
+    MemReader reader(base, size);
+    ReaderSource<MemReader> src(reader);
+
+    m_huffman.ReadEncoding(src);
+    m_numNodes = ReadVarUint<uint32_t>(src);
+    uint32_t const numFinalNodes = ReadVarUint<uint32_t>(src);
+    uint64_t pos = src.Pos();
+    pos = (pos + 7) / 8 * 8;
+
+    uint8_t const * p = m_topology.Map(base + pos, 2 * static_cast<uint64_t>(m_numNodes) + 1);
+    p = m_finalNodes.Map(p, m_numNodes);
+    m_offsets = p;
+    p += (numFinalNodes + 2) / 2 * 2 * sizeof(uint32_t);
+    m_values = p;
+
+    if (p > base + size)
+      MYTHROW(Reader::SizeException, (p - base, size));
+    ASSERT_EQUAL(m_finalNodes.Rank(m_numNodes), numFinalNodes, ());
   }
 
-  // Returns the topology of the trie in the external node representation.
-  // Arrange the nodes in the level order and write two bits for every
-  // node: the first bit for its left child and the second bit for its right child.
-  // Write '1' if the child is present and '0' if it is not.
-  // Prepend the resulting bit string with '1' (for a super-root) and you will get
-  // the external node representaiton.
-  succinct::rs_bit_vector const & GetTopology() const { return m_trieTopology; }
+  TIterator GetRoot() const { return TIterator(*this, 1 /* nodeBitPosition */); }
 
   // Returns the number of trie nodes.
   uint32_t NumNodes() const { return m_numNodes; }
@@ -50,212 +61,173 @@ public:
   // before adding them to this trie.
   coding::HuffmanCoder const & GetEncoding() const { return m_huffman; }
 
-  // Returns true if and only if the node is the last node of a string
-  // that was used as a key when building this trie.
-  bool NodeIsFinal(uint32_t id) const { return m_finalNodeIndex[id] >= 0; }
-
-  // Returns the offset relative to the beginning of the start of the
-  // value buffer where the data for node number |id| starts.
-  uint32_t Offset(uint32_t id) const
-  {
-    CHECK(NodeIsFinal(id), ());
-    return m_offsetTable[m_finalNodeIndex[id]];
-  }
+private:
+  friend class SuccinctTrieIterator<TValueReader>;
 
-  // Returns the number of values associated with a final node |id|.
-  uint32_t ValueListSize(uint32_t id)
+  // Returns the bit position of the child of the node at |nodeBitPosition|,
+  // or 0 when there is no such child. Bit positions are 1-based indices
+  // in the external node representation.
+  uint32_t GetChild(uint32_t nodeBitPosition, uint8_t edge) const
   {
-    CHECK(NodeIsFinal(id), ());
-    int finalId = m_finalNodeIndex[id];
-    return m_offsetTable[finalId + 1] - m_offsetTable[finalId];
+    ASSERT_LESS(edge, 2, ("Bad edge id of a binary trie."));
+    ASSERT(m_topology[nodeBitPosition - 1], (nodeBitPosition));
+    // Rank(x) is the number of ones in [0, x), but we count bit positions from 1.
+    uint32_t const child = 2 * static_cast<uint32_t>(m_topology.Rank(nodeBitPosition)) + edge;
+    if (child > 2 * m_numNodes + 1 || !m_topology[child - 1])
+      return 0;
+    return child;
   }
 
-  // Returns the reader from which the value buffer can be read.
-  TValueReader const & GetValueReader() const { return m_valueReader; }
-
-  // Returns the reader from which the trie can be read.
-  TReader const & GetReader() const { return m_reader; }
-
-private:
-  void Parse()
+  // Calls toDo for all the values of final nodes among the nodes with 0-based
+  // ids in [from, to). Values of such nodes are stored contiguously.
+  template <typename ToDo>
+  void ForEachValue(uint32_t from, uint32_t to, ToDo && toDo) const
   {
-    ReaderSource<TReader> src(m_reader);
+    uint32_t const beg = Offset(m_finalNodes.Rank(from));
+    uint32_t const end = Offset(m_finalNodes.Rank(to));
+    if (beg == end)
+      return;
 
-    m_huffman.ReadEncoding(src);
-    m_numNodes = ReadVarUint<uint32_t, ReaderSource<TReader>>(src);
-
-    BitReader<ReaderSource<TReader>> bitReader(src);
-    vector<bool> bv(2 * m_numNodes + 1);
-    // Convert the level order representation into the external node representation.
-    bv[0] = 1;
-    for (size_t i = 0; i < 2 * m_numNodes; ++i)
-      bv[i + 1] = bitReader.Read(1) == 1;
-
-    succinct::rs_bit_vector(bv).swap(m_trieTopology);
-
-    uint32_t const numFinalNodes = ReadVarUint<uint32_t, ReaderSource<TReader>>(src);
-    m_finalNodeIndex.assign(m_numNodes, -1);
-    m_offsetTable.resize(numFinalNodes + 1);
-    uint32_t id = 0;
-    uint32_t offset = 0;
-    for (size_t i = 0; i < numFinalNodes; ++i)
+    MemReader reader(m_values + beg, end - beg);
+    ReaderSource<MemReader> src(reader);
+    while (src.Size() > 0)
     {
-      // ids and offsets are delta-encoded
-      id += ReadVarUint<uint32_t, ReaderSource<TReader>>(src);
-      offset += ReadVarUint<uint32_t, ReaderSource<TReader>>(src);
-      m_finalNodeIndex[id] = i;
-      m_offsetTable[i] = offset;
+      TValue value;
+      m_valueReader(src, value);
+      toDo(value);
     }
-    m_offsetTable[numFinalNodes] = src.Size();
-    m_reader = m_reader.SubReader(src.Pos(), src.Size());
   }
 
-  TReader m_reader;
+  uint32_t Offset(uint64_t finalIndex) const
+  {
+    uint32_t offset;
+    memcpy(&offset, m_offsets + finalIndex * sizeof(offset), sizeof(offset));
+    return SwapIfBigEndian(offset);
+  }
 
-  // todo(@pimenov) Why do we even need an instance? Type name is enough.
-  TValueReader const & m_valueReader;
-  TEdgeValueReader const & m_edgeValueReader;
+  TValueReader const m_valueReader;
+  coding::HuffmanCoder m_huffman;
   uint32_t m_numNodes;
 
-  coding::HuffmanCoder m_huffman;
-  succinct::rs_bit_vector m_trieTopology;
+  RankBitVector m_topology;
+  RankBitVector m_finalNodes;
+  uint8_t const * m_offsets;
+  uint8_t const * m_values;
 
-  // m_finalNodeIndex[i] is the 0-based index of the i'th
-  // node in the list of all final nodes, or -1 if the
-  // node is not final.
-  vector<int> m_finalNodeIndex;
-  vector<uint32_t> m_offsetTable;
+  DISALLOW_COPY_AND_MOVE(SuccinctTrie);
 };
 
-template <class TReader, class TValueReader, class TEdgeValueReader>
+// Lightweight position in a SuccinctTrie, which can be freely copied.
+// Navigation doesn't allocate memory.
+template <class TValueReader>
 class SuccinctTrieIterator
 {
 public:
-  using TValue = typename TValueReader::ValueType;
-  using TEdgeValue = typename TEdgeValueReader::ValueType;
-  using TCommonData = TopologyAndOffsets<TReader, TValueReader, TEdgeValueReader>;
+  using TTrie = SuccinctTrie<TValueReader>;
 
-  SuccinctTrieIterator(TReader const & reader, shared_ptr<TCommonData> common,
-                       uint32_t nodeBitPosition)
-    : m_reader(reader), m_common(common), m_nodeBitPosition(nodeBitPosition), m_valuesRead(false)
+  SuccinctTrieIterator() : m_trie(nullptr), m_nodeBitPosition(0) {}
+  SuccinctTrieIterator(TTrie const & trie, uint32_t nodeBitPosition)
+    : m_trie(&trie), m_nodeBitPosition(nodeBitPosition)
   {
   }
 
-  unique_ptr<SuccinctTrieIterator> Clone() const
+  bool IsValid() const { return m_trie != nullptr; }
+
+  // Returns the Huffman encoding of the trie, e.g. to decode edges during traversal.
+  coding::HuffmanCoder const & GetEncoding() const { return m_trie->GetEncoding(); }
+
+  // Moves to the left (0) or right (1) child.
+  // @return False and leaves the iterator unchanged when there is no such child.
+  bool GoToEdge(uint8_t edge)
   {
-    return make_unique<SuccinctTrieIterator>(m_reader, m_common, m_nodeBitPosition);
+    uint32_t const child = m_trie->GetChild(m_nodeBitPosition, edge);
+    if (child == 0)
+      return false;
+    m_nodeBitPosition = child;
+    return true;
   }
 
-  unique_ptr<SuccinctTrieIterator> GoToEdge(size_t i) const
+  // Moves along the Huffman code of a symbol.
+  // @return False and leaves the iterator unchanged when the path doesn't exist.
+  bool GoToSymbol(uint32_t symbol)
   {
-    ASSERT_LESS(i, 2, ("Bad edge id of a binary trie."));
-    ASSERT_EQUAL(m_common->GetTopology()[m_nodeBitPosition - 1], 1, (m_nodeBitPosition));
-
-    // rank(x) returns the number of ones in [0, x) but we count bit positions from 1
-    uint32_t childBitPosition = 2 * m_common->GetTopology().rank(m_nodeBitPosition);
-    if (i == 1)
-      ++childBitPosition;
-    if (childBitPosition > 2 * m_common->NumNodes() ||
-        m_common->GetTopology()[childBitPosition - 1] == 0)
-    {
-      return nullptr;
-    }
-    return make_unique<SuccinctTrieIterator>(m_reader, m_common, childBitPosition);
+    uint32_t const position = m_nodeBitPosition;
+    if (MoveBySymbol(symbol))
+      return true;
+    m_nodeBitPosition = position;
+    return false;
   }
 
-  template <typename TEncodingReader>
-  unique_ptr<SuccinctTrieIterator> GoToString(TEncodingReader & bitEncoding, uint32_t numBits)
+  // Moves along the Huffman encoding of a string.
+  // @return False and leaves the iterator unchanged when the path doesn't exist.
+  bool GoToString(strings::UniString const & s)
   {
-    ReaderSource<TEncodingReader> src(bitEncoding);
-
-    // String size. Useful when the string is not alone in the writer to know where it
-    // ends but useless for our purpose here.
-    ReadVarUint<uint32_t, ReaderSource<TEncodingReader>>(src);
-
-    BitReader<ReaderSource<TEncodingReader>> bitReader(src);
-
-    auto ret = Clone();
-    for (uint32_t i = 0; i < numBits; ++i)
+    uint32_t const position = m_nodeBitPosition;
+    for (strings::UniChar c : s)
     {
-      uint8_t bit = bitReader.Read(1);
-      auto nxt = ret->GoToEdge(bit);
-      if (!nxt)
-        return nullptr;
-      ret = move(nxt);
+      if (!MoveBySymbol(static_cast<uint32_t>(c)))
+      {
+        m_nodeBitPosition = position;
+        return false;
+      }
     }
-    return ret;
+    return true;
   }
 
-  unique_ptr<SuccinctTrieIterator> GoToString(strings::UniString const & s)
+  // Calls toDo for the values of the current node.
+  template <typename ToDo>
+  void ForEachValue(ToDo && toDo) const
   {
-    vector<uint8_t> buf;
-    uint32_t numBits;
-    {
-      MemWriter<vector<uint8_t>> writer(buf);
-      numBits = m_common->GetEncoding().EncodeAndWrite(writer, s);
-    }
-    MemReader reader(&buf[0], buf.size());
-    return GoToString(reader, numBits);
+    uint32_t const id = NodeId();
+    m_trie->ForEachValue(id, id + 1, toDo);
   }
 
-  uint32_t NumValues()
+  // Calls toDo for the values of all the nodes in the subtree of the current node.
+  // In the level order, descendants of a node on every level are a contiguous range,
+  // so the subtree is traversed level by level without a queue.
+  template <typename ToDo>
+  void ForEachValueInSubtree(ToDo && toDo) const
   {
-    if (!m_valuesRead)
-      ReadValues();
-    return m_values.size();
+    uint64_t const maxPosition = 2 * static_cast<uint64_t>(m_trie->m_numNodes) + 1;
+    uint64_t lo = m_nodeBitPosition;
+    uint64_t hi = m_nodeBitPosition;
+    while (lo <= hi)
+    {
+      // Nodes at positions [lo, hi] have 0-based ids [from, to).
+      uint32_t const from = static_cast<uint32_t>(m_trie->m_topology.Rank(lo - 1));
+      uint32_t const to = static_cast<uint32_t>(m_trie->m_topology.Rank(hi));
+      if (from == to)
+        break;
+      m_trie->ForEachValue(from, to, toDo);
+      lo = 2 * static_cast<uint64_t>(from + 1);
+      hi = min(2 * static_cast<uint64_t>(to) + 1, maxPosition);
+    }
   }
 
-  TValue GetValue(size_t i)
+private:
+  uint32_t NodeId() const
   {
-    if (!m_valuesRead)
-      ReadValues();
-    ASSERT_LESS(i, m_values.size(), ());
-    return m_values[i];
+    return static_cast<uint32_t>(m_trie->m_topology.Rank(m_nodeBitPosition)) - 1;
   }
 
-private:
-  void ReadValues()
+  bool MoveBySymbol(uint32_t symbol)
   {
-    if (m_valuesRead)
-      return;
-    m_valuesRead = true;
-    // Back to 0-based indices.
-    uint32_t m_nodeId = m_common->GetTopology().rank(m_nodeBitPosition) - 1;
-    if (!m_common->NodeIsFinal(m_nodeId))
-      return;
-    uint32_t offset = m_common->Offset(m_nodeId);
-    uint32_t size = m_common->ValueListSize(m_nodeId);
-    ReaderPtr<TReader> subReaderPtr(m_reader.CreateSubReader(offset, size));
-    ReaderSource<ReaderPtr<TReader>> src(subReaderPtr);
-    while (src.Size() > 0)
+    coding::HuffmanCoder::Code code;
+    if (!m_trie->GetEncoding().Encode(symbol, code))
+      return false;
+    // Codes are written starting from the least significant bit.
+    for (uint32_t i = 0; i < code.len; ++i)
     {
-      TValue val;
-      m_common->GetValueReader()(src, val);
-      m_values.push_back(val);
+      if (!GoToEdge(static_cast<uint8_t>((code.bits >> i) & 1)))
+        return false;
     }
+    return true;
   }
 
-  TReader const & m_reader;
-  shared_ptr<TCommonData> m_common;
+  TTrie const * m_trie;
 
   // The bit with this 1-based index represents this node
   // in the external node representation of binary trie.
   uint32_t m_nodeBitPosition;
-
-  vector<TValue> m_values;
-  bool m_valuesRead;
 };
-
-template <typename TReader, typename TValueReader, typename TEdgeValueReader>
-unique_ptr<SuccinctTrieIterator<TReader, TValueReader, TEdgeValueReader>> ReadSuccinctTrie(
-    TReader const & reader, TValueReader valueReader = TValueReader(),
-    TEdgeValueReader edgeValueReader = TEdgeValueReader())
-{
-  using TCommonData = TopologyAndOffsets<TReader, TValueReader, TEdgeValueReader>;
-  using TIter = SuccinctTrieIterator<TReader, TValueReader, TEdgeValueReader>;
-
-  shared_ptr<TCommonData> common(new TCommonData(reader, valueReader, edgeValueReader));
-  return make_unique<TIter>(common->GetReader(), common, 1 /* bitPosition */);
-}
-
 }  // namespace trie
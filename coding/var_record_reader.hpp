@@ -79,3 +79,47 @@ protected:
   uint64_t m_ReaderSize;
   uint32_t m_ExpectedRecordSize; // Expected size of a record.
 };
+
+// Reads records, encoded as [size] [Data] .. [size] [Data], directly from memory
+// (e.g. memory-mapped file) without any copying.
+// Second template parameter is the same strategy as in VarRecordReader.
+template <uint32_t (*VarRecordSizeReaderFn)(ArrayByteSource &)>
+class MemVarRecordReader
+{
+public:
+  MemVarRecordReader(char const * data, uint64_t size) : m_Data(data), m_Size(size) {}
+
+  inline bool IsValid() const { return m_Data != nullptr; }
+
+  // Record data is valid as long as the underlying memory is valid.
+  uint64_t ReadRecord(uint64_t const pos, char const * & record, uint32_t & recordSize) const
+  {
+    ASSERT_LESS(pos, m_Size, ());
+    ArrayByteSource source(m_Data + pos);
+    recordSize = VarRecordSizeReaderFn(source);
+    record = source.PtrC();
+    uint64_t const nextPos = static_cast<uint64_t>(record - m_Data) + recordSize;
+    ASSERT_LESS_OR_EQUAL(nextPos, m_Size, ());
+    return nextPos;
+  }
+
+  template <typename F>
+  void ForEachRecord(F const & f) const
+  {
+    uint64_t pos = 0;
+    while (pos < m_Size)
+    {
+      char const * record = nullptr;
+      uint32_t size = 0;
+      uint64_t nextPos = ReadRecord(pos, record, size);
+      // uint64_t -> uint32_t : assume that feature dat file not more than 4Gb
+      f(static_cast<uint32_t>(pos), record, size);
+      pos = nextPos;
+    }
+    ASSERT_EQUAL(pos, m_Size, ());
+  }
+
+private:
+  char const * m_Data;
+  uint64_t m_Size;
+};
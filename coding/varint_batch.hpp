@@ -0,0 +1,143 @@
+#pragma once
+
+#include "coding/endianness.hpp"
+#include "coding/varint.hpp"
+
+#include "base/bits.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/cstring.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Batch decoders of varint arrays into plain memory. They give the same results
+/// as ReadVarUint64Array / ReadVarInt64Array, but deltas in geometry are mostly
+/// small, so runs of one-byte varints are decoded a block (16 bytes with SSE2,
+/// 8 bytes otherwise) at a time and only longer varints are decoded byte by byte.
+
+namespace impl
+{
+#if defined(__SSE2__)
+size_t constexpr kVarintBlockSize = 16;
+
+// Returns a mask with bit i set if byte i of the block has a continuation flag.
+inline uint32_t GetVarintContinuationMask(uint8_t const * p)
+{
+  return static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p))));
+}
+#else
+size_t constexpr kVarintBlockSize = 8;
+
+inline uint32_t GetVarintContinuationMask(uint8_t const * p)
+{
+  uint64_t word;
+  memcpy(&word, p, sizeof(word));
+  word = (SwapIfBigEndian(word) >> 7) & 0x0101010101010101ULL;
+  // Gathers the lowest bits of all the bytes in the highest byte.
+  return static_cast<uint32_t>((word * 0x0102040810204080ULL) >> 56);
+}
+#endif
+
+inline uint32_t NumLoZeroBits32(uint32_t mask)
+{
+  ASSERT_NOT_EQUAL(mask, 0, ());
+#if defined(__GNUC__)
+  return static_cast<uint32_t>(__builtin_ctz(mask));
+#else
+  uint32_t n = 0;
+  for (; !(mask & 1); mask >>= 1)
+    ++n;
+  return n;
+#endif
+}
+
+// Decodes a single varint, which should end before pEnd.
+inline uint64_t ReadVarUint64Bounded(uint8_t const *& p, uint8_t const * pEnd)
+{
+  uint64_t res = 0;
+  for (uint32_t shift = 0; p < pEnd && shift < 64; shift += 7)
+  {
+    uint8_t const t = *p++;
+    res |= static_cast<uint64_t>(t & 127) << shift;
+    if (!(t & 128))
+      return res;
+  }
+  MYTHROW(ReadVarIntException, ());
+}
+
+// Decodes at most maxCount varints from [p, pEnd). Block loads are done only when
+// the block is known to be inside the buffer: either it's before pEnd, or there
+// are at least kVarintBlockSize values left to decode.
+template <typename T, typename ConverterT>
+uint8_t const * ReadVarUint64Batch(uint8_t const * p, uint8_t const * pEnd, bool endIsKnown,
+                                   size_t maxCount, T * out, size_t & count,
+                                   ConverterT converter)
+{
+  size_t const kMaxVarintSize = 10;
+
+  count = 0;
+  while (count < maxCount && (!endIsKnown || p < pEnd))
+  {
+    if (maxCount - count >= kVarintBlockSize &&
+        (!endIsKnown || static_cast<size_t>(pEnd - p) >= kVarintBlockSize))
+    {
+      uint32_t const mask = GetVarintContinuationMask(p);
+      size_t const ones = mask == 0 ? kVarintBlockSize : NumLoZeroBits32(mask);
+      for (size_t i = 0; i < ones; ++i)
+        out[count + i] = converter(static_cast<uint64_t>(p[i]));
+      p += ones;
+      count += ones;
+      if (ones == kVarintBlockSize)
+        continue;
+    }
+
+    out[count++] = converter(ReadVarUint64Bounded(p, endIsKnown ? pEnd : p + kMaxVarintSize));
+  }
+  return p;
+}
+}  // namespace impl
+
+/// Decodes all the varints in [pBeg, pEnd) to out, which should have room for
+/// (pEnd - pBeg) values.
+/// @return Number of decoded values.
+inline size_t ReadVarUint64Batch(void const * pBeg, void const * pEnd, uint64_t * out)
+{
+  uint8_t const * p = static_cast<uint8_t const *>(pBeg);
+  uint8_t const * e = static_cast<uint8_t const *>(pEnd);
+  size_t count = 0;
+  impl::ReadVarUint64Batch(p, e, true /* endIsKnown */, static_cast<size_t>(e - p), out, count,
+                           IdFunctor());
+  return count;
+}
+
+/// Decodes count varints starting at pBeg to out.
+/// @return Pointer to the byte after the last decoded varint.
+inline void const * ReadVarUint64Batch(void const * pBeg, size_t count, uint64_t * out)
+{
+  uint8_t const * p = static_cast<uint8_t const *>(pBeg);
+  size_t decoded = 0;
+  return impl::ReadVarUint64Batch(p, nullptr, false /* endIsKnown */, count, out, decoded,
+                                  IdFunctor());
+}
+
+/// The same as ReadVarUint64Batch for zigzag-encoded signed values.
+inline size_t ReadVarInt64Batch(void const * pBeg, void const * pEnd, int64_t * out)
+{
+  uint8_t const * p = static_cast<uint8_t const *>(pBeg);
+  uint8_t const * e = static_cast<uint8_t const *>(pEnd);
+  size_t count = 0;
+  impl::ReadVarUint64Batch(p, e, true /* endIsKnown */, static_cast<size_t>(e - p), out, count,
+                           &bits::ZigZagDecode<uint64_t>);
+  return count;
+}
+
+inline void const * ReadVarInt64Batch(void const * pBeg, size_t count, int64_t * out)
+{
+  uint8_t const * p = static_cast<uint8_t const *>(pBeg);
+  size_t decoded = 0;
+  return impl::ReadVarUint64Batch(p, nullptr, false /* endIsKnown */, count, out, decoded,
+                                  &bits::ZigZagDecode<uint64_t>);
+}
@@ -19,11 +19,13 @@
 #define TRIANGLE_FILE_TAG "trg"
 #define INDEX_FILE_TAG "idx"
 #define SEARCH_INDEX_FILE_TAG "sdx"
+#define SUCCINCT_SEARCH_INDEX_FILE_TAG "ssdx"
 #define HEADER_FILE_TAG "header"
 #define VERSION_FILE_TAG "version"
 #define METADATA_FILE_TAG "meta"
 #define METADATA_INDEX_FILE_TAG "metaidx"
 #define COMPRESSED_SEARCH_INDEX_FILE_TAG "csdx"
+#define FEATURES_OFFSETS_FILE_TAG "offs"
 
 #define ROUTING_MATRIX_FILE_TAG "mercedes"
 #define ROUTING_EDGEDATA_FILE_TAG "daewoo"
@@ -34,6 +36,9 @@
 #define ROUTING_FTSEG_FILE_TAG  "ftseg"
 #define ROUTING_NODEIND_TO_FTSEGIND_FILE_TAG  "node2ftseg"
 
+#define PEDESTRIAN_GRAPH_FILE_TAG "pedgraph"
+#define PEDESTRIAN_HIERARCHY_FILE_TAG "pedch"
+
 #define READY_FILE_EXTENSION ".ready"
 #define RESUME_FILE_EXTENSION ".resume3"
 #define DOWNLOADING_FILE_EXTENSION ".downloading3"
@@ -18,7 +18,8 @@ struct GenerateInfo
   {
     Memory,
     Index,
-    File
+    File,
+    Paged
   };
 
   enum class OsmSourceType
@@ -44,6 +45,9 @@ struct GenerateInfo
 
   uint32_t m_versionDate = 0;
 
+  /// Number of threads translating OSM elements, 1 means sequential processing.
+  size_t m_threadsCount = 1;
+
   vector<string> m_bucketNames;
 
   bool m_createWorld = false;
@@ -75,6 +79,8 @@ struct GenerateInfo
       m_nodeStorageType = NodeStorageType::Index;
     else if (type == "mem")
       m_nodeStorageType = NodeStorageType::Memory;
+    else if (type == "paged")
+      m_nodeStorageType = NodeStorageType::Paged;
     else
       LOG(LCRITICAL, ("Incorrect node_storage type:", type));
   }
@@ -26,6 +26,7 @@ SOURCES += \
     osm2type.cpp \
     osm_id.cpp \
     osm_source.cpp \
+    road_graph_generator.cpp \
     routing_generator.cpp \
     statistics.cpp \
     tesselator.cpp \
@@ -48,6 +49,8 @@ HEADERS += \
     feature_sorter.hpp \
     gen_mwm_info.hpp \
     generate_info.hpp \
+    jobs_scheduler.hpp \
+    ordered_pipeline.hpp \
     osm2meta.hpp \
     osm2type.hpp \
     osm2meta.hpp \
@@ -56,6 +59,7 @@ HEADERS += \
     osm_o5m_source.hpp \
     osm_xml_source.hpp \
     polygonizer.hpp \
+    road_graph_generator.hpp \
     routing_generator.hpp \
     statistics.hpp \
     tesselator.hpp \
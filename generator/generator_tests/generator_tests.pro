@@ -23,10 +23,15 @@ SOURCES += \
     coasts_test.cpp \
     feature_builder_test.cpp \
     feature_merger_test.cpp \
+    index_file_test.cpp \
+    jobs_scheduler_test.cpp \
     metadata_test.cpp \
+    node_storage_test.cpp \
+    ordered_pipeline_test.cpp \
     osm_id_test.cpp \
     osm_o5m_source_test.cpp \
     osm_type_test.cpp \
+    road_graph_generator_test.cpp \
     tesselator_test.cpp \
     triangles_tree_coding_test.cpp \
     source_to_element_test.cpp \
@@ -0,0 +1,121 @@
+#include "testing/testing.hpp"
+
+#include "generator/intermediate_data.hpp"
+
+#include "coding/file_reader.hpp"
+#include "coding/file_writer.hpp"
+
+#include "base/scope_guard.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/bind.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+using namespace cache;
+
+namespace
+{
+using TWriter = detail::IndexFile<FileWriter, uint64_t>;
+using TReader = detail::IndexFile<FileReader, uint64_t>;
+
+// Keys are shuffled and repeated, keys of odd values are missing.
+vector<pair<uint64_t, uint64_t>> MakeElements(size_t count)
+{
+  vector<pair<uint64_t, uint64_t>> elements;
+  uint64_t seed = 1;
+  for (size_t i = 0; i < count; ++i)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t const key = ((seed >> 33) % (count / 2)) * 2;
+    elements.emplace_back(key, i);
+  }
+  return elements;
+}
+
+void TestIndexFile(size_t count, size_t runSize)
+{
+  string const name = "index_file_test.dat";
+  MY_SCOPE_GUARD(deleteFileGuard, bind(&FileWriter::DeleteFileX, cref(name)));
+
+  auto elements = MakeElements(count);
+  {
+    TWriter writer(name, runSize);
+    for (auto const & e : elements)
+      writer.Add(e.first, e.second);
+    writer.WriteAll();
+  }
+
+  sort(elements.begin(), elements.end());
+
+  TReader reader(name);
+  reader.ReadAll();
+
+  vector<uint64_t> keys;
+  for (uint64_t key = 0; key <= count; ++key)
+  {
+    keys.push_back(key);
+
+    auto const range = equal_range(elements.begin(), elements.end(), make_pair(key, uint64_t(0)),
+                                   [](pair<uint64_t, uint64_t> const & e1,
+                                      pair<uint64_t, uint64_t> const & e2)
+                                   {
+                                     return e1.first < e2.first;
+                                   });
+    vector<uint64_t> expected;
+    for (auto it = range.first; it != range.second; ++it)
+      expected.push_back(it->second);
+
+    vector<uint64_t> values;
+    reader.ForEachByKey(key, [&values](uint64_t value)
+    {
+      values.push_back(value);
+      return false;
+    });
+    TEST_EQUAL(values, expected, (key));
+
+    uint64_t value;
+    TEST_EQUAL(reader.GetValueByKey(key, value), !expected.empty(), (key));
+    if (!expected.empty())
+      TEST_EQUAL(value, expected.front(), (key));
+  }
+
+  reverse(keys.begin(), keys.end());
+  vector<uint64_t> values;
+  vector<bool> found;
+  reader.GetValuesByKeys(keys, values, found);
+  for (size_t i = 0; i < keys.size(); ++i)
+  {
+    uint64_t value;
+    TEST_EQUAL(found[i], reader.GetValueByKey(keys[i], value), (keys[i]));
+    if (found[i])
+      TEST_EQUAL(values[i], value, (keys[i]));
+  }
+}
+}  // namespace
+
+UNIT_TEST(IndexFile_OneRun)
+{
+  TestIndexFile(10000 /* count */, 100000 /* runSize */);
+}
+
+UNIT_TEST(IndexFile_MergedRuns)
+{
+  TestIndexFile(10000 /* count */, 777 /* runSize */);
+}
+
+UNIT_TEST(IndexFile_Empty)
+{
+  string const name = "index_file_test.dat";
+  MY_SCOPE_GUARD(deleteFileGuard, bind(&FileWriter::DeleteFileX, cref(name)));
+
+  {
+    TWriter writer(name);
+    writer.WriteAll();
+  }
+
+  TReader reader(name);
+  reader.ReadAll();
+  uint64_t value;
+  TEST(!reader.GetValueByKey(0, value), ());
+}
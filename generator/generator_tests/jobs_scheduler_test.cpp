@@ -0,0 +1,91 @@
+#include "testing/testing.hpp"
+
+#include "generator/jobs_scheduler.hpp"
+
+#include "base/macros.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/atomic.hpp"
+#include "std/chrono.hpp"
+#include "std/exception.hpp"
+#include "std/mutex.hpp"
+#include "std/thread.hpp"
+#include "std/vector.hpp"
+
+UNIT_TEST(JobsScheduler_RunsAllJobs)
+{
+  for (size_t threads : {1, 2, 8})
+  {
+    JobsScheduler scheduler(threads, 0 /* memoryBudget */);
+
+    mutex done;
+    vector<int> results;
+    for (int i = 0; i < 20; ++i)
+    {
+      scheduler.Add(i /* memoryCost */, [i, &done, &results]()
+      {
+        lock_guard<mutex> guard(done);
+        results.push_back(i);
+      });
+    }
+    scheduler.Run();
+
+    sort(results.begin(), results.end());
+    TEST_EQUAL(results.size(), 20, (threads));
+    for (int i = 0; i < 20; ++i)
+      TEST_EQUAL(results[i], i, (threads));
+  }
+}
+
+UNIT_TEST(JobsScheduler_MemoryBudget)
+{
+  uint64_t const kBudget = 10;
+  JobsScheduler scheduler(4 /* threadsCount */, kBudget);
+
+  atomic<uint64_t> used(0);
+  atomic<uint64_t> maxUsed(0);
+  atomic<size_t> finished(0);
+  uint64_t const costs[] = {6, 5, 4, 3, 3, 2, 12, 1};
+  for (uint64_t cost : costs)
+  {
+    scheduler.Add(cost, [cost, &used, &maxUsed, &finished]()
+    {
+      uint64_t const current = (used += cost);
+      uint64_t prev = maxUsed;
+      while (prev < current && !maxUsed.compare_exchange_weak(prev, current))
+        ;
+      this_thread::sleep_for(milliseconds(5));
+      used -= cost;
+      ++finished;
+    });
+  }
+  scheduler.Run();
+
+  TEST_EQUAL(finished, ARRAY_SIZE(costs), ());
+  // The job with cost 12 exceeds the budget and is run alone.
+  TEST_EQUAL(maxUsed, 12, ());
+}
+
+UNIT_TEST(JobsScheduler_Exception)
+{
+  JobsScheduler scheduler(3 /* threadsCount */, 0 /* memoryBudget */);
+  for (int i = 0; i < 10; ++i)
+  {
+    scheduler.Add(1 /* memoryCost */, [i]()
+    {
+      if (i == 4)
+        throw runtime_error("Broken job");
+    });
+  }
+
+  bool thrown = false;
+  try
+  {
+    scheduler.Run();
+  }
+  catch (runtime_error const &)
+  {
+    thrown = true;
+  }
+  TEST(thrown, ());
+}
@@ -0,0 +1,153 @@
+#include "testing/testing.hpp"
+
+#include "generator/intermediate_data.hpp"
+#include "generator/intermediate_elements.hpp"
+
+#include "coding/file_writer.hpp"
+
+#include "base/math.hpp"
+#include "base/scope_guard.hpp"
+
+#include "std/bind.hpp"
+#include "std/function.hpp"
+#include "std/thread.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+using namespace cache;
+
+namespace
+{
+// Coordinates are stored with 1E-7 precision.
+double constexpr kEps = 1E-6;
+
+pair<double, double> MakePoint(uint64_t id)
+{
+  return make_pair(-89.0 + (id % 17891) * 0.01, 179.0 - (id % 35791) * 0.01);
+}
+
+// Checks ids [0, count) from several threads, each thread walks them in its own order.
+void TestConcurrentRead(uint64_t count, function<bool(uint64_t id)> const & check)
+{
+  size_t constexpr kThreadsCount = 4;
+  vector<size_t> errors(kThreadsCount, 0);
+  vector<thread> threads;
+  for (size_t t = 0; t < kThreadsCount; ++t)
+  {
+    threads.emplace_back([&check, &errors, count, t]()
+    {
+      for (uint64_t i = 0; i < count; ++i)
+      {
+        if (!check((i * (2 * t + 1) + t * 7919) % count))
+          ++errors[t];
+      }
+    });
+  }
+  for (auto & t : threads)
+    t.join();
+
+  TEST_EQUAL(errors, vector<size_t>(kThreadsCount, 0), ());
+}
+}  // namespace
+
+UNIT_TEST(PagedFilePointStorage_Smoke)
+{
+  string const name = "paged_nodes.dat";
+  string const fileName = name + ".paged";
+  MY_SCOPE_GUARD(deleteFileGuard, bind(&FileWriter::DeleteFileX, cref(fileName)));
+
+  // Sparse sorted ids and some unsorted ones, which revisit written pages.
+  vector<uint64_t> ids;
+  for (uint64_t id = 1; id < 100000; id += 7)
+    ids.push_back(id);
+  for (uint64_t id = 5000000000ULL; id < 5000003000ULL; ++id)
+    ids.push_back(id);
+  ids.push_back(3);
+  ids.push_back(70001);
+
+  {
+    PagedFilePointStorage<EMode::Write> storage(name);
+    for (uint64_t id : ids)
+    {
+      auto const pt = MakePoint(id);
+      storage.AddPoint(id, pt.first, pt.second);
+    }
+    TEST_EQUAL(storage.GetProcessedPoint(), ids.size(), ());
+  }
+
+  PagedFilePointStorage<EMode::Read> storage(name);
+  for (uint64_t id : ids)
+  {
+    double lat, lng;
+    TEST(storage.GetPoint(id, lat, lng), (id));
+    auto const pt = MakePoint(id);
+    TEST(my::AlmostEqualAbs(lat, pt.first, kEps), (id, lat, pt.first));
+    TEST(my::AlmostEqualAbs(lng, pt.second, kEps), (id, lng, pt.second));
+  }
+
+  double lat, lng;
+  TEST(!storage.GetPoint(2, lat, lng), ());
+  TEST(!storage.GetPoint(200000, lat, lng), ());
+  TEST(!storage.GetPoint(6000000000ULL, lat, lng), ());
+}
+
+UNIT_TEST(PagedFilePointStorage_ConcurrentRead)
+{
+  string const name = "paged_nodes_concurrent.dat";
+  string const fileName = name + ".paged";
+  MY_SCOPE_GUARD(deleteFileGuard, bind(&FileWriter::DeleteFileX, cref(fileName)));
+
+  uint64_t constexpr kCount = 1000000;
+  {
+    PagedFilePointStorage<EMode::Write> storage(name);
+    for (uint64_t id = 0; id < kCount; id += 3)
+    {
+      auto const pt = MakePoint(id);
+      storage.AddPoint(id, pt.first, pt.second);
+    }
+  }
+
+  // Threads read pages in different orders, so they decode pages into the same cache slots.
+  PagedFilePointStorage<EMode::Read> storage(name);
+  TestConcurrentRead(kCount, [&storage](uint64_t id)
+  {
+    double lat, lng;
+    bool const found = storage.GetPoint(id, lat, lng);
+    if (found != (id % 3 == 0))
+      return false;
+    auto const pt = MakePoint(id);
+    return !found || (my::AlmostEqualAbs(lat, pt.first, kEps) &&
+                      my::AlmostEqualAbs(lng, pt.second, kEps));
+  });
+}
+
+UNIT_TEST(OSMElementCache_ConcurrentRead)
+{
+  string const name = "ways_concurrent.dat";
+  string const offsetsName = name + OFFSET_EXT;
+  MY_SCOPE_GUARD(deleteFileGuard, bind(&FileWriter::DeleteFileX, cref(name)));
+  MY_SCOPE_GUARD(deleteOffsetsGuard, bind(&FileWriter::DeleteFileX, cref(offsetsName)));
+
+  uint64_t constexpr kCount = 10000;
+  {
+    OSMElementCache<EMode::Write> ways(name);
+    for (uint64_t id = 0; id < kCount; ++id)
+    {
+      WayElement e(id);
+      e.nodes.assign(id % 10 + 2, id);
+      ways.Write(id, e);
+    }
+    ways.SaveOffsets();
+  }
+
+  for (bool preload : {false, true})
+  {
+    OSMElementCache<EMode::Read> ways(name, preload);
+    ways.LoadOffsets();
+    TestConcurrentRead(kCount, [&ways](uint64_t id)
+    {
+      WayElement e(id);
+      return ways.Read(id, e) && e.nodes == vector<uint64_t>(id % 10 + 2, id);
+    });
+  }
+}
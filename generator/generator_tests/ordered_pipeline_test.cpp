@@ -0,0 +1,73 @@
+#include "testing/testing.hpp"
+
+#include "generator/ordered_pipeline.hpp"
+
+#include "std/exception.hpp"
+#include "std/thread.hpp"
+#include "std/vector.hpp"
+
+namespace
+{
+using TPipeline = OrderedPipeline<vector<int>, vector<int>>;
+
+void Square(size_t /* workerIndex */, vector<int> & batch, vector<int> & result)
+{
+  // Slow down some batches to shuffle the order of results.
+  if (!batch.empty() && batch.front() % 3 == 0)
+    this_thread::yield();
+
+  for (int v : batch)
+    result.push_back(v * v);
+}
+}  // namespace
+
+UNIT_TEST(OrderedPipeline_KeepsOrder)
+{
+  for (size_t workers : {1, 2, 8})
+  {
+    vector<int> output;
+    TPipeline pipeline(workers, 3 /* maxBatches */, &Square, [&output](vector<int> & result)
+    {
+      output.insert(output.end(), result.begin(), result.end());
+    });
+
+    int const kBatches = 100;
+    int const kBatchSize = 10;
+    for (int b = 0; b < kBatches; ++b)
+    {
+      vector<int> batch;
+      for (int i = 0; i < kBatchSize; ++i)
+        batch.push_back(b * kBatchSize + i);
+      pipeline.Push(move(batch));
+    }
+    pipeline.Finish();
+
+    TEST_EQUAL(output.size(), kBatches * kBatchSize, (workers));
+    for (int i = 0; i < static_cast<int>(output.size()); ++i)
+      TEST_EQUAL(output[i], i * i, (workers));
+  }
+}
+
+UNIT_TEST(OrderedPipeline_Exception)
+{
+  TPipeline pipeline(4 /* workersCount */, 2 /* maxBatches */,
+                     [](size_t /* workerIndex */, vector<int> & batch, vector<int> & /* result */)
+                     {
+                       if (batch.front() == 5)
+                         throw runtime_error("Broken batch");
+                     },
+                     [](vector<int> & /* result */) {});
+
+  bool thrown = false;
+  try
+  {
+    for (int b = 0; b < 100; ++b)
+      pipeline.Push(vector<int>(1, b));
+    pipeline.Finish();
+  }
+  catch (runtime_error const &)
+  {
+    thrown = true;
+  }
+  TEST(thrown, ());
+}
@@ -181,3 +181,45 @@ UNIT_TEST(OSM_O5M_Source_Relation_read_test)
     }
   }
 }
+
+UNIT_TEST(OSM_O5M_Source_Chunks_test)
+{
+  string data(begin(relation_o5m_data), end(relation_o5m_data));
+
+  vector<pair<osm::O5MSource::EntityType, int64_t>> expected;
+  {
+    stringstream ss(data);
+    osm::O5MSource dataset([&ss](uint8_t * buffer, size_t size)
+    {
+      return ss.read(reinterpret_cast<char *>(buffer), size).gcount();
+    });
+    for (auto const & em : dataset)
+      expected.emplace_back(em.type, em.id);
+  }
+
+  stringstream ss(data);
+  osm::O5MChunkReader reader([&ss](uint8_t * buffer, size_t size)
+  {
+    return ss.read(reinterpret_cast<char *>(buffer), size).gcount();
+  }, 1 /* minChunkSize */, 10 /* buffer size */);
+
+  // Nodes, ways and relations are separated by reset datasets.
+  vector<pair<osm::O5MSource::EntityType, int64_t>> entities;
+  size_t chunksCount = 0;
+  vector<uint8_t> chunk;
+  while (reader.ReadChunk(chunk))
+  {
+    ++chunksCount;
+    string const chunkData(chunk.begin(), chunk.end());
+    stringstream chunkStream(chunkData);
+    osm::O5MSource dataset([&chunkStream](uint8_t * buffer, size_t size)
+    {
+      return chunkStream.read(reinterpret_cast<char *>(buffer), size).gcount();
+    });
+    for (auto const & em : dataset)
+      entities.emplace_back(em.type, em.id);
+  }
+
+  TEST_EQUAL(chunksCount, 3, ());
+  TEST_EQUAL(entities, expected, ());
+}
@@ -0,0 +1,34 @@
+#include "testing/testing.hpp"
+
+#include "generator/road_graph_generator.hpp"
+
+#include "indexer/classificator.hpp"
+#include "indexer/classificator_loader.hpp"
+
+using namespace routing;
+
+namespace
+{
+bool IsPedestrianRoad(string const & countryName, char const * type)
+{
+  shared_ptr<IVehicleModel> const model = GetPedestrianModelForMwm(countryName);
+  uint32_t const t = classif().GetTypeByPath({"highway", type});
+  return dynamic_cast<VehicleModel const &>(*model).IsRoad(t);
+}
+}  // namespace
+
+UNIT_TEST(RoadGraphGenerator_CountryModel)
+{
+  TEST_EQUAL(GetVehicleModelCountryName("UK_England"), "UK", ());
+  TEST_EQUAL(GetVehicleModelCountryName("Germany_Bavaria"), "Germany", ());
+  TEST_EQUAL(GetVehicleModelCountryName("Belarus"), "Belarus", ());
+
+  classificator::Load();
+
+  // Cycleways are pedestrian roads in the UK model only.
+  TEST(!IsPedestrianRoad("Abkhazia", "cycleway"), ());
+  TEST(IsPedestrianRoad("UK", "cycleway"), ());
+  TEST(IsPedestrianRoad("UK_England", "cycleway"), ());
+  TEST(IsPedestrianRoad("UK_Scotland_North", "cycleway"), ());
+  TEST(IsPedestrianRoad("UK_England", "footway"), ());
+}
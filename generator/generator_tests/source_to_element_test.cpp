@@ -64,3 +64,26 @@ UNIT_TEST(Source_To_Element_check_equivalence)
     TEST_EQUAL(elementsXML[i], elementsO5M[i], ());
   }
 }
+
+UNIT_TEST(Source_To_Element_o5m_concurrently)
+{
+  string src(begin(relation_o5m_data), end(relation_o5m_data));
+
+  istringstream ss1(src);
+  SourceReader reader1(ss1);
+  vector<OsmElement> expected;
+  BuildFeaturesFromO5M(reader1, [&expected](OsmElement * e)
+  {
+    expected.push_back(*e);
+  });
+
+  istringstream ss2(src);
+  SourceReader reader2(ss2);
+  vector<OsmElement> elements;
+  BuildFeaturesFromO5M(reader2, [&elements](OsmElement * e)
+  {
+    elements.push_back(*e);
+  }, 4 /* threadsCount */, 1 /* minChunkSize */);
+
+  TEST_EQUAL(elements, expected, ());
+}
@@ -7,7 +7,9 @@
 #include "generator/statistics.hpp"
 #include "generator/unpack_mwm.hpp"
 #include "generator/generate_info.hpp"
+#include "generator/jobs_scheduler.hpp"
 #include "generator/check_model.hpp"
+#include "generator/road_graph_generator.hpp"
 #include "generator/routing_generator.hpp"
 #include "generator/osm_source.hpp"
 
@@ -29,10 +31,12 @@
 
 #include "3party/gflags/src/gflags/gflags.h"
 
+#include "std/algorithm.hpp"
 #include "std/iostream.hpp"
 #include "std/fstream.hpp"
 #include "std/iomanip.hpp"
 #include "std/numeric.hpp"
+#include "std/thread.hpp"
 
 
 DEFINE_bool(generate_update, false,
@@ -48,10 +52,13 @@ DEFINE_bool(generate_features, false, "2nd pass - generate intermediate features
 DEFINE_bool(generate_geometry, false, "3rd pass - split and simplify geometry and triangles for features");
 DEFINE_bool(generate_index, false, "4rd pass - generate index");
 DEFINE_bool(generate_search_index, false, "5th pass - generate search index");
+DEFINE_bool(generate_succinct_search_index, false, "Also write succinct search index (ssdx section), it's faster but makes mwm bigger");
 DEFINE_bool(calc_statistics, false, "Calculate feature statistics for specified mwm bucket files");
 DEFINE_bool(type_statistics, false, "Calculate statistics by type for specified mwm bucket files");
 DEFINE_bool(preload_cache, false, "Preload all ways and relations cache");
-DEFINE_string(node_storage, "map", "Type of storage for intermediate points representation. Available: raw, map, mem");
+DEFINE_uint64(threads_count, 1, "Number of threads for preprocessing, features generation and generation of country files, 0 means all cores");
+DEFINE_uint64(memory_budget_mb, 0, "Approximate memory limit in MB for concurrent generation of country files, 0 means unlimited");
+DEFINE_string(node_storage, "map", "Type of storage for intermediate points representation. Available: raw, map, mem, paged");
 DEFINE_string(data_path, "", "Working directory, 'path_to_exe/../../data' if empty.");
 DEFINE_string(output, "", "File name for process (without 'mwm' ext).");
 DEFINE_string(intermediate_data_path, "", "Path to stored nodes, ways, relations.");
@@ -69,6 +76,8 @@ DEFINE_bool(generate_addresses_file, false, "Generate .addr file (for '--output'
 DEFINE_string(osrm_file_name, "", "Input osrm file to generate routing info");
 DEFINE_bool(make_routing, false, "Make routing info based on osrm file");
 DEFINE_bool(make_cross_section, false, "Make corss section in routing file for cross mwm routing");
+DEFINE_bool(make_pedestrian_graph, false, "Make precomputed pedestrian road graph section in mwm");
+DEFINE_bool(make_pedestrian_hierarchy, false, "Make contraction hierarchy of pedestrian road graph section in mwm");
 DEFINE_string(osm_file_name, "", "Input osm area file");
 DEFINE_string(osm_file_type, "xml", "Input osm area file type [xml, o5m]");
 DEFINE_string(user_resource_path, "", "User defined resource path for classificator.txt and etc.");
@@ -105,6 +114,8 @@ int main(int argc, char ** argv)
   genInfo.m_osmFileName = FLAGS_osm_file_name;
   genInfo.m_failOnCoasts = FLAGS_fail_on_coasts;
   genInfo.m_preloadCache = FLAGS_preload_cache;
+  genInfo.m_threadsCount = FLAGS_threads_count == 0 ? thread::hardware_concurrency()
+                                                    : static_cast<size_t>(FLAGS_threads_count);
 
   genInfo.m_versionDate = static_cast<uint32_t>(FLAGS_planet_version);
 
@@ -161,46 +172,62 @@ int main(int argc, char ** argv)
   }
 
   // Enumerate over all dat files that were created.
-  size_t const count = genInfo.m_bucketNames.size();
-  for (size_t i = 0; i < count; ++i)
+  // Countries are independent, so they are generated concurrently and share
+  // the loaded classificator.
+  JobsScheduler scheduler(genInfo.m_threadsCount, FLAGS_memory_budget_mb << 20);
+  // Threads left for every country, when there are less countries than threads.
+  size_t const countryThreadsCount =
+      max(genInfo.m_threadsCount / max(genInfo.m_bucketNames.size(), size_t(1)), size_t(1));
+  for (string const & country : genInfo.m_bucketNames)
   {
-    string const & country = genInfo.m_bucketNames[i];
-
-    if (FLAGS_generate_geometry)
-    {
-      LOG(LINFO, ("Generating result features for file", country));
+    string const datFile = path + country + DATA_FILE_EXTENSION;
 
-      int mapType = feature::DataHeader::country;
-      if (country == WORLD_FILE_NAME)
-        mapType = feature::DataHeader::world;
-      if (country == WORLD_COASTS_FILE_NAME)
-        mapType = feature::DataHeader::worldcoasts;
+    // Memory consumption of all the passes is roughly proportional to the size of
+    // the features file.
+    uint64_t fileSize = 0;
+    Platform::GetFileSizeByFullPath(FLAGS_generate_geometry ? genInfo.GetTmpFileName(country)
+                                                            : datFile,
+                                    fileSize);
+    uint64_t const kMemoryPerFileByte = 3;
 
-      if (!feature::GenerateFinalFeatures(genInfo, country, mapType))
+    scheduler.Add(fileSize * kMemoryPerFileByte, [&genInfo, country, datFile, countryThreadsCount]()
+    {
+      if (FLAGS_generate_geometry)
       {
-        // If error - move to next bucket without index generation
-        continue;
+        LOG(LINFO, ("Generating result features for file", country));
+
+        int mapType = feature::DataHeader::country;
+        if (country == WORLD_FILE_NAME)
+          mapType = feature::DataHeader::world;
+        if (country == WORLD_COASTS_FILE_NAME)
+          mapType = feature::DataHeader::worldcoasts;
+
+        if (!feature::GenerateFinalFeatures(genInfo, country, mapType))
+        {
+          // If error - move to next bucket without index generation
+          return;
+        }
       }
-    }
 
-    string const datFile = path + country + DATA_FILE_EXTENSION;
-
-    if (FLAGS_generate_index)
-    {
-      LOG(LINFO, ("Generating index for ", datFile));
+      if (FLAGS_generate_index)
+      {
+        LOG(LINFO, ("Generating index for ", datFile));
 
-      if (!indexer::BuildIndexFromDatFile(datFile, FLAGS_intermediate_data_path + country))
-        LOG(LCRITICAL, ("Error generating index."));
-    }
+        if (!indexer::BuildIndexFromDatFile(datFile, FLAGS_intermediate_data_path + country))
+          LOG(LCRITICAL, ("Error generating index."));
+      }
 
-    if (FLAGS_generate_search_index)
-    {
-      LOG(LINFO, ("Generating search index for ", datFile));
+      if (FLAGS_generate_search_index)
+      {
+        LOG(LINFO, ("Generating search index for ", datFile));
 
-      if (!indexer::BuildSearchIndexFromDatFile(datFile, true))
-        LOG(LCRITICAL, ("Error generating search index."));
-    }
+        if (!indexer::BuildSearchIndexFromDatFile(datFile, true, countryThreadsCount,
+                                                  FLAGS_generate_succinct_search_index))
+          LOG(LCRITICAL, ("Error generating search index."));
+      }
+    });
   }
+  scheduler.Run();
 
   // Create http update list for countries and corresponding files
   if (FLAGS_generate_update)
@@ -259,5 +286,11 @@ int main(int argc, char ** argv)
   if (!FLAGS_osrm_file_name.empty() && FLAGS_make_cross_section)
     routing::BuildCrossRoutingIndex(path, FLAGS_output, FLAGS_osrm_file_name);
 
+  if (FLAGS_make_pedestrian_graph)
+    routing::BuildPedestrianGraphSection(path, FLAGS_output);
+
+  if (FLAGS_make_pedestrian_hierarchy)
+    routing::BuildPedestrianHierarchySection(path, FLAGS_output);
+
   return 0;
 }
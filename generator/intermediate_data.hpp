@@ -5,14 +5,21 @@
 #include "coding/file_name_utils.hpp"
 #include "coding/file_reader.hpp"
 #include "coding/file_writer.hpp"
+#include "coding/byte_stream.hpp"
 #include "coding/mmap_reader.hpp"
+#include "coding/varint.hpp"
 
 #include "base/logging.hpp"
 
 #include "std/algorithm.hpp"
+#include "std/array.hpp"
+#include "std/cstring.hpp"
 #include "std/deque.hpp"
 #include "std/exception.hpp"
 #include "std/limits.hpp"
+#include "std/mutex.hpp"
+#include "std/queue.hpp"
+#include "std/unique_ptr.hpp"
 #include "std/utility.hpp"
 #include "std/vector.hpp"
 
@@ -29,6 +36,50 @@ enum class EMode { Write = true, Read = false };
 
 namespace detail
 {
+/// Reader of an immutable file, which may be used by several threads at once.
+/// The file is memory mapped where it's supported, otherwise reads are serialized.
+class SharedFileReader
+{
+  FileReader m_file;
+  unique_ptr<MmapReader> m_mapping;
+  mutable mutex m_mutex;
+
+public:
+  explicit SharedFileReader(string const & name) : m_file(name)
+  {
+#ifndef OMIM_OS_WINDOWS
+    // Empty files can't be mapped.
+    if (m_file.Size() != 0)
+      m_mapping.reset(new MmapReader(name));
+#endif
+  }
+
+  uint64_t Size() const { return m_file.Size(); }
+  string GetName() const { return m_file.GetName(); }
+
+  /// @return Pointer to the data of the file or nullptr if the file isn't mapped.
+  uint8_t const * Data() const { return m_mapping ? m_mapping->Data() : nullptr; }
+
+  void Read(uint64_t pos, void * p, size_t size) const
+  {
+    if (m_mapping)
+    {
+      m_mapping->Read(pos, p, size);
+      return;
+    }
+
+    // FileReader isn't thread-safe.
+    lock_guard<mutex> guard(m_mutex);
+    m_file.Read(pos, p, size);
+  }
+};
+
+/// Multimap from keys to values, which is written to a file sorted by keys.
+/// Elements are added in any order and are written to a temporary file in sorted
+/// runs, which are merged by WriteAll. So ReadAll doesn't sort and the file is
+/// used as is, through the memory mapping where it's supported.
+/// Lookups go through a small index of the first keys of 4K blocks of the file,
+/// which is kept in the Eytzinger (BFS) order to be cache friendly.
 template <class TFile, class TValue>
 class IndexFile
 {
@@ -40,7 +91,21 @@ class IndexFile
   TContainer m_elements;
   TFile m_file;
 
-  static size_t constexpr kFlushCount = 1024;
+  // Write mode: sorted runs of elements.
+  size_t const m_runSize;
+  unique_ptr<FileWriter> m_runsWriter;
+  vector<uint64_t> m_runSizes;
+
+  // Read mode: sorted elements of the file and the index of their blocks.
+  unique_ptr<MmapReader> m_mapping;
+  TElement const * m_data = nullptr;
+  size_t m_count = 0;
+  // 1-based Eytzinger layout of the first keys of blocks and numbers of the blocks.
+  vector<TKey> m_blockKeys;
+  vector<size_t> m_blockNumbers;
+
+  static size_t constexpr kMergeBufferSize = 1 << 14;
+  static size_t constexpr kBlockSize = 4096 / sizeof(TElement);
 
   struct ElementComparator
   {
@@ -58,72 +123,282 @@ class IndexFile
     return static_cast<size_t>(v);
   }
 
-public:
-  explicit IndexFile(string const & name) : m_file(name.c_str()) {}
+  string GetRunsFileName() const { return GetFileName() + ".runs"; }
 
-  string GetFileName() const { return m_file.GetName(); }
-
-  void WriteAll()
+  void FlushRun()
   {
     if (m_elements.empty())
       return;
 
-    m_file.Write(&m_elements[0], m_elements.size() * sizeof(TElement));
+    sort(m_elements.begin(), m_elements.end(), ElementComparator());
+    if (!m_runsWriter)
+      m_runsWriter.reset(new FileWriter(GetRunsFileName()));
+    m_runsWriter->Write(m_elements.data(), m_elements.size() * sizeof(TElement));
+    m_runSizes.push_back(m_elements.size());
     m_elements.clear();
   }
 
-  void ReadAll()
+  void MergeRuns()
   {
-    m_elements.clear();
-    size_t fileSize = m_file.Size();
-    if (fileSize == 0)
-      return;
+    m_runsWriter.reset();
 
-    LOG_SHORT(LINFO, ("Offsets reading is started for file ", GetFileName()));
-    CHECK_EQUAL(0, fileSize % sizeof(TElement), ("Damaged file."));
+    struct Run
+    {
+      uint64_t m_pos;
+      uint64_t m_end;
+      TContainer m_buffer;
+      size_t m_current = 0;
+    };
+
+    FileReader reader(GetRunsFileName());
+    vector<Run> runs(m_runSizes.size());
+    uint64_t pos = 0;
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+      runs[i].m_pos = pos;
+      pos += m_runSizes[i] * sizeof(TElement);
+      runs[i].m_end = pos;
+    }
+
+    auto const fillBuffer = [&reader](Run & run)
+    {
+      size_t const count = CheckedCast(min(static_cast<uint64_t>(kMergeBufferSize),
+                                           (run.m_end - run.m_pos) / sizeof(TElement)));
+      run.m_buffer.resize(count);
+      run.m_current = 0;
+      if (count != 0)
+        reader.Read(run.m_pos, run.m_buffer.data(), count * sizeof(TElement));
+      run.m_pos += count * sizeof(TElement);
+      return count != 0;
+    };
+
+    // Min-heap of the current elements of runs.
+    using TItem = pair<TElement, size_t>;
+    auto const greaterItem = [](TItem const & r1, TItem const & r2)
+    {
+      return ElementComparator()(r2.first, r1.first);
+    };
+    priority_queue<TItem, vector<TItem>, decltype(greaterItem)> queue(greaterItem);
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+      if (fillBuffer(runs[i]))
+        queue.emplace(runs[i].m_buffer[0], i);
+    }
 
+    while (!queue.empty())
+    {
+      TItem const item = queue.top();
+      queue.pop();
+      m_elements.push_back(item.first);
+      if (m_elements.size() == kMergeBufferSize)
+      {
+        m_file.Write(m_elements.data(), m_elements.size() * sizeof(TElement));
+        m_elements.clear();
+      }
+
+      Run & run = runs[item.second];
+      if (++run.m_current < run.m_buffer.size() || fillBuffer(run))
+        queue.emplace(run.m_buffer[run.m_current], item.second);
+    }
+
+    FileWriter::DeleteFileX(GetRunsFileName());
+    m_runSizes.clear();
+  }
+
+  void MapElements()
+  {
+#ifdef OMIM_OS_WINDOWS
     try
     {
-      m_elements.resize(CheckedCast(fileSize / sizeof(TElement)));
+      m_elements.resize(m_count);
     }
     catch (exception const &)  // bad_alloc
     {
       LOG(LCRITICAL, ("Insufficient memory for required offset map"));
     }
+    m_file.Read(0, m_elements.data(), m_count * sizeof(TElement));
+    m_data = m_elements.data();
+#else
+    m_mapping.reset(new MmapReader(GetFileName()));
+    m_data = reinterpret_cast<TElement const *>(m_mapping->Data());
+#endif
+  }
 
-    m_file.Read(0, &m_elements[0], CheckedCast(fileSize));
+  // Fills the Eytzinger layout in the in-order traversal.
+  size_t BuildBlockIndex(size_t block, size_t node)
+  {
+    if (node < m_blockKeys.size())
+    {
+      block = BuildBlockIndex(block, 2 * node);
+      m_blockKeys[node] = m_data[block * kBlockSize].first;
+      m_blockNumbers[node] = block++;
+      block = BuildBlockIndex(block, 2 * node + 1);
+    }
+    return block;
+  }
 
-    sort(m_elements.begin(), m_elements.end(), ElementComparator());
+  // Returns the first element with the key which is not less than k.
+  TElement const * LowerBound(TKey k) const
+  {
+    // Find the first block with the first key which is not less than k.
+    size_t node = 1;
+    while (node < m_blockKeys.size())
+      node = 2 * node + (m_blockKeys[node] < k ? 1 : 0);
+    // Go up to the last left turn.
+    while (node & 1)
+      node >>= 1;
+    node >>= 1;
+
+    size_t const blocksCount = m_blockKeys.size() - 1;
+    size_t const block = (node == 0 ? blocksCount : m_blockNumbers[node]);
+    if (block == 0)
+      return m_data;
+
+    // All the keys before the previous block are less than k.
+    TElement const * begin = m_data + (block - 1) * kBlockSize;
+    TElement const * end = m_data + min(block * kBlockSize, m_count);
+    return lower_bound(begin, end, k, ElementComparator());
+  }
+
+public:
+  /// @param runSize Max number of elements, which are sorted in memory.
+  explicit IndexFile(string const & name, size_t runSize = 1 << 22)
+    : m_file(name.c_str()), m_runSize(runSize)
+  {
+  }
+
+  ~IndexFile()
+  {
+    if (m_runsWriter)
+    {
+      m_runsWriter.reset();
+      FileWriter::DeleteFileX(GetRunsFileName());
+    }
+  }
+
+  string GetFileName() const { return m_file.GetName(); }
+
+  /// Writes all the added elements sorted. Should be called once, after all the elements are added.
+  void WriteAll()
+  {
+    if (m_runSizes.empty())
+    {
+      // Everything fits into one run.
+      sort(m_elements.begin(), m_elements.end(), ElementComparator());
+      if (!m_elements.empty())
+        m_file.Write(m_elements.data(), m_elements.size() * sizeof(TElement));
+    }
+    else
+    {
+      FlushRun();
+      MergeRuns();
+      if (!m_elements.empty())
+        m_file.Write(m_elements.data(), m_elements.size() * sizeof(TElement));
+    }
+    m_elements.clear();
+  }
+
+  void ReadAll()
+  {
+    m_elements.clear();
+    m_blockKeys.clear();
+    m_blockNumbers.clear();
+    m_mapping.reset();
+    m_data = nullptr;
+    m_count = 0;
+
+    uint64_t const fileSize = m_file.Size();
+    if (fileSize == 0)
+      return;
+
+    LOG_SHORT(LINFO, ("Offsets reading is started for file ", GetFileName()));
+    CHECK_EQUAL(0, fileSize % sizeof(TElement), ("Damaged file."));
+
+    m_count = CheckedCast(fileSize / sizeof(TElement));
+    MapElements();
+    // Files of older generators aren't sorted and lookups would silently miss keys in them.
+    CHECK(is_sorted(m_data, m_data + m_count, ElementComparator()),
+          ("Offsets aren't sorted in", GetFileName(), ", rerun the preprocessing."));
+
+    size_t const blocksCount = (m_count + kBlockSize - 1) / kBlockSize;
+    m_blockKeys.resize(blocksCount + 1);
+    m_blockNumbers.resize(blocksCount + 1);
+    BuildBlockIndex(0 /* block */, 1 /* node */);
 
     LOG_SHORT(LINFO, ("Offsets reading is finished"));
   }
 
   void Add(TKey k, TValue const & v)
   {
-    if (m_elements.size() > kFlushCount)
-      WriteAll();
+    if (m_elements.size() >= m_runSize)
+      FlushRun();
 
     m_elements.push_back(make_pair(k, v));
   }
 
   bool GetValueByKey(TKey key, TValue & value) const
   {
-    auto it = lower_bound(m_elements.begin(), m_elements.end(), key, ElementComparator());
-    if ((it != m_elements.end()) && ((*it).first == key))
+    if (m_count == 0)
+      return false;
+
+    TElement const * it = LowerBound(key);
+    if ((it != m_data + m_count) && (it->first == key))
     {
-      value = (*it).second;
+      value = it->second;
       return true;
     }
     return false;
   }
 
+  /// Finds values of keys, which may be unsorted and repeated. Keys are looked up
+  /// in the sorted order, so every block of the file is touched once at most.
+  /// values[i] is valid if found[i] is true.
+  void GetValuesByKeys(vector<TKey> const & keys, vector<TValue> & values,
+                       vector<bool> & found) const
+  {
+    values.assign(keys.size(), TValue());
+    found.assign(keys.size(), false);
+    if (m_count == 0)
+      return;
+
+    vector<size_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); ++i)
+      order[i] = i;
+    sort(order.begin(), order.end(), [&keys](size_t i1, size_t i2) { return keys[i1] < keys[i2]; });
+
+    TElement const * const end = m_data + m_count;
+    TElement const * it = m_data;
+    for (size_t i : order)
+    {
+      TKey const key = keys[i];
+      // Gallop from the previous position, which is close for near keys.
+      size_t step = 1;
+      TElement const * last = it;
+      while (last != end && last->first < key)
+      {
+        it = last;
+        last = (static_cast<size_t>(end - last) > step ? last + step : end);
+        step *= 2;
+      }
+      it = lower_bound(it, last, key, ElementComparator());
+      if (it != end && it->first == key)
+      {
+        values[i] = it->second;
+        found[i] = true;
+      }
+    }
+  }
+
   template <class ToDo>
   void ForEachByKey(TKey k, ToDo && toDo) const
   {
-    auto range = equal_range(m_elements.begin(), m_elements.end(), k, ElementComparator());
-    for (; range.first != range.second; ++range.first)
+    if (m_count == 0)
+      return;
+
+    TElement const * const end = m_data + m_count;
+    for (TElement const * it = LowerBound(k); it != end && it->first == k; ++it)
     {
-      if (toDo((*range.first).second))
+      if (toDo(it->second))
         return;
     }
   }
@@ -135,7 +410,8 @@ class OSMElementCache
 {
 public:
   using TKey = uint64_t;
-  using TStorage = typename conditional<TMode == EMode::Write, FileWriter, FileReader>::type;
+  using TStorage =
+      typename conditional<TMode == EMode::Write, FileWriter, detail::SharedFileReader>::type;
   using TOffsetFile = typename conditional<TMode == EMode::Write, FileWriter, FileReader>::type;
 
 protected:
@@ -186,7 +462,7 @@ public:
   }
 
   template <class TValue, EMode T = TMode>
-  typename enable_if<T == EMode::Read, bool>::type Read(TKey id, TValue & value)
+  typename enable_if<T == EMode::Read, bool>::type Read(TKey id, TValue & value) const
   {
     uint64_t pos = 0;
     if (!m_offsets.GetValueByKey(id, pos))
@@ -195,25 +471,53 @@ public:
       return false;
     }
 
-    uint32_t valueSize = m_preload ? *(reinterpret_cast<uint32_t *>(m_data.data() + pos)) : 0;
-    size_t offset = pos + sizeof(uint32_t);
+    ReadByOffset(pos, value);
+    return true;
+  }
 
-    if (!m_preload)
+  /// Reads values by ids in one batch, offsets of ids are looked up together.
+  /// values[i] is read if found[i] is true.
+  template <class TValue, EMode T = TMode>
+  typename enable_if<T == EMode::Read, void>::type Read(vector<TKey> const & ids,
+                                                        vector<TValue> & values,
+                                                        vector<bool> & found) const
+  {
+    ASSERT_EQUAL(ids.size(), values.size(), ());
+    vector<uint64_t> offsets;
+    m_offsets.GetValuesByKeys(ids, offsets, found);
+    for (size_t i = 0; i < ids.size(); ++i)
     {
-      // in case not-in-memory work we read buffer
-      m_storage.Read(pos, &valueSize, sizeof(valueSize));
-      m_data.resize(valueSize);
-      m_storage.Read(pos + sizeof(valueSize), m_data.data(), valueSize);
-      offset = 0;
+      if (found[i])
+        ReadByOffset(offsets[i], values[i]);
+      else
+        LOG_SHORT(LWARNING, ("Can't find offset in file", m_offsets.GetFileName(), "by id", ids[i]));
     }
-
-    MemReader reader(m_data.data() + offset, valueSize);
-    value.Read(reader);
-    return true;
   }
 
   inline void SaveOffsets() { m_offsets.WriteAll(); }
   inline void LoadOffsets() { m_offsets.ReadAll(); }
+
+private:
+  /// Reads a value without any shared state, so several threads may read at once.
+  template <class TValue>
+  void ReadByOffset(uint64_t pos, TValue & value) const
+  {
+    uint32_t valueSize;
+    uint8_t const * data = m_preload ? m_data.data() : m_storage.Data();
+    if (data != nullptr)
+    {
+      memcpy(&valueSize, data + pos, sizeof(valueSize));
+      MemReader reader(data + pos + sizeof(valueSize), valueSize);
+      value.Read(reader);
+      return;
+    }
+
+    m_storage.Read(pos, &valueSize, sizeof(valueSize));
+    TBuffer buffer(valueSize);
+    m_storage.Read(pos + sizeof(valueSize), buffer.data(), valueSize);
+    MemReader reader(buffer.data(), valueSize);
+    value.Read(reader);
+  }
 };
 
 /// Used to store all world nodes inside temporary index file.
@@ -246,13 +550,7 @@ public:
 template <EMode TMode>
 class RawFilePointStorage : public PointStorage
 {
-#ifdef OMIM_OS_WINDOWS
-  using TFileReader = FileReader;
-#else
-  using TFileReader = MmapReader;
-#endif
-
-  typename conditional<TMode == EMode::Write, FileWriter, TFileReader>::type m_file;
+  typename conditional<TMode == EMode::Write, FileWriter, detail::SharedFileReader>::type m_file;
 
   constexpr static double const kValueOrder = 1E+7;
 
@@ -425,4 +723,233 @@ public:
   }
 };
 
+/// Sparse storage of nodes, which are grouped into pages by id. Only pages with
+/// nodes are written, coordinates in a page are delta coded in the order of ids.
+///
+/// File layout:
+///   PageRecord records[];     // usually one record per page for id sorted input
+///   uint64_t pagesCount;
+///   uint64_t index[pagesCount]; // offset of the last record of every page + 1, 0 for missing page
+///   uint64_t indexOffset;
+///
+/// PageRecord:
+///   uint64_t prevRecord;          // offset of the previous record of the same page + 1 or 0
+///   uint32_t size;                // size of data
+///   uint8_t data[size];           // kPageSize bits for present nodes and varint deltas of them
+///
+/// GetPoint may be called by several threads, every slot of the cache of decoded pages
+/// has its own mutex.
+template <EMode TMode>
+class PagedFilePointStorage : public PointStorage
+{
+  static uint32_t constexpr kPageBits = 10;
+  static uint32_t constexpr kPageSize = 1 << kPageBits;
+  static uint32_t constexpr kBitmapSize = kPageSize / 8;
+  static uint32_t constexpr kRecordHeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+  static uint64_t constexpr kInvalidPage = numeric_limits<uint64_t>::max();
+  // Number of decoded pages, which are cached for reading.
+  static uint32_t constexpr kCacheSize = 256;
+
+  constexpr static double const kValueOrder = 1E+7;
+
+  struct Page
+  {
+    void Clear()
+    {
+      memset(m_bitmap, 0, sizeof(m_bitmap));
+    }
+
+    inline bool IsPresent(uint32_t i) const { return (m_bitmap[i >> 3] >> (i & 7)) & 1; }
+    inline void SetPresent(uint32_t i) { m_bitmap[i >> 3] |= (1 << (i & 7)); }
+
+    uint64_t m_id = kInvalidPage;
+    uint8_t m_bitmap[kBitmapSize];
+    LatLon m_values[kPageSize];
+  };
+
+  typename conditional<TMode == EMode::Write, FileWriter, detail::SharedFileReader>::type m_file;
+  vector<uint64_t> m_index;
+
+  // The page which is filled now for writing.
+  Page m_page;
+
+  // Decoded pages for reading, page id is cached at position id % kCacheSize.
+  mutable vector<Page> m_cache;
+  mutable array<mutex, kCacheSize> m_cacheMutexes;
+
+  // Encoded page for writing.
+  vector<uint8_t> m_buffer;
+
+public:
+  explicit PagedFilePointStorage(string const & name) : m_file(name + ".paged")
+  {
+    InitStorage<TMode>();
+  }
+
+  ~PagedFilePointStorage() { DoneStorage<TMode>(); }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Write, void>::type InitStorage()
+  {
+    m_page.Clear();
+  }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Read, void>::type InitStorage()
+  {
+    uint64_t const size = m_file.Size();
+    CHECK_GREATER_OR_EQUAL(size, 2 * sizeof(uint64_t), ("Damaged file", m_file.GetName()));
+
+    uint64_t indexOffset;
+    m_file.Read(size - sizeof(indexOffset), &indexOffset, sizeof(indexOffset));
+    uint64_t pagesCount;
+    m_file.Read(indexOffset, &pagesCount, sizeof(pagesCount));
+    CHECK_EQUAL(indexOffset + (pagesCount + 2) * sizeof(uint64_t), size,
+                ("Damaged file", m_file.GetName()));
+
+    m_index.resize(pagesCount);
+    if (pagesCount != 0)
+      m_file.Read(indexOffset + sizeof(pagesCount), m_index.data(), pagesCount * sizeof(uint64_t));
+
+    m_cache.resize(kCacheSize);
+  }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Write, void>::type DoneStorage()
+  {
+    FlushPage();
+
+    uint64_t const indexOffset = m_file.Pos();
+    uint64_t const pagesCount = m_index.size();
+    m_file.Write(&pagesCount, sizeof(pagesCount));
+    if (pagesCount != 0)
+      m_file.Write(m_index.data(), pagesCount * sizeof(uint64_t));
+    m_file.Write(&indexOffset, sizeof(indexOffset));
+  }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Read, void>::type DoneStorage() {}
+
+  template <EMode T = TMode>
+  typename enable_if<T == EMode::Write, void>::type AddPoint(uint64_t id, double lat, double lng)
+  {
+    int64_t const lat64 = lat * kValueOrder;
+    int64_t const lng64 = lng * kValueOrder;
+
+    uint64_t const page = id >> kPageBits;
+    if (page != m_page.m_id)
+    {
+      FlushPage();
+      m_page.m_id = page;
+    }
+
+    uint32_t const i = id & (kPageSize - 1);
+    LatLon & ll = m_page.m_values[i];
+    ll.lat = static_cast<int32_t>(lat64);
+    ll.lon = static_cast<int32_t>(lng64);
+    CHECK_EQUAL(static_cast<int64_t>(ll.lat), lat64, ("Latitude is out of 32bit boundary!"));
+    CHECK_EQUAL(static_cast<int64_t>(ll.lon), lng64, ("Longtitude is out of 32bit boundary!"));
+    m_page.SetPresent(i);
+
+    IncProcessedPoint();
+  }
+
+  template <EMode T = TMode>
+  typename enable_if<T == EMode::Read, bool>::type GetPoint(uint64_t id, double & lat,
+                                                            double & lng) const
+  {
+    uint64_t const pageId = id >> kPageBits;
+    uint32_t const i = id & (kPageSize - 1);
+    if (pageId < m_index.size() && m_index[pageId] != 0)
+    {
+      lock_guard<mutex> guard(m_cacheMutexes[pageId % kCacheSize]);
+      Page const & page = GetPage(pageId);
+      if (page.IsPresent(i))
+      {
+        lat = static_cast<double>(page.m_values[i].lat) / kValueOrder;
+        lng = static_cast<double>(page.m_values[i].lon) / kValueOrder;
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  void FlushPage()
+  {
+    if (m_page.m_id == kInvalidPage)
+      return;
+
+    m_buffer.assign(m_page.m_bitmap, m_page.m_bitmap + kBitmapSize);
+    PushBackByteSink<vector<uint8_t>> sink(m_buffer);
+    LatLon prev = {0, 0};
+    for (uint32_t i = 0; i < kPageSize; ++i)
+    {
+      if (!m_page.IsPresent(i))
+        continue;
+      LatLon const & ll = m_page.m_values[i];
+      WriteVarInt(sink, static_cast<int64_t>(ll.lat) - prev.lat);
+      WriteVarInt(sink, static_cast<int64_t>(ll.lon) - prev.lon);
+      prev = ll;
+    }
+
+    if (m_index.size() <= m_page.m_id)
+      m_index.resize(m_page.m_id + 1, 0);
+
+    // Revisited page gets one more record, which refers to the previous one.
+    uint64_t const prevRecord = m_index[m_page.m_id];
+    uint32_t const size = static_cast<uint32_t>(m_buffer.size());
+    m_index[m_page.m_id] = m_file.Pos() + 1;
+    m_file.Write(&prevRecord, sizeof(prevRecord));
+    m_file.Write(&size, sizeof(size));
+    m_file.Write(m_buffer.data(), m_buffer.size());
+
+    m_page.Clear();
+    m_page.m_id = kInvalidPage;
+  }
+
+  /// Should be called under the mutex of the cache slot of the page.
+  Page const & GetPage(uint64_t pageId) const
+  {
+    Page & page = m_cache[pageId % kCacheSize];
+    if (page.m_id == pageId)
+      return page;
+
+    page.Clear();
+    page.m_id = pageId;
+
+    // Records are decoded from the last one, so values of earlier records are skipped.
+    vector<uint8_t> buffer;
+    for (uint64_t record = m_index[pageId]; record != 0;)
+    {
+      uint64_t const offset = record - 1;
+      uint32_t size;
+      m_file.Read(offset, &record, sizeof(record));
+      m_file.Read(offset + sizeof(record), &size, sizeof(size));
+      buffer.resize(size);
+      m_file.Read(offset + kRecordHeaderSize, buffer.data(), size);
+
+      ArrayByteSource src(buffer.data() + kBitmapSize);
+      LatLon prev = {0, 0};
+      for (uint32_t i = 0; i < kPageSize; ++i)
+      {
+        if (((buffer[i >> 3] >> (i & 7)) & 1) == 0)
+          continue;
+
+        LatLon ll;
+        ll.lat = static_cast<int32_t>(prev.lat + ReadVarInt<int64_t>(src));
+        ll.lon = static_cast<int32_t>(prev.lon + ReadVarInt<int64_t>(src));
+        prev = ll;
+
+        if (!page.IsPresent(i))
+        {
+          page.m_values[i] = ll;
+          page.SetPresent(i);
+        }
+      }
+    }
+    return page;
+  }
+};
+
 }  // namespace cache
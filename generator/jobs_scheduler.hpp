@@ -0,0 +1,138 @@
+#pragma once
+
+#include "base/assert.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/condition_variable.hpp"
+#include "std/cstdint.hpp"
+#include "std/exception.hpp"
+#include "std/function.hpp"
+#include "std/mutex.hpp"
+#include "std/thread.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+/// Runs independent jobs (e.g. generation of country mwms) on a pool of threads.
+/// Every job has an estimated memory cost and the total cost of running jobs
+/// doesn't exceed the memory budget, except the case when a single job is more
+/// expensive than the whole budget: such a job is run alone.
+/// Expensive jobs are started first to reduce the tail of the schedule.
+class JobsScheduler
+{
+public:
+  using TJob = function<void()>;
+
+  /// @param memoryBudget Maximum total cost of running jobs, 0 means unlimited.
+  JobsScheduler(size_t threadsCount, uint64_t memoryBudget)
+    : m_threadsCount(max(threadsCount, size_t(1))), m_memoryBudget(memoryBudget)
+  {
+  }
+
+  void Add(uint64_t memoryCost, TJob const & job) { m_jobs.emplace_back(memoryCost, job); }
+
+  /// Runs all the added jobs and waits for them. Jobs, which are not started yet
+  /// when some job throws, are skipped, and the first exception is rethrown.
+  void Run()
+  {
+    stable_sort(m_jobs.begin(), m_jobs.end(), [](TItem const & lhs, TItem const & rhs)
+    {
+      return lhs.first > rhs.first;
+    });
+
+    size_t const threadsCount = min(m_threadsCount, m_jobs.size());
+    if (threadsCount <= 1)
+    {
+      for (auto & job : m_jobs)
+        job.second();
+      m_jobs.clear();
+      return;
+    }
+
+    m_started.assign(m_jobs.size(), false);
+    m_startedCount = 0;
+
+    vector<thread> threads;
+    for (size_t i = 0; i < threadsCount; ++i)
+      threads.emplace_back(&JobsScheduler::ThreadLoop, this);
+    for (auto & t : threads)
+      t.join();
+
+    m_jobs.clear();
+    if (m_exception)
+    {
+      exception_ptr e = m_exception;
+      m_exception = nullptr;
+      rethrow_exception(e);
+    }
+  }
+
+private:
+  using TItem = pair<uint64_t, TJob>;
+
+  // Returns index of the most expensive job that fits into the budget, or
+  // m_jobs.size() if there is no such job. Jobs are sorted by cost.
+  size_t FindJob() const
+  {
+    for (size_t i = 0; i < m_jobs.size(); ++i)
+    {
+      if (m_started[i])
+        continue;
+      if (m_running == 0 || m_memoryBudget == 0 || m_memoryUsed + m_jobs[i].first <= m_memoryBudget)
+        return i;
+    }
+    return m_jobs.size();
+  }
+
+  void ThreadLoop()
+  {
+    while (true)
+    {
+      size_t index;
+      {
+        unique_lock<mutex> lock(m_mutex);
+        m_jobFinished.wait(lock, [this, &index]()
+        {
+          index = FindJob();
+          return m_exception || m_startedCount == m_jobs.size() || index != m_jobs.size();
+        });
+        if (m_exception || m_startedCount == m_jobs.size())
+          return;
+
+        m_started[index] = true;
+        ++m_startedCount;
+        ++m_running;
+        m_memoryUsed += m_jobs[index].first;
+      }
+
+      exception_ptr e;
+      try
+      {
+        m_jobs[index].second();
+      }
+      catch (...)
+      {
+        e = current_exception();
+      }
+
+      lock_guard<mutex> guard(m_mutex);
+      if (e && !m_exception)
+        m_exception = e;
+      --m_running;
+      m_memoryUsed -= m_jobs[index].first;
+      m_jobFinished.notify_all();
+    }
+  }
+
+  size_t const m_threadsCount;
+  uint64_t const m_memoryBudget;
+  vector<TItem> m_jobs;
+
+  // Guards the fields below.
+  mutex m_mutex;
+  condition_variable m_jobFinished;
+  vector<bool> m_started;
+  size_t m_startedCount = 0;
+  size_t m_running = 0;
+  uint64_t m_memoryUsed = 0;
+  exception_ptr m_exception;
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "base/assert.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/condition_variable.hpp"
+#include "std/cstdint.hpp"
+#include "std/deque.hpp"
+#include "std/exception.hpp"
+#include "std/function.hpp"
+#include "std/map.hpp"
+#include "std/mutex.hpp"
+#include "std/thread.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+/// Three-stage pipeline: the calling thread pushes batches, a pool of workers
+/// converts them to results concurrently and a single writer thread consumes
+/// results in the order of batches, so the output doesn't depend on the number
+/// of workers. The number of batches in flight is bounded by maxBatches.
+template <typename TBatch, typename TResult>
+class OrderedPipeline
+{
+public:
+  /// Called on worker threads, workerIndex is in [0, workersCount).
+  using TWorkerFn = function<void(size_t workerIndex, TBatch & batch, TResult & result)>;
+  /// Called on the writer thread.
+  using TWriterFn = function<void(TResult & result)>;
+
+  OrderedPipeline(size_t workersCount, size_t maxBatches, TWorkerFn const & workerFn,
+                  TWriterFn const & writerFn)
+    : m_workerFn(workerFn), m_writerFn(writerFn), m_maxBatches(max(maxBatches, size_t(1)))
+  {
+    if (workersCount == 0)
+      workersCount = 1;
+
+    for (size_t i = 0; i < workersCount; ++i)
+      m_workers.emplace_back(&OrderedPipeline::WorkerLoop, this, i);
+    m_writer = thread(&OrderedPipeline::WriterLoop, this);
+  }
+
+  ~OrderedPipeline()
+  {
+    Stop();
+  }
+
+  /// Blocks while there are too many batches in flight.
+  /// Rethrows the first exception thrown by workers or writer.
+  void Push(TBatch && batch)
+  {
+    unique_lock<mutex> lock(m_mutex);
+    ASSERT(!m_finished, ());
+    m_batchWritten.wait(lock, [this]() { return m_failed || m_inFlight < m_maxBatches; });
+    if (m_failed)
+    {
+      lock.unlock();
+      Stop();
+      rethrow_exception(m_exception);
+    }
+
+    m_batches.emplace_back(m_pushed++, move(batch));
+    ++m_inFlight;
+    m_batchPushed.notify_one();
+  }
+
+  /// Waits until all the pushed batches are written.
+  /// Rethrows the first exception thrown by workers or writer.
+  void Finish()
+  {
+    Stop();
+    if (m_exception)
+      rethrow_exception(m_exception);
+  }
+
+private:
+  void Stop()
+  {
+    {
+      lock_guard<mutex> guard(m_mutex);
+      if (m_finished)
+        return;
+      m_finished = true;
+    }
+    m_batchPushed.notify_all();
+    m_resultReady.notify_all();
+
+    for (auto & t : m_workers)
+      t.join();
+    m_writer.join();
+  }
+
+  void Fail(exception_ptr e)
+  {
+    lock_guard<mutex> guard(m_mutex);
+    if (!m_failed)
+    {
+      m_failed = true;
+      m_exception = e;
+    }
+    m_batches.clear();
+    m_results.clear();
+    m_batchPushed.notify_all();
+    m_resultReady.notify_all();
+    m_batchWritten.notify_all();
+  }
+
+  void WorkerLoop(size_t workerIndex)
+  {
+    while (true)
+    {
+      pair<uint64_t, TBatch> batch;
+      {
+        unique_lock<mutex> lock(m_mutex);
+        m_batchPushed.wait(lock, [this]() { return m_failed || m_finished || !m_batches.empty(); });
+        if (m_failed || m_batches.empty())
+          return;
+        batch = move(m_batches.front());
+        m_batches.pop_front();
+      }
+
+      TResult result;
+      try
+      {
+        m_workerFn(workerIndex, batch.second, result);
+      }
+      catch (...)
+      {
+        Fail(current_exception());
+        return;
+      }
+
+      lock_guard<mutex> guard(m_mutex);
+      if (m_failed)
+        return;
+      m_results.emplace(batch.first, move(result));
+      if (batch.first == m_written)
+        m_resultReady.notify_one();
+    }
+  }
+
+  void WriterLoop()
+  {
+    while (true)
+    {
+      TResult result;
+      {
+        unique_lock<mutex> lock(m_mutex);
+        m_resultReady.wait(lock, [this]()
+        {
+          return m_failed || (m_finished && m_written == m_pushed) ||
+                 (!m_results.empty() && m_results.begin()->first == m_written);
+        });
+        if (m_failed || m_written == m_pushed)
+          return;
+        auto const it = m_results.begin();
+        result = move(it->second);
+        m_results.erase(it);
+      }
+
+      try
+      {
+        m_writerFn(result);
+      }
+      catch (...)
+      {
+        Fail(current_exception());
+        return;
+      }
+
+      lock_guard<mutex> guard(m_mutex);
+      ++m_written;
+      --m_inFlight;
+      m_batchWritten.notify_one();
+    }
+  }
+
+  TWorkerFn const m_workerFn;
+  TWriterFn const m_writerFn;
+  size_t const m_maxBatches;
+
+  vector<thread> m_workers;
+  thread m_writer;
+
+  // Guards the fields below.
+  mutex m_mutex;
+  condition_variable m_batchPushed;
+  condition_variable m_resultReady;
+  condition_variable m_batchWritten;
+  deque<pair<uint64_t, TBatch>> m_batches;
+  map<uint64_t, TResult> m_results;
+  uint64_t m_pushed = 0;
+  uint64_t m_written = 0;
+  size_t m_inFlight = 0;
+  exception_ptr m_exception;
+  bool m_failed = false;
+  bool m_finished = false;
+};
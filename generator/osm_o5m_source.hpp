@@ -2,6 +2,7 @@
 #pragma once
 
 #include "std/algorithm.hpp"
+#include "std/cstdint.hpp"
 #include "std/cstring.hpp"
 #include "std/function.hpp"
 #include "std/iomanip.hpp"
@@ -622,4 +623,132 @@ public:
   }
 };
 
+/// Splits o5m stream into chunks at reset datasets. Deltas and the string table
+/// are reset there, so every chunk may be decoded by a separate O5MSource.
+/// Only dataset headers are parsed, so splitting is much faster than decoding.
+class O5MChunkReader
+{
+  using EntityType = O5MSource::EntityType;
+
+  TReadFunc m_reader;
+  vector<uint8_t> m_buffer;
+  size_t m_position = 0;
+  size_t m_size = 0;
+  size_t const m_minChunkSize;
+  vector<uint8_t> m_header;
+  bool m_pendingReset = false;
+  bool m_end = false;
+
+  bool GetByte(uint8_t & b)
+  {
+    if (m_position == m_size)
+    {
+      m_size = m_end ? 0 : m_reader(m_buffer.data(), m_buffer.size());
+      m_position = 0;
+      if (m_size == 0)
+      {
+        m_end = true;
+        return false;
+      }
+    }
+    b = m_buffer[m_position++];
+    return true;
+  }
+
+  void CopyBytes(uint64_t count, vector<uint8_t> & dest)
+  {
+    while (count > 0)
+    {
+      if (m_position == m_size)
+      {
+        uint8_t b;
+        if (!GetByte(b))
+          return;
+        dest.push_back(b);
+        --count;
+        continue;
+      }
+      size_t const size = static_cast<size_t>(min(count, static_cast<uint64_t>(m_size - m_position)));
+      dest.insert(dest.end(), m_buffer.begin() + m_position, m_buffer.begin() + m_position + size);
+      m_position += size;
+      count -= size;
+    }
+  }
+
+  // Copies varint to dest and returns its value.
+  uint64_t CopyVarUInt(vector<uint8_t> & dest)
+  {
+    uint64_t ret = 0;
+    uint8_t b;
+    uint8_t i = 0;
+    do
+    {
+      if (!GetByte(b))
+        return ret;
+      dest.push_back(b);
+      ret |= (uint64_t)(b & 0x7f) << (i++ * 7);
+    } while (b & 0x80);
+    return ret;
+  }
+
+public:
+  O5MChunkReader(TReadFunc reader, size_t minChunkSize, size_t readBufferSizeInBytes = 1 << 20)
+    : m_reader(reader), m_buffer(readBufferSizeInBytes), m_minChunkSize(minChunkSize)
+  {
+    uint8_t b;
+    if (!GetByte(b) || EntityType::Reset != EntityType(b))
+      throw runtime_error("Incorrect o5m start");
+    m_header.push_back(b);
+
+    // The header is copied to every chunk.
+    if (!GetByte(b) || EntityType::Header != EntityType(b))
+      throw runtime_error("Incorrect o5m header");
+    m_header.push_back(b);
+    CopyBytes(CopyVarUInt(m_header), m_header);
+  }
+
+  /// Reads datasets from a reset point till the next reset point after minChunkSize bytes.
+  /// Chunk starts with the stream header and ends with the end dataset,
+  /// so it may be decoded by O5MSource.
+  /// @return False if there is no more data.
+  bool ReadChunk(vector<uint8_t> & chunk)
+  {
+    chunk.assign(m_header.begin(), m_header.end());
+    size_t const start = chunk.size();
+    if (m_pendingReset)
+    {
+      chunk.push_back(static_cast<uint8_t>(EntityType::Reset));
+      m_pendingReset = false;
+    }
+
+    uint8_t type;
+    while (GetByte(type))
+    {
+      if (EntityType::End == EntityType(type))
+      {
+        m_end = true;
+        m_position = m_size;
+        break;
+      }
+
+      if (EntityType::Reset == EntityType(type) && chunk.size() - start >= m_minChunkSize)
+      {
+        m_pendingReset = true;
+        break;
+      }
+
+      chunk.push_back(type);
+      // Datasets 0xf0-0xff consist of one byte only.
+      if (type < 0xf0)
+        CopyBytes(CopyVarUInt(chunk), chunk);
+    }
+
+    if (chunk.size() == start)
+      return false;
+
+    chunk.push_back(static_cast<uint8_t>(EntityType::End));
+    return true;
+  }
+};
+
 }  // namespace osm
@@ -9,6 +9,7 @@
 #include "generator/polygonizer.hpp"
 #include "generator/world_map_generator.hpp"
 #include "generator/osm_element.hpp"
+#include "generator/ordered_pipeline.hpp"
 
 #include "indexer/classificator.hpp"
 #include "indexer/mercator.hpp"
@@ -123,6 +124,10 @@ public:
 
   void AddWay(TKey id, WayElement const & e) { m_ways.Write(id, e); }
   bool GetWay(TKey id, WayElement & e) { return m_ways.Read(id, e); }
+  void GetWays(vector<TKey> const & ids, vector<WayElement> & ways, vector<bool> & found)
+  {
+    m_ways.Read(ids, ways, found);
+  }
 
   void AddRelation(TKey id, RelationElement const & e)
   {
@@ -175,6 +180,60 @@ public:
   }
 };
 
+/// Intermediate data of a batch of elements. Nodes, ways and relations are stored
+/// to independent parts of the cache, so only the order of elements of each kind is kept.
+class IntermediateDataBatch
+{
+  struct Node
+  {
+    uint64_t m_id;
+    double m_lat;
+    double m_lng;
+  };
+
+  vector<Node> m_nodes;
+  vector<pair<uint64_t, WayElement>> m_ways;
+  vector<pair<uint64_t, RelationElement>> m_relations;
+
+public:
+  void AddNode(uint64_t id, double lat, double lng) { m_nodes.push_back({id, lat, lng}); }
+  void AddWay(uint64_t id, WayElement const & e) { m_ways.emplace_back(id, e); }
+  void AddRelation(uint64_t id, RelationElement const & e) { m_relations.emplace_back(id, e); }
+
+  template <class TCache>
+  void AddTo(TCache & cache) const
+  {
+    for (auto const & node : m_nodes)
+      cache.AddNode(node.m_id, node.m_lat, node.m_lng);
+    for (auto const & way : m_ways)
+      cache.AddWay(way.first, way.second);
+    for (auto const & relation : m_relations)
+      cache.AddRelation(relation.first, relation.second);
+  }
+};
+
+/// Translated features of a batch of elements.
+class FeaturesBatch
+{
+  vector<FeatureBuilder1> m_features;
+
+public:
+  void operator()(FeatureBuilder1 const & fb) { m_features.push_back(fb); }
+
+  void Swap(FeaturesBatch & batch) { m_features.swap(batch.m_features); }
+
+  template <class ToDo>
+  void ForEach(ToDo && toDo)
+  {
+    for (auto & fb : m_features)
+      toDo(fb);
+  }
+};
+
+size_t constexpr kElementsBatchSize = 4096;
+// Number of batches in flight per translation thread.
+size_t constexpr kBatchesPerThread = 4;
+
 class MainFeaturesEmitter
 {
   using TWorldGenerator = WorldMapGenerator<feature::FeaturesCollector>;
@@ -409,15 +468,12 @@ void BuildIntermediateDataFromO5M(SourceReader & stream, TCache & cache)
     AddElementToCache(cache, e);
 }
 
-void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> processor)
+namespace
+{
+void O5MEntityToElement(osm::O5MSource::Entity const & em, OsmElement & p)
 {
   using TType = osm::O5MSource::EntityType;
 
-  osm::O5MSource dataset([&stream](uint8_t * buffer, size_t size)
-  {
-    return stream.Read(reinterpret_cast<char *>(buffer), size);
-  });
-
   auto translate = [](TType t) -> OsmElement::EntityType
   {
     switch (t)
@@ -429,44 +485,194 @@ void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> pr
     }
   };
 
+  p.id = em.id;
+
+  switch (em.type)
+  {
+    case TType::Node:
+    {
+      p.type = OsmElement::EntityType::Node;
+      p.lat = em.lat;
+      p.lon = em.lon;
+      break;
+    }
+    case TType::Way:
+    {
+      p.type = OsmElement::EntityType::Way;
+      for (uint64_t nd : em.Nodes())
+        p.AddNd(nd);
+      break;
+    }
+    case TType::Relation:
+    {
+      p.type = OsmElement::EntityType::Relation;
+      for (auto const & member : em.Members())
+        p.AddMember(member.ref, translate(member.type), member.role);
+      break;
+    }
+    default: break;
+  }
+
+  for (auto const & tag : em.Tags())
+    p.AddTag(tag.key, tag.value);
+}
+}  // namespace
+
+void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> processor)
+{
+  osm::O5MSource dataset([&stream](uint8_t * buffer, size_t size)
+  {
+    return stream.Read(reinterpret_cast<char *>(buffer), size);
+  });
+
   for (auto const & em : dataset)
   {
     OsmElement p;
-    p.id = em.id;
+    O5MEntityToElement(em, p);
+    processor(&p);
+  }
+}
 
-    switch (em.type)
-    {
-      case TType::Node:
-      {
-        p.type = OsmElement::EntityType::Node;
-        p.lat = em.lat;
-        p.lon = em.lon;
-        break;
-      }
-      case TType::Way:
+void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> processor,
+                          size_t threadsCount, size_t minChunkSize)
+{
+  if (threadsCount <= 1)
+  {
+    BuildFeaturesFromO5M(stream, processor);
+    return;
+  }
+
+  using TChunk = vector<uint8_t>;
+  using TElements = vector<OsmElement>;
+
+  OrderedPipeline<TChunk, TElements> pipeline(
+      threadsCount, 2 * threadsCount,
+      [](size_t /* worker */, TChunk & chunk, TElements & elements)
       {
-        p.type = OsmElement::EntityType::Way;
-        for (uint64_t nd : em.Nodes())
-          p.AddNd(nd);
-        break;
-      }
-      case TType::Relation:
+        size_t position = 0;
+        osm::O5MSource dataset([&chunk, &position](uint8_t * buffer, size_t size)
+        {
+          size = min(size, chunk.size() - position);
+          memcpy(buffer, chunk.data() + position, size);
+          position += size;
+          return size;
+        });
+
+        for (auto const & em : dataset)
+        {
+          elements.emplace_back();
+          O5MEntityToElement(em, elements.back());
+        }
+      },
+      [&processor](TElements & elements)
       {
-        p.type = OsmElement::EntityType::Relation;
-        for (auto const & member : em.Members())
-          p.AddMember(member.ref, translate(member.type), member.role);
-        break;
-      }
-      default: break;
-    }
+        for (auto & e : elements)
+          processor(&e);
+      });
 
-    for (auto const & tag : em.Tags())
-      p.AddTag(tag.key, tag.value);
+  osm::O5MChunkReader reader([&stream](uint8_t * buffer, size_t size)
+  {
+    return stream.Read(reinterpret_cast<char *>(buffer), size);
+  }, minChunkSize);
 
-    processor(&p);
+  TChunk chunk;
+  while (reader.ReadChunk(chunk))
+    pipeline.Push(move(chunk));
+  pipeline.Finish();
+}
+
+namespace
+{
+using TElementsBatch = vector<OsmElement>;
+
+void ForEachElement(feature::GenerateInfo const & info, function<void(OsmElement *)> const & fn)
+{
+  SourceReader reader = info.m_osmFileName.empty() ? SourceReader() : SourceReader(info.m_osmFileName);
+  switch (info.m_osmFileType)
+  {
+    case feature::GenerateInfo::OsmSourceType::XML:
+      BuildFeaturesFromXML(reader, fn);
+      break;
+    case feature::GenerateInfo::OsmSourceType::O5M:
+      BuildFeaturesFromO5M(reader, fn, info.m_threadsCount);
+      break;
   }
 }
 
+/// Parses the source on the calling thread and passes batches of elements to the pipeline.
+template <class TResult>
+void PushElementsToPipeline(feature::GenerateInfo const & info,
+                            OrderedPipeline<TElementsBatch, TResult> & pipeline)
+{
+  TElementsBatch batch;
+  batch.reserve(kElementsBatchSize);
+  ForEachElement(info, [&](OsmElement * e)
+  {
+    // Sources clear the element after the call, so it may be moved.
+    batch.push_back(move(*e));
+    if (batch.size() == kElementsBatchSize)
+    {
+      pipeline.Push(move(batch));
+      batch.clear();
+      batch.reserve(kElementsBatchSize);
+    }
+  });
+
+  if (!batch.empty())
+    pipeline.Push(move(batch));
+  pipeline.Finish();
+}
+
+/// Translates elements on info.m_threadsCount threads. Features are passed to
+/// emitter on one thread in the order of elements, so the output is the same
+/// as for the sequential translation.
+template <class TEmitter, class TDataCache>
+void TranslateElementsConcurrently(feature::GenerateInfo const & info, TEmitter & emitter,
+                                   TDataCache & cache, uint32_t coastType)
+{
+  using TTranslator = OsmToFeatureTranslator<FeaturesBatch, TDataCache>;
+
+  // Readers of the cache don't change it, so the translators share it without locks.
+  vector<FeaturesBatch> buffers(info.m_threadsCount);
+  vector<unique_ptr<TTranslator>> translators;
+  for (auto & buffer : buffers)
+    translators.emplace_back(new TTranslator(buffer, cache, coastType));
+
+  OrderedPipeline<TElementsBatch, FeaturesBatch> pipeline(
+      info.m_threadsCount, kBatchesPerThread * info.m_threadsCount,
+      [&](size_t worker, TElementsBatch & batch, FeaturesBatch & features)
+      {
+        for (auto & e : batch)
+          translators[worker]->EmitElement(&e);
+        features.Swap(buffers[worker]);
+      },
+      [&emitter](FeaturesBatch & features)
+      {
+        features.ForEach(emitter);
+      });
+  PushElementsToPipeline(info, pipeline);
+}
+
+/// Converts elements to the intermediate data on info.m_threadsCount threads
+/// and adds it to cache on one thread in the order of elements.
+template <class TDataCache>
+void AddElementsToCacheConcurrently(feature::GenerateInfo const & info, TDataCache & cache)
+{
+  OrderedPipeline<TElementsBatch, IntermediateDataBatch> pipeline(
+      info.m_threadsCount, kBatchesPerThread * info.m_threadsCount,
+      [](size_t /* worker */, TElementsBatch & batch, IntermediateDataBatch & data)
+      {
+        for (auto const & e : batch)
+          AddElementToCache(data, e);
+      },
+      [&cache](IntermediateDataBatch & data)
+      {
+        data.AddTo(cache);
+      });
+  PushElementsToPipeline(info, pipeline);
+}
+}  // namespace
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Generate functions implementations.
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -483,26 +689,23 @@ bool GenerateFeaturesImpl(feature::GenerateInfo & info)
     cache.LoadIndex();
 
     MainFeaturesEmitter bucketer(info);
-    OsmToFeatureTranslator<MainFeaturesEmitter, TDataCache> parser(
-        bucketer, cache, info.m_makeCoasts ? classif().GetCoastType() : 0,
-        info.GetAddressesFileName());
+    using TEmitter = PlacesAndAddressesEmitter<MainFeaturesEmitter>;
+    TEmitter emitter(bucketer, info.GetAddressesFileName());
+    uint32_t const coastType = info.m_makeCoasts ? classif().GetCoastType() : 0;
 
-    auto fn = [&parser](OsmElement * e) { parser.EmitElement(e); };
-
-    SourceReader reader = info.m_osmFileName.empty() ? SourceReader() : SourceReader(info.m_osmFileName);
-    switch (info.m_osmFileType)
+    if (info.m_threadsCount > 1)
+    {
+      TranslateElementsConcurrently(info, emitter, cache, coastType);
+    }
+    else
     {
-      case feature::GenerateInfo::OsmSourceType::XML:
-        BuildFeaturesFromXML(reader, fn);
-        break;
-      case feature::GenerateInfo::OsmSourceType::O5M:
-        BuildFeaturesFromO5M(reader, fn);
-        break;
+      OsmToFeatureTranslator<TEmitter, TDataCache> parser(emitter, cache, coastType);
+      ForEachElement(info, [&parser](OsmElement * e) { parser.EmitElement(e); });
     }
 
     LOG(LINFO, ("Processing", info.m_osmFileName, "done."));
 
-    parser.Finish();
+    emitter.Finish();
 
     // Stop if coasts are not merged and FLAG_fail_on_coasts is set
     if (!bucketer.Finish())
@@ -527,18 +730,24 @@ bool GenerateIntermediateDataImpl(feature::GenerateInfo & info)
     using TDataCache = IntermediateData<TNodesHolder, cache::EMode::Write>;
     TDataCache cache(nodes, info);
 
-    SourceReader reader = info.m_osmFileName.empty() ? SourceReader() : SourceReader(info.m_osmFileName);
-
     LOG(LINFO, ("Data source:", info.m_osmFileName));
 
-    switch (info.m_osmFileType)
+    if (info.m_threadsCount > 1)
     {
-      case feature::GenerateInfo::OsmSourceType::XML:
-        BuildIntermediateDataFromXML(reader, cache);
-        break;
-      case feature::GenerateInfo::OsmSourceType::O5M:
-        BuildIntermediateDataFromO5M(reader, cache);
-        break;
+      AddElementsToCacheConcurrently(info, cache);
+    }
+    else
+    {
+      SourceReader reader = info.m_osmFileName.empty() ? SourceReader() : SourceReader(info.m_osmFileName);
+      switch (info.m_osmFileType)
+      {
+        case feature::GenerateInfo::OsmSourceType::XML:
+          BuildIntermediateDataFromXML(reader, cache);
+          break;
+        case feature::GenerateInfo::OsmSourceType::O5M:
+          BuildIntermediateDataFromO5M(reader, cache);
+          break;
+      }
     }
 
     cache.SaveIndex();
@@ -561,6 +770,8 @@ bool GenerateFeatures(feature::GenerateInfo & info)
       return GenerateFeaturesImpl<cache::MapFilePointStorage<cache::EMode::Read>>(info);
     case feature::GenerateInfo::NodeStorageType::Memory:
       return GenerateFeaturesImpl<cache::RawMemPointStorage<cache::EMode::Read>>(info);
+    case feature::GenerateInfo::NodeStorageType::Paged:
+      return GenerateFeaturesImpl<cache::PagedFilePointStorage<cache::EMode::Read>>(info);
   }
   return false;
 }
@@ -575,6 +786,8 @@ bool GenerateIntermediateData(feature::GenerateInfo & info)
       return GenerateIntermediateDataImpl<cache::MapFilePointStorage<cache::EMode::Write>>(info);
     case feature::GenerateInfo::NodeStorageType::Memory:
       return GenerateIntermediateDataImpl<cache::RawMemPointStorage<cache::EMode::Write>>(info);
+    case feature::GenerateInfo::NodeStorageType::Paged:
+      return GenerateIntermediateDataImpl<cache::PagedFilePointStorage<cache::EMode::Write>>(info);
   }
   return false;
 }
@@ -36,5 +36,9 @@ bool GenerateFeatures(feature::GenerateInfo & info);
 bool GenerateIntermediateData(feature::GenerateInfo & info);
 
 void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> processor);
+/// Decodes chunks of the stream between reset points on threadsCount threads.
+/// Processor is called on one thread in the order of elements.
+void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> processor,
+                          size_t threadsCount, size_t minChunkSize = 16 * 1024 * 1024);
 void BuildFeaturesFromXML(SourceReader & stream, function<void(OsmElement *)> processor);
 
@@ -209,16 +209,62 @@ protected:
 
 }  // namespace
 
+/// Writes addresses of buildings and keeps only the best one of equal places,
+/// other features are passed to TEmitter as is. Features should come in the order
+/// of source elements, since the result depends on it.
 /// @param  TEmitter  Feature accumulating policy
+template <class TEmitter>
+class PlacesAndAddressesEmitter
+{
+  TEmitter & m_emitter;
+  unique_ptr<FileWriter> m_addrWriter;
+  m4::Tree<Place> m_places;
+
+public:
+  PlacesAndAddressesEmitter(TEmitter & emitter, string const & addrFilePath) : m_emitter(emitter)
+  {
+    if (!addrFilePath.empty())
+      m_addrWriter.reset(new FileWriter(addrFilePath));
+  }
+
+  void operator() (FeatureBuilder1 & ft)
+  {
+    string addr;
+    if (m_addrWriter && ftypes::IsBuildingChecker::Instance()(ft.GetTypes()) && ft.FormatFullAddress(addr))
+      m_addrWriter->Write(addr.c_str(), addr.size());
+
+    static uint32_t const placeType = classif().GetTypeByPath({"place"});
+    uint32_t const type = ft.FindType(placeType, 1);
+
+    if (type != ftype::GetEmptyValue() && !ft.GetName().empty())
+    {
+      m_places.ReplaceEqualInRect(Place(ft, type),
+                                  bind(&Place::IsEqual, _1, _2),
+                                  bind(&Place::IsBetterThan, _1, _2));
+    }
+    else
+      m_emitter(ft);
+  }
+
+  void Finish()
+  {
+    m_places.ForEach([this] (Place const & p)
+    {
+      m_emitter(p.GetFeature());
+    });
+  }
+};
+
+/// @param  TEmitter  Feature accumulating policy, it gets preserialized features
 /// @param  TCache   Nodes, ways, relations holder
+/// @note Translator keeps only caches of relations between elements, so elements
+/// may be translated concurrently by several translators with a thread-safe holder.
 template <class TEmitter, class TCache>
 class OsmToFeatureTranslator
 {
   TEmitter & m_emitter;
   TCache & m_holder;
   uint32_t m_coastType;
-  unique_ptr<FileWriter> m_addrWriter;
-  m4::Tree<Place> m_places;
   RelationTagsNode m_nodeRelations;
   RelationTagsWay m_wayRelations;
 
@@ -231,6 +277,7 @@ class OsmToFeatureTranslator
     HolesAccumulator(OsmToFeatureTranslator * pMain) : m_merger(pMain->m_holder) {}
 
     void operator() (uint64_t id) { m_merger.AddWay(id); }
+    void AddWays(vector<uint64_t> const & ids) { m_merger.AddWays(ids); }
 
     FeatureBuilder1::TGeometry & GetHoles()
     {
@@ -301,23 +348,7 @@ class OsmToFeatureTranslator
   {
     ft.SetParams(params);
     if (ft.PreSerialize())
-    {
-      string addr;
-      if (m_addrWriter && ftypes::IsBuildingChecker::Instance()(params.m_Types) && ft.FormatFullAddress(addr))
-        m_addrWriter->Write(addr.c_str(), addr.size());
-
-      static uint32_t const placeType = classif().GetTypeByPath({"place"});
-      uint32_t const type = params.FindType(placeType, 1);
-
-      if (type != ftype::GetEmptyValue() && !ft.GetName().empty())
-      {
-        m_places.ReplaceEqualInRect(Place(ft, type),
-                                    bind(&Place::IsEqual, _1, _2),
-                                    bind(&Place::IsBetterThan, _1, _2));
-      }
-      else
-        m_emitter(ft);
-    }
+      m_emitter(ft);
   }
 
   /// @param[in]  params  Pass by value because it can be modified.
@@ -477,16 +508,20 @@ public:
         AreaWayMerger<TCache> outer(m_holder);
 
         // 3. Iterate ways to get 'outer' and 'inner' geometries
+        vector<uint64_t> outerIds;
+        vector<uint64_t> innerIds;
         for (auto const & e : p->Members())
         {
           if (e.type != OsmElement::EntityType::Way)
             continue;
 
           if (e.role == "outer")
-            outer.AddWay(e.ref);
+            outerIds.push_back(e.ref);
           else if (e.role == "inner")
-            holes(e.ref);
+            innerIds.push_back(e.ref);
         }
+        outer.AddWays(outerIds);
+        holes.AddWays(innerIds);
 
         auto const & holesGeometry = holes.GetHoles();
         outer.ForEachArea(true, [&] (FeatureBuilder1::TPointSeq const & pts, vector<uint64_t> const & ids)
@@ -527,19 +562,8 @@ public:
   }
 
 public:
-  OsmToFeatureTranslator(TEmitter & emitter, TCache & holder,
-                   uint32_t coastType, string const & addrFilePath)
+  OsmToFeatureTranslator(TEmitter & emitter, TCache & holder, uint32_t coastType)
     : m_emitter(emitter), m_holder(holder), m_coastType(coastType)
   {
-    if (!addrFilePath.empty())
-      m_addrWriter.reset(new FileWriter(addrFilePath));
-  }
-
-  void Finish()
-  {
-    m_places.ForEach([this] (Place const & p)
-    {
-      m_emitter(p.GetFeature());
-    });
   }
 };
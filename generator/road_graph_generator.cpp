@@ -0,0 +1,96 @@
+#include "generator/road_graph_generator.hpp"
+
+#include "routing/contraction_hierarchy.hpp"
+#include "routing/pedestrian_model.hpp"
+#include "routing/road_graph_section.hpp"
+
+#include "indexer/feature.hpp"
+#include "indexer/feature_processor.hpp"
+
+#include "coding/file_container.hpp"
+#include "coding/writer.hpp"
+
+#include "base/logging.hpp"
+
+#include "defines.hpp"
+
+namespace routing
+{
+shared_ptr<IVehicleModel> GetPedestrianModelForMwm(string const & countryName)
+{
+  // The same model as FeaturesRoadGraph uses for features of the mwm.
+  return PedestrianModelFactory().GetVehicleModelForCountry(
+      GetVehicleModelCountryName(countryName));
+}
+
+void BuildPedestrianGraphSection(string const & baseDir, string const & countryName)
+{
+  string const mwmFile = baseDir + countryName + DATA_FILE_EXTENSION;
+  LOG(LINFO, ("Generating pedestrian graph for", mwmFile));
+
+  shared_ptr<IVehicleModel> const vehicleModel = GetPedestrianModelForMwm(countryName);
+
+  vector<RoadGraphSection::Road> roads;
+  auto const fn = [&roads, &vehicleModel](FeatureType & ft, uint32_t index)
+  {
+    if (ft.GetFeatureType() != feature::GEOM_LINE)
+      return;
+
+    double const speedKMPH = vehicleModel->GetSpeed(ft);
+    if (speedKMPH <= 0.0)
+      return;
+
+    ft.ParseGeometry(FeatureType::BEST_GEOMETRY);
+
+    IRoadGraph::RoadInfo ri;
+    ri.m_bidirectional = !vehicleModel->IsOneWay(ft);
+    ri.m_speedKMPH = speedKMPH;
+    ft.SwapPoints(ri.m_points);
+    roads.emplace_back(index, move(ri));
+  };
+  feature::ForEachFromDat(mwmFile, fn);
+
+  size_t const roadsCount = roads.size();
+  {
+    FilesContainerW cont(mwmFile, FileWriter::OP_WRITE_EXISTING);
+    FileWriter writer = cont.GetWriter(PEDESTRIAN_GRAPH_FILE_TAG);
+    RoadGraphSection::Serialize(roads, writer);
+  }
+
+  LOG(LINFO, ("Pedestrian graph is written, roads:", roadsCount));
+}
+
+void BuildPedestrianHierarchySection(string const & baseDir, string const & countryName)
+{
+  string const mwmFile = baseDir + countryName + DATA_FILE_EXTENSION;
+  LOG(LINFO, ("Generating pedestrian contraction hierarchy for", mwmFile));
+
+  vector<char> hierarchy;
+  {
+    FilesContainerR cont(mwmFile);
+    if (!cont.IsExist(PEDESTRIAN_GRAPH_FILE_TAG))
+    {
+      LOG(LERROR, ("There is no pedestrian graph in", mwmFile));
+      return;
+    }
+
+    FilesContainerR::ReaderT reader = cont.GetReader(PEDESTRIAN_GRAPH_FILE_TAG);
+    vector<char> data(static_cast<size_t>(reader.Size()));
+    reader.Read(0, data.data(), data.size());
+
+    RoadGraphSection graph;
+    if (!graph.Attach(data.data(), data.size()))
+    {
+      LOG(LERROR, ("Can't read pedestrian graph of", mwmFile));
+      return;
+    }
+
+    MemWriter<vector<char>> writer(hierarchy);
+    ContractionHierarchy::Build(graph, writer);
+  }
+
+  FilesContainerW cont(mwmFile, FileWriter::OP_WRITE_EXISTING);
+  FileWriter writer = cont.GetWriter(PEDESTRIAN_HIERARCHY_FILE_TAG);
+  writer.Write(hierarchy.data(), hierarchy.size());
+}
+}  // namespace routing
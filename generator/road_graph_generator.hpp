@@ -0,0 +1,25 @@
+#pragma once
+
+#include "routing/vehicle_model.hpp"
+
+#include "std/shared_ptr.hpp"
+#include "std/string.hpp"
+
+namespace routing
+{
+/// @return Pedestrian model for roads of mwm, the same which is used in routing.
+/// @param[in]  countryName   Country name same with .mwm file name.
+shared_ptr<IVehicleModel> GetPedestrianModelForMwm(string const & countryName);
+
+/// Builds routing::RoadGraphSection with pedestrian roads of mwm and writes it
+/// to the PEDESTRIAN_GRAPH_FILE_TAG section.
+/// @param[in]  baseDir       Full path to .mwm files directory.
+/// @param[in]  countryName   Country name same with .mwm file name.
+void BuildPedestrianGraphSection(string const & baseDir, string const & countryName);
+
+/// Builds routing::ContractionHierarchy of the pedestrian road graph section and writes it
+/// to the PEDESTRIAN_HIERARCHY_FILE_TAG section. The road graph section should be built before.
+/// @param[in]  baseDir       Full path to .mwm files directory.
+/// @param[in]  countryName   Country name same with .mwm file name.
+void BuildPedestrianHierarchySection(string const & baseDir, string const & countryName);
+}
@@ -17,16 +17,39 @@ class AreaWayMerger
   THolder & m_holder;
   TWayMap m_map;
 
+  void AddWay(shared_ptr<WayElement> const & e)
+  {
+    if (e->IsValid())
+    {
+      m_map.insert(make_pair(e->nodes.front(), e));
+      m_map.insert(make_pair(e->nodes.back(), e));
+    }
+  }
+
 public:
   AreaWayMerger(THolder & holder) : m_holder(holder) {}
 
   void AddWay(uint64_t id)
   {
     shared_ptr<WayElement> e(new WayElement(id));
-    if (m_holder.GetWay(id, *e) && e->IsValid())
+    if (m_holder.GetWay(id, *e))
+      AddWay(e);
+  }
+
+  /// The same as AddWay for every id, but ways are read in one batch.
+  void AddWays(vector<uint64_t> const & ids)
+  {
+    vector<WayElement> ways;
+    ways.reserve(ids.size());
+    for (uint64_t id : ids)
+      ways.emplace_back(id);
+
+    vector<bool> found;
+    m_holder.GetWays(ids, ways, found);
+    for (size_t i = 0; i < ways.size(); ++i)
     {
-      m_map.insert(make_pair(e->nodes.front(), e));
-      m_map.insert(make_pair(e->nodes.back(), e));
+      if (found[i])
+        AddWay(make_shared<WayElement>(move(ways[i])));
     }
   }
 
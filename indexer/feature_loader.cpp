@@ -190,14 +190,22 @@ uint32_t LoaderCurrent::ParseGeometry(int scale)
       int const ind = GetScaleIndex(scale, m_ptsOffsets);
       if (ind != -1)
       {
-        ReaderSource<FilesContainerR::ReaderT> src(m_Info.GetGeometryReader(ind));
-        src.Skip(m_ptsOffsets[ind]);
-
         serial::CodingParams cp = GetCodingParams(ind);
         cp.SetBasePoint(m_pF->m_points[0]);
-        serial::LoadOuterPath(src, cp, m_pF->m_points);
 
-        sz = static_cast<uint32_t>(src.Pos() - m_ptsOffsets[ind]);
+        if (char const * data = m_Info.GetGeometryData(ind))
+        {
+          char const * start = data + m_ptsOffsets[ind];
+          sz = static_cast<uint32_t>(serial::LoadOuterPathBulk(start, cp, m_pF->m_points) - start);
+        }
+        else
+        {
+          ReaderSource<FilesContainerR::ReaderT> src(m_Info.GetGeometryReader(ind));
+          src.Skip(m_ptsOffsets[ind]);
+          serial::LoadOuterPath(src, cp, m_pF->m_points);
+
+          sz = static_cast<uint32_t>(src.Pos() - m_ptsOffsets[ind]);
+        }
       }
     }
     else
@@ -238,11 +246,21 @@ uint32_t LoaderCurrent::ParseTriangles(int scale)
       uint32_t const ind = GetScaleIndex(scale, m_trgOffsets);
       if (ind != -1)
       {
-        ReaderSource<FilesContainerR::ReaderT> src(m_Info.GetTrianglesReader(ind));
-        src.Skip(m_trgOffsets[ind]);
-        serial::LoadOuterTriangles(src, GetCodingParams(ind), m_pF->m_triangles);
-
-        sz = static_cast<uint32_t>(src.Pos() - m_trgOffsets[ind]);
+        if (char const * data = m_Info.GetTrianglesData(ind))
+        {
+          char const * start = data + m_trgOffsets[ind];
+          sz = static_cast<uint32_t>(
+              serial::LoadOuterTrianglesBulk(start, GetCodingParams(ind), m_pF->m_triangles) -
+              start);
+        }
+        else
+        {
+          ReaderSource<FilesContainerR::ReaderT> src(m_Info.GetTrianglesReader(ind));
+          src.Skip(m_trgOffsets[ind]);
+          serial::LoadOuterTriangles(src, GetCodingParams(ind), m_pF->m_triangles);
+
+          sz = static_cast<uint32_t>(src.Pos() - m_trgOffsets[ind]);
+        }
       }
     }
 
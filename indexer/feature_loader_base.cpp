@@ -9,6 +9,7 @@
 #include "defines.hpp"
 
 #include "coding/byte_stream.hpp"
+#include "coding/mmap_reader.hpp"
 
 
 namespace feature
@@ -22,6 +23,9 @@ SharedLoadInfo::SharedLoadInfo(FilesContainerR const & cont, DataHeader const &
   : m_cont(cont), m_header(header)
 {
   CreateLoader();
+
+  m_geometryData.fill(make_pair(false, nullptr));
+  m_trianglesData.fill(make_pair(false, nullptr));
 }
 
 SharedLoadInfo::~SharedLoadInfo()
@@ -54,6 +58,32 @@ SharedLoadInfo::ReaderT SharedLoadInfo::GetTrianglesReader(int ind) const
   return m_cont.GetReader(GetTagForIndex(TRIANGLE_FILE_TAG, ind));
 }
 
+char const * SharedLoadInfo::GetGeometryData(int ind) const
+{
+  return GetMappedData(&SharedLoadInfo::GetGeometryReader, ind, m_geometryData);
+}
+
+char const * SharedLoadInfo::GetTrianglesData(int ind) const
+{
+  return GetMappedData(&SharedLoadInfo::GetTrianglesReader, ind, m_trianglesData);
+}
+
+char const * SharedLoadInfo::GetMappedData(ReaderT (SharedLoadInfo::*getReader)(int) const,
+                                           int ind, TMappedSections & sections) const
+{
+  ASSERT_LESS(static_cast<size_t>(ind), sections.size(), ());
+  auto & section = sections[ind];
+  if (!section.first)
+  {
+    // Mapped memory is owned by m_cont, so the pointer outlives the sub-reader.
+    ReaderT const reader = (this->*getReader)(ind);
+    MmapReader const * mmapReader = dynamic_cast<MmapReader const *>(reader.GetPtr());
+    section = make_pair(true, mmapReader ? reinterpret_cast<char const *>(mmapReader->Data())
+                                         : nullptr);
+  }
+  return section.second;
+}
+
 void SharedLoadInfo::CreateLoader()
 {
   if (m_header.GetFormat() == version::v1)
@@ -4,7 +4,9 @@
 
 #include "coding/file_container.hpp"
 
+#include "std/array.hpp"
 #include "std/noncopyable.hpp"
+#include "std/utility.hpp"
 
 
 class FeatureType;
@@ -25,6 +27,13 @@ namespace feature
     LoaderBase * m_pLoader;
     void CreateLoader();
 
+    // Lazily found memory of geometry and triangles sections for every scale index:
+    // (is found, pointer or nullptr when the container isn't memory-mapped).
+    using TMappedSections = array<pair<bool, char const *>, DataHeader::MAX_SCALES_COUNT>;
+    mutable TMappedSections m_geometryData, m_trianglesData;
+    char const * GetMappedData(ReaderT (SharedLoadInfo::*getReader)(int) const, int ind,
+                               TMappedSections & sections) const;
+
   public:
     SharedLoadInfo(FilesContainerR const & cont, DataHeader const & header);
     ~SharedLoadInfo();
@@ -35,6 +44,13 @@ namespace feature
     ReaderT GetGeometryReader(int ind) const;
     ReaderT GetTrianglesReader(int ind) const;
 
+    /// @return Geometry (triangles) section for scale index in memory, when the container
+    /// is memory-mapped (see SharedFeaturesVector), or nullptr otherwise.
+    //@{
+    char const * GetGeometryData(int ind) const;
+    char const * GetTrianglesData(int ind) const;
+    //@}
+
     LoaderBase * GetLoader() const { return m_pLoader; }
 
     inline serial::CodingParams const & GetDefCodingParams() const
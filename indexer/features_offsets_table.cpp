@@ -6,6 +6,7 @@
 #include "platform/platform.hpp"
 
 #include "coding/file_container.hpp"
+#include "coding/file_writer.hpp"
 #include "coding/internal/file_data.hpp"
 
 #include "base/assert.hpp"
@@ -64,6 +65,34 @@ namespace feature
     return LoadImpl(filePath);
   }
 
+  // static
+  unique_ptr<FeaturesOffsetsTable> FeaturesOffsetsTable::LoadFromSection(
+      LocalCountryFile const & localFile, FilesContainerR const & cont)
+  {
+    unique_ptr<FeaturesOffsetsTable> table(new FeaturesOffsetsTable());
+
+    char const * data;
+    // Only standalone files can be memory-mapped (not the ones packed into resources).
+    if (!localFile.GetDirectory().empty())
+    {
+      // Mapping outlives the container.
+      FilesMappingContainer mapping(localFile.GetPath(MapOptions::Map));
+      table->m_handle.Assign(mapping.Map(FEATURES_OFFSETS_FILE_TAG));
+      CHECK(table->m_handle.IsValid(), (localFile));
+      data = table->m_handle.GetData<char>();
+    }
+    else
+    {
+      FilesContainerR::ReaderT reader = cont.GetReader(FEATURES_OFFSETS_FILE_TAG);
+      table->m_buffer.resize(static_cast<size_t>(reader.Size()));
+      reader.Read(0, table->m_buffer.data(), table->m_buffer.size());
+      data = table->m_buffer.data();
+    }
+
+    succinct::mapper::map(table->m_table, data);
+    return table;
+  }
+
   // static
   unique_ptr<FeaturesOffsetsTable> FeaturesOffsetsTable::CreateImpl(
       platform::LocalCountryFile const & localFile,
@@ -84,10 +113,32 @@ namespace feature
     return table;
   }
 
+  // static
+  void FeaturesOffsetsTable::AddToContainer(string const & mwmPath)
+  {
+    string const tableFilePath = mwmPath + OFFSET_EXT;
+    {
+      Builder builder;
+      FeaturesVector::ForEachOffset(FilesContainerR(mwmPath).GetReader(DATA_FILE_TAG),
+                                    [&builder](uint32_t offset)
+      {
+        builder.PushOffset(offset);
+      });
+      Build(builder)->Save(tableFilePath);
+    }
+
+    FilesContainerW(mwmPath, FileWriter::OP_WRITE_EXISTING)
+        .Write(tableFilePath, FEATURES_OFFSETS_FILE_TAG);
+    FileWriter::DeleteFileX(tableFilePath);
+  }
+
   // static
   unique_ptr<FeaturesOffsetsTable> FeaturesOffsetsTable::CreateIfNotExistsAndLoad(
       LocalCountryFile const & localFile, FilesContainerR const & cont)
   {
+    if (cont.IsExist(FEATURES_OFFSETS_FILE_TAG))
+      return LoadFromSection(localFile, cont);
+
     string const offsetsFilePath = CountryIndexes::GetPath(localFile, CountryIndexes::Index::Offsets);
 
     if (Platform::IsFileExistsByFullPath(offsetsFilePath))
@@ -100,12 +151,7 @@ namespace feature
   unique_ptr<FeaturesOffsetsTable> FeaturesOffsetsTable::CreateIfNotExistsAndLoad(
       LocalCountryFile const & localFile)
   {
-    string const offsetsFilePath = CountryIndexes::GetPath(localFile, CountryIndexes::Index::Offsets);
-
-    if (Platform::IsFileExistsByFullPath(offsetsFilePath))
-      return LoadImpl(offsetsFilePath);
-
-    return CreateImpl(localFile, FilesContainerR(localFile.GetPath(MapOptions::Map)), offsetsFilePath);
+    return CreateIfNotExistsAndLoad(localFile, FilesContainerR(localFile.GetPath(MapOptions::Map)));
   }
 
   // static
@@ -128,6 +174,33 @@ namespace feature
     return static_cast<uint32_t>(m_table.select(index));
   }
 
+  void FeaturesOffsetsTable::GetFeatureOffsets(uint32_t const * indices, size_t count,
+                                               uint32_t * offsets) const
+  {
+    size_t i = 0;
+    while (i < count)
+    {
+      ASSERT_LESS(indices[i], size(), ("Index out of bounds", indices[i], size()));
+
+      size_t runEnd = i + 1;
+      while (runEnd < count && indices[runEnd] == indices[runEnd - 1] + 1)
+        ++runEnd;
+
+      if (runEnd - i == 1)
+      {
+        offsets[i] = static_cast<uint32_t>(m_table.select(indices[i]));
+      }
+      else
+      {
+        ASSERT_LESS(indices[runEnd - 1], size(), ("Index out of bounds", indices[runEnd - 1]));
+        succinct::elias_fano::select_enumerator it(m_table, indices[i]);
+        for (; i < runEnd; ++i)
+          offsets[i] = static_cast<uint32_t>(it.next());
+      }
+      i = runEnd;
+    }
+  }
+
   size_t FeaturesOffsetsTable::GetFeatureIndexbyOffset(uint32_t offset) const
   {
     ASSERT_GREATER(size(), 0, ("We must not ask empty table"));
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "coding/file_container.hpp"
 #include "coding/mmap_reader.hpp"
 
 #include "defines.hpp"
@@ -12,7 +13,6 @@
 #include "3party/succinct/mapper.hpp"
 
 
-class FilesContainerR;
 namespace platform
 {
   class LocalCountryFile;
@@ -57,7 +57,13 @@ namespace feature
     /// Load table by full path to the table file.
     static unique_ptr<FeaturesOffsetsTable> Load(string const & filePath);
 
+    /// Builds table for the features of the MWM file and stores it in the
+    /// FEATURES_OFFSETS_FILE_TAG section of the same file.
+    static void AddToContainer(string const & mwmPath);
+
     /// Get table for the MWM map, represented by localFile and cont.
+    /// When the MWM has FEATURES_OFFSETS_FILE_TAG section, the table is just
+    /// mapped from it, otherwise it's loaded from (or built to) the offsets file.
     static unique_ptr<FeaturesOffsetsTable> CreateIfNotExistsAndLoad(
         platform::LocalCountryFile const & localFile, FilesContainerR const & cont);
 
@@ -79,6 +85,11 @@ namespace feature
     /// \return offset a feature
     uint32_t GetFeatureOffset(size_t index) const;
 
+    /// Gets offsets of count features with given indices.
+    /// Runs of consecutive indices are decoded sequentially, which is much faster
+    /// than GetFeatureOffset for every index, so sort indices when possible.
+    void GetFeatureOffsets(uint32_t const * indices, size_t count, uint32_t * offsets) const;
+
     /// \param offset offset of a feature
     /// \return index of a feature
     size_t GetFeatureIndexbyOffset(uint32_t offset) const;
@@ -94,14 +105,24 @@ namespace feature
   private:
     FeaturesOffsetsTable(succinct::elias_fano::elias_fano_builder & builder);
     FeaturesOffsetsTable(string const & filePath);
+    FeaturesOffsetsTable() = default;
 
     static unique_ptr<FeaturesOffsetsTable> LoadImpl(string const & filePath);
+    static unique_ptr<FeaturesOffsetsTable> LoadFromSection(
+        platform::LocalCountryFile const & localFile, FilesContainerR const & cont);
     static unique_ptr<FeaturesOffsetsTable> CreateImpl(platform::LocalCountryFile const & localFile,
                                                        FilesContainerR const & cont,
                                                        string const & storePath);
 
     succinct::elias_fano m_table;
 
+    /// Memory of the table: the offsets file, the mapped MWM section or,
+    /// when the MWM can't be mapped (e.g. it's packed into resources), a copy
+    /// of the section.
+    //@{
     unique_ptr<MmapReader> m_pReader;
+    FilesMappingContainer::Handle m_handle;
+    vector<char> m_buffer;
+    //@}
   };
 }  // namespace feature
@@ -2,6 +2,8 @@
 #include "features_offsets_table.hpp"
 #include "data_factory.hpp"
 
+#include "coding/mmap_reader.hpp"
+
 #include "platform/constants.hpp"
 #include "platform/mwm_version.hpp"
 
@@ -15,6 +17,52 @@ void FeaturesVector::GetByIndex(uint32_t index, FeatureType & ft) const
 }
 
 
+SharedFeaturesVector::Context::Context(SharedFeaturesVector const & vector)
+  : m_vector(vector), m_loadInfo(vector.m_cont, vector.m_header)
+{
+}
+
+namespace
+{
+MemVarRecordReader<&VarRecordSizeReaderVarint> CreateMemRecordReader(
+    FilesContainerR::ReaderT const & reader)
+{
+  MmapReader const * mmapReader = dynamic_cast<MmapReader const *>(reader.GetPtr());
+  if (!mmapReader)
+    return MemVarRecordReader<&VarRecordSizeReaderVarint>(nullptr, 0);
+  return MemVarRecordReader<&VarRecordSizeReaderVarint>(
+      reinterpret_cast<char const *>(mmapReader->Data()), mmapReader->Size());
+}
+}  // namespace
+
+SharedFeaturesVector::SharedFeaturesVector(FilesContainerR const & cont,
+                                           feature::DataHeader const & header,
+                                           feature::FeaturesOffsetsTable const * table)
+  : m_cont(cont), m_header(header), m_RecordReader(m_cont.GetReader(DATA_FILE_TAG), 256),
+    m_MemRecordReader(CreateMemRecordReader(m_cont.GetReader(DATA_FILE_TAG))), m_table(table)
+{
+}
+
+void SharedFeaturesVector::GetByIndex(uint32_t index, FeatureType & ft, Context & context) const
+{
+  ASSERT_EQUAL(&context.m_vector, this, ());
+  auto const ftOffset = m_table ? m_table->GetFeatureOffset(index) : index;
+  if (m_MemRecordReader.IsValid())
+  {
+    // Mapped memory is owned by m_cont, so the record outlives the feature.
+    char const * record = nullptr;
+    uint32_t size = 0;
+    m_MemRecordReader.ReadRecord(ftOffset, record, size);
+    ft.Deserialize(context.m_loadInfo.GetLoader(), record);
+    return;
+  }
+
+  uint32_t offset = 0, size = 0;
+  m_RecordReader.ReadRecord(ftOffset, context.m_buffer, offset, size);
+  ft.Deserialize(context.m_loadInfo.GetLoader(), &context.m_buffer[offset]);
+}
+
+
 FeaturesVectorTest::FeaturesVectorTest(string const & filePath)
   : FeaturesVectorTest((FilesContainerR(filePath, READER_CHUNK_LOG_SIZE, READER_CHUNK_LOG_COUNT)))
 {
@@ -4,11 +4,14 @@
 
 #include "coding/var_record_reader.hpp"
 
+#include "defines.hpp"
+
 
 namespace feature { class FeaturesOffsetsTable; }
 
 /// Note! This class is NOT Thread-Safe.
 /// You should have separate instance of Vector for every thread.
+/// Use SharedFeaturesVector to read one mwm from many threads.
 class FeaturesVector
 {
   DISALLOW_COPY(FeaturesVector);
@@ -51,6 +54,54 @@ private:
   feature::FeaturesOffsetsTable const * m_table;
 };
 
+/// Immutable features reader, which can serve GetByIndex from many threads at once.
+/// All mutable decoding state (record buffer and features loader) lives in Context,
+/// which should be created once per thread and reused between calls.
+/// @note Container's reader should be thread-safe (e.g. MmapReader).
+class SharedFeaturesVector
+{
+  DISALLOW_COPY(SharedFeaturesVector);
+
+public:
+  class Context
+  {
+    DISALLOW_COPY(Context);
+
+  public:
+    explicit Context(SharedFeaturesVector const & vector);
+
+    /// Feature is valid until the next GetByIndex call with the same context.
+    inline void GetByIndex(uint32_t index, FeatureType & ft)
+    {
+      m_vector.GetByIndex(index, ft, *this);
+    }
+
+  private:
+    friend class SharedFeaturesVector;
+
+    SharedFeaturesVector const & m_vector;
+    feature::SharedLoadInfo m_loadInfo;
+    vector<char> m_buffer;
+  };
+
+  /// When container's reader is MmapReader, features are deserialized straight
+  /// from the mapped memory without any copying.
+  SharedFeaturesVector(FilesContainerR const & cont, feature::DataHeader const & header,
+                       feature::FeaturesOffsetsTable const * table);
+
+  void GetByIndex(uint32_t index, FeatureType & ft, Context & context) const;
+
+  inline FilesContainerR const & GetContainer() const { return m_cont; }
+  inline feature::DataHeader const & GetHeader() const { return m_header; }
+
+private:
+  FilesContainerR const m_cont;
+  feature::DataHeader const m_header;
+  VarRecordReader<FilesContainerR::ReaderT, &VarRecordSizeReaderVarint> m_RecordReader;
+  MemVarRecordReader<&VarRecordSizeReaderVarint> m_MemRecordReader;
+  feature::FeaturesOffsetsTable const * m_table;
+};
+
 /// Test features vector (reader) that combines all the needed data for stand-alone work.
 /// Used in generator_tool and unit tests.
 class FeaturesVectorTest
@@ -95,13 +95,38 @@ namespace serial
     DecodeImpl(fn, deltas, params, points, reserveF);
   }
 
+  void DecodePolylineBulk(uint64_t const * deltas, size_t count, CodingParams const & params,
+                          m2::PointD * out)
+  {
+    // Mirrors geo_coding::DecodePolylinePrev2, which is used by DecodePolyline.
+    if (count == 0)
+      return;
+
+    m2::PointU const maxPoint = pts::GetMaxPoint(params);
+    uint32_t const coordBits = params.GetCoordBits();
+
+    m2::PointU p2 = DecodeDelta(deltas[0], pts::GetBasePoint(params));
+    out[0] = pts::U2D(p2, coordBits);
+    if (count == 1)
+      return;
+
+    m2::PointU p1 = DecodeDelta(deltas[1], p2);
+    out[1] = pts::U2D(p1, coordBits);
+    for (size_t i = 2; i < count; ++i)
+    {
+      m2::PointU const p = DecodeDelta(deltas[i], PredictPointInPolyline(maxPoint, p1, p2));
+      out[i] = pts::U2D(p, coordBits);
+      p2 = p1;
+      p1 = p;
+    }
+  }
+
   void const * LoadInner(DecodeFunT fn, void const * pBeg, size_t count,
                          CodingParams const & params, OutPointsT & points)
   {
     DeltasT deltas;
-    deltas.reserve(count);
-    void const * ret = ReadVarUint64Array(static_cast<char const *>(pBeg), count,
-                                          MakeBackInsertFunctor(deltas));
+    deltas.resize_no_init(count);
+    void const * ret = ReadVarUint64Batch(pBeg, count, deltas.data());
 
     Decode(fn, deltas, params, points);
     return ret;
@@ -7,9 +7,11 @@
 
 #include "geometry/point2d.hpp"
 
+#include "coding/byte_stream.hpp"
 #include "coding/reader.hpp"
 #include "coding/writer.hpp"
 #include "coding/varint.hpp"
+#include "coding/varint_batch.hpp"
 
 #include "std/algorithm.hpp"
 #include "std/bind.hpp"
@@ -109,8 +111,8 @@ namespace serial
     src.Read(p, count);
 
     DeltasT deltas;
-    deltas.reserve(count / 2);
-    ReadVarUint64Array(p, p + count, MakeBackInsertFunctor(deltas));
+    deltas.resize_no_init(count);
+    deltas.resize(ReadVarUint64Batch(p, p + count, deltas.data()));
 
     Decode(fn, deltas, params, points, reserveF);
   }
@@ -140,6 +142,35 @@ namespace serial
   {
     LoadOuter(&geo_coding::DecodePolyline, src, params, points);
   }
+
+  /// Decodes count polyline deltas (see geo_coding::DecodePolyline) straight to out
+  /// in one loop without intermediate buffers.
+  void DecodePolylineBulk(uint64_t const * deltas, size_t count, CodingParams const & params,
+                          m2::PointD * out);
+
+  /// The same as LoadOuterPath, but reads serialized path from memory (e.g. mapped
+  /// section) and appends points to the caller's arena, which may already hold
+  /// points of other features.
+  /// @return Pointer to the end of the serialized path.
+  template <class TPoints>
+  char const * LoadOuterPathBulk(char const * p, CodingParams const & params, TPoints & points)
+  {
+    ArrayByteSource src(p);
+    uint32_t const size = ReadVarUint<uint32_t>(src);
+    char const * pBeg = src.PtrC();
+
+    if (size == 0)
+      return pBeg;
+
+    DeltasT deltas;
+    deltas.resize_no_init(size);
+    deltas.resize(ReadVarUint64Batch(pBeg, pBeg + size, deltas.data()));
+
+    size_t const offset = points.size();
+    points.resize(offset + deltas.size());
+    DecodePolylineBulk(deltas.data(), deltas.size(), params, points.data() + offset);
+    return pBeg + size;
+  }
   //@}
 
   /// @name Triangles.
@@ -210,5 +241,29 @@ namespace serial
     for (uint32_t i = 0; i < count; ++i)
       LoadOuter(&DecodeTriangles, src, params, triangles, 3);
   }
+
+  /// The same as LoadOuterTriangles, but reads serialized triangles from memory.
+  /// @return Pointer to the end of the serialized triangles.
+  template <class TPoints>
+  char const * LoadOuterTrianglesBulk(char const * p, CodingParams const & params,
+                                      TPoints & triangles)
+  {
+    ArrayByteSource src(p);
+    uint32_t const count = ReadVarUint<uint32_t>(src);
+
+    DeltasT deltas;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      uint32_t const size = ReadVarUint<uint32_t>(src);
+      char const * pBeg = src.PtrC();
+
+      deltas.resize_no_init(size);
+      deltas.resize(ReadVarUint64Batch(pBeg, pBeg + size, deltas.data()));
+      Decode(&DecodeTriangles, deltas, params, triangles, 3);
+
+      src.Advance(size);
+    }
+    return src.PtrC();
+  }
   //@}
 }
@@ -4,6 +4,7 @@
 
 #include "coding/file_name_utils.hpp"
 #include "coding/internal/file_data.hpp"
+#include "coding/mmap_reader.hpp"
 
 #include "base/logging.hpp"
 
@@ -17,7 +18,10 @@ using platform::LocalCountryFile;
 MwmValue::MwmValue(LocalCountryFile const & localFile)
     : m_cont(platform::GetCountryReader(localFile, MapOptions::Map)),
       m_file(localFile),
-      m_table(0)
+      m_table(0),
+      m_searchTrie(0),
+      m_sharedVector(0),
+      m_sharedIndex(0)
 {
   m_factory.Load(m_cont);
 }
@@ -32,6 +36,37 @@ void MwmValue::SetTable(MwmInfoEx & info)
   m_table = info.m_table.get();
 }
 
+void MwmValue::SetSearchTrie(MwmInfoEx & info)
+{
+  // Only standalone files can be memory-mapped (not the ones packed into resources).
+  if (m_file.GetDirectory().empty() || !m_cont.IsExist(SUCCINCT_SEARCH_INDEX_FILE_TAG))
+    return;
+
+  if (!info.m_searchTrie)
+  {
+    serial::CodingParams const cp(trie::GetCodingParams(GetHeader().GetDefCodingParams()));
+    info.m_searchTrie.reset(
+        new trie::MappedSearchTrie(FilesMappingContainer(m_file.GetPath(MapOptions::Map)), cp));
+  }
+  m_searchTrie = info.m_searchTrie.get();
+}
+
+void MwmValue::SetSharedReaders(MwmInfoEx & info)
+{
+  // Only standalone files can be memory-mapped (not the ones packed into resources).
+  if (m_file.GetDirectory().empty())
+    return;
+
+  if (!info.m_sharedVector)
+  {
+    FilesContainerR const cont(new MmapReader(m_file.GetPath(MapOptions::Map)));
+    info.m_sharedVector.reset(new SharedFeaturesVector(cont, GetHeader(), m_table));
+    info.m_sharedIndex.reset(new ScaleIndex<ModelReaderPtr>(cont.GetReader(INDEX_FILE_TAG), m_factory));
+  }
+  m_sharedVector = info.m_sharedVector.get();
+  m_sharedIndex = info.m_sharedIndex.get();
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 // Index implementation
 //////////////////////////////////////////////////////////////////////////////////
@@ -58,7 +93,14 @@ unique_ptr<MwmInfo> Index::CreateInfo(platform::LocalCountryFile const & localFi
 unique_ptr<MwmSet::MwmValueBase> Index::CreateValue(MwmInfo & info) const
 {
   unique_ptr<MwmValue> p(new MwmValue(info.GetLocalFile()));
-  p->SetTable(dynamic_cast<MwmInfoEx &>(info));
+  MwmInfoEx & infoEx = dynamic_cast<MwmInfoEx &>(info);
+  {
+    lock_guard<mutex> lock(infoEx.m_lock);
+    p->SetTable(infoEx);
+    p->SetSearchTrie(infoEx);
+    if (m_concurrentAccess)
+      p->SetSharedReaders(infoEx);
+  }
   ASSERT(p->GetHeader().IsMWMSuitable(), ());
   return unique_ptr<MwmSet::MwmValueBase>(move(p));
 }
@@ -112,3 +154,22 @@ void Index::FeaturesLoaderGuard::GetFeatureByIndex(uint32_t index, FeatureType &
   m_vector.GetByIndex(index, ft);
   ft.SetID(FeatureID(m_handle.GetId(), index));
 }
+
+//////////////////////////////////////////////////////////////////////////////////
+// Index::SharedFeaturesLoaderGuard implementation
+//////////////////////////////////////////////////////////////////////////////////
+
+Index::SharedFeaturesLoaderGuard::SharedFeaturesLoaderGuard(Index const & parent, MwmId id)
+    : m_handle(parent.GetMwmHandleById(id))
+{
+  MwmValue const * pValue = m_handle.GetValue<MwmValue>();
+  if (pValue && pValue->m_sharedVector)
+    m_context.reset(new SharedFeaturesVector::Context(*pValue->m_sharedVector));
+}
+
+void Index::SharedFeaturesLoaderGuard::GetFeatureByIndex(uint32_t index, FeatureType & ft)
+{
+  ASSERT(IsValid(), ());
+  m_context->GetByIndex(index, ft);
+  ft.SetID(FeatureID(m_handle.GetId(), index));
+}
@@ -6,6 +6,7 @@
 #include "indexer/features_vector.hpp"
 #include "indexer/mwm_set.hpp"
 #include "indexer/scale_index.hpp"
+#include "indexer/search_trie.hpp"
 #include "indexer/unique_index.hpp"
 
 #include "coding/file_container.hpp"
@@ -24,7 +25,21 @@
 class MwmInfoEx : public MwmInfo
 {
 public:
+  /// Guards lazy initialization of the fields below, because values
+  /// are created concurrently without MwmSet registry lock.
+  mutex m_lock;
+
   unique_ptr<feature::FeaturesOffsetsTable> m_table;
+
+  /// Memory-mapped succinct search index, when the mwm has it.
+  unique_ptr<trie::MappedSearchTrie> m_searchTrie;
+
+  /// @name Immutable readers shared between all threads in concurrent access mode.
+  /// See Index::SetConcurrentAccess.
+  //@{
+  unique_ptr<SharedFeaturesVector> m_sharedVector;
+  unique_ptr<ScaleIndex<ModelReaderPtr>> m_sharedIndex;
+  //@}
 };
 
 class MwmValue : public MwmSet::MwmValueBase
@@ -35,8 +50,17 @@ public:
   platform::LocalCountryFile const m_file;
   feature::FeaturesOffsetsTable const * m_table;
 
+  /// Not null only for standalone mwm files with succinct search index.
+  trie::MappedSearchTrie const * m_searchTrie;
+
+  /// Not null only in concurrent access mode.
+  SharedFeaturesVector const * m_sharedVector;
+  ScaleIndex<ModelReaderPtr> const * m_sharedIndex;
+
   explicit MwmValue(platform::LocalCountryFile const & localFile);
   void SetTable(MwmInfoEx & info);
+  void SetSearchTrie(MwmInfoEx & info);
+  void SetSharedReaders(MwmInfoEx & info);
 
   inline feature::DataHeader const & GetHeader() const { return m_factory.GetHeader(); }
   inline version::MwmVersion const & GetMwmVersion() const { return m_factory.GetMwmVersion(); }
@@ -87,11 +111,43 @@ public:
 
   bool RemoveObserver(Observer const & observer);
 
+  /// Enables concurrent access mode: every mwm, which lives in a separate file,
+  /// is memory-mapped once and its features vector and scale index are shared
+  /// between all threads, so reading functions don't create them on every call.
+  /// Features are deserialized straight from the mapping, without reader caches
+  /// and copies, and the page cache is shared between processes.
+  /// @precondition Should be called before any map is registered.
+  void SetConcurrentAccess(bool enable) { m_concurrentAccess = enable; }
+  bool IsConcurrentAccess() const { return m_concurrentAccess; }
+
 private:
 
   template <typename F> class ReadMWMFunctor
   {
     F & m_f;
+
+    template <class TFeaturesReader>
+    void ReadFeatures(TFeaturesReader & fv, ScaleIndex<ModelReaderPtr> const & index,
+                      covering::IntervalsT const & interval, uint32_t scale,
+                      CheckUniqueIndexes & checkUnique, MwmId const & mwmID) const
+    {
+      for (auto const & i : interval)
+      {
+        index.ForEachInIntervalAndScale([&] (uint32_t index)
+        {
+          if (checkUnique(index))
+          {
+            FeatureType feature;
+
+            fv.GetByIndex(index, feature);
+            feature.SetID(FeatureID(mwmID, index));
+
+            m_f(feature);
+          }
+        }, i.first, i.second, scale);
+      }
+    }
+
   public:
     ReadMWMFunctor(F & f) : m_f(f) {}
 
@@ -111,29 +167,98 @@ private:
         // Use last coding scale for covering (see index_builder.cpp).
         covering::IntervalsT const & interval = cov.Get(lastScale);
 
-        // prepare features reading
-        FeaturesVector fv(pValue->m_cont, header, pValue->m_table);
-        ScaleIndex<ModelReaderPtr> index(pValue->m_cont.GetReader(INDEX_FILE_TAG),
-                                         pValue->m_factory);
-
         // iterate through intervals
         CheckUniqueIndexes checkUnique(header.GetFormat() >= version::v5);
         MwmId const mwmID = handle.GetId();
 
-        for (auto const & i : interval)
+        if (pValue->m_sharedVector)
         {
-          index.ForEachInIntervalAndScale([&] (uint32_t index)
-          {
-            if (checkUnique(index))
-            {
-              FeatureType feature;
+          SharedFeaturesVector::Context fv(*pValue->m_sharedVector);
+          ReadFeatures(fv, *pValue->m_sharedIndex, interval, scale, checkUnique, mwmID);
+        }
+        else
+        {
+          // prepare features reading
+          FeaturesVector fv(pValue->m_cont, header, pValue->m_table);
+          ScaleIndex<ModelReaderPtr> index(pValue->m_cont.GetReader(INDEX_FILE_TAG),
+                                           pValue->m_factory);
+          ReadFeatures(fv, index, interval, scale, checkUnique, mwmID);
+        }
+      }
+    }
+  };
+
+  /// Reads features of an mwm in one forward sweep over the DAT section:
+  /// feature indexes are collected from all intervals first, then
+  /// deduplicated and sorted. Offsets grow with indexes (and indexes are
+  /// offsets themselves for old formats), so sorting by index is sorting
+  /// by file offset.
+  template <typename F> class ReadMWMBatchedFunctor
+  {
+    F & m_f;
+
+    template <class TFeaturesReader>
+    void ReadFeatures(TFeaturesReader & fv, vector<uint32_t> const & indexes,
+                      MwmId const & mwmID) const
+    {
+      for (uint32_t const index : indexes)
+      {
+        FeatureType feature;
 
-              fv.GetByIndex(index, feature);
-              feature.SetID(FeatureID(mwmID, index));
+        fv.GetByIndex(index, feature);
+        feature.SetID(FeatureID(mwmID, index));
 
-              m_f(feature);
-            }
-          }, i.first, i.second, scale);
+        m_f(feature);
+      }
+    }
+
+  public:
+    ReadMWMBatchedFunctor(F & f) : m_f(f) {}
+
+    void operator()(MwmHandle const & handle, covering::CoveringGetter & cov, uint32_t scale) const
+    {
+      MwmValue const * pValue = handle.GetValue<MwmValue>();
+      if (pValue)
+      {
+        feature::DataHeader const & header = pValue->GetHeader();
+
+        // Prepare needed covering.
+        uint32_t const lastScale = header.GetLastScale();
+
+        // In case of WorldCoasts we should pass correct scale in ForEachInIntervalAndScale.
+        if (scale > lastScale) scale = lastScale;
+
+        // Use last coding scale for covering (see index_builder.cpp).
+        covering::IntervalsT const & interval = cov.Get(lastScale);
+
+        vector<uint32_t> indexes;
+        auto const collectIndex = [&indexes] (uint32_t index) { indexes.push_back(index); };
+        if (pValue->m_sharedIndex)
+        {
+          for (auto const & i : interval)
+            pValue->m_sharedIndex->ForEachInIntervalAndScale(collectIndex, i.first, i.second, scale);
+        }
+        else
+        {
+          ScaleIndex<ModelReaderPtr> index(pValue->m_cont.GetReader(INDEX_FILE_TAG),
+                                           pValue->m_factory);
+          for (auto const & i : interval)
+            index.ForEachInIntervalAndScale(collectIndex, i.first, i.second, scale);
+        }
+
+        sort(indexes.begin(), indexes.end());
+        indexes.erase(unique(indexes.begin(), indexes.end()), indexes.end());
+
+        MwmId const mwmID = handle.GetId();
+        if (pValue->m_sharedVector)
+        {
+          SharedFeaturesVector::Context fv(*pValue->m_sharedVector);
+          ReadFeatures(fv, indexes, mwmID);
+        }
+        else
+        {
+          FeaturesVector fv(pValue->m_cont, header, pValue->m_table);
+          ReadFeatures(fv, indexes, mwmID);
         }
       }
     }
@@ -160,8 +285,14 @@ private:
 
         // Use last coding scale for covering (see index_builder.cpp).
         covering::IntervalsT const & interval = cov.Get(lastScale);
-        ScaleIndex<ModelReaderPtr> index(pValue->m_cont.GetReader(INDEX_FILE_TAG),
-                                         pValue->m_factory);
+        unique_ptr<ScaleIndex<ModelReaderPtr>> localIndex;
+        if (!pValue->m_sharedIndex)
+        {
+          localIndex.reset(new ScaleIndex<ModelReaderPtr>(pValue->m_cont.GetReader(INDEX_FILE_TAG),
+                                                          pValue->m_factory));
+        }
+        ScaleIndex<ModelReaderPtr> const & index =
+            localIndex ? *localIndex : *pValue->m_sharedIndex;
 
         // iterate through intervals
         CheckUniqueIndexes checkUnique(header.GetFormat() >= version::v5);
@@ -188,6 +319,16 @@ public:
     ForEachInIntervals(implFunctor, covering::ViewportWithLowLevels, rect, scale);
   }
 
+  /// Same as ForEachInRect, but features of every mwm are read in the order of
+  /// their offsets in the DAT section, which is much more friendly to disk and page cache.
+  /// @note Features order inside an mwm differs from ForEachInRect.
+  template <typename F>
+  void ForEachInRectBatched(F & f, m2::RectD const & rect, uint32_t scale) const
+  {
+    ReadMWMBatchedFunctor<F> implFunctor(f);
+    ForEachInIntervals(implFunctor, covering::ViewportWithLowLevels, rect, scale);
+  }
+
   template <typename F>
   void ForEachInRect_TileDrawing(F & f, m2::RectD const & rect, uint32_t scale) const
   {
@@ -234,6 +375,24 @@ public:
     FeaturesVector m_vector;
   };
 
+  /// Guard for loading features from particular MWM by demand in concurrent access mode.
+  /// Many guards for the same MWM share one SharedFeaturesVector and own only decoding buffers,
+  /// so create one guard per thread.
+  class SharedFeaturesLoaderGuard
+  {
+  public:
+    SharedFeaturesLoaderGuard(Index const & parent, MwmId id);
+
+    inline MwmSet::MwmId GetId() const { return m_handle.GetId(); }
+    /// @return False if mwm is not loaded or concurrent access mode is disabled.
+    inline bool IsValid() const { return m_context != nullptr; }
+    void GetFeatureByIndex(uint32_t index, FeatureType & ft);
+
+  private:
+    MwmHandle m_handle;
+    unique_ptr<SharedFeaturesVector::Context> m_context;
+  };
+
   template <typename F>
   void ForEachInRectForMWM(F & f, m2::RectD const & rect, uint32_t scale, MwmId const id) const
   {
@@ -259,17 +418,15 @@ private:
     MwmValue const * pValue = handle.GetValue<MwmValue>();
     if (pValue)
     {
-      FeaturesVector featureReader(pValue->m_cont, pValue->GetHeader(), pValue->m_table);
-      while (result < features.size() && id == features[result].m_mwmId)
+      if (pValue->m_sharedVector)
       {
-        FeatureID const & featureId = features[result];
-        FeatureType featureType;
-
-        featureReader.GetByIndex(featureId.m_index, featureType);
-        featureType.SetID(featureId);
-
-        f(featureType);
-        ++result;
+        SharedFeaturesVector::Context featureReader(*pValue->m_sharedVector);
+        result = ReadFeatureRangeImpl(f, featureReader, features, result);
+      }
+      else
+      {
+        FeaturesVector featureReader(pValue->m_cont, pValue->GetHeader(), pValue->m_table);
+        result = ReadFeatureRangeImpl(f, featureReader, features, result);
       }
     }
     else
@@ -285,6 +442,25 @@ private:
     return result;
   }
 
+  template <typename F, class TFeaturesReader>
+  static size_t ReadFeatureRangeImpl(F & f, TFeaturesReader & featureReader,
+                                     vector<FeatureID> const & features, size_t index)
+  {
+    MwmId const & id = features[index].m_mwmId;
+    while (index < features.size() && id == features[index].m_mwmId)
+    {
+      FeatureID const & featureId = features[index];
+      FeatureType featureType;
+
+      featureReader.GetByIndex(featureId.m_index, featureType);
+      featureType.SetID(featureId);
+
+      f(featureType);
+      ++index;
+    }
+    return index;
+  }
+
   template <typename F>
   void ForEachInIntervals(F & f, covering::CoveringMode mode, m2::RectD const & rect,
                           uint32_t scale) const
@@ -336,4 +512,6 @@ private:
   }
 
   my::ObserverList<Observer> m_observers;
+
+  bool m_concurrentAccess = false;
 };
@@ -1,4 +1,5 @@
 #include "indexer/index_builder.hpp"
+#include "indexer/features_offsets_table.hpp"
 #include "indexer/features_vector.hpp"
 
 #include "defines.hpp"
@@ -22,6 +23,8 @@ namespace indexer
 
       FilesContainerW(datFile, FileWriter::OP_WRITE_EXISTING).Write(idxFileName, INDEX_FILE_TAG);
       FileWriter::DeleteFileX(idxFileName);
+
+      feature::FeaturesOffsetsTable::AddToContainer(datFile);
     }
     catch (Reader::Exception const & e)
     {
@@ -9,12 +9,14 @@
 
 #include "coding/file_container.hpp"
 
+#include "base/macros.hpp"
 #include "base/scope_guard.hpp"
 
 #include "defines.hpp"
 
 #include "std/bind.hpp"
 #include "std/string.hpp"
+#include "std/vector.hpp"
 
 
 using namespace platform;
@@ -62,6 +64,12 @@ namespace feature
     TEST_EQUAL(static_cast<size_t>(5), table->GetFeatureIndexbyOffset(510), ());
     TEST_EQUAL(static_cast<size_t>(6), table->GetFeatureIndexbyOffset(513), ());
     TEST_EQUAL(static_cast<size_t>(7), table->GetFeatureIndexbyOffset(1024), ());
+
+    uint32_t const indices[] = {0, 1, 2, 5, 3, 4, 5, 6, 7, 7};
+    uint32_t offsets[ARRAY_SIZE(indices)];
+    table->GetFeatureOffsets(indices, ARRAY_SIZE(indices), offsets);
+    for (size_t i = 0; i < ARRAY_SIZE(indices); ++i)
+      TEST_EQUAL(table->GetFeatureOffset(indices[i]), offsets[i], (i));
   }
 
   UNIT_TEST(FeaturesOffsetsTable_CreateIfNotExistsAndLoad)
@@ -140,4 +148,58 @@ namespace feature
         TEST_EQUAL(table->GetFeatureOffset(i), loadedTable->GetFeatureOffset(i), ());
     }
   }
+
+  UNIT_TEST(FeaturesOffsetsTable_Section)
+  {
+    string const testFileName = "test_file_section";
+    Platform & pl = GetPlatform();
+
+    LocalCountryFile localFile = LocalCountryFile::MakeForTesting(testFileName);
+    string const indexFile = CountryIndexes::GetPath(localFile, CountryIndexes::Index::Offsets);
+    FileWriter::DeleteFileX(indexFile);
+
+    string const testFile = pl.WritablePathForFile(testFileName + DATA_FILE_EXTENSION);
+    MY_SCOPE_GUARD(deleteTestFileGuard, bind(&FileWriter::DeleteFileX, cref(testFile)));
+    {
+      FilesContainerR baseContainer(pl.GetReader("minsk-pass" DATA_FILE_EXTENSION));
+      FilesContainerW testContainer(testFile);
+      baseContainer.ForEachTag([&baseContainer, &testContainer](string const & tag)
+      {
+        if (tag != FEATURES_OFFSETS_FILE_TAG)
+          testContainer.Write(baseContainer.GetReader(tag), tag);
+      });
+    }
+
+    FeaturesOffsetsTable::Builder builder;
+    FeaturesVector::ForEachOffset(FilesContainerR(testFile).GetReader(DATA_FILE_TAG),
+                                  [&builder](uint32_t offset)
+    {
+      builder.PushOffset(offset);
+    });
+    unique_ptr<FeaturesOffsetsTable> expected(FeaturesOffsetsTable::Build(builder));
+
+    FeaturesOffsetsTable::AddToContainer(testFile);
+
+    unique_ptr<FeaturesOffsetsTable> table;
+    {
+      FilesContainerR cont(testFile);
+      TEST(cont.IsExist(FEATURES_OFFSETS_FILE_TAG), ());
+      table = FeaturesOffsetsTable::CreateIfNotExistsAndLoad(localFile, cont);
+    }
+    TEST(table.get(), ());
+    // The table is taken from the section without any offsets file.
+    TEST(!pl.IsFileExistsByFullPath(indexFile), ());
+
+    TEST_EQUAL(expected->size(), table->size(), ());
+    vector<uint32_t> indices(table->size());
+    vector<uint32_t> offsets(table->size());
+    for (uint32_t i = 0; i < indices.size(); ++i)
+      indices[i] = i;
+    table->GetFeatureOffsets(indices.data(), indices.size(), offsets.data());
+    for (uint32_t i = 0; i < indices.size(); ++i)
+    {
+      TEST_EQUAL(expected->GetFeatureOffset(i), table->GetFeatureOffset(i), ());
+      TEST_EQUAL(expected->GetFeatureOffset(i), offsets[i], ());
+    }
+  }
 }  // namespace feature
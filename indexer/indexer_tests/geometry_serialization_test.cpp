@@ -67,3 +67,31 @@ UNIT_TEST(SaveLoadPolyline_DataSet1)
 
   TEST(is_equal(r1, r2), (r1, r2));
 }
+
+UNIT_TEST(LoadOuterPathBulk_DataSet1)
+{
+  using namespace index_test;
+
+  vector<m2::PointD> data1(arr1, arr1 + ARRAY_SIZE(arr1));
+
+  vector<char> buffer;
+  PushBackByteSink<vector<char> > w(buffer);
+
+  serial::CodingParams cp;
+  serial::SaveOuterPath(data1, cp, w);
+  serial::SaveOuterPath(data1, cp, w);
+
+  vector<m2::PointD> expected;
+  ArrayByteSource r(&buffer[0]);
+  serial::LoadOuterPath(r, cp, expected);
+
+  // Arena holds points of both paths one after another.
+  vector<m2::PointD> arena;
+  char const * p = serial::LoadOuterPathBulk(&buffer[0], cp, arena);
+  TEST_EQUAL(p, r.PtrC(), ());
+  TEST_EQUAL(serial::LoadOuterPathBulk(p, cp, arena), &buffer[0] + buffer.size(), ());
+
+  TEST_EQUAL(arena.size(), 2 * expected.size(), ());
+  for (size_t i = 0; i < arena.size(); ++i)
+    TEST_EQUAL(arena[i], expected[i % expected.size()], (i));
+}
@@ -1,10 +1,15 @@
 #include "testing/testing.hpp"
 
+#include "indexer/classificator_loader.hpp"
 #include "indexer/data_header.hpp"
+#include "indexer/feature_algo.hpp"
+#include "indexer/features_offsets_table.hpp"
+#include "indexer/features_vector.hpp"
 #include "indexer/index.hpp"
 
 #include "coding/file_name_utils.hpp"
 #include "coding/internal/file_data.hpp"
+#include "coding/mmap_reader.hpp"
 
 #include "platform/country_file.hpp"
 #include "platform/local_country_file.hpp"
@@ -15,8 +20,12 @@
 #include "base/scope_guard.hpp"
 #include "base/stl_add.hpp"
 
+#include "std/algorithm.hpp"
 #include "std/bind.hpp"
 #include "std/string.hpp"
+#include "std/thread.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
 
 using platform::CountryFile;
 using platform::LocalCountryFile;
@@ -86,6 +95,143 @@ UNIT_TEST(Index_Parse)
   index.ForEachInScale(fn, 15);
 }
 
+namespace
+{
+class FeaturesCollector
+{
+public:
+  void operator()(FeatureType const & ft)
+  {
+    m_ids.push_back(ft.GetID());
+    m_centers.push_back(feature::GetCenter(ft, FeatureType::BEST_GEOMETRY));
+  }
+
+  vector<FeatureID> m_ids;
+  vector<m2::PointD> m_centers;
+};
+}  // namespace
+
+UNIT_TEST(Index_ConcurrentAccess)
+{
+  classificator::Load();
+
+  LocalCountryFile const localFile = LocalCountryFile::MakeForTesting("minsk-pass");
+  uint32_t const scale = 15;
+
+  Index index;
+  UNUSED_VALUE(index.RegisterMap(localFile));
+  FeaturesCollector expected;
+  index.ForEachInScale(expected, scale);
+  TEST(!expected.m_ids.empty(), ());
+
+  Index sharedIndex;
+  sharedIndex.SetConcurrentAccess(true);
+  auto const p = sharedIndex.RegisterMap(localFile);
+  TEST(p.first.IsAlive(), ());
+
+  size_t const kThreadsCount = 4;
+  vector<FeaturesCollector> collectors(kThreadsCount);
+  vector<thread> threads;
+  for (size_t i = 0; i < kThreadsCount; ++i)
+  {
+    threads.emplace_back([&sharedIndex, &collectors, i, scale]()
+    {
+      sharedIndex.ForEachInScale(collectors[i], scale);
+    });
+  }
+  for (auto & t : threads)
+    t.join();
+
+  for (auto const & collector : collectors)
+  {
+    TEST_EQUAL(expected.m_ids.size(), collector.m_ids.size(), ());
+    for (size_t i = 0; i < expected.m_ids.size(); ++i)
+    {
+      TEST_EQUAL(expected.m_ids[i].m_index, collector.m_ids[i].m_index, ());
+      TEST(m2::AlmostEqualULPs(expected.m_centers[i], collector.m_centers[i]), (i));
+    }
+  }
+
+  Index::SharedFeaturesLoaderGuard guard(sharedIndex, p.first);
+  TEST(guard.IsValid(), ());
+  FeatureType ft;
+  guard.GetFeatureByIndex(expected.m_ids.front().m_index, ft);
+  TEST(m2::AlmostEqualULPs(expected.m_centers.front(),
+                           feature::GetCenter(ft, FeatureType::BEST_GEOMETRY)), ());
+}
+
+UNIT_TEST(Index_MappedGeometryEqualsRead)
+{
+  classificator::Load();
+
+  string const path = GetPlatform().WritableDir() + "minsk-pass" DATA_FILE_EXTENSION;
+  FeaturesVectorTest features(path);
+
+  FilesContainerR const mapped(new MmapReader(path));
+  unique_ptr<feature::FeaturesOffsetsTable> table =
+      feature::FeaturesOffsetsTable::CreateIfNotExistsAndLoad(mapped);
+  SharedFeaturesVector const sharedFeatures(mapped, features.GetHeader(), table.get());
+  SharedFeaturesVector::Context context(sharedFeatures);
+
+  auto const addTo = [](vector<m2::PointD> & v)
+  {
+    return [&v](m2::PointD const & p1, m2::PointD const & p2, m2::PointD const & p3)
+    {
+      v.push_back(p1);
+      v.push_back(p2);
+      v.push_back(p3);
+    };
+  };
+
+  size_t pointsCount = 0;
+  size_t trianglesCount = 0;
+  for (int scale : {static_cast<int>(FeatureType::BEST_GEOMETRY), 15, 10, 5})
+  {
+    features.GetVector().ForEach([&](FeatureType const & expected, uint32_t index)
+    {
+      FeatureType ft;
+      context.GetByIndex(index, ft);
+
+      vector<m2::PointD> expectedPoints, points;
+      expected.ForEachPoint(MakeBackInsertFunctor(expectedPoints), scale);
+      ft.ForEachPoint(MakeBackInsertFunctor(points), scale);
+      TEST_EQUAL(expectedPoints, points, (index, scale));
+      pointsCount += points.size();
+
+      vector<m2::PointD> expectedTriangles, triangles;
+      expected.ForEachTriangle(addTo(expectedTriangles), scale);
+      ft.ForEachTriangle(addTo(triangles), scale);
+      TEST_EQUAL(expectedTriangles, triangles, (index, scale));
+      trianglesCount += triangles.size();
+    });
+  }
+  TEST_GREATER(pointsCount, 0, ());
+  TEST_GREATER(trianglesCount, 0, ());
+}
+
+UNIT_TEST(Index_ForEachInRectBatched)
+{
+  classificator::Load();
+
+  Index index;
+  UNUSED_VALUE(index.RegisterMap(LocalCountryFile::MakeForTesting("minsk-pass")));
+
+  m2::RectD const rect = m2::RectD::GetInfiniteRect();
+  uint32_t const scale = 17;
+
+  FeaturesCollector expected;
+  index.ForEachInRect(expected, rect, scale);
+  FeaturesCollector batched;
+  index.ForEachInRectBatched(batched, rect, scale);
+
+  TEST(!batched.m_ids.empty(), ());
+  TEST(is_sorted(batched.m_ids.begin(), batched.m_ids.end()), ());
+  TEST(adjacent_find(batched.m_ids.begin(), batched.m_ids.end()) == batched.m_ids.end(), ());
+
+  sort(expected.m_ids.begin(), expected.m_ids.end());
+  TEST_EQUAL(expected.m_ids, batched.m_ids, ());
+}
+
 UNIT_TEST(Index_MwmStatusNotifications)
 {
   Platform & platform = GetPlatform();
@@ -41,6 +41,7 @@ SOURCES += \
     scales_test.cpp \
     search_string_utils_test.cpp \
     sort_and_merge_intervals_test.cpp \
+    string_file_test.cpp \
     test_polylines.cpp \
     test_type.cpp \
     visibility_test.cpp \
@@ -1,10 +1,15 @@
 #include "testing/testing.hpp"
 #include "indexer/interval_index.hpp"
 #include "indexer/interval_index_builder.hpp"
+#include "coding/file_writer.hpp"
+#include "coding/mmap_reader.hpp"
 #include "coding/reader.hpp"
 #include "coding/writer.hpp"
 #include "base/macros.hpp"
+#include "base/scope_guard.hpp"
 #include "base/stl_add.hpp"
+#include "std/bind.hpp"
+#include "std/string.hpp"
 #include "std/utility.hpp"
 #include "std/vector.hpp"
 
@@ -103,7 +108,8 @@ UNIT_TEST(IntervalIndex_Serialized)
   data.push_back(CellIdFeaturePairForTest(0x1637U, 2));
   vector<uint8_t> serialIndex;
   MemWriter<vector<uint8_t> > writer(serialIndex);
-  IntervalIndexBuilder(16, 1, 4).BuildIndex(writer, data.begin(), data.end());
+  IntervalIndexBuilder(16, 1, 4, IntervalIndexBase::kVersionV1)
+      .BuildIndex(writer, data.begin(), data.end());
 
   char const expSerial [] =
       "\x01\x02\x04\x01"               // Header
@@ -127,6 +133,97 @@ UNIT_TEST(IntervalIndex_Serialized)
   TEST_EQUAL(values, vector<uint32_t>(expected, expected + ARRAY_SIZE(expected)), ());
 }
 
+UNIT_TEST(IntervalIndex_SerializedSubtrees)
+{
+  vector<CellIdFeaturePairForTest> data;
+  data.push_back(CellIdFeaturePairForTest(0x1537U, 0));
+  data.push_back(CellIdFeaturePairForTest(0x1538U, 1));
+  data.push_back(CellIdFeaturePairForTest(0x1637U, 2));
+  vector<uint8_t> serialIndex;
+  MemWriter<vector<uint8_t> > writer(serialIndex);
+  IntervalIndexBuilder(16, 1, 4).BuildIndex(writer, data.begin(), data.end());
+
+  char const expSerial [] =
+      "\x02\x02\x04\x01"               // Header
+      "\x10\x00\x00\x00"               // Root subtree size
+      "\x03" "\x00\x01\x0C"             // Root
+      "\x05" "\x01\x60\x00\x04\x02"     // 0x15, 0x16 node
+      "\x37\x00" "\x38\x02" "\x37\x04" // 0x1537 0x1538 0x1637
+      "";
+
+  TEST_EQUAL(serialIndex, vector<uint8_t>(expSerial, expSerial + ARRAY_SIZE(expSerial) - 1), ());
+
+  MemReader reader(&serialIndex[0], serialIndex.size());
+  IntervalIndex<MemReader> index(reader);
+  uint32_t expected [] = {0, 1, 2};
+  vector<uint32_t> values;
+  TEST_EQUAL(index.KeyEnd(), 0x10000, ());
+  index.ForEach(MakeBackInsertFunctor(values), 0, 0x10000);
+  TEST_EQUAL(values, vector<uint32_t>(expected, expected + ARRAY_SIZE(expected)), ());
+}
+
+UNIT_TEST(IntervalIndex_Versions)
+{
+  vector<CellIdFeaturePairForTest> data;
+  uint64_t cell = 1;
+  for (uint32_t i = 0; i < 20000; ++i)
+  {
+    // Dense and sparse runs of cells.
+    cell += (i % 7 == 0 ? 0 : (i % 1000 < 500 ? 3 : 0x1234567));
+    data.push_back(CellIdFeaturePairForTest(cell, i));
+  }
+  uint64_t const keyEnd = 1ULL << 40;
+  CHECK_LESS(cell, keyEnd, ());
+
+  vector<char> serialV1, serialV2;
+  {
+    MemWriter<vector<char> > writer(serialV1);
+    BuildIntervalIndex(data.begin(), data.end(), writer, 40, IntervalIndexBase::kVersionV1);
+  }
+  {
+    MemWriter<vector<char> > writer(serialV2);
+    BuildIntervalIndex(data.begin(), data.end(), writer, 40);
+  }
+
+  string const fileName = "interval_index_test.tmp";
+  {
+    FileWriter writer(fileName);
+    writer.Write(serialV2.data(), serialV2.size());
+  }
+  MY_SCOPE_GUARD(deleteFileGuard, bind(&FileWriter::DeleteFileX, cref(fileName)));
+
+  MemReader readerV1(serialV1.data(), serialV1.size());
+  MemReader readerV2(serialV2.data(), serialV2.size());
+  IntervalIndex<MemReader> indexV1(readerV1);
+  IntervalIndex<MemReader> indexV2(readerV2);
+  // Reads nodes in place.
+  IntervalIndex<ModelReaderPtr> indexMapped(ModelReaderPtr(new MmapReader(fileName)));
+
+  uint64_t const kBounds[][2] = {{0, keyEnd},
+                                 {1, 2},
+                                 {data[100].GetCell(), data[5000].GetCell()},
+                                 {data[700].GetCell() + 1, data[19000].GetCell() + 1},
+                                 {data[12345].GetCell(), data[12345].GetCell() + 1},
+                                 {data.back().GetCell(), keyEnd}};
+  for (auto const & bounds : kBounds)
+  {
+    vector<uint32_t> expected;
+    for (auto const & p : data)
+    {
+      if (p.GetCell() >= bounds[0] && p.GetCell() < bounds[1])
+        expected.push_back(p.GetFeature());
+    }
+
+    vector<uint32_t> values1, values2, valuesMapped;
+    indexV1.ForEach(MakeBackInsertFunctor(values1), bounds[0], bounds[1]);
+    indexV2.ForEach(MakeBackInsertFunctor(values2), bounds[0], bounds[1]);
+    indexMapped.ForEach(MakeBackInsertFunctor(valuesMapped), bounds[0], bounds[1]);
+    TEST_EQUAL(values1, expected, (bounds[0], bounds[1]));
+    TEST_EQUAL(values2, expected, (bounds[0], bounds[1]));
+    TEST_EQUAL(valuesMapped, expected, (bounds[0], bounds[1]));
+  }
+}
+
 UNIT_TEST(IntervalIndex_Simple)
 {
   vector<CellIdFeaturePairForTest> data;
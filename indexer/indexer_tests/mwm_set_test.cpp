@@ -7,7 +7,9 @@
 #include "base/macros.hpp"
 
 #include "std/initializer_list.hpp"
+#include "std/thread.hpp"
 #include "std/unordered_map.hpp"
+#include "std/vector.hpp"
 
 using platform::CountryFile;
 using platform::LocalCountryFile;
@@ -157,3 +159,52 @@ UNIT_TEST(MwmSetLockAndIdTest)
   TEST(!handle.GetId().IsAlive(), ());
   TEST(!handle.GetId().GetInfo().get(), ());
 }
+
+UNIT_TEST(MwmSetConcurrentHandlesTest)
+{
+  TestMwmSet mwmSet(4 /* cacheSize */, 2 /* cacheShardsCount */);
+  vector<MwmSet::MwmId> ids;
+  for (auto const & name : {"0", "1", "2"})
+  {
+    auto const p = mwmSet.Register(LocalCountryFile::MakeForTesting(name));
+    TEST_EQUAL(MwmSet::RegResult::Success, p.second, (name));
+    ids.push_back(p.first);
+  }
+
+  size_t const kThreadsCount = 8;
+  size_t const kIterationsCount = 1000;
+  vector<size_t> failures(kThreadsCount, 0);
+  vector<thread> threads;
+  for (size_t i = 0; i < kThreadsCount; ++i)
+  {
+    threads.emplace_back([&mwmSet, &ids, &failures, i, kIterationsCount]()
+    {
+      for (size_t j = 0; j < kIterationsCount; ++j)
+      {
+        MwmSet::MwmHandle const handle = mwmSet.GetMwmHandleById(ids[(i + j) % ids.size()]);
+        if (!handle.IsAlive())
+          ++failures[i];
+      }
+    });
+  }
+  for (auto & t : threads)
+    t.join();
+
+  for (size_t i = 0; i < kThreadsCount; ++i)
+    TEST_EQUAL(0, failures[i], (i));
+  for (auto const & id : ids)
+    TEST_EQUAL(0, id.GetInfo()->GetNumRefs(), (id));
+
+  {
+    MwmSet::MwmHandle const handle = mwmSet.GetMwmHandleById(ids[1]);
+    TEST_EQUAL(1, ids[1].GetInfo()->GetNumRefs(), ());
+    TEST(!mwmSet.Deregister(CountryFile("1")), ());
+    TEST_EQUAL(MwmInfo::STATUS_MARKED_TO_DEREGISTER, ids[1].GetInfo()->GetStatus(), ());
+  }
+  TEST_EQUAL(MwmInfo::STATUS_DEREGISTERED, ids[1].GetInfo()->GetStatus(), ());
+  TEST(!mwmSet.GetMwmHandleById(ids[1]).IsAlive(), ());
+
+  TMwmsInfo mwmsInfo;
+  GetMwmsInfo(mwmSet, mwmsInfo);
+  TestFilesPresence(mwmsInfo, {"0", "2"});
+}
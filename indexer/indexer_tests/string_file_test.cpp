@@ -0,0 +1,128 @@
+#include "testing/testing.hpp"
+
+#include "indexer/string_file.hpp"
+#include "indexer/string_file_values.hpp"
+
+#include "coding/file_writer.hpp"
+
+#include "base/string_utils.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/thread.hpp"
+#include "std/vector.hpp"
+
+namespace
+{
+using TStringsFile = StringsFile<FeatureIndexValue>;
+
+string const kStringsFile = "strings_file_test.tmp";
+
+TStringsFile::TString MakeString(uint32_t i)
+{
+  FeatureIndexValue value;
+  value.m_value = i;
+  // Many values share the same key.
+  return TStringsFile::TString(strings::MakeUniString(strings::to_string(i % 1000)),
+                               0 /* lang */, value);
+}
+
+vector<TStringsFile::TString> ReadAll(TStringsFile & file)
+{
+  vector<TStringsFile::TString> result;
+  for (auto it = file.Begin(); it != file.End(); ++it)
+    result.push_back(*it);
+  return result;
+}
+}  // namespace
+
+UNIT_TEST(StringsFile_ConcurrentPortionsAndMerge)
+{
+  uint32_t const kCount = 50000;
+
+  vector<TStringsFile::TString> expected;
+  for (uint32_t i = 0; i < kCount; ++i)
+    expected.push_back(MakeString(i));
+  sort(expected.begin(), expected.end());
+
+  for (size_t threadsCount : {1, 3, 8})
+  {
+    {
+      TStringsFile file(kStringsFile);
+      vector<thread> threads;
+      for (size_t t = 0; t < threadsCount; ++t)
+      {
+        threads.emplace_back([&file, t, threadsCount, kCount]()
+        {
+          // Several small portions per thread.
+          TStringsFile::StringsListT strings;
+          for (uint32_t i = t; i < kCount; i += threadsCount)
+          {
+            strings.push_back(MakeString(i));
+            if (strings.size() == 1000)
+              file.AddStrings(strings);
+          }
+          file.AddStrings(strings);
+        });
+      }
+      for (auto & t : threads)
+        t.join();
+
+      file.EndAdding();
+      file.OpenForRead(threadsCount > 1 /* mergeConcurrently */);
+      TEST(ReadAll(file) == expected, (threadsCount));
+    }
+    FileWriter::DeleteFileX(kStringsFile);
+  }
+}
+
+UNIT_TEST(StringsFile_StopMergeEarly)
+{
+  {
+    TStringsFile file(kStringsFile);
+    for (uint32_t i = 0; i < 100000; ++i)
+      file.AddString(MakeString(i));
+    file.EndAdding();
+    file.OpenForRead(true /* mergeConcurrently */);
+
+    auto it = file.Begin();
+    TEST(it != file.End(), ());
+    TEST_EQUAL((*it).GetValue().m_value, 0, ());
+  }
+  FileWriter::DeleteFileX(kStringsFile);
+}
+
+UNIT_TEST(StringsFile_ReadTwice)
+{
+  uint32_t const kCount = 30000;
+
+  vector<TStringsFile::TString> expected;
+  for (uint32_t i = 0; i < kCount; ++i)
+    expected.push_back(MakeString(i));
+  sort(expected.begin(), expected.end());
+
+  for (bool mergeConcurrently : {false, true})
+  {
+    {
+      TStringsFile file(kStringsFile);
+      TStringsFile::StringsListT strings;
+      for (uint32_t i = 0; i < kCount; ++i)
+      {
+        strings.push_back(MakeString(i));
+        if (strings.size() == 1000)
+          file.AddStrings(strings);
+      }
+      file.AddStrings(strings);
+      file.EndAdding();
+
+      file.OpenForRead(mergeConcurrently);
+      TEST(ReadAll(file) == expected, (mergeConcurrently));
+
+      // Reading is restarted in the middle of the previous one too.
+      file.OpenForRead(mergeConcurrently);
+      TEST(file.Begin() != file.End(), (mergeConcurrently));
+      file.OpenForRead(mergeConcurrently);
+      TEST(ReadAll(file) == expected, (mergeConcurrently));
+    }
+    FileWriter::DeleteFileX(kStringsFile);
+  }
+}
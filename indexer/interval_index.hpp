@@ -3,12 +3,15 @@
 
 #include "coding/endianness.hpp"
 #include "coding/byte_stream.hpp"
+#include "coding/mmap_reader.hpp"
 #include "coding/reader.hpp"
 #include "coding/varint.hpp"
 
 #include "base/assert.hpp"
 #include "base/buffer_vector.hpp"
 
+#include "std/algorithm.hpp"
+
 
 class IntervalIndexBase : public IntervalIndexIFace
 {
@@ -30,23 +33,63 @@ public:
     return 1 << (bitsPerLevel - 3);
   }
 
-  enum { kVersion = 1 };
+  /// Version 1: nodes are stored level by level, so descent to a leaf touches
+  /// a distant part of the file on every level.
+  /// Version 2: nodes are stored depth-first, every node is followed by subtrees
+  /// of its children. Nodes visited by a range query lie in one contiguous span.
+  /// Version 2 is written since version::v6 of mwm format, so older applications
+  /// reject such mwms by the format version instead of failing on the index.
+  enum
+  {
+    kVersionV1 = 1,
+    kVersion = 2
+  };
 };
 
+namespace impl
+{
+/// @return Memory of the reader when it can be accessed without copying, or nullptr.
+template <class TReader>
+inline uint8_t const * GetReaderData(TReader const &)
+{
+  return nullptr;
+}
+
+inline uint8_t const * GetReaderData(ModelReaderPtr const & reader)
+{
+  MmapReader const * mmapReader = dynamic_cast<MmapReader const *>(reader.GetPtr());
+  return mmapReader ? mmapReader->Data() : nullptr;
+}
+}  // namespace impl
+
 template <class ReaderT>
 class IntervalIndex : public IntervalIndexBase
 {
   typedef IntervalIndexBase base_t;
 public:
 
-  explicit IntervalIndex(ReaderT const & reader) : m_Reader(reader)
+  /// When reader's memory is directly accessible (e.g. MmapReader), nodes are
+  /// decoded in place without copying.
+  explicit IntervalIndex(ReaderT const & reader)
+    : m_Reader(reader), m_pData(impl::GetReaderData(reader))
   {
     ReaderSource<ReaderT> src(reader);
     src.Read(&m_Header, sizeof(Header));
-    CHECK_EQUAL(m_Header.m_Version, static_cast<uint8_t>(kVersion), ());
+    CHECK(m_Header.m_Version == kVersionV1 || m_Header.m_Version == kVersion,
+          (m_Header.m_Version));
     if (m_Header.m_Levels != 0)
-      for (int i = 0; i <= m_Header.m_Levels + 1; ++i)
-        m_LevelOffsets.push_back(ReadPrimitiveFromSource<uint32_t>(src));
+    {
+      if (m_Header.m_Version == kVersionV1)
+      {
+        for (int i = 0; i <= m_Header.m_Levels + 1; ++i)
+          m_LevelOffsets.push_back(ReadPrimitiveFromSource<uint32_t>(src));
+      }
+      else
+      {
+        m_RootSize = ReadPrimitiveFromSource<uint32_t>(src);
+        m_RootOffset = static_cast<uint32_t>(src.Pos());
+      }
+    }
   }
 
   uint64_t KeyEnd() const
@@ -66,8 +109,15 @@ public:
       if (end > KeyEnd())
         end = KeyEnd();
       --end;  // end is inclusive in ForEachImpl().
-      ForEachNode(f, beg, end, m_Header.m_Levels, 0,
-                  m_LevelOffsets[m_Header.m_Levels + 1] - m_LevelOffsets[m_Header.m_Levels]);
+      if (m_Header.m_Version == kVersionV1)
+      {
+        ForEachNode(f, beg, end, m_Header.m_Levels, 0,
+                    m_LevelOffsets[m_Header.m_Levels + 1] - m_LevelOffsets[m_Header.m_Levels]);
+      }
+      else
+      {
+        ForEachNode(f, beg, end, m_Header.m_Levels, m_RootOffset, m_RootSize);
+      }
     }
   }
 
@@ -77,18 +127,27 @@ public:
   }
 
 private:
+  // Returns size bytes at offset, copied to buffer when reader's memory isn't accessible.
+  template <class TBuffer>
+  uint8_t const * GetData(uint32_t offset, uint32_t size, TBuffer & buffer) const
+  {
+    if (m_pData)
+      return m_pData + offset;
+
+    buffer.resize_no_init(size);
+    m_Reader.Read(offset, &buffer[0], size);
+    return &buffer[0];
+  }
 
   template <typename F>
   void ForEachLeaf(F const & f, uint64_t const beg, uint64_t const end,
                    uint32_t const offset, uint32_t const size) const
   {
-    buffer_vector<uint8_t, 1024> data;
-    data.resize_no_init(size);
+    buffer_vector<uint8_t, 1024> buffer;
+    uint8_t const * data = GetData(offset, size, buffer);
+    ArrayByteSource src(data);
 
-    m_Reader.Read(offset, &data[0], size);
-    ArrayByteSource src(&data[0]);
-
-    void const * pEnd = &data[0] + size;
+    void const * pEnd = data + size;
     uint32_t value = 0;
     while (src.Ptr() < pEnd)
     {
@@ -107,7 +166,9 @@ private:
   void ForEachNode(F const & f, uint64_t beg, uint64_t end, int level,
                    uint32_t offset, uint32_t size) const
   {
-    offset += m_LevelOffsets[level];
+    // In version 1 offsets are relative to the level, in version 2 they are absolute.
+    if (m_Header.m_Version == kVersionV1)
+      offset += m_LevelOffsets[level];
 
     if (level == 0)
     {
@@ -123,14 +184,25 @@ private:
     uint32_t const end0 = static_cast<uint32_t>(end >> skipBits);
     ASSERT_LESS(end0, (1U << m_Header.m_BitsPerLevel), (beg, end, skipBits));
 
-    buffer_vector<uint8_t, 576> data;
-    data.resize_no_init(size);
+    buffer_vector<uint8_t, 576> buffer;
+    uint32_t childrenOffset = 0;
+    if (m_Header.m_Version != kVersionV1)
+    {
+      // Subtree is the node size, the node and subtrees of node's children.
+      uint32_t const kMaxVarUint32Size = 5;
+      uint8_t const * header = GetData(offset, min(size, kMaxVarUint32Size), buffer);
+      ArrayByteSource sizeSrc(header);
+      uint32_t const nodeSize = ReadVarUint<uint32_t>(sizeSrc);
+      offset += static_cast<uint32_t>(sizeSrc.PtrUC() - header);
+      size = nodeSize;
+      childrenOffset = offset + nodeSize;
+    }
 
-    m_Reader.Read(offset, &data[0], size);
-    ArrayByteSource src(&data[0]);
+    uint8_t const * data = GetData(offset, size, buffer);
+    ArrayByteSource src(data);
 
     uint32_t const offsetAndFlag = ReadVarUint<uint32_t>(src);
-    uint32_t childOffset = offsetAndFlag >> 1;
+    uint32_t childOffset = childrenOffset + (offsetAndFlag >> 1);
     if (offsetAndFlag & 1)
     {
       // Reading bitmap.
@@ -151,12 +223,12 @@ private:
         }
       }
       ASSERT(end0 != (1 << m_Header.m_BitsPerLevel) - 1 ||
-             static_cast<uint8_t const *>(src.Ptr()) - &data[0] == size,
-             (beg, end, beg0, end0, offset, size, src.Ptr(), &data[0]));
+             static_cast<uint8_t const *>(src.Ptr()) - data == size,
+             (beg, end, beg0, end0, offset, size, src.Ptr(), data));
     }
     else
     {
-      void const * pEnd = &data[0] + size;
+      void const * pEnd = data + size;
       while (src.Ptr() < pEnd)
       {
         uint8_t const i = src.ReadByte();
@@ -175,6 +247,11 @@ private:
   }
 
   ReaderT m_Reader;
+  uint8_t const * m_pData;
   Header m_Header;
+  // Version 1.
   buffer_vector<uint32_t, 7> m_LevelOffsets;
+  // Version 2.
+  uint32_t m_RootOffset = 0;
+  uint32_t m_RootSize = 0;
 };
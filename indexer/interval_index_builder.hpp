@@ -4,6 +4,7 @@
 #include "coding/endianness.hpp"
 #include "coding/varint.hpp"
 #include "coding/write_to_sink.hpp"
+#include "coding/writer.hpp"
 #include "base/assert.hpp"
 #include "base/base.hpp"
 #include "base/bits.hpp"
@@ -29,13 +30,30 @@
 // +------------------------------+
 // |        Level N data          |
 // +------------------------------+
+//
+// Version 2 keeps nodes in depth-first order:
+//
+// +------------------------------+
+// |            Header            |
+// +------------------------------+
+// |        Root subtree size     |
+// +------------------------------+
+// |        Root subtree          |
+// +------------------------------+
+//
+// where subtree is varuint size of the node, the node (with zero children offset)
+// and subtrees of node's children in key order, and the size of the child in
+// the node is the size of its subtree. Leaves are the same as in version 1.
 
 class IntervalIndexBuilder
 {
 public:
-  IntervalIndexBuilder(uint32_t keyBits, uint32_t leafBytes, uint32_t bitsPerLevel = 8)
-    : m_BitsPerLevel(bitsPerLevel), m_LeafBytes(leafBytes)
+  IntervalIndexBuilder(uint32_t keyBits, uint32_t leafBytes, uint32_t bitsPerLevel = 8,
+                       uint32_t version = IntervalIndexBase::kVersion)
+    : m_BitsPerLevel(bitsPerLevel), m_LeafBytes(leafBytes), m_Version(version)
   {
+    CHECK(version == IntervalIndexBase::kVersionV1 || version == IntervalIndexBase::kVersion,
+          (version));
     CHECK_GREATER(leafBytes, 0, ());
     CHECK_LESS(keyBits, 63, ());
     int const nodeKeyBits = keyBits - (m_LeafBytes << 3);
@@ -54,7 +72,7 @@ public:
     if (beg == end)
     {
       IntervalIndexBase::Header header;
-      header.m_Version = IntervalIndexBase::kVersion;
+      header.m_Version = static_cast<uint8_t>(m_Version);
       header.m_BitsPerLevel = 0;
       header.m_Levels = 0;
       header.m_LeafBytes = 0;
@@ -62,6 +80,12 @@ public:
       return;
     }
 
+    if (m_Version != IntervalIndexBase::kVersionV1)
+    {
+      BuildSubtreesIndex(writer, beg, end);
+      return;
+    }
+
     uint64_t const initialPos = writer.Pos();
     WriteZeroesToSink(writer, sizeof(IntervalIndexBase::Header));
     WriteZeroesToSink(writer, 4 * (m_Levels + 2));
@@ -85,18 +109,7 @@ public:
     uint64_t const lastPos = writer.Pos();
     writer.Seek(initialPos);
 
-    // Write header.
-    {
-      IntervalIndexBase::Header header;
-      header.m_Version = IntervalIndexBase::kVersion;
-      header.m_BitsPerLevel = static_cast<uint8_t>(m_BitsPerLevel);
-      ASSERT_EQUAL(header.m_BitsPerLevel, m_BitsPerLevel, ());
-      header.m_Levels = static_cast<uint8_t>(m_Levels);
-      ASSERT_EQUAL(header.m_Levels, m_Levels, ());
-      header.m_LeafBytes = static_cast<uint8_t>(m_LeafBytes);
-      ASSERT_EQUAL(header.m_LeafBytes, m_LeafBytes, ());
-      writer.Write(&header, sizeof(header));
-    }
+    WriteHeader(writer);
 
     // Write level offsets.
     for (size_t i = 0; i < levelOffset.size(); ++i)
@@ -107,6 +120,89 @@ public:
     writer.Seek(lastPos);
   }
 
+  template <class WriterT, typename CellIdValueIterT>
+  void BuildSubtreesIndex(WriterT & writer, CellIdValueIterT const & beg,
+                          CellIdValueIterT const & end)
+  {
+    vector<char> subtrees;
+    vector<uint32_t> sizes;
+    {
+      MemWriter<vector<char>> leavesWriter(subtrees);
+      BuildLeaves(leavesWriter, beg, end, sizes);
+    }
+    for (int i = 1; i <= static_cast<int>(m_Levels); ++i)
+    {
+      vector<char> nextSubtrees;
+      vector<uint32_t> nextSizes;
+      BuildSubtrees(beg, end, i, subtrees, sizes, nextSubtrees, nextSizes);
+      nextSubtrees.swap(subtrees);
+      nextSizes.swap(sizes);
+    }
+    CHECK_EQUAL(sizes.size(), 1, ());
+    CHECK_EQUAL(sizes[0], subtrees.size(), ());
+
+    WriteHeader(writer);
+    WriteToSink(writer, sizes[0]);
+    writer.Write(subtrees.data(), subtrees.size());
+  }
+
+  /// Builds subtrees of the level from the subtrees of the level below, which are
+  /// stored in children and have sizes childSizes.
+  template <typename CellIdValueIterT>
+  void BuildSubtrees(CellIdValueIterT const & beg, CellIdValueIterT const & end, int level,
+                     vector<char> const & children, vector<uint32_t> const & childSizes,
+                     vector<char> & subtrees, vector<uint32_t> & sizes)
+  {
+    ASSERT_GREATER(level, 0, ());
+    uint32_t const skipBits = m_LeafBytes * 8 + (level - 1) * m_BitsPerLevel;
+    vector<uint32_t> expandedSizes(1 << m_BitsPerLevel);
+    uint64_t prevKey = static_cast<uint64_t>(-1);
+    uint32_t childrenBeg = 0;
+    uint32_t childrenEnd = 0;
+    auto childSize = childSizes.begin();
+    for (CellIdValueIterT it = beg; it != end; ++it)
+    {
+      uint64_t const key = it->GetCell() >> skipBits;
+      if (key == prevKey)
+        continue;
+
+      if (it != beg && (key >> m_BitsPerLevel) != (prevKey >> m_BitsPerLevel))
+      {
+        WriteSubtree(&expandedSizes[0], children.data() + childrenBeg,
+                     children.data() + childrenEnd, subtrees, sizes);
+        childrenBeg = childrenEnd;
+        expandedSizes.assign(expandedSizes.size(), 0);
+      }
+
+      childrenEnd += *childSize;
+      expandedSizes[key & m_LastBitsMask] += *childSize;
+      ++childSize;
+      prevKey = key;
+    }
+    WriteSubtree(&expandedSizes[0], children.data() + childrenBeg, children.data() + childrenEnd,
+                 subtrees, sizes);
+    ASSERT(childSize == childSizes.end(), ());
+    ASSERT_EQUAL(childrenEnd, children.size(), ());
+  }
+
+  void WriteSubtree(uint32_t * childSizes, char const * childrenBeg, char const * childrenEnd,
+                    vector<char> & subtrees, vector<uint32_t> & sizes)
+  {
+    vector<char> node;
+    PushBackByteSink<vector<char>> nodeSink(node);
+    WriteNode(nodeSink, 0 /* offset */, childSizes);
+
+    size_t const subtreeBeg = subtrees.size();
+    PushBackByteSink<vector<char>> sink(subtrees);
+    WriteVarUint(sink, static_cast<uint32_t>(node.size()));
+    subtrees.insert(subtrees.end(), node.begin(), node.end());
+    subtrees.insert(subtrees.end(), childrenBeg, childrenEnd);
+
+    uint64_t const size = subtrees.size() - subtreeBeg;
+    CHECK_EQUAL(size, static_cast<uint32_t>(size), ());
+    sizes.push_back(static_cast<uint32_t>(size));
+  }
+
   template <typename CellIdValueIterT>
   bool CheckIntervalIndexInputSequence(CellIdValueIterT const & beg, CellIdValueIterT const & end)
   {
@@ -262,12 +358,28 @@ public:
   }
 
 private:
+  template <class WriterT>
+  void WriteHeader(WriterT & writer)
+  {
+    IntervalIndexBase::Header header;
+    header.m_Version = static_cast<uint8_t>(m_Version);
+    header.m_BitsPerLevel = static_cast<uint8_t>(m_BitsPerLevel);
+    ASSERT_EQUAL(header.m_BitsPerLevel, m_BitsPerLevel, ());
+    header.m_Levels = static_cast<uint8_t>(m_Levels);
+    ASSERT_EQUAL(header.m_Levels, m_Levels, ());
+    header.m_LeafBytes = static_cast<uint8_t>(m_LeafBytes);
+    ASSERT_EQUAL(header.m_LeafBytes, m_LeafBytes, ());
+    writer.Write(&header, sizeof(header));
+  }
+
   uint32_t m_Levels, m_BitsPerLevel, m_LeafBytes, m_LastBitsMask;
+  uint32_t m_Version;
 };
 
 template <class WriterT, typename CellIdValueIterT>
 void BuildIntervalIndex(CellIdValueIterT const & beg, CellIdValueIterT const & end,
-                        WriterT & writer, uint32_t keyBits)
+                        WriterT & writer, uint32_t keyBits,
+                        uint32_t version = IntervalIndexBase::kVersion)
 {
-  IntervalIndexBuilder(keyBits, 1).BuildIndex(writer, beg, end);
+  IntervalIndexBuilder(keyBits, 1, 8 /* bitsPerLevel */, version).BuildIndex(writer, beg, end);
 }
@@ -9,6 +9,7 @@
 #include "base/stl_add.hpp"
 
 #include "std/algorithm.hpp"
+#include "std/functional.hpp"
 #include "std/sstream.hpp"
 
 
@@ -27,6 +28,36 @@ MwmInfo::MwmTypeT MwmInfo::GetType() const
   return COASTS;
 }
 
+uint32_t MwmInfo::GetNumRefs() const
+{
+  int32_t const refs = m_numRefs.load();
+  return refs == kSealedRefs ? 0 : static_cast<uint32_t>(refs);
+}
+
+bool MwmInfo::TryAddRef()
+{
+  int32_t refs = m_numRefs.load();
+  do
+  {
+    if (refs == kSealedRefs)
+      return false;
+  } while (!m_numRefs.compare_exchange_weak(refs, refs + 1));
+  return true;
+}
+
+uint32_t MwmInfo::ReleaseRef()
+{
+  int32_t const refs = m_numRefs.fetch_sub(1) - 1;
+  ASSERT_GREATER_OR_EQUAL(refs, 0, ());
+  return static_cast<uint32_t>(refs);
+}
+
+bool MwmInfo::TrySealRefs()
+{
+  int32_t expected = 0;
+  return m_numRefs.compare_exchange_strong(expected, kSealedRefs);
+}
+
 string DebugPrint(MwmSet::MwmId const & id)
 {
   ostringstream ss;
@@ -53,6 +84,15 @@ MwmSet::MwmHandle::MwmHandle(MwmHandle && handle)
   handle.m_value = nullptr;
 }
 
+MwmSet::MwmSet(size_t cacheSize, size_t cacheShardsCount)
+  : m_shardCacheSize((cacheSize + cacheShardsCount - 1) / max(cacheShardsCount, size_t(1))),
+    m_infoSnapshot(make_shared<InfoSnapshotType>())
+{
+  ASSERT_GREATER(cacheShardsCount, 0, ());
+  for (size_t i = 0; i < max(cacheShardsCount, size_t(1)); ++i)
+    m_cacheShards.emplace_back(new CacheShard());
+}
+
 MwmSet::MwmHandle::~MwmHandle()
 {
   if (m_mwmSet && m_value)
@@ -127,6 +167,7 @@ pair<MwmSet::MwmId, MwmSet::RegResult> MwmSet::RegisterImpl(LocalCountryFile con
   info->m_file = localFile;
   info->SetStatus(MwmInfo::STATUS_REGISTERED);
   m_info[localFile.GetCountryName()].push_back(info);
+  UpdateInfoSnapshot();
 
   return make_pair(MwmId(info), RegResult::Success);
 }
@@ -137,17 +178,22 @@ bool MwmSet::DeregisterImpl(MwmId const & id)
     return false;
 
   shared_ptr<MwmInfo> const & info = id.GetInfo();
-  if (info->m_numRefs == 0)
+  if (!info->TrySealRefs())
   {
-    info->SetStatus(MwmInfo::STATUS_DEREGISTERED);
-    vector<shared_ptr<MwmInfo>> & infos = m_info[info->GetCountryName()];
-    infos.erase(remove(infos.begin(), infos.end(), info), infos.end());
-    OnMwmDeregistered(info->GetLocalFile());
-    return true;
+    info->SetStatus(MwmInfo::STATUS_MARKED_TO_DEREGISTER);
+
+    // The last handle may have been released before the status was changed,
+    // so try to seal it once again.
+    if (!info->TrySealRefs())
+      return false;
   }
 
-  info->SetStatus(MwmInfo::STATUS_MARKED_TO_DEREGISTER);
-  return false;
+  info->SetStatus(MwmInfo::STATUS_DEREGISTERED);
+  vector<shared_ptr<MwmInfo>> & infos = m_info[info->GetCountryName()];
+  infos.erase(remove(infos.begin(), infos.end(), info), infos.end());
+  UpdateInfoSnapshot();
+  OnMwmDeregistered(info->GetLocalFile());
+  return true;
 }
 
 bool MwmSet::Deregister(CountryFile const & countryFile)
@@ -176,35 +222,31 @@ bool MwmSet::IsLoaded(CountryFile const & countryFile) const
 
 void MwmSet::GetMwmsInfo(vector<shared_ptr<MwmInfo>> & info) const
 {
-  lock_guard<mutex> lock(m_lock);
-  info.clear();
-  info.reserve(m_info.size());
+  shared_ptr<InfoSnapshotType const> const snapshot = atomic_load(&m_infoSnapshot);
+  info.assign(snapshot->begin(), snapshot->end());
+}
+
+void MwmSet::UpdateInfoSnapshot()
+{
+  auto snapshot = make_shared<InfoSnapshotType>();
+  snapshot->reserve(m_info.size());
   for (auto const & p : m_info)
   {
     if (!p.second.empty())
-      info.push_back(p.second.back());
+      snapshot->push_back(p.second.back());
   }
+  atomic_store(&m_infoSnapshot, shared_ptr<InfoSnapshotType const>(move(snapshot)));
 }
 
-unique_ptr<MwmSet::MwmValueBase> MwmSet::LockValue(MwmId const & id)
+MwmSet::CacheShard & MwmSet::GetCacheShard(MwmId const & id)
 {
-  lock_guard<mutex> lock(m_lock);
-  return LockValueImpl(id);
+  size_t const hash = std::hash<MwmInfo const *>()(id.GetInfo().get());
+  return *m_cacheShards[hash % m_cacheShards.size()];
 }
 
-unique_ptr<MwmSet::MwmValueBase> MwmSet::LockValueImpl(MwmId const & id)
+unique_ptr<MwmSet::MwmValueBase> MwmSet::CacheShard::Pop(MwmId const & id)
 {
-  CHECK(id.IsAlive(), (id));
-  shared_ptr<MwmInfo> info = id.GetInfo();
-
-  // It's better to return valid "value pointer" even for "out-of-date" files,
-  // because they can be locked for a long time by other algos.
-  //if (!info->IsUpToDate())
-  //  return TMwmValueBasePtr();
-
-  ++info->m_numRefs;
-
-  // Search in cache.
+  lock_guard<mutex> lock(m_lock);
   for (auto it = m_cache.begin(); it != m_cache.end(); ++it)
   {
     if (it->first == id)
@@ -214,6 +256,56 @@ unique_ptr<MwmSet::MwmValueBase> MwmSet::LockValueImpl(MwmId const & id)
       return result;
     }
   }
+  return nullptr;
+}
+
+void MwmSet::CacheShard::Push(MwmId const & id, unique_ptr<MwmValueBase> && p, size_t maxSize)
+{
+  // Evicted value is destroyed out of the lock.
+  unique_ptr<MwmValueBase> evicted;
+  {
+    lock_guard<mutex> lock(m_lock);
+    m_cache.push_back(make_pair(id, move(p)));
+    if (m_cache.size() > maxSize)
+    {
+      ASSERT_EQUAL(m_cache.size(), maxSize + 1, ());
+      evicted = move(m_cache.front().second);
+      m_cache.pop_front();
+    }
+  }
+}
+
+void MwmSet::CacheShard::Clear()
+{
+  lock_guard<mutex> lock(m_lock);
+  m_cache.clear();
+}
+
+void MwmSet::CacheShard::Clear(MwmId const & id)
+{
+  auto sameId = [&id](pair<MwmSet::MwmId, unique_ptr<MwmSet::MwmValueBase>> const & p)
+  {
+    return (p.first == id);
+  };
+
+  lock_guard<mutex> lock(m_lock);
+  m_cache.erase(RemoveIfKeepValid(m_cache.begin(), m_cache.end(), sameId), m_cache.end());
+}
+
+unique_ptr<MwmSet::MwmValueBase> MwmSet::LockValue(MwmId const & id)
+{
+  shared_ptr<MwmInfo> const & info = id.GetInfo();
+
+  // It's better to return valid "value pointer" even for "out-of-date" files,
+  // because they can be locked for a long time by other algos.
+  // Only deregistered mwms can't be locked.
+  if (!info || !info->TryAddRef())
+    return nullptr;
+
+  // Search in cache.
+  unique_ptr<MwmValueBase> result = GetCacheShard(id).Pop(id);
+  if (result)
+    return result;
 
   try
   {
@@ -223,55 +315,54 @@ unique_ptr<MwmSet::MwmValueBase> MwmSet::LockValueImpl(MwmId const & id)
   {
     LOG(LERROR, ("Can't create MWMValue for", info->GetCountryName(), "Reason", ex.what()));
 
-    --info->m_numRefs;
+    info->ReleaseRef();
+    lock_guard<mutex> lock(m_lock);
     DeregisterImpl(id);
     return nullptr;
   }
 }
 
 void MwmSet::UnlockValue(MwmId const & id, unique_ptr<MwmValueBase> && p)
-{
-  lock_guard<mutex> lock(m_lock);
-  UnlockValueImpl(id, move(p));
-}
-
-void MwmSet::UnlockValueImpl(MwmId const & id, unique_ptr<MwmValueBase> && p)
 {
   ASSERT(id.IsAlive() && p, (id));
   if (!id.IsAlive() || !p)
     return;
 
   shared_ptr<MwmInfo> const & info = id.GetInfo();
-  ASSERT_GREATER(info->m_numRefs, 0, ());
-  --info->m_numRefs;
-  if (info->m_numRefs == 0 && info->GetStatus() == MwmInfo::STATUS_MARKED_TO_DEREGISTER)
-    VERIFY(DeregisterImpl(id), ());
 
+  // Value is cached while the handle is still counted, so the mwm can't be
+  // deregistered and its cache can't be cleared in the meantime.
   if (info->IsUpToDate())
   {
     /// @todo Probably, it's better to store only "unique by id" free caches here.
     /// But it's no obvious if we have many threads working with the single mwm.
+    GetCacheShard(id).Push(id, move(p), m_shardCacheSize);
+  }
+  else
+  {
+    p.reset();
+  }
 
-    m_cache.push_back(make_pair(id, move(p)));
-    if (m_cache.size() > m_cacheSize)
-    {
-      ASSERT_EQUAL(m_cache.size(), m_cacheSize + 1, ());
-      m_cache.pop_front();
-    }
+  if (info->ReleaseRef() == 0 && info->GetStatus() == MwmInfo::STATUS_MARKED_TO_DEREGISTER)
+  {
+    lock_guard<mutex> lock(m_lock);
+    if (DeregisterImpl(id))
+      ClearCache(id);
   }
 }
 
 void MwmSet::Clear()
 {
   lock_guard<mutex> lock(m_lock);
-  ClearCacheImpl(m_cache.begin(), m_cache.end());
+  ClearCache();
   m_info.clear();
+  UpdateInfoSnapshot();
 }
 
 void MwmSet::ClearCache()
 {
-  lock_guard<mutex> lock(m_lock);
-  ClearCacheImpl(m_cache.begin(), m_cache.end());
+  for (auto & shard : m_cacheShards)
+    shard->Clear();
 }
 
 MwmSet::MwmId MwmSet::GetMwmIdByCountryFile(CountryFile const & countryFile) const
@@ -282,13 +373,11 @@ MwmSet::MwmId MwmSet::GetMwmIdByCountryFile(CountryFile const & countryFile) con
 
 MwmSet::MwmHandle MwmSet::GetMwmHandleByCountryFile(CountryFile const & countryFile)
 {
-  lock_guard<mutex> lock(m_lock);
-  return GetMwmHandleByIdImpl(GetMwmIdByCountryFileImpl(countryFile));
+  return GetMwmHandleByIdImpl(GetMwmIdByCountryFile(countryFile));
 }
 
 MwmSet::MwmHandle MwmSet::GetMwmHandleById(MwmId const & id)
 {
-  lock_guard<mutex> lock(m_lock);
   return GetMwmHandleByIdImpl(id);
 }
 
@@ -296,22 +385,13 @@ MwmSet::MwmHandle MwmSet::GetMwmHandleByIdImpl(MwmId const & id)
 {
   unique_ptr<MwmValueBase> value;
   if (id.IsAlive())
-    value = LockValueImpl(id);
+    value = LockValue(id);
   return MwmHandle(*this, id, move(value));
 }
 
-void MwmSet::ClearCacheImpl(CacheType::iterator beg, CacheType::iterator end)
-{
-  m_cache.erase(beg, end);
-}
-
 void MwmSet::ClearCache(MwmId const & id)
 {
-  auto sameId = [&id](pair<MwmSet::MwmId, unique_ptr<MwmSet::MwmValueBase>> const & p)
-  {
-    return (p.first == id);
-  };
-  ClearCacheImpl(RemoveIfKeepValid(m_cache.begin(), m_cache.end(), sameId), m_cache.end());
+  GetCacheShard(id).Clear(id);
 }
 
 string DebugPrint(MwmSet::RegResult result)
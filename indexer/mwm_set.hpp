@@ -8,6 +8,7 @@
 
 #include "base/macros.hpp"
 
+#include "std/atomic.hpp"
 #include "std/deque.hpp"
 #include "std/map.hpp"
 #include "std/mutex.hpp"
@@ -47,7 +48,7 @@ public:
   uint8_t m_maxScale;             ///< Max zoom level of mwm.
   version::MwmVersion m_version;  ///< Mwm file version.
 
-  inline Status GetStatus() const { return m_status; }
+  inline Status GetStatus() const { return m_status.load(); }
 
   inline bool IsUpToDate() const { return IsRegistered(); }
 
@@ -65,14 +66,27 @@ public:
   MwmTypeT GetType() const;
 
   /// Returns the lock counter value for test needs.
-  uint8_t GetNumRefs() const { return m_numRefs; }
+  uint32_t GetNumRefs() const;
 
 private:
   inline void SetStatus(Status status) { m_status = status; }
 
+  /// @name Lock-free reference counting of active handles.
+  //@{
+  /// Increments the number of active handles if mwm is not deregistered.
+  bool TryAddRef();
+  /// Decrements the number of active handles and returns the new value.
+  uint32_t ReleaseRef();
+  /// Atomically forbids any new handles if there are no active handles now.
+  /// @return False if mwm has active handles.
+  bool TrySealRefs();
+  //@}
+
   platform::LocalCountryFile m_file;  ///< Path to the mwm file.
-  Status m_status;                    ///< Current country status.
-  uint8_t m_numRefs;                  ///< Number of active handles.
+  atomic<Status> m_status;            ///< Current country status.
+  atomic<int32_t> m_numRefs;          ///< Number of active handles or kSealedRefs.
+
+  static int32_t const kSealedRefs = -1;
 };
 
 class MwmSet
@@ -104,7 +118,10 @@ public:
   };
 
 public:
-  explicit MwmSet(size_t cacheSize = 5) : m_cacheSize(cacheSize) {}
+  /// \param cacheSize Total number of free mwm values kept in cache.
+  /// \param cacheShardsCount Number of independently locked cache shards.
+  ///        Use more than one shard when many threads acquire handles concurrently.
+  explicit MwmSet(size_t cacheSize = 5, size_t cacheShardsCount = 1);
   virtual ~MwmSet() = default;
 
   class MwmValueBase
@@ -192,6 +209,7 @@ public:
 
   /// Get ids of all mwms. Some of them may be with not active status.
   /// In that case, LockValue returns NULL.
+  /// @note Doesn't acquire the registry lock, reads the latest registry snapshot.
   void GetMwmsInfo(vector<shared_ptr<MwmInfo>> & info) const;
 
   // Clears caches and mwm's registry. All known mwms won't be marked as DEREGISTERED.
@@ -221,33 +239,50 @@ protected:
 private:
   typedef deque<pair<MwmId, unique_ptr<MwmValueBase>>> CacheType;
 
-  /// @precondition This function is always called under mutex m_lock.
+  /// LRU cache of free mwm values with its own lock.
+  class CacheShard
+  {
+  public:
+    unique_ptr<MwmValueBase> Pop(MwmId const & id);
+    void Push(MwmId const & id, unique_ptr<MwmValueBase> && p, size_t maxSize);
+    void Clear();
+    void Clear(MwmId const & id);
+
+  private:
+    mutex m_lock;
+    CacheType m_cache;
+  };
+
+  CacheShard & GetCacheShard(MwmId const & id);
+
+  /// Acquires a handle without locking m_lock.
   MwmHandle GetMwmHandleByIdImpl(MwmId const & id);
 
   unique_ptr<MwmValueBase> LockValue(MwmId const & id);
-  unique_ptr<MwmValueBase> LockValueImpl(MwmId const & id);
   void UnlockValue(MwmId const & id, unique_ptr<MwmValueBase> && p);
-  void UnlockValueImpl(MwmId const & id, unique_ptr<MwmValueBase> && p);
 
-  /// Do the cleaning for [beg, end) without acquiring the mutex.
+  /// Rebuilds the registry snapshot, which is read by GetMwmsInfo.
   /// @precondition This function is always called under mutex m_lock.
-  void ClearCacheImpl(CacheType::iterator beg, CacheType::iterator end);
+  void UpdateInfoSnapshot();
 
-  CacheType m_cache;
-  size_t const m_cacheSize;
+  vector<unique_ptr<CacheShard>> m_cacheShards;
+  size_t const m_shardCacheSize;
+
+  typedef vector<shared_ptr<MwmInfo>> InfoSnapshotType;
+  /// Immutable list of the latest mwms versions, accessed with atomic_load/atomic_store only.
+  shared_ptr<InfoSnapshotType const> m_infoSnapshot;
 
 protected:
-  /// @precondition This function is always called under mutex m_lock.
+  /// Acquires cache shard locks, so it may be called under mutex m_lock.
   void ClearCache(MwmId const & id);
 
   /// Find mwm with a given name.
   /// @precondition This function is always called under mutex m_lock.
   MwmId GetMwmIdByCountryFileImpl(platform::CountryFile const & countryFile) const;
 
-  /// @precondition This function is always called under mutex m_lock.
   WARN_UNUSED_RESULT inline MwmHandle GetLock(MwmId const & id)
   {
-    return MwmHandle(*this, id, LockValueImpl(id));
+    return MwmHandle(*this, id, LockValue(id));
   }
 
   // This method is called under m_lock when mwm is removed from a
@@ -256,6 +291,7 @@ protected:
 
   map<string, vector<shared_ptr<MwmInfo>>> m_info;
 
+  /// Guards the registry (m_info). Handles are acquired and released without it.
   mutable mutex m_lock;
 };
 
@@ -5,6 +5,7 @@
 #include "indexer/feature_algo.hpp"
 #include "indexer/feature_utils.hpp"
 #include "indexer/feature_visibility.hpp"
+#include "indexer/features_offsets_table.hpp"
 #include "indexer/features_vector.hpp"
 #include "indexer/search_delimiters.hpp"
 #include "indexer/search_string_utils.hpp"
@@ -16,9 +17,12 @@
 
 #include "defines.hpp"
 
+#include "platform/mwm_version.hpp"
 #include "platform/platform.hpp"
 
+#include "coding/mmap_reader.hpp"
 #include "coding/reader_writer_ops.hpp"
+#include "coding/succinct_trie_builder.hpp"
 #include "coding/trie_builder.hpp"
 #include "coding/writer.hpp"
 
@@ -31,8 +35,13 @@
 
 #include "std/algorithm.hpp"
 #include "std/fstream.hpp"
+#include "std/function.hpp"
 #include "std/initializer_list.hpp"
+#include "std/exception.hpp"
 #include "std/limits.hpp"
+#include "std/numeric.hpp"
+#include "std/thread.hpp"
+#include "std/unique_ptr.hpp"
 #include "std/unordered_map.hpp"
 #include "std/vector.hpp"
 
@@ -367,48 +376,165 @@ public:
   }
 };
 
-void AddFeatureNameIndexPairs(FilesContainerR const & container,
-                              CategoriesHolder & categoriesHolder,
-                              StringsFile<FeatureIndexValue> & stringsFile)
+/// Collects strings of one thread and passes them to StringsFile as sorted portions.
+template <typename TValue>
+class StringsPortion
 {
-  FeaturesVectorTest features(container);
-  feature::DataHeader const & header = features.GetHeader();
+public:
+  using ValueT = TValue;
+  using TString = typename StringsFile<TValue>::TString;
 
-  ValueBuilder<FeatureIndexValue> valueBuilder;
+  StringsPortion(StringsFile<TValue> & names, size_t maxSize) : m_names(names), m_maxSize(maxSize)
+  {
+  }
 
+  void AddString(TString const & s)
+  {
+    m_strings.push_back(s);
+    if (m_strings.size() >= m_maxSize)
+      Flush();
+  }
+
+  void Flush() { m_names.AddStrings(m_strings); }
+
+private:
+  StringsFile<TValue> & m_names;
+  size_t const m_maxSize;
+  typename StringsFile<TValue>::StringsListT m_strings;
+};
+
+/// Tokenizes all the features of the container and adds tokens to names.
+/// When threadsCount > 1, container should be a standalone file: it's memory-mapped
+/// and every thread tokenizes and sorts its own contiguous range of features.
+template <typename TValue>
+void AddFeatures(FilesContainerR const & cont, feature::DataHeader const & header,
+                 CategoriesHolder const & catHolder, ValueBuilder<TValue> const & valueBuilder,
+                 StringsFile<TValue> & names, size_t threadsCount)
+{
   unique_ptr<SynonymsHolder> synonyms;
   if (header.GetType() == feature::DataHeader::world)
     synonyms.reset(new SynonymsHolder(GetPlatform().WritablePathForFile(SYNONYMS_FILE)));
 
-  features.GetVector().ForEach(FeatureInserter<StringsFile<FeatureIndexValue>>(
-      synonyms.get(), stringsFile, categoriesHolder, header.GetScaleRange(), valueBuilder));
+  if (threadsCount <= 1)
+  {
+    FeaturesVectorTest features(cont);
+    features.GetVector().ForEach(FeatureInserter<StringsFile<TValue>>(
+        synonyms.get(), names, catHolder, header.GetScaleRange(), valueBuilder));
+    return;
+  }
+
+  // Ids of features, the same as FeaturesVector::ForEach passes.
+  unique_ptr<feature::FeaturesOffsetsTable> table;
+  if (header.GetFormat() >= version::v5)
+    table = feature::FeaturesOffsetsTable::CreateIfNotExistsAndLoad(cont);
+  vector<uint32_t> ids;
+  if (table)
+  {
+    ids.resize(table->size());
+    iota(ids.begin(), ids.end(), 0);
+  }
+  else
+  {
+    FeaturesVector::ForEachOffset(cont.GetReader(DATA_FILE_TAG), [&ids](uint32_t pos)
+    {
+      ids.push_back(pos);
+    });
+  }
+
+  FilesContainerR const mapped(new MmapReader(cont.GetFileName()));
+  SharedFeaturesVector const features(mapped, header, table.get());
+
+  // The total number of strings kept in memory is the same as in the sequential case.
+  size_t const portionSize = max(StringsFile<TValue>::kMaxStringsInPortion / threadsCount,
+                                 size_t(1));
+
+  vector<exception_ptr> exceptions(threadsCount);
+  vector<thread> threads;
+  for (size_t i = 0; i < threadsCount; ++i)
+  {
+    threads.emplace_back([&, i]()
+    {
+      try
+      {
+        StringsPortion<TValue> portion(names, portionSize);
+        FeatureInserter<StringsPortion<TValue>> inserter(synonyms.get(), portion, catHolder,
+                                                         header.GetScaleRange(), valueBuilder);
+
+        SharedFeaturesVector::Context context(features);
+        size_t const end = ids.size() * (i + 1) / threadsCount;
+        for (size_t j = ids.size() * i / threadsCount; j < end; ++j)
+        {
+          FeatureType ft;
+          context.GetByIndex(ids[j], ft);
+          inserter(ft, ids[j]);
+        }
+        portion.Flush();
+      }
+      catch (...)
+      {
+        exceptions[i] = current_exception();
+      }
+    });
+  }
+  for (auto & t : threads)
+    t.join();
+
+  for (auto const & e : exceptions)
+  {
+    if (e)
+      rethrow_exception(e);
+  }
+}
+
+void AddFeatureNameIndexPairs(FilesContainerR const & container,
+                              CategoriesHolder & categoriesHolder,
+                              StringsFile<FeatureIndexValue> & stringsFile, size_t threadsCount)
+{
+  feature::DataHeader const header(container);
+  ValueBuilder<FeatureIndexValue> valueBuilder;
+  AddFeatures(container, header, categoriesHolder, valueBuilder, stringsFile, threadsCount);
 }
 
+/// Writes the classic trie to |writer| (in reversed order) and the succinct trie
+/// to |succinctWriter|, when it isn't null.
 void BuildSearchIndex(FilesContainerR const & cont, CategoriesHolder const & catHolder,
-                      Writer & writer, string const & tmpFilePath)
+                      Writer & writer, Writer * succinctWriter, string const & tmpFilePath,
+                      size_t threadsCount)
 {
   {
-    FeaturesVectorTest features(cont);
-    feature::DataHeader const & header = features.GetHeader();
+    feature::DataHeader const header(cont);
 
     serial::CodingParams cp(trie::GetCodingParams(header.GetDefCodingParams()));
     ValueBuilder<SerializedFeatureInfoValue> valueBuilder(cp);
 
-    unique_ptr<SynonymsHolder> synonyms;
-    if (header.GetType() == feature::DataHeader::world)
-      synonyms.reset(new SynonymsHolder(GetPlatform().WritablePathForFile(SYNONYMS_FILE)));
+    using TStringsFile = StringsFile<SerializedFeatureInfoValue>;
+    TStringsFile names(tmpFilePath);
 
-    StringsFile<SerializedFeatureInfoValue> names(tmpFilePath);
-
-    features.GetVector().ForEach(FeatureInserter<StringsFile<SerializedFeatureInfoValue>>(
-        synonyms.get(), names, catHolder, header.GetScaleRange(), valueBuilder));
+    AddFeatures(cont, header, catHolder, valueBuilder, names, threadsCount);
 
     names.EndAdding();
-    names.OpenForRead();
-    
-    trie::Build<Writer, typename StringsFile<SerializedFeatureInfoValue>::IteratorT,
-                trie::EmptyEdgeBuilder, ValueList<SerializedFeatureInfoValue>>(
-        writer, names.Begin(), names.End(), trie::EmptyEdgeBuilder());
+    // Merge of sorted portions goes ahead of the trie writer.
+    bool const mergeConcurrently = threadsCount > 1;
+    names.OpenForRead(mergeConcurrently);
+
+    trie::Build<Writer, typename TStringsFile::IteratorT, trie::EmptyEdgeBuilder,
+                ValueList<SerializedFeatureInfoValue>>(writer, names.Begin(), names.End(),
+                                                       trie::EmptyEdgeBuilder());
+
+    if (succinctWriter)
+    {
+      // Every pass merges the sorted strings from the file again, so they aren't kept in memory.
+      auto const forEachString = [&names, mergeConcurrently](
+          function<void(TStringsFile::TString const &)> const & toDo)
+      {
+        names.OpenForRead(mergeConcurrently);
+        for (auto it = names.Begin(); it != names.End(); ++it)
+          toDo(*it);
+      };
+      trie::BuildSuccinctTrie<Writer, TStringsFile::TString, trie::EmptyEdgeBuilder,
+                              ValueList<SerializedFeatureInfoValue>>(
+          *succinctWriter, forEachString, trie::EmptyEdgeBuilder());
+    }
 
     // at this point all readers of StringsFile should be dead
   }
@@ -418,7 +544,8 @@ void BuildSearchIndex(FilesContainerR const & cont, CategoriesHolder const & cat
 }  // namespace
 
 namespace indexer {
-bool BuildSearchIndexFromDatFile(string const & datFile, bool forceRebuild)
+bool BuildSearchIndexFromDatFile(string const & datFile, bool forceRebuild, size_t threadsCount,
+                                 bool buildSuccinctIndex)
 {
   LOG(LINFO, ("Start building search index. Bits = ", search::kPointCodingBits));
 
@@ -427,6 +554,7 @@ bool BuildSearchIndexFromDatFile(string const & datFile, bool forceRebuild)
     Platform & pl = GetPlatform();
     string const tmpFile1 = datFile + ".search_index_1.tmp";
     string const tmpFile2 = datFile + ".search_index_2.tmp";
+    string const tmpFile3 = datFile + ".search_index_3.tmp";
 
     {
       FilesContainerR readCont(datFile);
@@ -435,22 +563,36 @@ bool BuildSearchIndexFromDatFile(string const & datFile, bool forceRebuild)
         return true;
 
       FileWriter writer(tmpFile2);
+      unique_ptr<FileWriter> succinctWriter;
+      if (buildSuccinctIndex)
+        succinctWriter.reset(new FileWriter(tmpFile3));
 
       CategoriesHolder catHolder(pl.GetReader(SEARCH_CATEGORIES_FILE_NAME));
 
-      BuildSearchIndex(readCont, catHolder, writer, tmpFile1);
+      BuildSearchIndex(readCont, catHolder, writer, succinctWriter.get(), tmpFile1, threadsCount);
 
       LOG(LINFO, ("Search index size = ", writer.Size()));
+      if (succinctWriter)
+        LOG(LINFO, ("Succinct search index size = ", succinctWriter->Size()));
     }
 
     {
       // Write to container in reversed order.
       FilesContainerW writeCont(datFile, FileWriter::OP_WRITE_EXISTING);
-      FileWriter writer = writeCont.GetWriter(SEARCH_INDEX_FILE_TAG);
-      rw_ops::Reverse(FileReader(tmpFile2), writer);
+      {
+        FileWriter writer = writeCont.GetWriter(SEARCH_INDEX_FILE_TAG);
+        rw_ops::Reverse(FileReader(tmpFile2), writer);
+      }
+
+      if (buildSuccinctIndex)
+        writeCont.Write(tmpFile3, SUCCINCT_SEARCH_INDEX_FILE_TAG);
+      else if (writeCont.IsExist(SUCCINCT_SEARCH_INDEX_FILE_TAG))
+        writeCont.DeleteSection(SUCCINCT_SEARCH_INDEX_FILE_TAG);  // It's built for the old strings.
     }
 
     FileWriter::DeleteFileX(tmpFile2);
+    if (buildSuccinctIndex)
+      FileWriter::DeleteFileX(tmpFile3);
   }
   catch (Reader::Exception const & e)
   {
@@ -467,7 +609,7 @@ bool BuildSearchIndexFromDatFile(string const & datFile, bool forceRebuild)
   return true;
 }
 
-bool AddCompresedSearchIndexSection(string const & fName, bool forceRebuild)
+bool AddCompresedSearchIndexSection(string const & fName, bool forceRebuild, size_t threadsCount)
 {
   Platform & platform = GetPlatform();
 
@@ -482,7 +624,7 @@ bool AddCompresedSearchIndexSection(string const & fName, bool forceRebuild)
   {
     {
       FileWriter indexWriter(indexFile);
-      BuildCompressedSearchIndex(readContainer, indexWriter);
+      BuildCompressedSearchIndex(readContainer, indexWriter, threadsCount);
     }
     {
       FilesContainerW writeContainer(readContainer.GetFileName(), FileWriter::OP_WRITE_EXISTING);
@@ -504,7 +646,8 @@ bool AddCompresedSearchIndexSection(string const & fName, bool forceRebuild)
   return true;
 }
 
-void BuildCompressedSearchIndex(FilesContainerR & container, Writer & indexWriter)
+void BuildCompressedSearchIndex(FilesContainerR & container, Writer & indexWriter,
+                                size_t threadsCount)
 {
   Platform & platform = GetPlatform();
 
@@ -517,13 +660,13 @@ void BuildCompressedSearchIndex(FilesContainerR & container, Writer & indexWrite
 
   CategoriesHolder categoriesHolder(platform.GetReader(SEARCH_CATEGORIES_FILE_NAME));
 
-  AddFeatureNameIndexPairs(container, categoriesHolder, stringsFile);
+  AddFeatureNameIndexPairs(container, categoriesHolder, stringsFile, threadsCount);
 
   stringsFile.EndAdding();
 
   LOG(LINFO, ("End sorting strings:", timer.ElapsedSeconds()));
 
-  stringsFile.OpenForRead();
+  stringsFile.OpenForRead(threadsCount > 1 /* mergeConcurrently */);
   trie::Build<Writer, typename StringsFile<FeatureIndexValue>::IteratorT, trie::EmptyEdgeBuilder,
               ValueList<FeatureIndexValue>>(indexWriter, stringsFile.Begin(), stringsFile.End(),
                                             trie::EmptyEdgeBuilder());
@@ -531,9 +674,9 @@ void BuildCompressedSearchIndex(FilesContainerR & container, Writer & indexWrite
   LOG(LINFO, ("End building compressed search index, elapsed seconds:", timer.ElapsedSeconds()));
 }
 
-void BuildCompressedSearchIndex(string const & fName, Writer & indexWriter)
+void BuildCompressedSearchIndex(string const & fName, Writer & indexWriter, size_t threadsCount)
 {
   FilesContainerR container(GetPlatform().GetReader(fName));
-  BuildCompressedSearchIndex(container, indexWriter);
+  BuildCompressedSearchIndex(container, indexWriter, threadsCount);
 }
 }  // namespace indexer
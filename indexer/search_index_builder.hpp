@@ -1,5 +1,6 @@
 #pragma once
 
+#include "std/cstdint.hpp"
 #include "std/string.hpp"
 
 class FilesContainerR;
@@ -7,11 +8,19 @@ class Writer;
 
 namespace indexer
 {
-bool BuildSearchIndexFromDatFile(string const & fName, bool forceRebuild = false);
+/// @param threadsCount Number of threads tokenizing and sorting feature names.
+///                     Values greater than 1 require a standalone (not packed) file.
+/// @param buildSuccinctIndex Also writes the succinct trie section, which search prefers
+///                           to the classic one, but which makes mwm bigger.
+bool BuildSearchIndexFromDatFile(string const & fName, bool forceRebuild = false,
+                                 size_t threadsCount = 1, bool buildSuccinctIndex = false);
 
-bool AddCompresedSearchIndexSection(string const & fName, bool forceRebuild);
+bool AddCompresedSearchIndexSection(string const & fName, bool forceRebuild,
+                                    size_t threadsCount = 1);
 
-void BuildCompressedSearchIndex(FilesContainerR & container, Writer & indexWriter);
+void BuildCompressedSearchIndex(FilesContainerR & container, Writer & indexWriter,
+                                size_t threadsCount = 1);
 
-void BuildCompressedSearchIndex(string const & fName, Writer & indexWriter);
+void BuildCompressedSearchIndex(string const & fName, Writer & indexWriter,
+                                size_t threadsCount = 1);
 }  // namespace indexer
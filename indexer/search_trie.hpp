@@ -2,10 +2,14 @@
 
 #include "indexer/geometry_serialization.hpp"
 
+#include "coding/file_container.hpp"
 #include "coding/reader.hpp"
+#include "coding/succinct_trie_reader.hpp"
 #include "coding/trie.hpp"
 #include "coding/trie_reader.hpp"
 
+#include "defines.hpp"
+
 
 namespace search
 {
@@ -58,4 +62,27 @@ inline serial::CodingParams GetCodingParams(serial::CodingParams const & orig)
                               PointU2PointD(orig.GetBasePoint(), orig.GetCoordBits()));
 }
 
+using TSuccinctTrie = SuccinctTrie<ValueReader>;
+using TSuccinctIterator = TSuccinctTrie::TIterator;
+
+/// Succinct search trie of a standalone mwm file. The section is memory-mapped
+/// and stays mapped while the object lives, so queries navigate the trie in place.
+class MappedSearchTrie
+{
+public:
+  MappedSearchTrie(FilesMappingContainer const & cont, serial::CodingParams const & cp)
+    : m_cp(cp)
+    , m_handle(cont.Map(SUCCINCT_SEARCH_INDEX_FILE_TAG))
+    , m_trie(m_handle.GetData<uint8_t>(), m_handle.GetSize(), ValueReader(m_cp))
+  {
+  }
+
+  TSuccinctIterator GetRoot() const { return m_trie.GetRoot(); }
+
+private:
+  serial::CodingParams const m_cp;
+  FilesMappingContainer::Handle m_handle;
+  TSuccinctTrie m_trie;
+};
+
 }  // namespace trie
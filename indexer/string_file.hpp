@@ -9,9 +9,14 @@
 #include "base/worker_thread.hpp"
 
 #include "coding/read_write_utils.hpp"
+#include "std/condition_variable.hpp"
+#include "std/deque.hpp"
+#include "std/exception.hpp"
 #include "std/iterator_facade.hpp"
+#include "std/mutex.hpp"
 #include "std/queue.hpp"
 #include "std/functional.hpp"
+#include "std/thread.hpp"
 #include "std/unique_ptr.hpp"
 
 template <typename TValue>
@@ -107,8 +112,11 @@ public:
     ///                to the list.
     /// \param strings Vector of strings that should be sorted. Internal data is moved out from
     ///                strings, so it'll become empty after ctor.
-    SortAndDumpStringsTask(FileWriter & writer, OffsetsListT & offsets, StringsListT & strings)
-        : m_writer(writer), m_offsets(offsets)
+    /// \param writerMutex A mutex that guards writer and offsets when several
+    ///                    tasks are run concurrently.
+    SortAndDumpStringsTask(FileWriter & writer, OffsetsListT & offsets, StringsListT & strings,
+                           mutex & writerMutex)
+        : m_writer(writer), m_offsets(offsets), m_writerMutex(writerMutex)
     {
       strings.swap(m_strings);
     }
@@ -129,6 +137,7 @@ public:
                      });
       }
 
+      lock_guard<mutex> guard(m_writerMutex);
       uint64_t const spos = m_writer.Pos();
       m_writer.Write(memBuffer.data(), memBuffer.size());
       uint64_t const epos = m_writer.Pos();
@@ -139,6 +148,7 @@ public:
   private:
     FileWriter & m_writer;
     OffsetsListT & m_offsets;
+    mutex & m_writerMutex;
     StringsListT m_strings;
 
     DISALLOW_COPY_AND_MOVE(SortAndDumpStringsTask);
@@ -165,14 +175,28 @@ public:
     void increment();
   };
 
+  /// Max number of strings, which are sorted in memory at once.
+  static size_t constexpr kMaxStringsInPortion = 1000000;
+
   StringsFile(string const & fPath);
+  ~StringsFile();
 
   void EndAdding();
-  void OpenForRead();
+  /// Starts reading of the sorted strings. Can be called again to read them once more,
+  /// then the portions are merged from the beginning and the previous reading is finished.
+  /// \param mergeConcurrently When true, sorted portions are merged on a separate
+  ///                          thread ahead of the iterator.
+  void OpenForRead(bool mergeConcurrently = false);
 
   /// @precondition Should be opened for writing.
   void AddString(TString const & s);
 
+  /// Sorts strings on the calling thread and writes them as a separate portion.
+  /// Strings become empty after the call. Can be called from several threads
+  /// at once, but not together with AddString.
+  /// @precondition Should be opened for writing.
+  void AddStrings(StringsListT & strings);
+
   IteratorT Begin() { return IteratorT(*this, false); }
   IteratorT End() { return IteratorT(*this, true); }
 
@@ -183,14 +207,24 @@ private:
   void Flush();
   bool PushNextValue(size_t i);
 
+  bool IsMergeEnd();
+  TString const & GetMergeTop();
+  void PopMergeTop();
+
+  void MergeLoop();
+  void StopMerge();
+
   StringsListT m_strings;
   OffsetsListT m_offsets;
+  // Positions of the next strings of the portions for the merge.
+  vector<uint64_t> m_positions;
 
   // A worker thread that sorts and writes groups of strings.  The
   // whole process looks like a pipeline, i.e. main thread accumulates
   // strings while worker thread sequentially sorts and stores groups
   // of strings on a disk.
   my::WorkerThread<SortAndDumpStringsTask> m_workerThread;
+  mutex m_writerMutex;
 
   struct QValue
   {
@@ -203,42 +237,62 @@ private:
   };
 
   priority_queue<QValue, vector<QValue>, greater<QValue>> m_queue;
+
+  // Concurrent merge: m_mergeThread pops strings from m_queue and passes them
+  // to the iterator in blocks.
+  thread m_mergeThread;
+  StringsListT m_block;
+  size_t m_blockPos = 0;
+
+  // Guards the fields below.
+  mutex m_blocksMutex;
+  condition_variable m_blocksCond;
+  deque<StringsListT> m_blocks;
+  exception_ptr m_mergeException;
+  bool m_mergeFinished = false;
+  bool m_stopMerge = false;
 };
 
+template <typename ValueT>
+size_t constexpr StringsFile<ValueT>::kMaxStringsInPortion;
+
 template <typename ValueT>
 void StringsFile<ValueT>::AddString(TString const & s)
 {
-  size_t const kMaxSize = 1000000;
-
-  if (m_strings.size() >= kMaxSize)
+  if (m_strings.size() >= kMaxStringsInPortion)
     Flush();
 
   m_strings.push_back(s);
 }
 
+template <typename ValueT>
+void StringsFile<ValueT>::AddStrings(StringsListT & strings)
+{
+  if (strings.empty())
+    return;
+  SortAndDumpStringsTask task(*m_writer, m_offsets, strings, m_writerMutex);
+  task();
+}
+
 template <typename ValueT>
 bool StringsFile<ValueT>::IteratorT::IsEnd() const
 {
-  return m_file.m_queue.empty();
+  return m_file.IsMergeEnd();
 }
 
 template <typename ValueT>
 typename StringsFile<ValueT>::TString StringsFile<ValueT>::IteratorT::dereference() const
 {
   ASSERT(IsValid(), ());
-  return m_file.m_queue.top().m_string;
+  return m_file.GetMergeTop();
 }
 
 template <typename ValueT>
 void StringsFile<ValueT>::IteratorT::increment()
 {
   ASSERT(IsValid(), ());
-  int const index = m_file.m_queue.top().m_index;
-
-  m_file.m_queue.pop();
-
-  if (!m_file.PushNextValue(index))
-    m_end = IsEnd();
+  m_file.PopMergeTop();
+  m_end = IsEnd();
 }
 
 template <typename ValueT>
@@ -248,11 +302,31 @@ StringsFile<ValueT>::StringsFile(string const & fPath)
   m_writer.reset(new FileWriter(fPath));
 }
 
+template <typename ValueT>
+StringsFile<ValueT>::~StringsFile()
+{
+  StopMerge();
+}
+
+template <typename ValueT>
+void StringsFile<ValueT>::StopMerge()
+{
+  if (m_mergeThread.joinable())
+  {
+    {
+      lock_guard<mutex> guard(m_blocksMutex);
+      m_stopMerge = true;
+    }
+    m_blocksCond.notify_all();
+    m_mergeThread.join();
+  }
+}
+
 template <typename ValueT>
 void StringsFile<ValueT>::Flush()
 {
   shared_ptr<SortAndDumpStringsTask> task(
-      new SortAndDumpStringsTask(*m_writer, m_offsets, m_strings));
+      new SortAndDumpStringsTask(*m_writer, m_offsets, m_strings, m_writerMutex));
   m_workerThread.Push(task);
 }
 
@@ -260,19 +334,19 @@ template <typename ValueT>
 bool StringsFile<ValueT>::PushNextValue(size_t i)
 {
   // reach the end of the portion file
-  if (m_offsets[i].first >= m_offsets[i].second)
+  if (m_positions[i] >= m_offsets[i].second)
     return false;
 
   // init source to needed offset
   ReaderSource<FileReader> src(*m_reader);
-  src.Skip(m_offsets[i].first);
+  src.Skip(m_positions[i]);
 
   // read string
   TString s;
   s.Read(src);
 
   // update offset
-  m_offsets[i].first = src.Pos();
+  m_positions[i] = src.Pos();
 
   // push value to queue
   m_queue.push(QValue(s, i));
@@ -290,13 +364,121 @@ void StringsFile<ValueT>::EndAdding()
 }
 
 template <typename ValueT>
-void StringsFile<ValueT>::OpenForRead()
+void StringsFile<ValueT>::OpenForRead(bool mergeConcurrently)
 {
-  string const fPath = m_writer->GetName();
-  m_writer.reset();
+  if (m_writer)
+  {
+    string const fPath = m_writer->GetName();
+    m_writer.reset();
 
-  m_reader.reset(new FileReader(fPath));
+    m_reader.reset(new FileReader(fPath));
+  }
+  else
+  {
+    // Reading once more.
+    StopMerge();
+    m_queue = decltype(m_queue)();
+    m_block.clear();
+    m_blockPos = 0;
+    m_blocks.clear();
+    m_mergeException = exception_ptr();
+    m_mergeFinished = false;
+    m_stopMerge = false;
+  }
+
+  m_positions.clear();
+  for (auto const & offsets : m_offsets)
+    m_positions.push_back(offsets.first);
 
   for (size_t i = 0; i < m_offsets.size(); ++i)
     PushNextValue(i);
+
+  if (mergeConcurrently)
+    m_mergeThread = thread(&StringsFile::MergeLoop, this);
+}
+
+template <typename ValueT>
+void StringsFile<ValueT>::MergeLoop()
+{
+  size_t const kBlockSize = 4096;
+  size_t const kMaxBlocks = 16;
+
+  try
+  {
+    StringsListT block;
+    while (!m_queue.empty())
+    {
+      QValue const & top = m_queue.top();
+      size_t const index = top.m_index;
+      block.push_back(top.m_string);
+      m_queue.pop();
+      PushNextValue(index);
+
+      if (block.size() < kBlockSize && !m_queue.empty())
+        continue;
+
+      unique_lock<mutex> lock(m_blocksMutex);
+      m_blocksCond.wait(lock, [this]() { return m_stopMerge || m_blocks.size() < kMaxBlocks; });
+      if (m_stopMerge)
+        return;
+      m_blocks.push_back(move(block));
+      block.clear();
+      m_blocksCond.notify_all();
+    }
+  }
+  catch (...)
+  {
+    lock_guard<mutex> guard(m_blocksMutex);
+    m_mergeException = current_exception();
+  }
+
+  lock_guard<mutex> guard(m_blocksMutex);
+  m_mergeFinished = true;
+  m_blocksCond.notify_all();
+}
+
+template <typename ValueT>
+bool StringsFile<ValueT>::IsMergeEnd()
+{
+  if (!m_mergeThread.joinable())
+    return m_queue.empty();
+
+  if (m_blockPos < m_block.size())
+    return false;
+
+  unique_lock<mutex> lock(m_blocksMutex);
+  m_blocksCond.wait(lock, [this]() { return m_mergeFinished || !m_blocks.empty(); });
+  if (m_blocks.empty())
+  {
+    if (m_mergeException)
+      rethrow_exception(m_mergeException);
+    return true;
+  }
+  m_block = move(m_blocks.front());
+  m_blocks.pop_front();
+  m_blockPos = 0;
+  m_blocksCond.notify_all();
+  return false;
+}
+
+template <typename ValueT>
+typename StringsFile<ValueT>::TString const & StringsFile<ValueT>::GetMergeTop()
+{
+  if (!m_mergeThread.joinable())
+    return m_queue.top().m_string;
+  return m_block[m_blockPos];
+}
+
+template <typename ValueT>
+void StringsFile<ValueT>::PopMergeTop()
+{
+  if (m_mergeThread.joinable())
+  {
+    ++m_blockPos;
+    return;
+  }
+
+  size_t const index = m_queue.top().m_index;
+  m_queue.pop();
+  PushNextValue(index);
 }
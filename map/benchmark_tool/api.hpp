@@ -43,4 +43,8 @@ namespace bench
 
   /// @param[in] count number of times to run benchmark
   void RunFeaturesLoadingBenchmark(string const & file, pair<int, int> scaleR, AllResult & res);
+
+  /// Compares token matching in the classic and the succinct search tries of the mwm.
+  /// @param[in] tokens space-separated tokens to match
+  void RunSearchTrieBenchmark(string const & file, string const & tokens);
 }
@@ -6,7 +6,7 @@ CONFIG -= app_bundle
 TEMPLATE = app
 
 ROOT_DIR = ../..
-DEPENDENCIES = map indexer platform geometry coding base gflags protobuf tomcrypt
+DEPENDENCIES = map search indexer platform geometry coding base gflags protobuf tomcrypt
 
 include($$ROOT_DIR/common.pri)
 
@@ -17,6 +17,7 @@ QT *= core
 SOURCES += \
     features_loading.cpp \
     main.cpp \
+    search_trie.cpp \
     api.cpp \
 
 HEADERS += \
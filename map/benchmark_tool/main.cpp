@@ -12,6 +12,8 @@ DEFINE_string(input, "", "MWM file name in the data directory");
 DEFINE_int32(lowS, 10, "Low processing scale");
 DEFINE_int32(highS, 17, "High processing scale");
 DEFINE_bool(print_scales, false, "Print geometry scales for MWM and exit");
+DEFINE_bool(search_trie, false, "Benchmark token matching in the search index tries of MWM and exit");
+DEFINE_string(tokens, "cafe bank street school park", "Space-separated tokens for the search trie benchmark");
 
 
 int main(int argc, char ** argv)
@@ -37,6 +39,12 @@ int main(int argc, char ** argv)
     return 0;
   }
 
+  if (FLAGS_search_trie)
+  {
+    bench::RunSearchTrieBenchmark(FLAGS_input, FLAGS_tokens);
+    return 0;
+  }
+
   if (!FLAGS_input.empty())
   {
     using namespace bench;
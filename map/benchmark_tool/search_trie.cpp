@@ -0,0 +1,146 @@
+#include "map/benchmark_tool/api.hpp"
+
+#include "search/feature_offset_match.hpp"
+
+#include "indexer/data_header.hpp"
+#include "indexer/search_string_utils.hpp"
+#include "indexer/search_trie.hpp"
+
+#include "platform/local_country_file.hpp"
+
+#include "coding/file_container.hpp"
+#include "coding/file_name_utils.hpp"
+#include "coding/reader_wrapper.hpp"
+
+#include "base/string_utils.hpp"
+#include "base/timer.hpp"
+
+#include "std/iomanip.hpp"
+#include "std/iostream.hpp"
+
+
+namespace bench
+{
+
+namespace
+{
+  size_t const kIterations = 10;
+
+  class Counter
+  {
+    size_t & m_count;
+
+  public:
+    Counter(size_t & count) : m_count(count) {}
+
+    void operator() (trie::ValueReader::ValueType const &) { ++m_count; }
+  };
+
+  template <class TMatch>
+  void RunMatch(char const * name, vector<search::TrieRootPrefix> const & roots,
+                vector<strings::UniString> const & tokens, TMatch const & match)
+  {
+    size_t count = 0;
+    Counter counter(count);
+
+    my::Timer timer;
+    for (size_t i = 0; i < kIterations; ++i)
+    {
+      for (auto const & token : tokens)
+      {
+        search::SearchQueryParams::TSynonymsVector const syns(1, token);
+        for (auto const & root : roots)
+          match(syns, root, counter);
+      }
+    }
+    double const seconds = timer.ElapsedSeconds();
+
+    cout << fixed << setprecision(6) << name << "[ total:" << seconds
+         << " per token*1000:" << seconds * 1000 / (kIterations * tokens.size())
+         << " values:" << count / kIterations << " ]" << endl;
+  }
+
+  void RunMatches(char const * name, vector<search::TrieRootPrefix> const & roots,
+                  vector<strings::UniString> const & tokens)
+  {
+    using TSyns = search::SearchQueryParams::TSynonymsVector;
+
+    cout << name << endl;
+    RunMatch("  FULL   ", roots, tokens,
+             [](TSyns const & syns, search::TrieRootPrefix const & root, Counter & counter)
+             {
+               search::MatchTokenInTrie(syns, root, counter);
+             });
+    RunMatch("  PREFIX ", roots, tokens,
+             [](TSyns const & syns, search::TrieRootPrefix const & root, Counter & counter)
+             {
+               search::MatchTokenPrefixInTrie(syns, root, counter);
+             });
+    RunMatch("  TYPOS  ", roots, tokens,
+             [](TSyns const & syns, search::TrieRootPrefix const & root, Counter & counter)
+             {
+               search::MatchTokenInTrieWithTypos(syns, root, false /* isPrefix */, counter);
+             });
+  }
+}
+
+void RunSearchTrieBenchmark(string const & file, string const & tokens)
+{
+  string fileName = file;
+  my::GetNameFromFullPath(fileName);
+  my::GetNameWithoutExt(fileName);
+
+  string const path = platform::LocalCountryFile::MakeForTesting(fileName).GetPath(MapOptions::Map);
+
+  FilesContainerR cont(path);
+  if (!cont.IsExist(SEARCH_INDEX_FILE_TAG) || !cont.IsExist(SUCCINCT_SEARCH_INDEX_FILE_TAG))
+  {
+    cout << "No search index sections in " << path << endl;
+    return;
+  }
+
+  feature::DataHeader const header(cont);
+  serial::CodingParams const cp(trie::GetCodingParams(header.GetDefCodingParams()));
+
+  vector<strings::UniString> tokensList;
+  for (strings::SimpleTokenizer iter(tokens, " "); iter; ++iter)
+    tokensList.push_back(search::NormalizeAndSimplifyString(*iter));
+  if (tokensList.empty())
+    return;
+
+  // Classic trie: the root is decoded from the section and every step
+  // down the trie reads and allocates a node.
+  {
+    unique_ptr<trie::DefaultIterator> const root(
+        trie::ReadTrie(SubReaderWrapper<Reader>(cont.GetReader(SEARCH_INDEX_FILE_TAG).GetPtr()),
+                       trie::ValueReader(cp), trie::TEdgeValueReader()));
+
+    vector<unique_ptr<trie::DefaultIterator>> langRoots;
+    vector<search::TrieRootPrefix> roots;
+    for (size_t i = 0; i < root->m_edge.size(); ++i)
+    {
+      auto const & edge = root->m_edge[i].m_str;
+      if (edge[0] >= search::kCategoriesLang)
+        continue;
+      langRoots.emplace_back(root->GoToEdge(i));
+      roots.emplace_back(*langRoots.back(), edge);
+    }
+    RunMatches("CLASSIC", roots, tokensList);
+  }
+
+  // Succinct trie: the section is mapped and navigated in place.
+  {
+    trie::MappedSearchTrie const trie(FilesMappingContainer(path), cp);
+
+    vector<search::TrieRootPrefix> roots;
+    for (uint32_t lang = 0; lang < search::kCategoriesLang; ++lang)
+    {
+      trie::TSuccinctIterator langRoot = trie.GetRoot();
+      if (langRoot.GoToSymbol(lang))
+        roots.emplace_back(langRoot);
+    }
+    RunMatches("SUCCINCT", roots, tokensList);
+  }
+}
+
+}
@@ -102,6 +102,8 @@ namespace
   static const int BM_TOUCH_PIXEL_INCREASE = 20;
   static const int kKeepPedestrianDistanceMeters = 10000;
   char const kRouterTypeKey[] = "router";
+  // Contraction hierarchies don't find routes across mwm borders yet, so they are opt-in.
+  char const kPedestrianHierarchyKey[] = "PedestrianContractionHierarchy";
 }
 
 pair<MwmSet::MwmId, MwmSet::RegResult> Framework::RegisterMap(
@@ -2208,7 +2210,12 @@ void Framework::SetRouterImpl(RouterType type)
 
   if (type == RouterType::Pedestrian)
   {
-    router = CreatePedestrianAStarBidirectionalRouter(m_model.GetIndex(), countryFileGetter);
+    bool useHierarchy = false;
+    (void)Settings::Get(kPedestrianHierarchyKey, useHierarchy);
+    if (useHierarchy)
+      router = CreatePedestrianContractionHierarchyRouter(m_model.GetIndex(), countryFileGetter);
+    else
+      router = CreatePedestrianAStarBidirectionalRouter(m_model.GetIndex(), countryFileGetter);
     m_routingSession.SetRoutingSettings(routing::GetPedestrianRoutingSettings());
   }
   else
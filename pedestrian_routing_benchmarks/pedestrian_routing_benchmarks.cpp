@@ -76,6 +76,15 @@ unique_ptr<routing::IRouter> CreatePedestrianAStarBidirectionalTestRouter(Index
   return router;
 }
 
+unique_ptr<routing::IRouter> CreatePedestrianAStarBidirectionalParallelTestRouter(Index & index)
+{
+  auto UKGetter = [](m2::PointD const & /* point */){return "UK_England";};
+  unique_ptr<routing::IVehicleModelFactory> vehicleModelFactory(new SimplifiedPedestrianModelFactory());
+  unique_ptr<routing::IRoutingAlgorithm> algorithm(new routing::AStarBidirectionalParallelRoutingAlgorithm());
+  unique_ptr<routing::IRouter> router(new routing::RoadGraphRouter("test-astar-bidirectional-parallel-pedestrian", index, UKGetter, move(vehicleModelFactory), move(algorithm), nullptr));
+  return router;
+}
+
 m2::PointD GetPointOnEdge(routing::Edge & e, double posAlong)
 {
   if (posAlong <= 0.0)
@@ -117,6 +126,11 @@ void TestRouters(Index & index, m2::PointD const & startPos, m2::PointD const &
   unique_ptr<routing::IRouter> router = CreatePedestrianAStarBidirectionalTestRouter(index);
   TestRouter(*router, startPos, finalPos, routeFoundByAstarBidirectional);
 
+  // find route by parallel A*-bidirectional algorithm
+  routing::Route routeFoundByAstarBidirectionalParallel("");
+  router = CreatePedestrianAStarBidirectionalParallelTestRouter(index);
+  TestRouter(*router, startPos, finalPos, routeFoundByAstarBidirectionalParallel);
+
   // find route by A* algorithm
   routing::Route routeFoundByAstar("");
   router = CreatePedestrianAStarTestRouter(index);
@@ -126,6 +140,22 @@ void TestRouters(Index & index, m2::PointD const & startPos, m2::PointD const &
   double constexpr kEpsilon = 1e-6;
   TEST(my::AlmostEqualAbs(routeFoundByAstar.GetTotalDistanceMeters(),
                           routeFoundByAstarBidirectional.GetTotalDistanceMeters(), kEpsilon), ());
+  TEST(my::AlmostEqualAbs(routeFoundByAstar.GetTotalDistanceMeters(),
+                          routeFoundByAstarBidirectionalParallel.GetTotalDistanceMeters(), kEpsilon), ());
+
+  // Contraction hierarchies are built with the real pedestrian model, so the found route
+  // is compared with the route found by A*-bidirectional algorithm with the same model.
+  auto UKGetter = [](m2::PointD const & /* point */){return "UK_England";};
+  routing::Route routeFoundByAstarBidirectionalWithSections("");
+  router = routing::CreatePedestrianAStarBidirectionalRouter(index, UKGetter);
+  TestRouter(*router, startPos, finalPos, routeFoundByAstarBidirectionalWithSections);
+
+  routing::Route routeFoundByContractionHierarchy("");
+  router = routing::CreatePedestrianContractionHierarchyRouter(index, UKGetter);
+  TestRouter(*router, startPos, finalPos, routeFoundByContractionHierarchy);
+
+  TEST(my::AlmostEqualAbs(routeFoundByAstarBidirectionalWithSections.GetTotalDistanceMeters(),
+                          routeFoundByContractionHierarchy.GetTotalDistanceMeters(), kEpsilon), ());
 }
 
 void TestTwoPointsOnFeature(m2::PointD const & startPos, m2::PointD const & finalPos)
@@ -2,16 +2,47 @@
 
 #include "base/assert.hpp"
 #include "base/cancellable.hpp"
+#include "base/indexed_heap.hpp"
 #include "std/algorithm.hpp"
+#include "std/atomic.hpp"
+#include "std/exception.hpp"
 #include "std/functional.hpp"
 #include "std/iostream.hpp"
+#include "std/limits.hpp"
 #include "std/map.hpp"
+#include "std/mutex.hpp"
 #include "std/queue.hpp"
+#include "std/thread.hpp"
+#include "std/type_traits.hpp"
+#include "std/utility.hpp"
 #include "std/vector.hpp"
 
 namespace routing
 {
 
+// Graphs which number their vertices compactly define
+//   uint32_t GetVerticesCount() const;
+//   uint32_t GetVertexIndex(TVertexType const & v) const; // in [0, GetVerticesCount())
+// and AStarAlgorithm keeps their per-vertex state in flat arrays.
+// Every query allocates the arrays for all GetVerticesCount() vertices, so this
+// pays off for graphs whose searches settle a noticeable part of them.
+// Only test graphs implement it for now: the pedestrian RoadGraph has Junction
+// vertices of several mwms and fake vertices of route ends, and RoadGraphSection
+// junction ids are local to one mwm.
+template <typename TGraph>
+class HasDenseVertexIndex
+{
+  template <typename T>
+  static auto Check(T const * graph)
+      -> decltype(graph->GetVertexIndex(declval<typename T::TVertexType>()),
+                  graph->GetVerticesCount(), true_type());
+  template <typename T>
+  static false_type Check(...);
+
+public:
+  static bool constexpr value = decltype(Check<TGraph>(nullptr))::value;
+};
+
 template <typename TGraph>
 class AStarAlgorithm
 {
@@ -20,6 +51,11 @@ public:
   using TVertexType = typename TGraphType::TVertexType;
   using TEdgeType = typename TGraphType::TEdgeType;
 
+  // When true, best distances and parents are kept in flat arrays indexed by
+  // vertex index and vertices are queued in an indexed d-ary heap with
+  // decrease-key. Otherwise maps and a priority queue with lazy deletion are used.
+  static bool constexpr kDenseMode = HasDenseVertexIndex<TGraph>::value;
+
   enum class Result
   {
     OK,
@@ -58,6 +94,17 @@ public:
                                my::Cancellable const & cancellable = my::Cancellable(),
                                TOnVisitedVertexCallback onVisitedVertexCallback = nullptr) const;
 
+  /// The same as FindPathBidirectional, but the backward search runs on a separate
+  /// thread concurrently with the forward one. Const methods of the graph must be
+  /// safe to call from several threads. onVisitedVertexCallback is called for
+  /// the forward search only, i.e. on the calling thread.
+  Result FindPathBidirectionalParallel(TGraphType const & graph,
+                                       TVertexType const & startVertex,
+                                       TVertexType const & finalVertex,
+                                       vector<TVertexType> & path,
+                                       my::Cancellable const & cancellable = my::Cancellable(),
+                                       TOnVisitedVertexCallback onVisitedVertexCallback = nullptr) const;
+
 private:
   // Periodicy of checking is cancellable cancelled.
   static uint32_t constexpr kCancelledPollPeriod = 128;
@@ -83,6 +130,145 @@ private:
     double distance;
   };
 
+  // Per-vertex state of a search in one direction: best known reduced
+  // distances, parents and the queue of vertices to visit.
+  // It's used for arbitrary vertices.
+  class MapVertexState
+  {
+  public:
+    explicit MapVertexState(TGraphType const & /* graph */) {}
+
+    void Start(TVertexType const & v)
+    {
+      m_bestDistance[v] = 0.0;
+      m_queue.push(State(v, 0.0 /* distance */));
+    }
+
+    inline bool IsQueueEmpty() const { return m_queue.empty(); }
+
+    // Distance of the nearest queued vertex.
+    double TopDistance() const
+    {
+      ASSERT(!m_queue.empty(), ());
+      return m_bestDistance.at(m_queue.top().vertex);
+    }
+
+    // Pops the nearest queued vertex.
+    // Returns false if it's an outdated duplicate, which should be skipped.
+    bool PopNearest(State & state)
+    {
+      state = m_queue.top();
+      m_queue.pop();
+      return state.distance <= m_bestDistance.at(state.vertex);
+    }
+
+    bool GetBestDistance(TVertexType const & v, double & distance) const
+    {
+      auto const it = m_bestDistance.find(v);
+      if (it == m_bestDistance.end())
+        return false;
+      distance = it->second;
+      return true;
+    }
+
+    void Relax(TVertexType const & v, double distance, TVertexType const & parent)
+    {
+      m_bestDistance[v] = distance;
+      m_parent[v] = parent;
+      m_queue.push(State(v, distance));
+    }
+
+    void ReconstructPath(TVertexType const & v, vector<TVertexType> & path) const
+    {
+      path.clear();
+      TVertexType cur = v;
+      while (true)
+      {
+        path.push_back(cur);
+        auto it = m_parent.find(cur);
+        if (it == m_parent.end())
+          break;
+        cur = it->second;
+      }
+      reverse(path.begin(), path.end());
+    }
+
+  private:
+    priority_queue<State, vector<State>, greater<State>> m_queue;
+    map<TVertexType, double> m_bestDistance;
+    map<TVertexType, TVertexType> m_parent;
+  };
+
+  // The same as MapVertexState for graphs with dense vertex indexes (see HasDenseVertexIndex).
+  class DenseVertexState
+  {
+  public:
+    explicit DenseVertexState(TGraphType const & graph)
+      : m_graph(graph)
+      , m_queue(graph.GetVerticesCount())
+      , m_bestDistance(graph.GetVerticesCount(), kUnreached)
+      , m_parent(graph.GetVerticesCount(), kNoParent)
+      , m_vertices(graph.GetVerticesCount())
+    {
+    }
+
+    void Start(TVertexType const & v)
+    {
+      uint32_t const id = m_graph.GetVertexIndex(v);
+      m_bestDistance[id] = 0.0;
+      m_vertices[id] = v;
+      m_queue.PushOrDecrease(id, 0.0 /* distance */);
+    }
+
+    inline bool IsQueueEmpty() const { return m_queue.Empty(); }
+
+    double TopDistance() const { return m_queue.TopPriority(); }
+
+    // Decrease-key keeps only one entry per vertex in the queue, so it's never outdated.
+    bool PopNearest(State & state)
+    {
+      uint32_t const id = m_queue.TopId();
+      state = State(m_vertices[id], m_queue.TopPriority());
+      m_queue.Pop();
+      return true;
+    }
+
+    bool GetBestDistance(TVertexType const & v, double & distance) const
+    {
+      distance = m_bestDistance[m_graph.GetVertexIndex(v)];
+      return distance != kUnreached;
+    }
+
+    void Relax(TVertexType const & v, double distance, TVertexType const & parent)
+    {
+      uint32_t const id = m_graph.GetVertexIndex(v);
+      m_bestDistance[id] = distance;
+      m_parent[id] = m_graph.GetVertexIndex(parent);
+      m_vertices[id] = v;
+      m_queue.PushOrDecrease(id, distance);
+    }
+
+    void ReconstructPath(TVertexType const & v, vector<TVertexType> & path) const
+    {
+      path.clear();
+      for (uint32_t id = m_graph.GetVertexIndex(v); id != kNoParent; id = m_parent[id])
+        path.push_back(m_vertices[id]);
+      reverse(path.begin(), path.end());
+    }
+
+  private:
+    static uint32_t constexpr kNoParent = numeric_limits<uint32_t>::max();
+    static double constexpr kUnreached = numeric_limits<double>::max();
+
+    TGraphType const & m_graph;
+    my::IndexedHeap<double> m_queue;
+    vector<double> m_bestDistance;
+    vector<uint32_t> m_parent;
+    vector<TVertexType> m_vertices;
+  };
+
+  using TVertexState = typename conditional<kDenseMode, DenseVertexState, MapVertexState>::type;
+
   // BidirectionalStepContext keeps all the information that is needed to
   // search starting from one of the two directions. Its main
   // purpose is to make the code that changes directions more readable.
@@ -90,18 +276,13 @@ private:
   {
     BidirectionalStepContext(bool forward, TVertexType const & startVertex,
                              TVertexType const & finalVertex, TGraphType const & graph)
-        : forward(forward), startVertex(startVertex), finalVertex(finalVertex), graph(graph)
+        : forward(forward), startVertex(startVertex), finalVertex(finalVertex), graph(graph),
+          state(graph)
     {
       bestVertex = forward ? startVertex : finalVertex;
       pS = ConsistentHeuristic(bestVertex);
     }
 
-    double TopDistance() const
-    {
-      ASSERT(!queue.empty(), ());
-      return bestDistance.at(queue.top().vertex);
-    }
-
     // p_f(v) = 0.5*(π_f(v) - π_r(v)) + 0.5*π_r(t)
     // p_r(v) = 0.5*(π_r(v) - π_f(v)) + 0.5*π_f(s)
     // p_r(v) + p_f(v) = const. Note: this condition is called consistence.
@@ -138,22 +319,63 @@ private:
     TVertexType const & finalVertex;
     TGraph const & graph;
 
-    priority_queue<State, vector<State>, greater<State>> queue;
-    map<TVertexType, double> bestDistance;
-    map<TVertexType, TVertexType> parent;
+    TVertexState state;
     TVertexType bestVertex;
 
     double pS;
   };
 
-  static void ReconstructPath(TVertexType const & v, map<TVertexType, TVertexType> const & parent,
-                              vector<TVertexType> & path);
+  // A search direction of FindPathBidirectionalParallel.
+  struct ParallelStepContext : public BidirectionalStepContext
+  {
+    using BidirectionalStepContext::BidirectionalStepContext;
+
+    // Reduced distance of the last vertex taken from the queue. As distances of
+    // taken vertices never decrease, it's a lower bound for all the vertices
+    // which are not settled yet. It's read by the opposite direction.
+    atomic<double> topDistance{0.0};
+    // True when the queue is exhausted and the search is stopped.
+    atomic<bool> exhausted{false};
+  };
+
+  // State shared by both directions of FindPathBidirectionalParallel.
+  struct ParallelMeetingContext
+  {
+    // Guards best distances of both directions, bestVertex of both directions
+    // and the fields below. Checking a vertex in the opposite direction and
+    // relaxing it in the current one are done under the lock at once, so a
+    // meeting vertex can't be missed by both directions.
+    mutex lock;
+    bool foundAnyPath = false;
+    double bestPathReducedLength = 0.0;
+
+    atomic<bool> done{false};
+    atomic<bool> cancelled{false};
+  };
+
+  static void RunParallelDirection(ParallelStepContext & cur, ParallelStepContext & nxt,
+                                   ParallelMeetingContext & meeting,
+                                   my::Cancellable const & cancellable,
+                                   TOnVisitedVertexCallback const & onVisitedVertexCallback);
+
   static void ReconstructPathBidirectional(TVertexType const & v, TVertexType const & w,
-                                           map<TVertexType, TVertexType> const & parentV,
-                                           map<TVertexType, TVertexType> const & parentW,
+                                           TVertexState const & stateV,
+                                           TVertexState const & stateW,
                                            vector<TVertexType> & path);
 };
 
+template <typename TGraph>
+bool constexpr HasDenseVertexIndex<TGraph>::value;
+
+template <typename TGraph>
+bool constexpr AStarAlgorithm<TGraph>::kDenseMode;
+
+template <typename TGraph>
+uint32_t constexpr AStarAlgorithm<TGraph>::DenseVertexState::kNoParent;
+
+template <typename TGraph>
+double constexpr AStarAlgorithm<TGraph>::DenseVertexState::kUnreached;
+
 // This implementation is based on the view that the A* algorithm
 // is equivalent to Dijkstra's algorithm that is run on a reweighted
 // version of the graph. If an edge (v, w) has length l(v, w), its reduced
@@ -176,27 +398,21 @@ typename AStarAlgorithm<TGraph>::Result AStarAlgorithm<TGraph>::FindPath(
   if (nullptr == onVisitedVertexCallback)
     onVisitedVertexCallback = [](TVertexType const &, TVertexType const &){};
 
-  map<TVertexType, double> bestDistance;
-  priority_queue<State, vector<State>, greater<State>> queue;
-  map<TVertexType, TVertexType> parent;
-
-  bestDistance[startVertex] = 0.0;
-  queue.push(State(startVertex, 0.0));
+  TVertexState state(graph);
+  state.Start(startVertex);
 
   vector<TEdgeType> adj;
 
   uint32_t steps = 0;
-  while (!queue.empty())
+  State stateV(startVertex, 0.0);
+  while (!state.IsQueueEmpty())
   {
     ++steps;
 
     if (steps % kCancelledPollPeriod == 0 && cancellable.IsCancelled())
       return Result::Cancelled;
 
-    State const stateV = queue.top();
-    queue.pop();
-
-    if (stateV.distance > bestDistance[stateV.vertex])
+    if (!state.PopNearest(stateV))
       continue;
 
     if (steps % kVisitedVerticesPeriod == 0)
@@ -204,7 +420,7 @@ typename AStarAlgorithm<TGraph>::Result AStarAlgorithm<TGraph>::FindPath(
 
     if (stateV.vertex == finalVertex)
     {
-      ReconstructPath(stateV.vertex, parent, path);
+      state.ReconstructPath(stateV.vertex, path);
       return Result::OK;
     }
 
@@ -223,14 +439,11 @@ typename AStarAlgorithm<TGraph>::Result AStarAlgorithm<TGraph>::FindPath(
       CHECK(reducedLen >= -kEpsilon, ("Invariant violated:", reducedLen, "<", -kEpsilon));
       double const newReducedDist = stateV.distance + max(reducedLen, 0.0);
 
-      auto const t = bestDistance.find(stateW.vertex);
-      if (t != bestDistance.end() && newReducedDist >= t->second - kEpsilon)
+      double bestDistW;
+      if (state.GetBestDistance(stateW.vertex, bestDistW) && newReducedDist >= bestDistW - kEpsilon)
         continue;
 
-      stateW.distance = newReducedDist;
-      bestDistance[stateW.vertex] = newReducedDist;
-      parent[stateW.vertex] = stateV.vertex;
-      queue.push(stateW);
+      state.Relax(stateW.vertex, newReducedDist, stateV.vertex);
     }
   }
 
@@ -254,11 +467,8 @@ typename AStarAlgorithm<TGraph>::Result AStarAlgorithm<TGraph>::FindPathBidirect
   bool foundAnyPath = false;
   double bestPathReducedLength = 0.0;
 
-  forward.bestDistance[startVertex] = 0.0;
-  forward.queue.push(State(startVertex, 0.0 /* distance */));
-
-  backward.bestDistance[finalVertex] = 0.0;
-  backward.queue.push(State(finalVertex, 0.0 /* distance */));
+  forward.state.Start(startVertex);
+  backward.state.Start(finalVertex);
 
   // To use the search code both for backward and forward directions
   // we keep the pointers to everything related to the search in the
@@ -273,7 +483,8 @@ typename AStarAlgorithm<TGraph>::Result AStarAlgorithm<TGraph>::FindPathBidirect
   // because if we have not found a path by the time one of the
   // queues is exhausted, we never will.
   uint32_t steps = 0;
-  while (!cur->queue.empty() && !nxt->queue.empty())
+  State stateV(startVertex, 0.0);
+  while (!cur->state.IsQueueEmpty() && !nxt->state.IsQueueEmpty())
   {
     ++steps;
 
@@ -285,8 +496,8 @@ typename AStarAlgorithm<TGraph>::Result AStarAlgorithm<TGraph>::FindPathBidirect
 
     if (foundAnyPath)
     {
-      double const curTop = cur->TopDistance();
-      double const nxtTop = nxt->TopDistance();
+      double const curTop = cur->state.TopDistance();
+      double const nxtTop = nxt->state.TopDistance();
 
       // The intuition behind this is that we cannot obtain a path shorter
       // than the left side of the inequality because that is how any path we find
@@ -301,7 +512,7 @@ typename AStarAlgorithm<TGraph>::Result AStarAlgorithm<TGraph>::FindPathBidirect
 
       if (curTop + nxtTop >= bestPathReducedLength - kEpsilon)
       {
-        ReconstructPathBidirectional(cur->bestVertex, nxt->bestVertex, cur->parent, nxt->parent,
+        ReconstructPathBidirectional(cur->bestVertex, nxt->bestVertex, cur->state, nxt->state,
                                      path);
         CHECK(!path.empty(), ());
         if (!cur->forward)
@@ -310,10 +521,7 @@ typename AStarAlgorithm<TGraph>::Result AStarAlgorithm<TGraph>::FindPathBidirect
       }
     }
 
-    State const stateV = cur->queue.top();
-    cur->queue.pop();
-
-    if (stateV.distance > cur->bestDistance[stateV.vertex])
+    if (!cur->state.PopNearest(stateV))
       continue;
 
     if (steps % kVisitedVerticesPeriod == 0)
@@ -334,14 +542,16 @@ typename AStarAlgorithm<TGraph>::Result AStarAlgorithm<TGraph>::FindPathBidirect
       CHECK(reducedLen >= -kEpsilon, ("Invariant violated:", reducedLen, "<", -kEpsilon));
       double const newReducedDist = stateV.distance + max(reducedLen, 0.0);
 
-      auto const itCur = cur->bestDistance.find(stateW.vertex);
-      if (itCur != cur->bestDistance.end() && newReducedDist >= itCur->second - kEpsilon)
+      double bestDistW;
+      if (cur->state.GetBestDistance(stateW.vertex, bestDistW) &&
+          newReducedDist >= bestDistW - kEpsilon)
+      {
         continue;
+      }
 
-      auto const itNxt = nxt->bestDistance.find(stateW.vertex);
-      if (itNxt != nxt->bestDistance.end())
+      double distW;
+      if (nxt->state.GetBestDistance(stateW.vertex, distW))
       {
-        double const distW = itNxt->second;
         // Reduced length that the path we've just found has in the original graph:
         // find the reduced length of the path's parts in the reduced forward and backward graphs.
         double const curPathReducedLength = newReducedDist + distW;
@@ -355,45 +565,184 @@ typename AStarAlgorithm<TGraph>::Result AStarAlgorithm<TGraph>::FindPathBidirect
         }
       }
 
-      stateW.distance = newReducedDist;
-      cur->bestDistance[stateW.vertex] = newReducedDist;
-      cur->parent[stateW.vertex] = stateV.vertex;
-      cur->queue.push(stateW);
+      cur->state.Relax(stateW.vertex, newReducedDist, stateV.vertex);
     }
   }
 
   return Result::NoPath;
 }
 
+template <typename TGraph>
+typename AStarAlgorithm<TGraph>::Result AStarAlgorithm<TGraph>::FindPathBidirectionalParallel(
+    TGraphType const & graph,
+    TVertexType const & startVertex, TVertexType const & finalVertex,
+    vector<TVertexType> & path,
+    my::Cancellable const & cancellable,
+    TOnVisitedVertexCallback onVisitedVertexCallback) const
+{
+  if (nullptr == onVisitedVertexCallback)
+    onVisitedVertexCallback = [](TVertexType const &, TVertexType const &){};
+
+  ParallelStepContext forward(true /* forward */, startVertex, finalVertex, graph);
+  ParallelStepContext backward(false /* forward */, startVertex, finalVertex, graph);
+  ParallelMeetingContext meeting;
+
+  forward.state.Start(startVertex);
+  backward.state.Start(finalVertex);
+
+  exception_ptr backwardException;
+  thread backwardThread([&]()
+  {
+    try
+    {
+      RunParallelDirection(backward, forward, meeting, cancellable, nullptr);
+    }
+    catch (...)
+    {
+      backwardException = current_exception();
+      meeting.done = true;
+    }
+  });
+
+  try
+  {
+    RunParallelDirection(forward, backward, meeting, cancellable, onVisitedVertexCallback);
+  }
+  catch (...)
+  {
+    meeting.done = true;
+    backwardThread.join();
+    throw;
+  }
+  backwardThread.join();
+
+  if (backwardException)
+    rethrow_exception(backwardException);
+
+  if (meeting.cancelled)
+    return Result::Cancelled;
+  if (!meeting.foundAnyPath)
+    return Result::NoPath;
+
+  ReconstructPathBidirectional(forward.bestVertex, backward.bestVertex, forward.state,
+                               backward.state, path);
+  CHECK(!path.empty(), ());
+  return Result::OK;
+}
+
 // static
 template <typename TGraph>
-void AStarAlgorithm<TGraph>::ReconstructPath(TVertexType const & v,
-                                             map<TVertexType, TVertexType> const & parent,
-                                             vector<TVertexType> & path)
+void AStarAlgorithm<TGraph>::RunParallelDirection(
+    ParallelStepContext & cur, ParallelStepContext & nxt, ParallelMeetingContext & meeting,
+    my::Cancellable const & cancellable, TOnVisitedVertexCallback const & onVisitedVertexCallback)
 {
-  path.clear();
-  TVertexType cur = v;
-  while (true)
+  vector<TEdgeType> adj;
+  vector<State> relaxed;
+
+  uint32_t steps = 0;
+  State stateV(cur.forward ? cur.startVertex : cur.finalVertex, 0.0);
+  while (!meeting.done)
   {
-    path.push_back(cur);
-    auto it = parent.find(cur);
-    if (it == parent.end())
-      break;
-    cur = it->second;
+    ++steps;
+
+    if (steps % kCancelledPollPeriod == 0 && cancellable.IsCancelled())
+    {
+      meeting.cancelled = true;
+      meeting.done = true;
+      return;
+    }
+
+    // Unlike the one-thread version, the search can't be stopped when only one
+    // of the queues is exhausted: the opposite direction may meet the
+    // vertices settled by this one later.
+    if (cur.state.IsQueueEmpty())
+    {
+      cur.exhausted = true;
+      if (nxt.exhausted)
+        meeting.done = true;
+      return;
+    }
+
+    {
+      lock_guard<mutex> guard(meeting.lock);
+      if (meeting.foundAnyPath)
+      {
+        // See the comment in FindPathBidirectional. The top distance of the opposite
+        // direction may be outdated, but it's still a lower bound. When the opposite
+        // direction is exhausted all of its vertices are settled and zero is a lower bound.
+        double const curTop = cur.state.TopDistance();
+        double const nxtTop = nxt.exhausted ? 0.0 : nxt.topDistance.load();
+        if (curTop + nxtTop >= meeting.bestPathReducedLength - kEpsilon)
+        {
+          meeting.done = true;
+          return;
+        }
+      }
+    }
+
+    // Only this thread modifies the queue, while the opposite one reads
+    // best distances, which aren't touched here.
+    if (!cur.state.PopNearest(stateV))
+      continue;
+    cur.topDistance = stateV.distance;
+
+    if (onVisitedVertexCallback && steps % kVisitedVerticesPeriod == 0)
+      onVisitedVertexCallback(stateV.vertex, cur.forward ? cur.finalVertex : cur.startVertex);
+
+    // Edges and heuristics are the most expensive part, so they are
+    // evaluated without the lock.
+    cur.GetAdjacencyList(stateV.vertex, adj);
+    relaxed.clear();
+    double const pV = cur.ConsistentHeuristic(stateV.vertex);
+    for (auto const & edge : adj)
+    {
+      TVertexType const & w = edge.GetTarget();
+      if (stateV.vertex == w)
+        continue;
+
+      double const reducedLen = edge.GetWeight() + cur.ConsistentHeuristic(w) - pV;
+      CHECK(reducedLen >= -kEpsilon, ("Invariant violated:", reducedLen, "<", -kEpsilon));
+      relaxed.emplace_back(w, stateV.distance + max(reducedLen, 0.0));
+    }
+
+    lock_guard<mutex> guard(meeting.lock);
+    for (State const & stateW : relaxed)
+    {
+      double bestDistW;
+      if (cur.state.GetBestDistance(stateW.vertex, bestDistW) &&
+          stateW.distance >= bestDistW - kEpsilon)
+      {
+        continue;
+      }
+
+      double distW;
+      if (nxt.state.GetBestDistance(stateW.vertex, distW))
+      {
+        double const curPathReducedLength = stateW.distance + distW;
+        if (!meeting.foundAnyPath || meeting.bestPathReducedLength > curPathReducedLength)
+        {
+          meeting.bestPathReducedLength = curPathReducedLength;
+          meeting.foundAnyPath = true;
+          cur.bestVertex = stateV.vertex;
+          nxt.bestVertex = stateW.vertex;
+        }
+      }
+
+      cur.state.Relax(stateW.vertex, stateW.distance, stateV.vertex);
+    }
   }
-  reverse(path.begin(), path.end());
 }
 
 // static
 template <typename TGraph>
 void AStarAlgorithm<TGraph>::ReconstructPathBidirectional(
-    TVertexType const & v, TVertexType const & w, map<TVertexType, TVertexType> const & parentV,
-    map<TVertexType, TVertexType> const & parentW, vector<TVertexType> & path)
+    TVertexType const & v, TVertexType const & w, TVertexState const & stateV,
+    TVertexState const & stateW, vector<TVertexType> & path)
 {
   vector<TVertexType> pathV;
-  ReconstructPath(v, parentV, pathV);
+  stateV.ReconstructPath(v, pathV);
   vector<TVertexType> pathW;
-  ReconstructPath(w, parentW, pathW);
+  stateW.ReconstructPath(w, pathW);
   path.clear();
   path.reserve(pathV.size() + pathW.size());
   path.insert(path.end(), pathV.begin(), pathV.end());
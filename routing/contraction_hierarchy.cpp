@@ -0,0 +1,448 @@
+#include "routing/contraction_hierarchy.hpp"
+
+#include "indexer/mercator.hpp"
+
+#include "coding/write_to_sink.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/functional.hpp"
+#include "std/queue.hpp"
+#include "std/unordered_map.hpp"
+
+namespace routing
+{
+namespace
+{
+double constexpr KMPH2MPS = 1000.0 / (60 * 60);
+
+uint32_t constexpr kHeaderSize = 3 * sizeof(uint32_t);
+
+// Middle node of arcs, which are road segments, not shortcuts.
+uint32_t constexpr kNoMiddle = ContractionHierarchy::kInvalidNode;
+
+// Witness searches are bounded, so some unnecessary shortcuts may be added.
+uint32_t constexpr kMaxWitnessSettledNodes = 500;
+
+uint32_t constexpr kCancellationCheckPeriod = 1024;
+
+double constexpr kInfinity = numeric_limits<double>::max();
+
+struct Arc
+{
+  uint32_t m_target;
+  uint32_t m_middle;
+  double m_weight;
+};
+
+using TQueueItem = pair<double, uint32_t>;
+
+void WriteDouble(Writer & writer, double value)
+{
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  WriteToSink(writer, bits);
+}
+using TQueue = priority_queue<TQueueItem, vector<TQueueItem>, greater<TQueueItem>>;
+
+// Contracts nodes in order of edge difference, see "Contraction Hierarchies:
+// Faster and Simpler Hierarchical Routing in Road Networks" by R. Geisberger et al.
+class Contractor
+{
+public:
+  explicit Contractor(RoadGraphSection const & graph)
+    : m_arcs(graph.GetJunctionsCount())
+    , m_upwardArcs(graph.GetJunctionsCount())
+    , m_contracted(graph.GetJunctionsCount(), false)
+    , m_contractedNeighbours(graph.GetJunctionsCount(), 0)
+    , m_witnessWeights(graph.GetJunctionsCount(), kInfinity)
+  {
+    graph.ForEachEdge([&](uint32_t from, uint32_t to, double speedKMPH)
+    {
+      if (from == to)
+        return;
+      double const weight = ContractionHierarchy::GetEdgeWeight(graph.GetJunction(from),
+                                                                 graph.GetJunction(to), speedKMPH);
+      AddArc(from, to, kNoMiddle, weight);
+    });
+  }
+
+  void Run()
+  {
+    uint32_t const nodesCount = static_cast<uint32_t>(m_arcs.size());
+
+    using TPriorityItem = pair<int64_t, uint32_t>;
+    priority_queue<TPriorityItem, vector<TPriorityItem>, greater<TPriorityItem>> queue;
+    for (uint32_t node = 0; node < nodesCount; ++node)
+      queue.emplace(GetPriority(node), node);
+
+    uint32_t contracted = 0;
+    uint64_t shortcuts = 0;
+    while (!queue.empty())
+    {
+      uint32_t const node = queue.top().second;
+      queue.pop();
+      if (m_contracted[node])
+        continue;
+
+      // Lazy update: node is contracted only if its actual priority is still the smallest one.
+      int64_t const priority = GetPriority(node);
+      if (!queue.empty() && priority > queue.top().first)
+      {
+        queue.emplace(priority, node);
+        continue;
+      }
+
+      shortcuts += ProcessNode(node, true /* contract */);
+      if (++contracted % 100000 == 0)
+        LOG(LINFO, ("Contracted", contracted, "of", nodesCount, "nodes, shortcuts:", shortcuts));
+    }
+    LOG(LINFO, ("Contraction is finished, nodes:", nodesCount, "shortcuts:", shortcuts));
+  }
+
+  void Serialize(Writer & writer) const
+  {
+    uint32_t arcsCount = 0;
+    for (auto const & arcs : m_upwardArcs)
+      arcsCount += static_cast<uint32_t>(arcs.size());
+
+    WriteToSink(writer, ContractionHierarchy::kVersion);
+    WriteToSink(writer, static_cast<uint32_t>(m_upwardArcs.size()));
+    WriteToSink(writer, arcsCount);
+
+    uint32_t offset = 0;
+    WriteToSink(writer, offset);
+    for (auto const & arcs : m_upwardArcs)
+    {
+      offset += static_cast<uint32_t>(arcs.size());
+      WriteToSink(writer, offset);
+    }
+
+    for (auto const & arcs : m_upwardArcs)
+    {
+      for (Arc const & arc : arcs)
+      {
+        WriteToSink(writer, arc.m_target);
+        WriteToSink(writer, arc.m_middle);
+        WriteDouble(writer, arc.m_weight);
+      }
+    }
+  }
+
+private:
+  // Adds the arc or decreases weight of the existing one.
+  void AddArc(uint32_t from, uint32_t to, uint32_t middle, double weight)
+  {
+    for (Arc & arc : m_arcs[from])
+    {
+      if (arc.m_target != to)
+        continue;
+      if (weight < arc.m_weight)
+      {
+        arc.m_weight = weight;
+        arc.m_middle = middle;
+      }
+      return;
+    }
+    m_arcs[from].push_back({to, middle, weight});
+  }
+
+  int64_t GetPriority(uint32_t node)
+  {
+    int64_t const shortcuts = ProcessNode(node, false /* contract */);
+    return shortcuts - static_cast<int64_t>(m_arcs[node].size()) + m_contractedNeighbours[node];
+  }
+
+  // Returns number of shortcuts, which are needed to contract node.
+  // When contract is true the shortcuts are added and node is removed from the graph.
+  uint32_t ProcessNode(uint32_t node, bool contract)
+  {
+    vector<Arc> const arcs = m_arcs[node];
+    uint32_t shortcuts = 0;
+
+    for (size_t i = 0; i + 1 < arcs.size(); ++i)
+    {
+      double maxWeight = 0.0;
+      for (size_t j = i + 1; j < arcs.size(); ++j)
+        maxWeight = max(maxWeight, arcs[i].m_weight + arcs[j].m_weight);
+
+      FindWitnesses(arcs[i].m_target, node, maxWeight);
+
+      for (size_t j = i + 1; j < arcs.size(); ++j)
+      {
+        double const weight = arcs[i].m_weight + arcs[j].m_weight;
+        if (m_witnessWeights[arcs[j].m_target] <= weight)
+          continue;
+
+        ++shortcuts;
+        if (contract)
+        {
+          AddArc(arcs[i].m_target, arcs[j].m_target, node, weight);
+          AddArc(arcs[j].m_target, arcs[i].m_target, node, weight);
+        }
+      }
+    }
+
+    if (contract)
+    {
+      for (Arc const & arc : arcs)
+      {
+        vector<Arc> & neighbourArcs = m_arcs[arc.m_target];
+        neighbourArcs.erase(remove_if(neighbourArcs.begin(), neighbourArcs.end(),
+                                      [node](Arc const & a) { return a.m_target == node; }),
+                            neighbourArcs.end());
+        ++m_contractedNeighbours[arc.m_target];
+      }
+      m_upwardArcs[node] = m_arcs[node];
+      vector<Arc>().swap(m_arcs[node]);
+      m_contracted[node] = true;
+    }
+
+    return shortcuts;
+  }
+
+  // Fills m_witnessWeights by weights of paths from source, which don't pass excluded.
+  void FindWitnesses(uint32_t source, uint32_t excluded, double maxWeight)
+  {
+    for (uint32_t node : m_witnessTouched)
+      m_witnessWeights[node] = kInfinity;
+    m_witnessTouched.clear();
+
+    TQueue queue;
+    m_witnessWeights[source] = 0.0;
+    m_witnessTouched.push_back(source);
+    queue.emplace(0.0, source);
+
+    uint32_t settled = 0;
+    while (!queue.empty() && settled < kMaxWitnessSettledNodes)
+    {
+      TQueueItem const top = queue.top();
+      queue.pop();
+      if (top.first > m_witnessWeights[top.second])
+        continue;
+      if (top.first > maxWeight)
+        break;
+      ++settled;
+
+      for (Arc const & arc : m_arcs[top.second])
+      {
+        if (arc.m_target == excluded)
+          continue;
+        double const weight = top.first + arc.m_weight;
+        if (weight >= m_witnessWeights[arc.m_target])
+          continue;
+        if (m_witnessWeights[arc.m_target] == kInfinity)
+          m_witnessTouched.push_back(arc.m_target);
+        m_witnessWeights[arc.m_target] = weight;
+        queue.emplace(weight, arc.m_target);
+      }
+    }
+  }
+
+  // Arcs between not contracted nodes.
+  vector<vector<Arc>> m_arcs;
+  // Arcs of contracted nodes to nodes, which were contracted later.
+  vector<vector<Arc>> m_upwardArcs;
+  vector<bool> m_contracted;
+  vector<uint32_t> m_contractedNeighbours;
+
+  vector<double> m_witnessWeights;
+  vector<uint32_t> m_witnessTouched;
+};
+
+struct SearchState
+{
+  double m_weight;
+  uint32_t m_parent;
+};
+}  // namespace
+
+uint32_t constexpr ContractionHierarchy::kVersion;
+uint32_t constexpr ContractionHierarchy::kInvalidNode;
+uint32_t constexpr ContractionHierarchy::kArcRecordSize;
+
+// static
+void ContractionHierarchy::Build(RoadGraphSection const & graph, Writer & writer)
+{
+  Contractor contractor(graph);
+  contractor.Run();
+  contractor.Serialize(writer);
+}
+
+bool ContractionHierarchy::Attach(RoadGraphSection const & graph, char const * data, uint64_t size)
+{
+  *this = ContractionHierarchy();
+
+  if (!graph.IsAttached() || size < kHeaderSize)
+    return false;
+
+  uint32_t const version = Read<uint32_t>(data, 0);
+  if (version != kVersion)
+  {
+    LOG(LWARNING, ("Unknown contraction hierarchy version:", version));
+    return false;
+  }
+
+  uint32_t const nodesCount = Read<uint32_t>(data, 1);
+  uint32_t const arcsCount = Read<uint32_t>(data, 2);
+  uint64_t const offsetsSize = sizeof(uint32_t) * (static_cast<uint64_t>(nodesCount) + 1);
+  uint64_t const arcsSize = kArcRecordSize * static_cast<uint64_t>(arcsCount);
+  if (nodesCount != graph.GetJunctionsCount() || size != kHeaderSize + offsetsSize + arcsSize)
+  {
+    LOG(LWARNING, ("Contraction hierarchy doesn't match the road graph, nodes:", nodesCount,
+                   "size:", size));
+    return false;
+  }
+
+  m_graph = &graph;
+  m_nodesCount = nodesCount;
+  m_arcsCount = arcsCount;
+  m_offsets = data + kHeaderSize;
+  m_arcs = m_offsets + offsetsSize;
+  return true;
+}
+
+ContractionHierarchy::Result ContractionHierarchy::FindPath(vector<TWeightedNode> const & sources,
+                                                            vector<TWeightedNode> const & targets,
+                                                            my::Cancellable const & cancellable,
+                                                            vector<uint32_t> & path,
+                                                            double & weight) const
+{
+  ASSERT(IsAttached(), ());
+
+  // Index 0 is the forward search from sources, index 1 is the backward one from targets.
+  unordered_map<uint32_t, SearchState> states[2];
+  TQueue queues[2];
+
+  auto const relax = [&](size_t dir, uint32_t node, double nodeWeight, uint32_t parent)
+  {
+    auto const res = states[dir].emplace(node, SearchState{nodeWeight, parent});
+    if (!res.second)
+    {
+      if (res.first->second.m_weight <= nodeWeight)
+        return;
+      res.first->second = SearchState{nodeWeight, parent};
+    }
+    queues[dir].emplace(nodeWeight, node);
+  };
+
+  for (auto const & source : sources)
+    relax(0, source.first, source.second, kInvalidNode);
+  for (auto const & target : targets)
+    relax(1, target.first, target.second, kInvalidNode);
+
+  double bestWeight = kInfinity;
+  uint32_t meetingNode = kInvalidNode;
+  uint32_t steps = 0;
+
+  while (true)
+  {
+    bool const forwardActive = !queues[0].empty() && queues[0].top().first < bestWeight;
+    bool const backwardActive = !queues[1].empty() && queues[1].top().first < bestWeight;
+    if (!forwardActive && !backwardActive)
+      break;
+
+    size_t const dir =
+        (forwardActive && (!backwardActive || queues[0].top().first <= queues[1].top().first))
+            ? 0
+            : 1;
+
+    if (++steps % kCancellationCheckPeriod == 0 && cancellable.IsCancelled())
+      return Result::Cancelled;
+
+    TQueueItem const top = queues[dir].top();
+    queues[dir].pop();
+    uint32_t const node = top.second;
+    if (top.first > states[dir][node].m_weight)
+      continue;
+
+    auto const it = states[1 - dir].find(node);
+    if (it != states[1 - dir].end() && top.first + it->second.m_weight < bestWeight)
+    {
+      bestWeight = top.first + it->second.m_weight;
+      meetingNode = node;
+    }
+
+    ForEachUpwardArc(node, [&](uint32_t target, uint32_t /* middle */, double arcWeight)
+    {
+      relax(dir, target, top.first + arcWeight, node);
+    });
+  }
+
+  if (meetingNode == kInvalidNode)
+    return Result::NoPath;
+
+  vector<uint32_t> packedPath;
+  for (uint32_t node = meetingNode; node != kInvalidNode; node = states[0][node].m_parent)
+    packedPath.push_back(node);
+  reverse(packedPath.begin(), packedPath.end());
+  for (uint32_t node = states[1][meetingNode].m_parent; node != kInvalidNode;
+       node = states[1][node].m_parent)
+  {
+    packedPath.push_back(node);
+  }
+
+  path.clear();
+  path.push_back(packedPath.front());
+  for (size_t i = 1; i < packedPath.size(); ++i)
+    UnpackArc(packedPath[i - 1], packedPath[i], path);
+
+  weight = bestWeight;
+  return Result::OK;
+}
+
+// static
+double ContractionHierarchy::GetEdgeWeight(m2::PointD const & from, m2::PointD const & to,
+                                           double speedKMPH)
+{
+  ASSERT_GREATER(speedKMPH, 0.0, ());
+  return MercatorBounds::DistanceOnEarth(from, to) / (speedKMPH * KMPH2MPS);
+}
+
+void ContractionHierarchy::UnpackArc(uint32_t from, uint32_t to, vector<uint32_t> & path) const
+{
+  // Arc is kept by the node, which was contracted earlier.
+  double bestWeight = kInfinity;
+  uint32_t middle = kNoMiddle;
+  auto const findArc = [&](uint32_t node, uint32_t target)
+  {
+    ForEachUpwardArc(node, [&](uint32_t arcTarget, uint32_t arcMiddle, double arcWeight)
+    {
+      if (arcTarget == target && arcWeight < bestWeight)
+      {
+        bestWeight = arcWeight;
+        middle = arcMiddle;
+      }
+    });
+  };
+  findArc(from, to);
+  findArc(to, from);
+  ASSERT_LESS(bestWeight, kInfinity, ("No arc between", from, "and", to));
+
+  if (middle == kNoMiddle)
+  {
+    path.push_back(to);
+    return;
+  }
+
+  UnpackArc(from, middle, path);
+  UnpackArc(middle, to, path);
+}
+
+string DebugPrint(ContractionHierarchy::Result const & result)
+{
+  switch (result)
+  {
+  case ContractionHierarchy::Result::OK:
+    return "OK";
+  case ContractionHierarchy::Result::NoPath:
+    return "NoPath";
+  case ContractionHierarchy::Result::Cancelled:
+    return "Cancelled";
+  }
+  return string();
+}
+
+}  // namespace routing
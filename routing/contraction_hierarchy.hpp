@@ -0,0 +1,120 @@
+#pragma once
+
+#include "routing/road_graph_section.hpp"
+
+#include "coding/endianness.hpp"
+#include "coding/writer.hpp"
+
+#include "base/cancellable.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/cstring.hpp"
+#include "std/limits.hpp"
+#include "std/string.hpp"
+#include "std/type_traits.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+namespace routing
+{
+
+/// Contraction hierarchy of a precomputed road graph (see RoadGraphSection).
+/// Nodes of the hierarchy are junctions of the road graph and arc weights are
+/// travel times in seconds. The road graph is symmetric, so the same upward arcs
+/// are used by forward and backward searches.
+///
+/// Section layout, all the values are little-endian:
+///   uint32_t version, nodesCount, arcsCount;
+///   uint32_t arcsOffsets[nodesCount + 1]; // upward arcs of node i are
+///                                         // in [arcsOffsets[i], arcsOffsets[i + 1])
+///   ArcRecord arcs[arcsCount];            // target, middle node and weight
+class ContractionHierarchy
+{
+public:
+  static uint32_t constexpr kVersion = 0;
+  static uint32_t constexpr kInvalidNode = numeric_limits<uint32_t>::max();
+
+  enum class Result
+  {
+    OK,
+    NoPath,
+    Cancelled
+  };
+
+  /// Node with the weight of the path to it (from it for targets).
+  using TWeightedNode = pair<uint32_t, double>;
+
+  /// Contracts graph and writes the hierarchy section.
+  static void Build(RoadGraphSection const & graph, Writer & writer);
+
+  /// Attaches to the serialized section built for graph. Both graph and data
+  /// should be alive while the object is used.
+  /// @return False if data is not a valid section of graph.
+  bool Attach(RoadGraphSection const & graph, char const * data, uint64_t size);
+
+  inline bool IsAttached() const { return m_graph != nullptr; }
+  inline uint32_t GetNodesCount() const { return m_nodesCount; }
+  inline uint32_t GetArcsCount() const { return m_arcsCount; }
+
+  /// @return Node of a junction, which is almost equal to point, or kInvalidNode.
+  inline uint32_t FindNode(m2::PointD const & point) const
+  {
+    uint32_t const node = m_graph->FindJunction(point);
+    return node == RoadGraphSection::kInvalidJunction ? kInvalidNode : node;
+  }
+
+  inline m2::PointD GetPoint(uint32_t node) const { return m_graph->GetJunction(node); }
+
+  /// Finds the shortest path from one of sources to one of targets.
+  /// @param path Unpacked nodes of the path from a source to a target.
+  /// @param weight Weight of the path including weights of its source and target.
+  Result FindPath(vector<TWeightedNode> const & sources, vector<TWeightedNode> const & targets,
+                  my::Cancellable const & cancellable, vector<uint32_t> & path,
+                  double & weight) const;
+
+  /// @return Travel time in seconds along a road segment, the same as routing algorithms use.
+  static double GetEdgeWeight(m2::PointD const & from, m2::PointD const & to, double speedKMPH);
+
+private:
+  static uint32_t constexpr kArcRecordSize = 2 * sizeof(uint32_t) + sizeof(double);
+
+  template <typename TFn>
+  void ForEachUpwardArc(uint32_t node, TFn && fn) const
+  {
+    uint32_t const end = Read<uint32_t>(m_offsets, node + 1);
+    for (uint32_t a = Read<uint32_t>(m_offsets, node); a < end; ++a)
+    {
+      char const * arc = m_arcs + static_cast<size_t>(a) * kArcRecordSize;
+      fn(Read<uint32_t>(arc, 0) /* target */, Read<uint32_t>(arc, 1) /* middle */,
+         Read<double>(arc + 2 * sizeof(uint32_t), 0) /* weight */);
+    }
+  }
+
+  // Appends nodes of the arc between from and to except from.
+  void UnpackArc(uint32_t from, uint32_t to, vector<uint32_t> & path) const;
+
+  template <typename T>
+  static inline T Read(char const * base, uint32_t i)
+  {
+    using TBits = typename conditional<sizeof(T) == sizeof(uint64_t), uint64_t, uint32_t>::type;
+    static_assert(sizeof(T) == sizeof(TBits), "Only 32 and 64 bit values are supported.");
+
+    TBits bits;
+    memcpy(&bits, base + static_cast<size_t>(i) * sizeof(T), sizeof(T));
+    bits = SwapIfBigEndian(bits);
+    T value;
+    memcpy(&value, &bits, sizeof(T));
+    return value;
+  }
+
+  RoadGraphSection const * m_graph = nullptr;
+  uint32_t m_nodesCount = 0;
+  uint32_t m_arcsCount = 0;
+
+  char const * m_offsets = nullptr;
+  char const * m_arcs = nullptr;
+};
+
+string DebugPrint(ContractionHierarchy::Result const & result);
+
+}  // namespace routing
@@ -1,5 +1,7 @@
+#include "routing/contraction_hierarchy.hpp"
 #include "routing/features_road_graph.hpp"
 #include "routing/nearest_edge_finder.hpp"
+#include "routing/road_graph_section.hpp"
 #include "routing/route.hpp"
 #include "routing/vehicle_model.hpp"
 
@@ -8,8 +10,13 @@
 #include "indexer/index.hpp"
 #include "indexer/scales.hpp"
 
+#include "platform/local_country_file.hpp"
+
+#include "coding/file_container.hpp"
+
 #include "geometry/distance_on_sphere.hpp"
 
+#include "base/buffer_vector.hpp"
 #include "base/logging.hpp"
 #include "base/macros.hpp"
 
@@ -24,17 +31,13 @@ double constexpr kMwmRoadCrossingRadiusMeters = 2.0;
 
 double constexpr kMwmCrossingNodeEqualityRadiusMeters = 100.0;
 
+// Mwm limit rects are inflated by it to be sure that they contain all the road points.
+double constexpr kMwmLimitRectEps = 1e-5;
+
 string GetFeatureCountryName(FeatureID const featureId)
 {
-  /// @todo Rework this function when storage will provide information about mwm's country
-  // MwmInfo.GetCountryName returns country name as 'Country' or 'Country_Region', but only 'Country' is needed
   ASSERT(featureId.IsValid(), ());
-
-  string const & countryName = featureId.m_mwmId.GetInfo()->GetCountryName();
-  size_t const pos = countryName.find('_');
-  if (string::npos == pos)
-    return countryName;
-  return countryName.substr(0, pos);
+  return GetVehicleModelCountryName(featureId.m_mwmId.GetInfo()->GetCountryName());
 }
 
 inline bool PointsAlmostEqualAbs(const m2::PointD & pt1, const m2::PointD & pt2)
@@ -68,6 +71,7 @@ bool FeaturesRoadGraph::CrossCountryVehicleModel::IsOneWay(FeatureType const & f
 
 IVehicleModel * FeaturesRoadGraph::CrossCountryVehicleModel::GetVehicleModel(FeatureID const & featureId) const
 {
+  lock_guard<mutex> guard(m_mutex);
   auto itr = m_cache.find(featureId.m_mwmId);
   if (itr != m_cache.end())
     return itr->second.get();
@@ -84,16 +88,33 @@ IVehicleModel * FeaturesRoadGraph::CrossCountryVehicleModel::GetVehicleModel(Fea
 
 void FeaturesRoadGraph::CrossCountryVehicleModel::Clear()
 {
+  lock_guard<mutex> guard(m_mutex);
   m_cache.clear();
 }
 
 
-IRoadGraph::RoadInfo & FeaturesRoadGraph::RoadInfoCache::Find(FeatureID const & featureId, bool & found)
+FeaturesRoadGraph::TRoadInfoPtr FeaturesRoadGraph::RoadInfoCache::Find(FeatureID const & featureId)
+{
+  auto const itr = m_cache.find(featureId.m_mwmId);
+  if (itr == m_cache.end())
+    return TRoadInfoPtr();
+
+  bool found = false;
+  TRoadInfoPtr & ri = itr->second.Find(featureId.m_index, found);
+  // The slot is taken by featureId now, so it's reset to be treated as a miss later.
+  if (!found)
+    ri.reset();
+  return ri;
+}
+
+void FeaturesRoadGraph::RoadInfoCache::Insert(FeatureID const & featureId,
+                                              TRoadInfoPtr const & roadInfo)
 {
   auto res = m_cache.insert(make_pair(featureId.m_mwmId, TMwmFeatureCache()));
   if (res.second)
     res.first->second.Init(kPowOfTwoForFeatureCacheSize);
-  return res.first->second.Find(featureId.m_index, found);
+  bool found = false;
+  res.first->second.Find(featureId.m_index, found) = roadInfo;
 }
 
 void FeaturesRoadGraph::RoadInfoCache::Clear()
@@ -102,12 +123,34 @@ void FeaturesRoadGraph::RoadInfoCache::Clear()
 }
 
 
-FeaturesRoadGraph::FeaturesRoadGraph(Index & index, unique_ptr<IVehicleModelFactory> && vehicleModelFactory)
+struct FeaturesRoadGraph::MwmRoadGraph
+{
+  explicit MwmRoadGraph(MwmSet::MwmId const & mwmId) : m_mwmId(mwmId) {}
+
+  MwmSet::MwmId const m_mwmId;
+  bool m_opened = false;
+  FilesMappingContainer m_container;
+  FilesMappingContainer::Handle m_mapping;
+  RoadGraphSection m_section;
+  FilesMappingContainer::Handle m_hierarchyMapping;
+  ContractionHierarchy m_hierarchy;
+};
+
+FeaturesRoadGraph::FeaturesRoadGraph(Index & index,
+                                     unique_ptr<IVehicleModelFactory> && vehicleModelFactory,
+                                     shared_ptr<SharedRoadInfoCache> sharedCache,
+                                     string const & roadGraphSectionTag,
+                                     string const & hierarchySectionTag)
     : m_index(index),
+      m_sharedCache(move(sharedCache)),
+      m_roadGraphSectionTag(roadGraphSectionTag),
+      m_hierarchySectionTag(hierarchySectionTag),
       m_vehicleModel(move(vehicleModelFactory))
 {
 }
 
+FeaturesRoadGraph::~FeaturesRoadGraph() {}
+
 uint32_t FeaturesRoadGraph::GetStreetReadScale() { return scales::GetUpperScale(); }
 
 class CrossFeaturesLoader
@@ -129,9 +172,9 @@ public:
 
     FeatureID const featureId = ft.GetID();
 
-    IRoadGraph::RoadInfo const & roadInfo = m_graph.GetCachedRoadInfo(featureId, ft, speedKMPH);
+    auto const roadInfo = m_graph.GetCachedRoadInfo(featureId, ft, speedKMPH);
 
-    m_edgesLoader(featureId, roadInfo);
+    m_edgesLoader(featureId, *roadInfo);
   }
 
 private:
@@ -141,14 +184,23 @@ private:
 
 IRoadGraph::RoadInfo FeaturesRoadGraph::GetRoadInfo(FeatureID const & featureId) const
 {
-  RoadInfo const & ri = GetCachedRoadInfo(featureId);
-  ASSERT_GREATER(ri.m_speedKMPH, 0.0, ());
-  return ri;
+  auto const ri = GetCachedRoadInfo(featureId);
+  ASSERT_GREATER(ri->m_speedKMPH, 0.0, ());
+  return *ri;
 }
 
 double FeaturesRoadGraph::GetSpeedKMPH(FeatureID const & featureId) const
 {
-  double const speedKMPH = GetCachedRoadInfo(featureId).m_speedKMPH;
+  if (!m_roadGraphSectionTag.empty())
+  {
+    lock_guard<mutex> guard(m_mutex);
+    MwmRoadGraph const * graph = GetMwmRoadGraph(featureId.m_mwmId);
+    double speedKMPH;
+    if (graph && graph->m_section.GetSpeedKMPH(featureId.m_index, speedKMPH))
+      return speedKMPH;
+  }
+
+  double const speedKMPH = GetCachedRoadInfo(featureId)->m_speedKMPH;
   ASSERT_GREATER(speedKMPH, 0.0, ());
   return speedKMPH;
 }
@@ -161,6 +213,9 @@ double FeaturesRoadGraph::GetMaxSpeedKMPH() const
 void FeaturesRoadGraph::ForEachFeatureClosestToCross(m2::PointD const & cross,
                                                      CrossEdgesLoader & edgesLoader) const
 {
+  if (LoadPrecomputedEdges(cross, edgesLoader))
+    return;
+
   CrossFeaturesLoader featuresLoader(*this, edgesLoader);
   m2::RectD const rect = MercatorBounds::RectByCenterXYAndSizeInMeters(cross, kMwmRoadCrossingRadiusMeters);
   m_index.ForEachInRect(featuresLoader, rect, GetStreetReadScale());
@@ -169,6 +224,13 @@ void FeaturesRoadGraph::ForEachFeatureClosestToCross(m2::PointD const & cross,
 void FeaturesRoadGraph::FindClosestEdges(m2::PointD const & point, uint32_t count,
                                          vector<pair<Edge, m2::PointD>> & vicinities) const
 {
+  // It's called once at the start of a route, so the set of mwms is rechecked here.
+  if (!m_roadGraphSectionTag.empty())
+  {
+    lock_guard<mutex> guard(m_mutex);
+    m_activeRoadGraphsValid = false;
+  }
+
   NearestEdgeFinder finder(point);
 
   auto const f = [&finder, this](FeatureType & ft)
@@ -182,9 +244,9 @@ void FeaturesRoadGraph::FindClosestEdges(m2::PointD const & point, uint32_t coun
 
     FeatureID const featureId = ft.GetID();
 
-    IRoadGraph::RoadInfo const & roadInfo = GetCachedRoadInfo(featureId, ft, speedKMPH);
+    auto const roadInfo = GetCachedRoadInfo(featureId, ft, speedKMPH);
 
-    finder.AddInformationSource(featureId, roadInfo);
+    finder.AddInformationSource(featureId, *roadInfo);
   };
 
   m_index.ForEachInRect(
@@ -230,11 +292,39 @@ void FeaturesRoadGraph::GetJunctionTypes(Junction const & junction, feature::Typ
   m_index.ForEachInRect(f, rect, GetStreetReadScale());
 }
 
+void FeaturesRoadGraph::GetContractionHierarchies(
+    m2::PointD const & point, vector<ContractionHierarchy const *> & hierarchies) const
+{
+  if (m_hierarchySectionTag.empty())
+    return;
+
+  lock_guard<mutex> guard(m_mutex);
+  if (!m_activeRoadGraphsValid)
+    UpdateMwmRoadGraphs();
+
+  for (MwmRoadGraph const * activeGraph : m_activeRoadGraphs)
+  {
+    m2::RectD rect = activeGraph->m_mwmId.GetInfo()->m_limitRect;
+    rect.Inflate(kMwmLimitRectEps, kMwmLimitRectEps);
+    if (!rect.IsPointInside(point))
+      continue;
+
+    MwmRoadGraph const * graph = GetMwmRoadGraph(activeGraph->m_mwmId);
+    if (graph && graph->m_hierarchy.IsAttached())
+      hierarchies.push_back(&graph->m_hierarchy);
+  }
+}
+
 void FeaturesRoadGraph::ClearState()
 {
-  m_cache.Clear();
   m_vehicleModel.Clear();
+
+  lock_guard<mutex> guard(m_mutex);
+  m_cache.Clear();
   m_mwmLocks.clear();
+  m_activeRoadGraphs.clear();
+  m_activeRoadGraphsValid = false;
+  m_mwmRoadGraphs.clear();
 }
 
 bool FeaturesRoadGraph::IsOneWay(FeatureType const & ft) const
@@ -247,13 +337,11 @@ double FeaturesRoadGraph::GetSpeedKMPHFromFt(FeatureType const & ft) const
   return m_vehicleModel.GetSpeed(ft);
 }
 
-IRoadGraph::RoadInfo const & FeaturesRoadGraph::GetCachedRoadInfo(FeatureID const & featureId) const
+FeaturesRoadGraph::TRoadInfoPtr FeaturesRoadGraph::GetCachedRoadInfo(FeatureID const & featureId) const
 {
-  bool found = false;
-  RoadInfo & ri = m_cache.Find(featureId, found);
-
-  if (found)
-    return ri;
+  TRoadInfoPtr const cached = FindCachedRoadInfo(featureId);
+  if (cached)
+    return cached;
 
   FeatureType ft;
   Index::FeaturesLoaderGuard loader(m_index, featureId.m_mwmId);
@@ -262,39 +350,69 @@ IRoadGraph::RoadInfo const & FeaturesRoadGraph::GetCachedRoadInfo(FeatureID cons
 
   ft.ParseGeometry(FeatureType::BEST_GEOMETRY);
 
+  RoadInfo ri;
   ri.m_bidirectional = !IsOneWay(ft);
   ri.m_speedKMPH = GetSpeedKMPHFromFt(ft);
   ft.SwapPoints(ri.m_points);
 
-  LockFeatureMwm(featureId);
-
-  return ri;
+  return CacheRoadInfo(featureId, move(ri));
 }
 
-IRoadGraph::RoadInfo const & FeaturesRoadGraph::GetCachedRoadInfo(FeatureID const & featureId,
-                                                                  FeatureType & ft,
-                                                                  double speedKMPH) const
+FeaturesRoadGraph::TRoadInfoPtr FeaturesRoadGraph::GetCachedRoadInfo(FeatureID const & featureId,
+                                                                     FeatureType & ft,
+                                                                     double speedKMPH) const
 {
-  bool found = false;
-  RoadInfo & ri = m_cache.Find(featureId, found);
-
-  if (found)
-    return ri;
+  TRoadInfoPtr const cached = FindCachedRoadInfo(featureId);
+  if (cached)
+    return cached;
 
   // ft must be set
   ASSERT_EQUAL(featureId, ft.GetID(), ());
 
   ft.ParseGeometry(FeatureType::BEST_GEOMETRY);
 
+  RoadInfo ri;
   ri.m_bidirectional = !IsOneWay(ft);
   ri.m_speedKMPH = speedKMPH;
   ft.SwapPoints(ri.m_points);
 
-  LockFeatureMwm(featureId);
+  return CacheRoadInfo(featureId, move(ri));
+}
+
+FeaturesRoadGraph::TRoadInfoPtr FeaturesRoadGraph::FindCachedRoadInfo(FeatureID const & featureId) const
+{
+  {
+    lock_guard<mutex> guard(m_mutex);
+    TRoadInfoPtr ri = m_cache.Find(featureId);
+    if (ri)
+      return ri;
+  }
 
+  if (!m_sharedCache)
+    return TRoadInfoPtr();
+
+  TRoadInfoPtr ri = m_sharedCache->Find(featureId);
+  if (ri)
+  {
+    lock_guard<mutex> guard(m_mutex);
+    m_cache.Insert(featureId, ri);
+    LockFeatureMwm(featureId);
+  }
   return ri;
 }
 
+FeaturesRoadGraph::TRoadInfoPtr FeaturesRoadGraph::CacheRoadInfo(FeatureID const & featureId,
+                                                                 RoadInfo && ri) const
+{
+  TRoadInfoPtr const cached = m_sharedCache ? m_sharedCache->Insert(featureId, move(ri))
+                                            : make_shared<RoadInfo const>(move(ri));
+
+  lock_guard<mutex> guard(m_mutex);
+  m_cache.Insert(featureId, cached);
+  LockFeatureMwm(featureId);
+  return cached;
+}
+
 void FeaturesRoadGraph::LockFeatureMwm(FeatureID const & featureId) const
 {
   MwmSet::MwmId mwmId = featureId.m_mwmId;
@@ -310,4 +428,109 @@ void FeaturesRoadGraph::LockFeatureMwm(FeatureID const & featureId) const
   m_mwmLocks.insert(make_pair(move(mwmId), move(mwmHandle)));
 }
 
+bool FeaturesRoadGraph::LoadPrecomputedEdges(m2::PointD const & cross,
+                                             CrossEdgesLoader & edgesLoader) const
+{
+  if (m_roadGraphSectionTag.empty())
+    return false;
+
+  buffer_vector<MwmRoadGraph const *, 4> graphs;
+  {
+    lock_guard<mutex> guard(m_mutex);
+    if (!m_activeRoadGraphsValid)
+      UpdateMwmRoadGraphs();
+
+    for (MwmRoadGraph const * activeGraph : m_activeRoadGraphs)
+    {
+      m2::RectD rect = activeGraph->m_mwmId.GetInfo()->m_limitRect;
+      rect.Inflate(kMwmLimitRectEps, kMwmLimitRectEps);
+      if (!rect.IsPointInside(cross))
+        continue;
+
+      MwmRoadGraph const * graph = GetMwmRoadGraph(activeGraph->m_mwmId);
+      if (graph == nullptr)
+        return false;
+      graphs.push_back(graph);
+    }
+
+    for (MwmRoadGraph const * graph : graphs)
+      LockFeatureMwm(FeatureID(graph->m_mwmId, 0 /* index */));
+  }
+
+  // Sections are immutable, so they are read without the lock.
+  for (MwmRoadGraph const * graph : graphs)
+  {
+    graph->m_section.ForEachOutgoingEdge(cross, [&](uint32_t featureIndex, bool forward,
+                                                    uint32_t segId, m2::PointD const & start,
+                                                    m2::PointD const & end)
+    {
+      edgesLoader.AddEdge(Edge(FeatureID(graph->m_mwmId, featureIndex), forward, segId,
+                               Junction(start), Junction(end)));
+    });
+  }
+  return true;
+}
+
+FeaturesRoadGraph::MwmRoadGraph const * FeaturesRoadGraph::GetMwmRoadGraph(MwmSet::MwmId const & mwmId) const
+{
+  if (m_roadGraphSectionTag.empty() || !mwmId.IsAlive())
+    return nullptr;
+
+  unique_ptr<MwmRoadGraph> & graph = m_mwmRoadGraphs[mwmId];
+  if (!graph)
+    graph.reset(new MwmRoadGraph(mwmId));
+
+  if (!graph->m_opened)
+  {
+    graph->m_opened = true;
+    try
+    {
+      graph->m_container.Open(mwmId.GetInfo()->GetLocalFile().GetPath(MapOptions::Map));
+      if (graph->m_container.IsExist(m_roadGraphSectionTag))
+      {
+        graph->m_mapping.Assign(graph->m_container.Map(m_roadGraphSectionTag));
+        if (!graph->m_section.Attach(graph->m_mapping.GetData<char>(), graph->m_mapping.GetSize()))
+          graph->m_mapping.Unmap();
+      }
+      if (graph->m_section.IsAttached() && !m_hierarchySectionTag.empty() &&
+          graph->m_container.IsExist(m_hierarchySectionTag))
+      {
+        graph->m_hierarchyMapping.Assign(graph->m_container.Map(m_hierarchySectionTag));
+        if (!graph->m_hierarchy.Attach(graph->m_section, graph->m_hierarchyMapping.GetData<char>(),
+                                       graph->m_hierarchyMapping.GetSize()))
+        {
+          graph->m_hierarchyMapping.Unmap();
+        }
+      }
+    }
+    catch (Reader::Exception const & e)
+    {
+      LOG(LWARNING, ("Can't map road graph section of", mwmId, e.Msg()));
+    }
+  }
+
+  return graph->m_section.IsAttached() ? graph.get() : nullptr;
+}
+
+void FeaturesRoadGraph::UpdateMwmRoadGraphs() const
+{
+  m_activeRoadGraphs.clear();
+
+  vector<shared_ptr<MwmInfo>> infos;
+  m_index.GetMwmsInfo(infos);
+  for (auto const & info : infos)
+  {
+    MwmSet::MwmId const mwmId(info);
+    if (info->GetType() != MwmInfo::COUNTRY || !mwmId.IsAlive())
+      continue;
+
+    unique_ptr<MwmRoadGraph> & graph = m_mwmRoadGraphs[mwmId];
+    if (!graph)
+      graph.reset(new MwmRoadGraph(mwmId));
+    m_activeRoadGraphs.push_back(graph.get());
+  }
+
+  m_activeRoadGraphsValid = true;
+}
+
 }  // namespace routing
@@ -1,5 +1,6 @@
 #pragma once
 #include "routing/road_graph.hpp"
+#include "routing/road_info_cache.hpp"
 #include "routing/vehicle_model.hpp"
 
 #include "indexer/feature_data.hpp"
@@ -10,6 +11,9 @@
 #include "base/cache.hpp"
 
 #include "std/map.hpp"
+#include "std/mutex.hpp"
+#include "std/shared_ptr.hpp"
+#include "std/string.hpp"
 #include "std/unique_ptr.hpp"
 #include "std/vector.hpp"
 
@@ -19,9 +23,16 @@ class FeatureType;
 namespace routing
 {
 
+/// All the IRoadGraph methods may be called concurrently.
+/// Decoded roads are cached at two levels: a small per-graph cache and
+/// an optional cache shared with other graphs of the same vehicle model.
+/// When mwms have a precomputed road graph section (see RoadGraphSection),
+/// edges and speeds are taken from it instead of features.
 class FeaturesRoadGraph : public IRoadGraph
 {
 private:
+  using TRoadInfoPtr = SharedRoadInfoCache::TRoadInfoPtr;
+
   class CrossCountryVehicleModel : public IVehicleModel
   {
   public:
@@ -40,23 +51,35 @@ private:
     unique_ptr<IVehicleModelFactory> const m_vehicleModelFactory;
     double const m_maxSpeedKMPH;
 
+    mutable mutex m_mutex;
     mutable map<MwmSet::MwmId, shared_ptr<IVehicleModel>> m_cache;
   };
 
   class RoadInfoCache
   {
   public:
-    RoadInfo & Find(FeatureID const & featureId, bool & found);
+    // Returns nullptr if featureId is not cached.
+    TRoadInfoPtr Find(FeatureID const & featureId);
+    void Insert(FeatureID const & featureId, TRoadInfoPtr const & roadInfo);
 
     void Clear();
 
   private:
-    using TMwmFeatureCache = my::Cache<uint32_t, RoadInfo>;
+    using TMwmFeatureCache = my::Cache<uint32_t, TRoadInfoPtr>;
     map<MwmSet::MwmId, TMwmFeatureCache> m_cache;
   };
 
 public:
-  FeaturesRoadGraph(Index & index, unique_ptr<IVehicleModelFactory> && vehicleModelFactory);
+  /// @param sharedCache Cache of roads shared with other graphs, may be nullptr.
+  /// @param roadGraphSectionTag Tag of mwm sections with precomputed road graphs
+  /// built for the same vehicle model, empty if they shouldn't be used.
+  /// @param hierarchySectionTag Tag of mwm sections with contraction hierarchies
+  /// of the precomputed road graphs, empty if they shouldn't be used.
+  FeaturesRoadGraph(Index & index, unique_ptr<IVehicleModelFactory> && vehicleModelFactory,
+                    shared_ptr<SharedRoadInfoCache> sharedCache = nullptr,
+                    string const & roadGraphSectionTag = string(),
+                    string const & hierarchySectionTag = string());
+  ~FeaturesRoadGraph() override;
 
   static uint32_t GetStreetReadScale();
 
@@ -70,29 +93,57 @@ public:
                         vector<pair<Edge, m2::PointD>> & vicinities) const override;
   void GetFeatureTypes(FeatureID const & featureId, feature::TypesHolder & types) const override;
   void GetJunctionTypes(Junction const & junction, feature::TypesHolder & types) const override;
+  void GetContractionHierarchies(m2::PointD const & point,
+                                 vector<ContractionHierarchy const *> & hierarchies) const override;
   void ClearState() override;
 
 private:
   friend class CrossFeaturesLoader;
 
+  struct MwmRoadGraph;
+
   bool IsOneWay(FeatureType const & ft) const;
   double GetSpeedKMPHFromFt(FeatureType const & ft) const;
 
-  // Searches a feature RoadInfo in the cache, and if does not find then
+  // Searches a feature RoadInfo in the caches, and if does not find then
   // loads feature from the index and takes speed for the feature from the vehicle model.
-  RoadInfo const & GetCachedRoadInfo(FeatureID const & featureId) const;
-  // Searches a feature RoadInfo in the cache, and if does not find then takes passed feature and speed.
+  TRoadInfoPtr GetCachedRoadInfo(FeatureID const & featureId) const;
+  // Searches a feature RoadInfo in the caches, and if does not find then takes passed feature and speed.
   // This version is used to prevent redundant feature loading when feature speed is known.
-  RoadInfo const & GetCachedRoadInfo(FeatureID const & featureId,
-                                     FeatureType & ft,
-                                     double speedKMPH) const;
+  TRoadInfoPtr GetCachedRoadInfo(FeatureID const & featureId, FeatureType & ft,
+                                 double speedKMPH) const;
 
+  // Looks for a feature RoadInfo in the caches.
+  TRoadInfoPtr FindCachedRoadInfo(FeatureID const & featureId) const;
+  // Puts decoded feature RoadInfo into the caches.
+  TRoadInfoPtr CacheRoadInfo(FeatureID const & featureId, RoadInfo && ri) const;
+
+  // Keeps the feature mwm alive while the graph is used. m_mutex must be held.
   void LockFeatureMwm(FeatureID const & featureId) const;
 
+  // Passes edges of the cross from precomputed road graphs to edgesLoader.
+  // Returns false if some mwm around the cross has no precomputed graph.
+  bool LoadPrecomputedEdges(m2::PointD const & cross, CrossEdgesLoader & edgesLoader) const;
+  // Returns precomputed graph of the mwm or nullptr. m_mutex must be held.
+  MwmRoadGraph const * GetMwmRoadGraph(MwmSet::MwmId const & mwmId) const;
+  // Rereads the list of registered mwms. m_mutex must be held.
+  void UpdateMwmRoadGraphs() const;
+
   Index & m_index;
-  mutable RoadInfoCache m_cache;
+  shared_ptr<SharedRoadInfoCache> const m_sharedCache;
+  string const m_roadGraphSectionTag;
+  string const m_hierarchySectionTag;
   mutable CrossCountryVehicleModel m_vehicleModel;
+
+  // Guards the fields below.
+  mutable mutex m_mutex;
+  mutable RoadInfoCache m_cache;
   mutable map<MwmSet::MwmId, MwmSet::MwmHandle> m_mwmLocks;
+  // Precomputed road graphs of mwms, which were ever used, sections are mapped lazily.
+  mutable map<MwmSet::MwmId, unique_ptr<MwmRoadGraph>> m_mwmRoadGraphs;
+  // Road graphs of currently registered country mwms.
+  mutable vector<MwmRoadGraph *> m_activeRoadGraphs;
+  mutable bool m_activeRoadGraphsValid = false;
 };
 
 }  // namespace routing
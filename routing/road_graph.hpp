@@ -13,6 +13,8 @@
 namespace routing
 {
 
+class ContractionHierarchy;
+
 /// The Junction class represents a node description on a road network graph
 class Junction
 {
@@ -107,6 +109,9 @@ public:
 
     void operator()(FeatureID const & featureId, RoadInfo const & roadInfo);
 
+    /// Adds an outgoing edge of the cross, which is known in advance, e.g. a precomputed one.
+    inline void AddEdge(Edge const & edge) { m_outgoingEdges.push_back(edge); }
+
   private:
     m2::PointD const m_cross;
     TEdgeVector & m_outgoingEdges;
@@ -139,7 +144,8 @@ public:
   /// Returns max speed in KM/H
   virtual double GetMaxSpeedKMPH() const = 0;
 
-  /// Calls edgesLoader on each feature which is close to cross.
+  /// Calls edgesLoader on each feature which is close to cross
+  /// or passes edges of the cross to it directly.
   virtual void ForEachFeatureClosestToCross(m2::PointD const & cross,
                                             CrossEdgesLoader & edgesLoader) const = 0;
 
@@ -158,6 +164,13 @@ public:
   /// @return Types for specified junction
   virtual void GetJunctionTypes(Junction const & junction, feature::TypesHolder & types) const = 0;
 
+  /// Adds precomputed contraction hierarchies of the graph, which may contain
+  /// junctions around point. Hierarchies are valid until ClearState() is called.
+  virtual void GetContractionHierarchies(m2::PointD const & /* point */,
+                                         vector<ContractionHierarchy const *> & /* hierarchies */) const
+  {
+  }
+
   /// Clear all temporary buffers.
   virtual void ClearState() {}
 
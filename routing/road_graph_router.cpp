@@ -22,6 +22,8 @@
 
 #include "base/assert.hpp"
 
+#include "defines.hpp"
+
 using platform::CountryFile;
 using platform::LocalCountryFile;
 
@@ -132,6 +134,16 @@ void FindClosestEdges(IRoadGraph const & graph, m2::PointD const & point,
     }
   }
 }
+
+// Roads decoded for pedestrians are shared by all pedestrian routers.
+uint64_t constexpr kPedestrianRoadInfoCacheBytes = 32 * 1024 * 1024;
+
+shared_ptr<SharedRoadInfoCache> GetPedestrianRoadInfoCache()
+{
+  static shared_ptr<SharedRoadInfoCache> const cache =
+      make_shared<SharedRoadInfoCache>(kPedestrianRoadInfoCacheBytes);
+  return cache;
+}
 }  // namespace
 
 RoadGraphRouter::~RoadGraphRouter() {}
@@ -140,12 +152,17 @@ RoadGraphRouter::RoadGraphRouter(string const & name, Index & index,
                                  TCountryFileFn const & countryFileFn,
                                  unique_ptr<IVehicleModelFactory> && vehicleModelFactory,
                                  unique_ptr<IRoutingAlgorithm> && algorithm,
-                                 unique_ptr<IDirectionsEngine> && directionsEngine)
+                                 unique_ptr<IDirectionsEngine> && directionsEngine,
+                                 shared_ptr<SharedRoadInfoCache> sharedRoadInfoCache,
+                                 string const & roadGraphSectionTag,
+                                 string const & hierarchySectionTag)
     : m_name(name)
     , m_countryFileFn(countryFileFn)
     , m_index(index)
     , m_algorithm(move(algorithm))
-    , m_roadGraph(make_unique<FeaturesRoadGraph>(index, move(vehicleModelFactory)))
+    , m_roadGraph(make_unique<FeaturesRoadGraph>(index, move(vehicleModelFactory),
+                                                 move(sharedRoadInfoCache), roadGraphSectionTag,
+                                                 hierarchySectionTag))
     , m_directionsEngine(move(directionsEngine))
 {
 }
@@ -263,7 +280,7 @@ unique_ptr<IRouter> CreatePedestrianAStarRouter(Index & index, TCountryFileFn co
   unique_ptr<IVehicleModelFactory> vehicleModelFactory(new PedestrianModelFactory());
   unique_ptr<IRoutingAlgorithm> algorithm(new AStarRoutingAlgorithm());
   unique_ptr<IDirectionsEngine> directionsEngine(new PedestrianDirectionsEngine());
-  unique_ptr<IRouter> router(new RoadGraphRouter("astar-pedestrian", index, countryFileFn, move(vehicleModelFactory), move(algorithm), move(directionsEngine)));
+  unique_ptr<IRouter> router(new RoadGraphRouter("astar-pedestrian", index, countryFileFn, move(vehicleModelFactory), move(algorithm), move(directionsEngine), GetPedestrianRoadInfoCache(), PEDESTRIAN_GRAPH_FILE_TAG));
   return router;
 }
 
@@ -272,7 +289,25 @@ unique_ptr<IRouter> CreatePedestrianAStarBidirectionalRouter(Index & index, TCou
   unique_ptr<IVehicleModelFactory> vehicleModelFactory(new PedestrianModelFactory());
   unique_ptr<IRoutingAlgorithm> algorithm(new AStarBidirectionalRoutingAlgorithm());
   unique_ptr<IDirectionsEngine> directionsEngine(new PedestrianDirectionsEngine());
-  unique_ptr<IRouter> router(new RoadGraphRouter("astar-bidirectional-pedestrian", index, countryFileFn, move(vehicleModelFactory), move(algorithm), move(directionsEngine)));
+  unique_ptr<IRouter> router(new RoadGraphRouter("astar-bidirectional-pedestrian", index, countryFileFn, move(vehicleModelFactory), move(algorithm), move(directionsEngine), GetPedestrianRoadInfoCache(), PEDESTRIAN_GRAPH_FILE_TAG));
+  return router;
+}
+
+unique_ptr<IRouter> CreatePedestrianAStarBidirectionalParallelRouter(Index & index, TCountryFileFn const & countryFileFn)
+{
+  unique_ptr<IVehicleModelFactory> vehicleModelFactory(new PedestrianModelFactory());
+  unique_ptr<IRoutingAlgorithm> algorithm(new AStarBidirectionalParallelRoutingAlgorithm());
+  unique_ptr<IDirectionsEngine> directionsEngine(new PedestrianDirectionsEngine());
+  unique_ptr<IRouter> router(new RoadGraphRouter("astar-bidirectional-parallel-pedestrian", index, countryFileFn, move(vehicleModelFactory), move(algorithm), move(directionsEngine), GetPedestrianRoadInfoCache(), PEDESTRIAN_GRAPH_FILE_TAG));
+  return router;
+}
+
+unique_ptr<IRouter> CreatePedestrianContractionHierarchyRouter(Index & index, TCountryFileFn const & countryFileFn)
+{
+  unique_ptr<IVehicleModelFactory> vehicleModelFactory(new PedestrianModelFactory());
+  unique_ptr<IRoutingAlgorithm> algorithm(new ContractionHierarchyRoutingAlgorithm());
+  unique_ptr<IDirectionsEngine> directionsEngine(new PedestrianDirectionsEngine());
+  unique_ptr<IRouter> router(new RoadGraphRouter("ch-pedestrian", index, countryFileFn, move(vehicleModelFactory), move(algorithm), move(directionsEngine), GetPedestrianRoadInfoCache(), PEDESTRIAN_GRAPH_FILE_TAG, PEDESTRIAN_HIERARCHY_FILE_TAG));
   return router;
 }
 
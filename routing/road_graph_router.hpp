@@ -2,6 +2,7 @@
 
 #include "routing/directions_engine.hpp"
 #include "routing/road_graph.hpp"
+#include "routing/road_info_cache.hpp"
 #include "routing/router.hpp"
 #include "routing/routing_algorithm.hpp"
 #include "routing/vehicle_model.hpp"
@@ -11,6 +12,7 @@
 #include "geometry/point2d.hpp"
 
 #include "std/function.hpp"
+#include "std/shared_ptr.hpp"
 #include "std/string.hpp"
 #include "std/unique_ptr.hpp"
 #include "std/vector.hpp"
@@ -27,7 +29,10 @@ public:
                   TCountryFileFn const & countryFileFn,
                   unique_ptr<IVehicleModelFactory> && vehicleModelFactory,
                   unique_ptr<IRoutingAlgorithm> && algorithm,
-                  unique_ptr<IDirectionsEngine> && directionsEngine);
+                  unique_ptr<IDirectionsEngine> && directionsEngine,
+                  shared_ptr<SharedRoadInfoCache> sharedRoadInfoCache = nullptr,
+                  string const & roadGraphSectionTag = string(),
+                  string const & hierarchySectionTag = string());
   ~RoadGraphRouter() override;
 
   // IRouter overrides:
@@ -56,4 +61,7 @@ private:
 unique_ptr<IRouter> CreatePedestrianAStarRouter(Index & index, TCountryFileFn const & countryFileFn);
 
 unique_ptr<IRouter> CreatePedestrianAStarBidirectionalRouter(Index & index, TCountryFileFn const & countryFileFn);
+
+unique_ptr<IRouter> CreatePedestrianAStarBidirectionalParallelRouter(Index & index, TCountryFileFn const & countryFileFn);
+unique_ptr<IRouter> CreatePedestrianContractionHierarchyRouter(Index & index, TCountryFileFn const & countryFileFn);
 }  // namespace routing
@@ -0,0 +1,221 @@
+#include "routing/road_graph_section.hpp"
+
+#include "coding/write_to_sink.hpp"
+
+#include "base/assert.hpp"
+#include "base/logging.hpp"
+
+#include "std/algorithm.hpp"
+
+namespace routing
+{
+namespace
+{
+uint32_t constexpr kHeaderSize = 4 * sizeof(uint32_t);
+
+bool LessByXY(m2::PointD const & a, m2::PointD const & b)
+{
+  if (a.x != b.x)
+    return a.x < b.x;
+  return a.y < b.y;
+}
+
+bool EqualXY(m2::PointD const & a, m2::PointD const & b) { return a.x == b.x && a.y == b.y; }
+
+void WriteDouble(Writer & writer, double value)
+{
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  WriteToSink(writer, bits);
+}
+
+struct EdgeRecord
+{
+  uint32_t m_junction;
+  uint32_t m_road;
+  uint32_t m_seg;
+  uint32_t m_target;
+};
+}  // namespace
+
+uint32_t constexpr RoadGraphSection::kVersion;
+uint32_t constexpr RoadGraphSection::kInvalidJunction;
+double constexpr RoadGraphSection::kPointEqualityEps;
+uint32_t constexpr RoadGraphSection::kForwardBit;
+uint32_t constexpr RoadGraphSection::kEdgeRecordSize;
+
+// static
+void RoadGraphSection::Serialize(vector<Road> & roads, Writer & writer)
+{
+  roads.erase(remove_if(roads.begin(), roads.end(), [](Road const & road)
+              {
+                return road.m_info.m_speedKMPH <= 0.0 || road.m_info.m_points.empty();
+              }), roads.end());
+  sort(roads.begin(), roads.end(), [](Road const & a, Road const & b)
+       {
+         return a.m_featureIndex < b.m_featureIndex;
+       });
+  roads.erase(unique(roads.begin(), roads.end(), [](Road const & a, Road const & b)
+              {
+                return a.m_featureIndex == b.m_featureIndex;
+              }), roads.end());
+
+  vector<m2::PointD> junctions;
+  for (Road const & road : roads)
+    junctions.insert(junctions.end(), road.m_info.m_points.begin(), road.m_info.m_points.end());
+  sort(junctions.begin(), junctions.end(), &LessByXY);
+  junctions.erase(unique(junctions.begin(), junctions.end(), &EqualXY), junctions.end());
+
+  auto const getJunction = [&junctions](m2::PointD const & p)
+  {
+    auto const it = lower_bound(junctions.begin(), junctions.end(), p, &LessByXY);
+    ASSERT(it != junctions.end() && EqualXY(*it, p), ());
+    return static_cast<uint32_t>(distance(junctions.begin(), it));
+  };
+
+  // The same edges as IRoadGraph::CrossEdgesLoader makes.
+  vector<EdgeRecord> edges;
+  for (uint32_t r = 0; r < roads.size(); ++r)
+  {
+    auto const & points = roads[r].m_info.m_points;
+    size_t const numPoints = points.size();
+    for (size_t i = 0; i < numPoints; ++i)
+    {
+      uint32_t const junction = getJunction(points[i]);
+      if (i > 0)
+        edges.push_back({junction, r, static_cast<uint32_t>(i - 1), getJunction(points[i - 1])});
+      if (i + 1 < numPoints)
+        edges.push_back({junction, r, static_cast<uint32_t>(i) | kForwardBit, getJunction(points[i + 1])});
+    }
+  }
+  stable_sort(edges.begin(), edges.end(), [](EdgeRecord const & a, EdgeRecord const & b)
+              {
+                return a.m_junction < b.m_junction;
+              });
+
+  WriteToSink(writer, kVersion);
+  WriteToSink(writer, static_cast<uint32_t>(junctions.size()));
+  WriteToSink(writer, static_cast<uint32_t>(edges.size()));
+  WriteToSink(writer, static_cast<uint32_t>(roads.size()));
+
+  for (m2::PointD const & p : junctions)
+  {
+    WriteDouble(writer, p.x);
+    WriteDouble(writer, p.y);
+  }
+
+  uint32_t e = 0;
+  for (uint32_t j = 0; j <= junctions.size(); ++j)
+  {
+    while (e < edges.size() && edges[e].m_junction < j)
+      ++e;
+    WriteToSink(writer, e);
+  }
+
+  for (EdgeRecord const & edge : edges)
+  {
+    WriteToSink(writer, edge.m_road);
+    WriteToSink(writer, edge.m_seg);
+    WriteToSink(writer, edge.m_target);
+  }
+
+  for (Road const & road : roads)
+    WriteToSink(writer, road.m_featureIndex);
+  for (Road const & road : roads)
+    WriteDouble(writer, road.m_info.m_speedKMPH);
+}
+
+bool RoadGraphSection::Attach(char const * data, uint64_t size)
+{
+  *this = RoadGraphSection();
+
+  if (size < kHeaderSize)
+    return false;
+
+  uint32_t const version = Read<uint32_t>(data, 0);
+  if (version != kVersion)
+  {
+    LOG(LWARNING, ("Unknown road graph section version:", version));
+    return false;
+  }
+
+  uint32_t const junctionsCount = Read<uint32_t>(data, 1);
+  uint32_t const edgesCount = Read<uint32_t>(data, 2);
+  uint32_t const roadsCount = Read<uint32_t>(data, 3);
+
+  uint64_t const junctionsSize = 2 * sizeof(double) * static_cast<uint64_t>(junctionsCount);
+  uint64_t const offsetsSize = sizeof(uint32_t) * (static_cast<uint64_t>(junctionsCount) + 1);
+  uint64_t const edgesSize = kEdgeRecordSize * static_cast<uint64_t>(edgesCount);
+  uint64_t const roadsSize = (sizeof(uint32_t) + sizeof(double)) * static_cast<uint64_t>(roadsCount);
+  if (size != kHeaderSize + junctionsSize + offsetsSize + edgesSize + roadsSize)
+  {
+    LOG(LWARNING, ("Wrong road graph section size:", size));
+    return false;
+  }
+
+  m_junctionsCount = junctionsCount;
+  m_edgesCount = edgesCount;
+  m_roadsCount = roadsCount;
+
+  m_junctions = data + kHeaderSize;
+  m_offsets = m_junctions + junctionsSize;
+  m_edges = m_offsets + offsetsSize;
+  m_roadFeatures = m_edges + edgesSize;
+  m_roadSpeeds = m_roadFeatures + sizeof(uint32_t) * static_cast<uint64_t>(roadsCount);
+  return true;
+}
+
+uint32_t RoadGraphSection::FindJunction(m2::PointD const & point) const
+{
+  uint32_t result = kInvalidJunction;
+  for (uint32_t i = LowerBoundX(point.x - kPointEqualityEps); i < m_junctionsCount; ++i)
+  {
+    m2::PointD const p = GetJunction(i);
+    if (p.x > point.x + kPointEqualityEps)
+      break;
+    if (fabs(p.y - point.y) > kPointEqualityEps)
+      continue;
+    if (EqualXY(p, point))
+      return i;
+    if (result == kInvalidJunction)
+      result = i;
+  }
+  return result;
+}
+
+bool RoadGraphSection::GetSpeedKMPH(uint32_t featureIndex, double & speedKMPH) const
+{
+  uint32_t lo = 0;
+  uint32_t hi = m_roadsCount;
+  while (lo < hi)
+  {
+    uint32_t const mid = lo + (hi - lo) / 2;
+    if (Read<uint32_t>(m_roadFeatures, mid) < featureIndex)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo == m_roadsCount || Read<uint32_t>(m_roadFeatures, lo) != featureIndex)
+    return false;
+
+  speedKMPH = Read<double>(m_roadSpeeds, lo);
+  return true;
+}
+
+uint32_t RoadGraphSection::LowerBoundX(double minX) const
+{
+  uint32_t lo = 0;
+  uint32_t hi = m_junctionsCount;
+  while (lo < hi)
+  {
+    uint32_t const mid = lo + (hi - lo) / 2;
+    if (GetJunction(mid).x < minX)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+}  // namespace routing
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "routing/road_graph.hpp"
+
+#include "coding/endianness.hpp"
+#include "coding/writer.hpp"
+
+#include "geometry/point2d.hpp"
+
+#include "base/assert.hpp"
+
+#include "std/cmath.hpp"
+#include "std/cstdint.hpp"
+#include "std/cstring.hpp"
+#include "std/limits.hpp"
+#include "std/type_traits.hpp"
+#include "std/vector.hpp"
+
+namespace routing
+{
+
+/// Precomputed road graph of one mwm, which is written to a separate mwm
+/// section by the generator and is read through the memory mapping.
+/// It keeps the same outgoing edges which IRoadGraph::CrossEdgesLoader
+/// creates for features around a junction, so edges are found by a binary
+/// search instead of a spatial query.
+///
+/// Section layout, all the values are little-endian, doubles are written
+/// as their IEEE 754 bits:
+///   uint32_t version, junctionsCount, edgesCount, roadsCount;
+///   m2::PointD junctions[junctionsCount];      // sorted
+///   uint32_t edgesOffsets[junctionsCount + 1]; // CSR: edges of junction i are
+///                                              // in [edgesOffsets[i], edgesOffsets[i + 1])
+///   EdgeRecord edges[edgesCount];
+///   uint32_t roadFeatures[roadsCount];          // sorted feature indexes
+///   double roadSpeeds[roadsCount];              // KM/H
+class RoadGraphSection
+{
+public:
+  static uint32_t constexpr kVersion = 0;
+  static uint32_t constexpr kInvalidJunction = numeric_limits<uint32_t>::max();
+
+  struct Road
+  {
+    Road(uint32_t featureIndex, IRoadGraph::RoadInfo && info)
+      : m_featureIndex(featureIndex), m_info(move(info))
+    {
+    }
+
+    uint32_t m_featureIndex;
+    IRoadGraph::RoadInfo m_info;
+  };
+
+  /// Writes section for roads with positive speeds.
+  static void Serialize(vector<Road> & roads, Writer & writer);
+
+  /// Attaches to the serialized section. Data should be alive while the object is used.
+  /// @return False if data is not a valid section.
+  bool Attach(char const * data, uint64_t size);
+
+  inline bool IsAttached() const { return m_junctions != nullptr; }
+  inline uint32_t GetJunctionsCount() const { return m_junctionsCount; }
+  inline uint32_t GetEdgesCount() const { return m_edgesCount; }
+  inline uint32_t GetRoadsCount() const { return m_roadsCount; }
+
+  inline m2::PointD GetJunction(uint32_t i) const
+  {
+    ASSERT_LESS(i, m_junctionsCount, ());
+    return m2::PointD(Read<double>(m_junctions, 2 * i), Read<double>(m_junctions, 2 * i + 1));
+  }
+
+  /// @return Index of a junction, which is almost equal to point, or kInvalidJunction.
+  uint32_t FindJunction(m2::PointD const & point) const;
+
+  /// Calls fn(featureIndex, forward, segId, startPoint, endPoint) for every
+  /// outgoing edge of junctions, which are almost equal to cross.
+  template <typename TFn>
+  void ForEachOutgoingEdge(m2::PointD const & cross, TFn && fn) const
+  {
+    for (uint32_t i = LowerBoundX(cross.x - kPointEqualityEps); i < m_junctionsCount; ++i)
+    {
+      m2::PointD const p = GetJunction(i);
+      if (p.x > cross.x + kPointEqualityEps)
+        break;
+      if (fabs(p.y - cross.y) > kPointEqualityEps)
+        continue;
+
+      ForEachEdgeRecord(i, [&](uint32_t road, uint32_t seg, uint32_t target)
+      {
+        fn(Read<uint32_t>(m_roadFeatures, road), (seg & kForwardBit) != 0, seg & ~kForwardBit, p,
+           GetJunction(target));
+      });
+    }
+  }
+
+  /// Calls fn(junction, targetJunction, speedKMPH) for every edge of the graph.
+  template <typename TFn>
+  void ForEachEdge(TFn && fn) const
+  {
+    for (uint32_t i = 0; i < m_junctionsCount; ++i)
+    {
+      ForEachEdgeRecord(i, [&](uint32_t road, uint32_t /* seg */, uint32_t target)
+      {
+        fn(i, target, Read<double>(m_roadSpeeds, road));
+      });
+    }
+  }
+
+  /// @return False if there is no feature with featureIndex in the section.
+  bool GetSpeedKMPH(uint32_t featureIndex, double & speedKMPH) const;
+
+private:
+  // The same precision as in IRoadGraph::CrossEdgesLoader.
+  static double constexpr kPointEqualityEps = 1e-6;
+  static uint32_t constexpr kForwardBit = 1U << 31;
+  // roadIndex, segId with kForwardBit and target junction.
+  static uint32_t constexpr kEdgeRecordSize = 3 * sizeof(uint32_t);
+
+  // Section offsets aren't aligned, so values are copied.
+  template <typename T>
+  static inline T Read(char const * base, uint32_t i)
+  {
+    using TBits = typename conditional<sizeof(T) == sizeof(uint64_t), uint64_t, uint32_t>::type;
+    static_assert(sizeof(T) == sizeof(TBits), "Only 32 and 64 bit values are supported.");
+
+    TBits bits;
+    memcpy(&bits, base + static_cast<size_t>(i) * sizeof(T), sizeof(T));
+    bits = SwapIfBigEndian(bits);
+    T value;
+    memcpy(&value, &bits, sizeof(T));
+    return value;
+  }
+
+  // Returns the first junction with x >= minX.
+  uint32_t LowerBoundX(double minX) const;
+
+  template <typename TFn>
+  void ForEachEdgeRecord(uint32_t junction, TFn && fn) const
+  {
+    uint32_t const end = Read<uint32_t>(m_offsets, junction + 1);
+    for (uint32_t e = Read<uint32_t>(m_offsets, junction); e < end; ++e)
+    {
+      char const * edge = m_edges + e * kEdgeRecordSize;
+      fn(Read<uint32_t>(edge, 0), Read<uint32_t>(edge, 1), Read<uint32_t>(edge, 2));
+    }
+  }
+
+  uint32_t m_junctionsCount = 0;
+  uint32_t m_edgesCount = 0;
+  uint32_t m_roadsCount = 0;
+
+  char const * m_junctions = nullptr;
+  char const * m_offsets = nullptr;
+  char const * m_edges = nullptr;
+  char const * m_roadFeatures = nullptr;
+  char const * m_roadSpeeds = nullptr;
+};
+
+}  // namespace routing
@@ -0,0 +1,202 @@
+#include "routing/road_info_cache.hpp"
+
+#include "base/assert.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/functional.hpp"
+#include "std/sstream.hpp"
+
+namespace routing
+{
+namespace
+{
+// Approximate memory used by a hash table node, a shared_ptr control block and so on.
+uint64_t constexpr kRoadOverheadBytes = 64;
+// Number of points stored inside RoadInfo without a heap allocation.
+size_t constexpr kInplacePointsCount = 32;
+}  // namespace
+
+SharedRoadInfoCache::SharedRoadInfoCache(uint64_t maxBytes, uint32_t shardsCount)
+  : m_maxBytesPerShard(maxBytes / max(shardsCount, static_cast<uint32_t>(1)))
+{
+  shardsCount = max(shardsCount, static_cast<uint32_t>(1));
+  m_shards.reserve(shardsCount);
+  for (uint32_t i = 0; i < shardsCount; ++i)
+    m_shards.emplace_back(new Shard());
+}
+
+SharedRoadInfoCache::~SharedRoadInfoCache() = default;
+
+SharedRoadInfoCache::TRoadInfoPtr SharedRoadInfoCache::Find(FeatureID const & featureId)
+{
+  Key const key(featureId);
+  Shard & shard = GetShard(key);
+  lock_guard<mutex> guard(shard.m_mutex);
+
+  auto const it = shard.m_positions.find(key);
+  if (it == shard.m_positions.end())
+  {
+    ++shard.m_misses;
+    return TRoadInfoPtr();
+  }
+
+  // MwmInfo of the cached road is released, and the new one took its place.
+  if (shard.m_entries[it->second].IsExpired())
+  {
+    shard.Erase(it->second);
+    ++shard.m_misses;
+    return TRoadInfoPtr();
+  }
+
+  ++shard.m_hits;
+  Entry & entry = shard.m_entries[it->second];
+  entry.m_referenced = true;
+  return entry.m_roadInfo;
+}
+
+SharedRoadInfoCache::TRoadInfoPtr SharedRoadInfoCache::Insert(FeatureID const & featureId,
+                                                              IRoadGraph::RoadInfo && roadInfo)
+{
+  uint64_t const bytes = GetRoadInfoBytes(roadInfo);
+  TRoadInfoPtr ptr = make_shared<IRoadGraph::RoadInfo>(move(roadInfo));
+
+  Key const key(featureId);
+  Shard & shard = GetShard(key);
+  lock_guard<mutex> guard(shard.m_mutex);
+
+  auto const it = shard.m_positions.find(key);
+  if (it != shard.m_positions.end())
+  {
+    if (!shard.m_entries[it->second].IsExpired())
+      return shard.m_entries[it->second].m_roadInfo;
+    shard.Erase(it->second);
+  }
+
+  // Roads which don't fit into the shard at all are not cached.
+  if (bytes > m_maxBytesPerShard)
+    return ptr;
+
+  shard.Reserve(bytes, m_maxBytesPerShard);
+
+  uint32_t pos;
+  if (shard.m_freeEntries.empty())
+  {
+    pos = static_cast<uint32_t>(shard.m_entries.size());
+    shard.m_entries.emplace_back();
+  }
+  else
+  {
+    pos = shard.m_freeEntries.back();
+    shard.m_freeEntries.pop_back();
+  }
+
+  Entry & entry = shard.m_entries[pos];
+  entry.m_key = key;
+  entry.m_mwm = featureId.m_mwmId.GetInfo();
+  entry.m_roadInfo = ptr;
+  entry.m_bytes = bytes;
+  entry.m_referenced = false;
+
+  shard.m_positions.emplace(key, pos);
+  shard.m_bytes += bytes;
+  return ptr;
+}
+
+void SharedRoadInfoCache::Clear()
+{
+  for (auto & shard : m_shards)
+  {
+    lock_guard<mutex> guard(shard->m_mutex);
+    shard->Clear();
+  }
+}
+
+SharedRoadInfoCache::Stats SharedRoadInfoCache::GetStats() const
+{
+  Stats stats;
+  for (auto const & shard : m_shards)
+  {
+    lock_guard<mutex> guard(shard->m_mutex);
+    stats.m_hits += shard->m_hits;
+    stats.m_misses += shard->m_misses;
+    stats.m_evictions += shard->m_evictions;
+    stats.m_bytes += shard->m_bytes;
+    stats.m_roads += shard->m_positions.size();
+  }
+  return stats;
+}
+
+// static
+uint64_t SharedRoadInfoCache::GetRoadInfoBytes(IRoadGraph::RoadInfo const & roadInfo)
+{
+  uint64_t bytes = sizeof(Entry) + sizeof(IRoadGraph::RoadInfo) + kRoadOverheadBytes;
+  if (roadInfo.m_points.size() > kInplacePointsCount)
+    bytes += roadInfo.m_points.size() * sizeof(m2::PointD);
+  return bytes;
+}
+
+size_t SharedRoadInfoCache::KeyHash::operator()(Key const & key) const
+{
+  size_t const mwmHash = hash<MwmInfo const *>()(key.m_mwm);
+  return mwmHash ^ (hash<uint32_t>()(key.m_index) + 0x9e3779b9 + (mwmHash << 6) + (mwmHash >> 2));
+}
+
+void SharedRoadInfoCache::Shard::Reserve(uint64_t newBytes, uint64_t maxBytes)
+{
+  while (m_bytes + newBytes > maxBytes && !m_positions.empty())
+  {
+    if (m_hand >= m_entries.size())
+      m_hand = 0;
+
+    Entry & entry = m_entries[m_hand];
+    if (entry.m_roadInfo)
+    {
+      // Roads of released mwms don't get the second chance.
+      if (entry.m_referenced && !entry.IsExpired())
+      {
+        entry.m_referenced = false;
+      }
+      else
+      {
+        Erase(m_hand);
+        ++m_evictions;
+      }
+    }
+    ++m_hand;
+  }
+}
+
+void SharedRoadInfoCache::Shard::Erase(uint32_t pos)
+{
+  Entry & entry = m_entries[pos];
+  ASSERT(entry.m_roadInfo, ());
+  m_positions.erase(entry.m_key);
+  m_bytes -= entry.m_bytes;
+  entry = Entry();
+  m_freeEntries.push_back(pos);
+}
+
+void SharedRoadInfoCache::Shard::Clear()
+{
+  m_positions.clear();
+  m_entries.clear();
+  m_freeEntries.clear();
+  m_hand = 0;
+  m_bytes = 0;
+}
+
+SharedRoadInfoCache::Shard & SharedRoadInfoCache::GetShard(Key const & key)
+{
+  return *m_shards[KeyHash()(key) % m_shards.size()];
+}
+
+string DebugPrint(SharedRoadInfoCache::Stats const & stats)
+{
+  ostringstream os;
+  os << "SharedRoadInfoCache::Stats [ hits: " << stats.m_hits << ", misses: " << stats.m_misses
+     << ", evictions: " << stats.m_evictions << ", bytes: " << stats.m_bytes
+     << ", roads: " << stats.m_roads << " ]";
+  return os.str();
+}
+
+}  // namespace routing
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "routing/road_graph.hpp"
+
+#include "indexer/feature_decl.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/mutex.hpp"
+#include "std/shared_ptr.hpp"
+#include "std/string.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/unordered_map.hpp"
+#include "std/vector.hpp"
+#include "std/weak_ptr.hpp"
+
+namespace routing
+{
+
+/// Thread-safe cache of decoded roads, which may be shared by road graphs
+/// of several routers and concurrent requests. All roads in the cache must
+/// be decoded for the same vehicle model, since RoadInfo keeps speed.
+/// Memory is bounded by the approximate size of cached roads. When the bound is
+/// exceeded roads are evicted by CLOCK (second chance) policy.
+/// The cache doesn't keep mwms alive: roads of an mwm are dropped when its MwmInfo
+/// is released, e.g. after the mwm is deregistered or updated.
+class SharedRoadInfoCache
+{
+public:
+  using TRoadInfoPtr = shared_ptr<IRoadGraph::RoadInfo const>;
+
+  struct Stats
+  {
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_evictions = 0;
+    uint64_t m_bytes = 0;
+    uint64_t m_roads = 0;
+  };
+
+  /// @param maxBytes Approximate bound of memory used by cached roads.
+  /// @param shardsCount Number of independently locked parts of the cache.
+  explicit SharedRoadInfoCache(uint64_t maxBytes, uint32_t shardsCount = 16);
+  ~SharedRoadInfoCache();
+
+  /// @return Cached road or nullptr.
+  TRoadInfoPtr Find(FeatureID const & featureId);
+
+  /// Puts road to the cache.
+  /// @return Cached road, which may differ from the passed one if the same
+  /// road has been put concurrently.
+  TRoadInfoPtr Insert(FeatureID const & featureId, IRoadGraph::RoadInfo && roadInfo);
+
+  void Clear();
+
+  Stats GetStats() const;
+
+  /// @return Approximate number of bytes used by cached roadInfo.
+  static uint64_t GetRoadInfoBytes(IRoadGraph::RoadInfo const & roadInfo);
+
+private:
+  struct Key
+  {
+    Key() = default;
+    explicit Key(FeatureID const & featureId)
+      : m_mwm(featureId.m_mwmId.GetInfo().get()), m_index(featureId.m_index)
+    {
+    }
+
+    bool operator==(Key const & rhs) const { return m_mwm == rhs.m_mwm && m_index == rhs.m_index; }
+
+    MwmInfo const * m_mwm = nullptr;
+    uint32_t m_index = 0;
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(Key const & key) const;
+  };
+
+  struct Entry
+  {
+    // @return True when the mwm of the road has been released.
+    bool IsExpired() const { return m_key.m_mwm != nullptr && m_mwm.expired(); }
+
+    Key m_key;
+    weak_ptr<MwmInfo> m_mwm;
+    TRoadInfoPtr m_roadInfo;
+    uint64_t m_bytes = 0;
+    bool m_referenced = false;
+  };
+
+  struct Shard
+  {
+    // Evicts roads until newBytes more bytes fit into maxBytes.
+    void Reserve(uint64_t newBytes, uint64_t maxBytes);
+    void Erase(uint32_t pos);
+    void Clear();
+
+    mutable mutex m_mutex;
+    unordered_map<Key, uint32_t, KeyHash> m_positions;
+    // Ring of the CLOCK policy, empty entries are reused.
+    vector<Entry> m_entries;
+    vector<uint32_t> m_freeEntries;
+    uint32_t m_hand = 0;
+    uint64_t m_bytes = 0;
+
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_evictions = 0;
+  };
+
+  Shard & GetShard(Key const & key);
+
+  uint64_t const m_maxBytesPerShard;
+  vector<unique_ptr<Shard>> m_shards;
+};
+
+string DebugPrint(SharedRoadInfoCache::Stats const & stats);
+
+}  // namespace routing
@@ -16,6 +16,7 @@ SOURCES += \
     async_router.cpp \
     base/followed_polyline.cpp \
     car_model.cpp \
+    contraction_hierarchy.cpp \
     cross_mwm_road_graph.cpp \
     cross_mwm_router.cpp \
     cross_routing_context.cpp \
@@ -29,7 +30,9 @@ SOURCES += \
     pedestrian_directions.cpp \
     pedestrian_model.cpp \
     road_graph.cpp \
+    road_graph_section.cpp \
     road_graph_router.cpp \
+    road_info_cache.cpp \
     route.cpp \
     router.cpp \
     router_delegate.cpp \
@@ -49,6 +52,7 @@ HEADERS += \
     base/astar_algorithm.hpp \
     base/followed_polyline.hpp \
     car_model.hpp \
+    contraction_hierarchy.hpp \
     cross_mwm_road_graph.hpp \
     cross_mwm_router.hpp \
     cross_routing_context.hpp \
@@ -64,7 +68,9 @@ HEADERS += \
     pedestrian_directions.hpp \
     pedestrian_model.hpp \
     road_graph.hpp \
+    road_graph_section.hpp \
     road_graph_router.hpp \
+    road_info_cache.hpp \
     route.hpp \
     router.hpp \
     router_delegate.hpp \
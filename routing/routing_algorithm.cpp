@@ -1,3 +1,4 @@
+#include "routing/contraction_hierarchy.hpp"
 #include "routing/road_graph.hpp"
 #include "routing/routing_algorithm.hpp"
 #include "routing/base/astar_algorithm.hpp"
@@ -7,6 +8,11 @@
 
 #include "indexer/mercator.hpp"
 
+#include "std/algorithm.hpp"
+#include "std/limits.hpp"
+#include "std/map.hpp"
+#include "std/queue.hpp"
+
 namespace routing
 {
 
@@ -95,6 +101,123 @@ private:
 
 typedef AStarAlgorithm<RoadGraph> TAlgorithmImpl;
 
+// Max number of junctions around start and final positions, which are visited before
+// junctions of a contraction hierarchy are reached.
+size_t constexpr kMaxHierarchyAccessJunctions = 256;
+
+/// Dijkstra search from a fake position, which stops at junctions of a contraction
+/// hierarchy. Found junctions are sources (or targets) of the hierarchy search.
+class HierarchyAccessSearch
+{
+public:
+  HierarchyAccessSearch(RoadGraph const & graph, ContractionHierarchy const & hierarchy,
+                        bool forward)
+    : m_graph(graph), m_hierarchy(hierarchy), m_forward(forward)
+  {
+  }
+
+  /// @return False if there're too many junctions around pos.
+  bool Run(Junction const & pos)
+  {
+    using TQueueItem = pair<double, Junction>;
+    priority_queue<TQueueItem, vector<TQueueItem>, greater<TQueueItem>> queue;
+
+    m_states[pos] = State(0.0, pos);
+    queue.emplace(0.0, pos);
+
+    size_t visited = 0;
+    vector<WeightedEdge> adj;
+    while (!queue.empty())
+    {
+      TQueueItem const top = queue.top();
+      queue.pop();
+      Junction const & v = top.second;
+      if (top.first > m_states[v].m_weight)
+        continue;
+
+      uint32_t const node = m_hierarchy.FindNode(v.GetPoint());
+      if (node != ContractionHierarchy::kInvalidNode)
+      {
+        // The first found junction of the node is the closest one.
+        if (m_nodeJunctions.emplace(node, v).second)
+          m_nodes.emplace_back(node, top.first);
+        continue;
+      }
+
+      if (++visited > kMaxHierarchyAccessJunctions)
+        return false;
+
+      if (m_forward)
+        m_graph.GetOutgoingEdgesList(v, adj);
+      else
+        m_graph.GetIngoingEdgesList(v, adj);
+
+      for (WeightedEdge const & e : adj)
+      {
+        double const weight = top.first + e.GetWeight();
+        auto const res = m_states.emplace(e.GetTarget(), State(weight, v));
+        if (!res.second)
+        {
+          if (res.first->second.m_weight <= weight)
+            continue;
+          res.first->second = State(weight, v);
+        }
+        queue.emplace(weight, e.GetTarget());
+      }
+    }
+    return true;
+  }
+
+  inline vector<ContractionHierarchy::TWeightedNode> const & GetNodes() const { return m_nodes; }
+
+  inline Junction const & GetNodeJunction(uint32_t node) const { return m_nodeJunctions.at(node); }
+
+  /// @return Weight of the path to junction or +inf if junction wasn't reached.
+  double GetWeight(Junction const & junction) const
+  {
+    auto const it = m_states.find(junction);
+    return it == m_states.end() ? numeric_limits<double>::max() : it->second.m_weight;
+  }
+
+  /// Appends path from the search position to junction, for backward search path is reversed
+  /// and goes from junction to the search position.
+  void AppendPath(Junction const & junction, vector<Junction> & path) const
+  {
+    vector<Junction> part;
+    Junction v = junction;
+    while (true)
+    {
+      part.push_back(v);
+      Junction const & parent = m_states.at(v).m_parent;
+      if (parent == v)
+        break;
+      v = parent;
+    }
+    if (m_forward)
+      reverse(part.begin(), part.end());
+    path.insert(path.end(), part.begin(), part.end());
+  }
+
+private:
+  struct State
+  {
+    State() = default;
+    State(double weight, Junction const & parent) : m_weight(weight), m_parent(parent) {}
+
+    double m_weight = 0.0;
+    // The search position is a parent of itself.
+    Junction m_parent;
+  };
+
+  RoadGraph const & m_graph;
+  ContractionHierarchy const & m_hierarchy;
+  bool const m_forward;
+
+  map<Junction, State> m_states;
+  map<uint32_t, Junction> m_nodeJunctions;
+  vector<ContractionHierarchy::TWeightedNode> m_nodes;
+};
+
 IRoutingAlgorithm::Result Convert(TAlgorithmImpl::Result value)
 {
   switch (value)
@@ -176,4 +299,92 @@ IRoutingAlgorithm::Result AStarBidirectionalRoutingAlgorithm::CalculateRoute(
   return Convert(res);
 }
 
+// *************************** AStar-bidirectional parallel routing algorithm implementation ******
+
+IRoutingAlgorithm::Result AStarBidirectionalParallelRoutingAlgorithm::CalculateRoute(
+    IRoadGraph const & graph, Junction const & startPos, Junction const & finalPos,
+    RouterDelegate const & delegate, vector<Junction> & path)
+{
+  AStarProgress progress(0, 100);
+
+  // It's called for the forward wave only, so progress is estimated as for directed algorithm.
+  function<void(Junction const &, Junction const &)> onVisitJunctionFn =
+      [&delegate, &progress](Junction const & junction, Junction const & /* target */)
+  {
+    delegate.OnPointCheck(junction.GetPoint());
+    auto const lastValue = progress.GetLastValue();
+    auto const newValue = progress.GetProgressForDirectedAlgo(junction.GetPoint());
+    if (newValue - lastValue > kProgressInterval)
+      delegate.OnProgress(newValue);
+  };
+
+  my::Cancellable const & cancellable = delegate;
+  progress.Initialize(startPos.GetPoint(), finalPos.GetPoint());
+  TAlgorithmImpl::Result const res = TAlgorithmImpl().FindPathBidirectionalParallel(
+      RoadGraph(graph), startPos, finalPos, path, cancellable, onVisitJunctionFn);
+  return Convert(res);
+}
+
+// *************************** Contraction hierarchy routing algorithm implementation *************
+
+IRoutingAlgorithm::Result ContractionHierarchyRoutingAlgorithm::CalculateRoute(
+    IRoadGraph const & graph, Junction const & startPos, Junction const & finalPos,
+    RouterDelegate const & delegate, vector<Junction> & path)
+{
+  vector<ContractionHierarchy const *> startHierarchies;
+  graph.GetContractionHierarchies(startPos.GetPoint(), startHierarchies);
+  vector<ContractionHierarchy const *> finalHierarchies;
+  graph.GetContractionHierarchies(finalPos.GetPoint(), finalHierarchies);
+
+  RoadGraph const roadGraph(graph);
+  double bestWeight = numeric_limits<double>::max();
+  vector<Junction> bestPath;
+
+  for (ContractionHierarchy const * hierarchy : startHierarchies)
+  {
+    if (find(finalHierarchies.begin(), finalHierarchies.end(), hierarchy) == finalHierarchies.end())
+      continue;
+
+    HierarchyAccessSearch forward(roadGraph, *hierarchy, true /* forward */);
+    HierarchyAccessSearch backward(roadGraph, *hierarchy, false /* forward */);
+    if (!forward.Run(startPos) || !backward.Run(finalPos))
+      continue;
+
+    // Start and final positions may be connected by fake edges only.
+    double const directWeight = forward.GetWeight(finalPos);
+    if (directWeight < bestWeight)
+    {
+      bestWeight = directWeight;
+      bestPath.clear();
+      forward.AppendPath(finalPos, bestPath);
+    }
+
+    if (forward.GetNodes().empty() || backward.GetNodes().empty())
+      continue;
+
+    vector<uint32_t> nodes;
+    double weight = 0.0;
+    ContractionHierarchy::Result const res =
+        hierarchy->FindPath(forward.GetNodes(), backward.GetNodes(), delegate, nodes, weight);
+    if (res == ContractionHierarchy::Result::Cancelled)
+      return Result::Cancelled;
+    if (res != ContractionHierarchy::Result::OK || weight >= bestWeight)
+      continue;
+
+    bestWeight = weight;
+    bestPath.clear();
+    forward.AppendPath(forward.GetNodeJunction(nodes.front()), bestPath);
+    for (size_t i = 1; i + 1 < nodes.size(); ++i)
+      bestPath.emplace_back(hierarchy->GetPoint(nodes[i]));
+    backward.AppendPath(backward.GetNodeJunction(nodes.back()), bestPath);
+  }
+
+  if (bestPath.empty())
+    return m_fallbackAlgorithm.CalculateRoute(graph, startPos, finalPos, delegate, path);
+
+  bestPath.erase(unique(bestPath.begin(), bestPath.end()), bestPath.end());
+  path.swap(bestPath);
+  return Result::OK;
+}
+
 }  // namespace routing
@@ -51,4 +51,32 @@ public:
                         vector<Junction> & path) override;
 };
 
+// AStar-bidirectional routing algorithm, which runs forward and backward waves
+// on two threads. The graph must be safe to read from several threads.
+class AStarBidirectionalParallelRoutingAlgorithm : public IRoutingAlgorithm
+{
+public:
+  // IRoutingAlgorithm overrides:
+  Result CalculateRoute(IRoadGraph const & graph, Junction const & startPos,
+                        Junction const & finalPos, RouterDelegate const & delegate,
+                        vector<Junction> & path) override;
+};
+
+// Routing algorithm, which uses precomputed contraction hierarchies of the graph
+// (see ContractionHierarchy). Routes are searched within one hierarchy, so when
+// there's no such route AStar-bidirectional algorithm is used.
+// Note: a shorter route across an mwm border isn't found when both ends are in
+// one hierarchy, so routes may be longer than the AStar ones near borders.
+class ContractionHierarchyRoutingAlgorithm : public IRoutingAlgorithm
+{
+public:
+  // IRoutingAlgorithm overrides:
+  Result CalculateRoute(IRoadGraph const & graph, Junction const & startPos,
+                        Junction const & finalPos, RouterDelegate const & delegate,
+                        vector<Junction> & path) override;
+
+private:
+  AStarBidirectionalRoutingAlgorithm m_fallbackAlgorithm;
+};
+
 }  // namespace routing
@@ -57,9 +57,26 @@ private:
   map<unsigned, vector<Edge>> m_adjs;
 };
 
-void TestAStar(UndirectedGraph const & graph, vector<unsigned> const & expectedRoute)
+// The same graph on vertices [0, verticesCount) which are used as their own indexes.
+class DenseUndirectedGraph : public UndirectedGraph
 {
-  using TAlgorithm = AStarAlgorithm<UndirectedGraph>;
+public:
+  explicit DenseUndirectedGraph(uint32_t verticesCount) : m_verticesCount(verticesCount) {}
+
+  uint32_t GetVerticesCount() const { return m_verticesCount; }
+  uint32_t GetVertexIndex(unsigned v) const { return v; }
+
+private:
+  uint32_t m_verticesCount;
+};
+
+static_assert(!AStarAlgorithm<UndirectedGraph>::kDenseMode, "");
+static_assert(AStarAlgorithm<DenseUndirectedGraph>::kDenseMode, "");
+
+template <typename TGraph>
+void TestAStar(TGraph const & graph, vector<unsigned> const & expectedRoute)
+{
+  using TAlgorithm = AStarAlgorithm<TGraph>;
 
   TAlgorithm algo;
 
@@ -70,6 +87,11 @@ void TestAStar(UndirectedGraph const & graph, vector<unsigned> const & expectedR
   actualRoute.clear();
   TEST_EQUAL(TAlgorithm::Result::OK, algo.FindPathBidirectional(graph, 0u, 4u, actualRoute), ());
   TEST_EQUAL(expectedRoute, actualRoute, ());
+
+  actualRoute.clear();
+  TEST_EQUAL(TAlgorithm::Result::OK,
+             algo.FindPathBidirectionalParallel(graph, 0u, 4u, actualRoute), ());
+  TEST_EQUAL(expectedRoute, actualRoute, ());
 }
 
 UNIT_TEST(AStarAlgorithm_Sample)
@@ -88,4 +110,112 @@ UNIT_TEST(AStarAlgorithm_Sample)
   TestAStar(graph, expectedRoute);
 }
 
+UNIT_TEST(AStarAlgorithm_DenseSample)
+{
+  DenseUndirectedGraph graph(6 /* verticesCount */);
+
+  graph.AddEdge(0, 1, 10);
+  graph.AddEdge(1, 2, 5);
+  graph.AddEdge(2, 3, 5);
+  graph.AddEdge(2, 4, 10);
+  graph.AddEdge(3, 4, 3);
+  graph.AddEdge(0, 5, 2);
+  graph.AddEdge(5, 2, 20);
+
+  vector<unsigned> const expectedRoute = {0, 1, 2, 3, 4};
+
+  TestAStar(graph, expectedRoute);
+}
+
+UNIT_TEST(AStarAlgorithm_DenseAndMapModesAgree)
+{
+  uint32_t constexpr kVerticesCount = 100;
+  UndirectedGraph sparse;
+  DenseUndirectedGraph dense(kVerticesCount);
+
+  // Ring with chords of pseudo-random weights.
+  uint32_t seed = 1;
+  auto const nextWeight = [&seed]()
+  {
+    seed = seed * 1103515245 + 12345;
+    return 1 + (seed >> 16) % 100;
+  };
+  for (uint32_t u = 0; u < kVerticesCount; ++u)
+  {
+    uint32_t const w1 = nextWeight();
+    sparse.AddEdge(u, (u + 1) % kVerticesCount, w1);
+    dense.AddEdge(u, (u + 1) % kVerticesCount, w1);
+    uint32_t const w2 = nextWeight();
+    sparse.AddEdge(u, (u * 7 + 3) % kVerticesCount, w2);
+    dense.AddEdge(u, (u * 7 + 3) % kVerticesCount, w2);
+  }
+
+  // Both modes may choose different routes of the same length.
+  auto const routeLength = [&sparse](vector<unsigned> const & route)
+  {
+    double length = 0;
+    vector<Edge> adj;
+    for (size_t i = 1; i < route.size(); ++i)
+    {
+      sparse.GetOutgoingEdgesList(route[i - 1], adj);
+      double best = -1;
+      for (Edge const & e : adj)
+      {
+        if (e.GetTarget() == route[i] && (best < 0 || e.GetWeight() < best))
+          best = e.GetWeight();
+      }
+      TEST_GREATER(best, 0, ());
+      length += best;
+    }
+    return length;
+  };
+
+  AStarAlgorithm<UndirectedGraph> sparseAlgo;
+  AStarAlgorithm<DenseUndirectedGraph> denseAlgo;
+  for (unsigned finish = 1; finish < kVerticesCount; finish += 7)
+  {
+    vector<unsigned> sparseRoute;
+    vector<unsigned> denseRoute;
+    TEST_EQUAL(AStarAlgorithm<UndirectedGraph>::Result::OK,
+               sparseAlgo.FindPath(sparse, 0u, finish, sparseRoute), ());
+    TEST_EQUAL(AStarAlgorithm<DenseUndirectedGraph>::Result::OK,
+               denseAlgo.FindPath(dense, 0u, finish, denseRoute), ());
+    TEST_EQUAL(routeLength(sparseRoute), routeLength(denseRoute), ());
+
+    denseRoute.clear();
+    TEST_EQUAL(AStarAlgorithm<DenseUndirectedGraph>::Result::OK,
+               denseAlgo.FindPathBidirectional(dense, 0u, finish, denseRoute), ());
+    TEST_EQUAL(denseRoute.front(), 0, ());
+    TEST_EQUAL(denseRoute.back(), finish, ());
+    TEST_EQUAL(routeLength(sparseRoute), routeLength(denseRoute), ());
+
+    vector<unsigned> parallelRoute;
+    TEST_EQUAL(AStarAlgorithm<UndirectedGraph>::Result::OK,
+               sparseAlgo.FindPathBidirectionalParallel(sparse, 0u, finish, parallelRoute), ());
+    TEST_EQUAL(routeLength(sparseRoute), routeLength(parallelRoute), ());
+
+    parallelRoute.clear();
+    TEST_EQUAL(AStarAlgorithm<DenseUndirectedGraph>::Result::OK,
+               denseAlgo.FindPathBidirectionalParallel(dense, 0u, finish, parallelRoute), ());
+    TEST_EQUAL(parallelRoute.front(), 0, ());
+    TEST_EQUAL(parallelRoute.back(), finish, ());
+    TEST_EQUAL(routeLength(sparseRoute), routeLength(parallelRoute), ());
+  }
+}
+
+UNIT_TEST(AStarAlgorithm_ParallelNoPath)
+{
+  UndirectedGraph graph;
+  graph.AddEdge(0, 1, 10);
+  graph.AddEdge(1, 2, 5);
+  graph.AddEdge(3, 4, 3);
+  graph.AddEdge(4, 5, 3);
+
+  using TAlgorithm = AStarAlgorithm<UndirectedGraph>;
+  vector<unsigned> route;
+  TEST_EQUAL(TAlgorithm::Result::NoPath,
+             TAlgorithm().FindPathBidirectionalParallel(graph, 0u, 5u, route), ());
+  TEST(route.empty(), ());
+}
+
 }  // namespace routing_test
@@ -266,3 +266,32 @@ UNIT_TEST(AStarRouter_SimpleGraph_PickTheFasterRoad3)
              ());
   TEST_EQUAL(path, vector<Junction>({m2::PointD(2,2), m2::PointD(2,1), m2::PointD(10,1), m2::PointD(10,2)}), ());
 }
+
+UNIT_TEST(AStarRouter_Graph2_Parallel)
+{
+  classificator::Load();
+
+  RoadGraphMockSource graph;
+  InitRoadGraphMockSourceWithTest2(graph);
+
+  RouterDelegate delegate;
+  AStarBidirectionalParallelRoutingAlgorithm parallelAlgorithm;
+  TRoutingAlgorithm algorithm;
+
+  vector<pair<Junction, Junction>> const routes = {
+      {m2::PointD(0, 0), m2::PointD(80, 55)},
+      {m2::PointD(80, 55), m2::PointD(80, 0)},
+      {m2::PointD(80, 0), m2::PointD(0, 0)}};
+  for (auto const & route : routes)
+  {
+    vector<Junction> expected;
+    TEST_EQUAL(TRoutingAlgorithm::Result::OK,
+               algorithm.CalculateRoute(graph, route.first, route.second, delegate, expected), ());
+
+    vector<Junction> path;
+    TEST_EQUAL(TRoutingAlgorithm::Result::OK,
+               parallelAlgorithm.CalculateRoute(graph, route.first, route.second, delegate, path),
+               ());
+    TEST_EQUAL(expected, path, ());
+  }
+}
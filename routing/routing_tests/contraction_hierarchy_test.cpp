@@ -0,0 +1,266 @@
+#include "testing/testing.hpp"
+
+#include "routing/routing_tests/road_graph_builder.hpp"
+
+#include "routing/contraction_hierarchy.hpp"
+#include "routing/road_graph_section.hpp"
+#include "routing/router_delegate.hpp"
+#include "routing/routing_algorithm.hpp"
+
+#include "indexer/classificator_loader.hpp"
+
+#include "coding/writer.hpp"
+
+#include "std/cmath.hpp"
+#include "std/functional.hpp"
+#include "std/limits.hpp"
+#include "std/queue.hpp"
+#include "std/vector.hpp"
+
+using namespace routing;
+using namespace routing_test;
+
+namespace
+{
+/// Mock graph with a contraction hierarchy built for all its roads.
+class HierarchyMockSource : public RoadGraphMockSource
+{
+public:
+  void BuildHierarchy()
+  {
+    vector<RoadGraphSection::Road> roads;
+    for (uint32_t i = 0; i < GetRoadCount(); ++i)
+      roads.emplace_back(i, GetRoadInfo(MakeTestFeatureID(i)));
+
+    {
+      MemWriter<vector<char>> writer(m_sectionData);
+      RoadGraphSection::Serialize(roads, writer);
+    }
+    TEST(m_section.Attach(m_sectionData.data(), m_sectionData.size()), ());
+
+    {
+      MemWriter<vector<char>> writer(m_hierarchyData);
+      ContractionHierarchy::Build(m_section, writer);
+    }
+    TEST(m_hierarchy.Attach(m_section, m_hierarchyData.data(), m_hierarchyData.size()), ());
+  }
+
+  inline RoadGraphSection const & GetSection() const { return m_section; }
+  inline ContractionHierarchy const & GetHierarchy() const { return m_hierarchy; }
+
+  // IRoadGraph overrides:
+  void GetContractionHierarchies(m2::PointD const & /* point */,
+                                 vector<ContractionHierarchy const *> & hierarchies) const override
+  {
+    hierarchies.push_back(&m_hierarchy);
+  }
+
+private:
+  vector<char> m_sectionData;
+  RoadGraphSection m_section;
+  vector<char> m_hierarchyData;
+  ContractionHierarchy m_hierarchy;
+};
+
+// Grid of roads with different speeds and some diagonals.
+void InitGrid(HierarchyMockSource & graph, uint32_t size)
+{
+  double const maxSpeedKMPH = graph.GetMaxSpeedKMPH();
+  uint32_t seed = 1;
+  auto const nextSpeed = [&seed, maxSpeedKMPH]()
+  {
+    seed = seed * 1103515245 + 12345;
+    return maxSpeedKMPH * (1 + (seed >> 16) % 4) / 4;
+  };
+
+  for (uint32_t i = 0; i < size; ++i)
+  {
+    for (uint32_t j = 0; j + 1 < size; ++j)
+    {
+      graph.AddRoad(IRoadGraph::RoadInfo(true /* bidir */, nextSpeed(),
+                                         {m2::PointD(j, i), m2::PointD(j + 1, i)}));
+      graph.AddRoad(IRoadGraph::RoadInfo(true /* bidir */, nextSpeed(),
+                                         {m2::PointD(i, j), m2::PointD(i, j + 1)}));
+    }
+  }
+  for (uint32_t i = 0; i + 1 < size; i += 2)
+  {
+    graph.AddRoad(IRoadGraph::RoadInfo(true /* bidir */, nextSpeed(),
+                                       {m2::PointD(i, i), m2::PointD(i + 1, i + 1)}));
+  }
+}
+
+// Plain Dijkstra over the road graph section.
+double FindWeightByDijkstra(RoadGraphSection const & section, uint32_t source, uint32_t target)
+{
+  vector<vector<pair<uint32_t, double>>> adj(section.GetJunctionsCount());
+  section.ForEachEdge([&](uint32_t from, uint32_t to, double speedKMPH)
+  {
+    adj[from].emplace_back(to, ContractionHierarchy::GetEdgeWeight(section.GetJunction(from),
+                                                                   section.GetJunction(to),
+                                                                   speedKMPH));
+  });
+
+  vector<double> weights(adj.size(), numeric_limits<double>::max());
+  using TItem = pair<double, uint32_t>;
+  priority_queue<TItem, vector<TItem>, greater<TItem>> queue;
+  weights[source] = 0.0;
+  queue.emplace(0.0, source);
+  while (!queue.empty())
+  {
+    TItem const top = queue.top();
+    queue.pop();
+    if (top.first > weights[top.second])
+      continue;
+    for (auto const & e : adj[top.second])
+    {
+      if (top.first + e.second < weights[e.first])
+      {
+        weights[e.first] = top.first + e.second;
+        queue.emplace(weights[e.first], e.first);
+      }
+    }
+  }
+  return weights[target];
+}
+
+// Returns weight of the path by the road graph section edges or -1 if the path is broken.
+double GetPathWeight(RoadGraphSection const & section, vector<uint32_t> const & path)
+{
+  double weight = 0.0;
+  for (size_t i = 1; i < path.size(); ++i)
+  {
+    double best = numeric_limits<double>::max();
+    section.ForEachEdge([&](uint32_t from, uint32_t to, double speedKMPH)
+    {
+      if (from == path[i - 1] && to == path[i])
+      {
+        best = min(best, ContractionHierarchy::GetEdgeWeight(section.GetJunction(from),
+                                                             section.GetJunction(to), speedKMPH));
+      }
+    });
+    if (best == numeric_limits<double>::max())
+      return -1.0;
+    weight += best;
+  }
+  return weight;
+}
+
+void TestAlgorithmsAgree(IRoadGraph & graph, Junction const & startPos, Junction const & finalPos)
+{
+  RouterDelegate delegate;
+
+  vector<Junction> expected;
+  TEST_EQUAL(IRoutingAlgorithm::Result::OK,
+             AStarBidirectionalRoutingAlgorithm().CalculateRoute(graph, startPos, finalPos,
+                                                                 delegate, expected),
+             ());
+
+  vector<Junction> path;
+  TEST_EQUAL(IRoutingAlgorithm::Result::OK,
+             ContractionHierarchyRoutingAlgorithm().CalculateRoute(graph, startPos, finalPos,
+                                                                   delegate, path),
+             ());
+
+  TEST_EQUAL(expected, path, (startPos, finalPos));
+}
+}  // namespace
+
+UNIT_TEST(ContractionHierarchy_AgreesWithDijkstra)
+{
+  HierarchyMockSource graph;
+  InitGrid(graph, 7 /* size */);
+  graph.BuildHierarchy();
+
+  RoadGraphSection const & section = graph.GetSection();
+  ContractionHierarchy const & hierarchy = graph.GetHierarchy();
+  TEST_EQUAL(hierarchy.GetNodesCount(), 49, ());
+
+  my::Cancellable cancellable;
+  for (uint32_t source = 0; source < hierarchy.GetNodesCount(); ++source)
+  {
+    for (uint32_t target = 0; target < hierarchy.GetNodesCount(); ++target)
+    {
+      vector<uint32_t> path;
+      double weight = 0.0;
+      TEST_EQUAL(ContractionHierarchy::Result::OK,
+                 hierarchy.FindPath({{source, 0.0}}, {{target, 0.0}}, cancellable, path, weight),
+                 ());
+
+      double const expectedWeight = FindWeightByDijkstra(section, source, target);
+      TEST_LESS(fabs(weight - expectedWeight), 1e-6 * (1.0 + expectedWeight), (source, target));
+
+      TEST_EQUAL(path.front(), source, ());
+      TEST_EQUAL(path.back(), target, ());
+      TEST_LESS(fabs(GetPathWeight(section, path) - weight), 1e-6 * (1.0 + weight), (source, target));
+    }
+  }
+}
+
+UNIT_TEST(ContractionHierarchy_NoPath)
+{
+  HierarchyMockSource graph;
+  graph.AddRoad(IRoadGraph::RoadInfo(true /* bidir */, 5.0 /* speedKMPH */,
+                                     {m2::PointD(0, 0), m2::PointD(1, 0)}));
+  graph.AddRoad(IRoadGraph::RoadInfo(true /* bidir */, 5.0 /* speedKMPH */,
+                                     {m2::PointD(5, 5), m2::PointD(6, 5)}));
+  graph.BuildHierarchy();
+
+  ContractionHierarchy const & hierarchy = graph.GetHierarchy();
+  uint32_t const source = hierarchy.FindNode(m2::PointD(0, 0));
+  uint32_t const target = hierarchy.FindNode(m2::PointD(6, 5));
+  TEST_NOT_EQUAL(source, ContractionHierarchy::kInvalidNode, ());
+  TEST_NOT_EQUAL(target, ContractionHierarchy::kInvalidNode, ());
+  TEST_EQUAL(hierarchy.FindNode(m2::PointD(3, 3)), ContractionHierarchy::kInvalidNode, ());
+
+  my::Cancellable cancellable;
+  vector<uint32_t> path;
+  double weight = 0.0;
+  TEST_EQUAL(ContractionHierarchy::Result::NoPath,
+             hierarchy.FindPath({{source, 0.0}}, {{target, 0.0}}, cancellable, path, weight), ());
+}
+
+UNIT_TEST(ContractionHierarchyRouter_Graph2)
+{
+  classificator::Load();
+
+  HierarchyMockSource graph;
+  InitRoadGraphMockSourceWithTest2(graph);
+  graph.BuildHierarchy();
+
+  TestAlgorithmsAgree(graph, m2::PointD(0, 0), m2::PointD(80, 55));
+  TestAlgorithmsAgree(graph, m2::PointD(80, 55), m2::PointD(80, 0));
+  TestAlgorithmsAgree(graph, m2::PointD(12, 25), m2::PointD(70, 30));
+  TestAlgorithmsAgree(graph, m2::PointD(80, 10), m2::PointD(0, 0));
+}
+
+UNIT_TEST(ContractionHierarchyRouter_FakeEdges)
+{
+  classificator::Load();
+
+  HierarchyMockSource graph;
+  InitRoadGraphMockSourceWithTest2(graph);
+  graph.BuildHierarchy();
+
+  Junction const startPos(m2::PointD(2, 20));
+  Junction const finalPos(m2::PointD(75, 35));
+  graph.AddFakeEdges(startPos, {make_pair(Edge(MakeTestFeatureID(1), true /* forward */, 1,
+                                                  m2::PointD(5, 10), m2::PointD(5, 40)),
+                                             m2::PointD(5, 20))});
+  graph.AddFakeEdges(finalPos, {make_pair(Edge(MakeTestFeatureID(5), true /* forward */, 2,
+                                                  m2::PointD(70, 30), m2::PointD(80, 30)),
+                                             m2::PointD(75, 30))});
+
+  TestAlgorithmsAgree(graph, startPos, finalPos);
+  TestAlgorithmsAgree(graph, finalPos, startPos);
+}
+
+UNIT_TEST(ContractionHierarchyRouter_FallbackWithoutHierarchy)
+{
+  classificator::Load();
+
+  RoadGraphMockSource graph;
+  InitRoadGraphMockSourceWithTest2(graph);
+
+  TestAlgorithmsAgree(graph, m2::PointD(0, 0), m2::PointD(80, 55));
+}
@@ -0,0 +1,112 @@
+#include "testing/testing.hpp"
+
+#include "routing/road_graph_section.hpp"
+
+#include "coding/writer.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/vector.hpp"
+
+using namespace routing;
+
+namespace
+{
+//       2
+//       |
+// 0 --- 1 --- 3 --- 4
+//             |
+//             5
+vector<RoadGraphSection::Road> MakeRoads()
+{
+  vector<RoadGraphSection::Road> roads;
+  roads.emplace_back(7, IRoadGraph::RoadInfo(true /* bidir */, 5.0 /* speedKMPH */,
+                                             {m2::PointD(0, 0), m2::PointD(1, 0), m2::PointD(2, 0),
+                                              m2::PointD(3, 0)}));
+  roads.emplace_back(3, IRoadGraph::RoadInfo(false /* bidir */, 4.0 /* speedKMPH */,
+                                             {m2::PointD(1, 1), m2::PointD(1, 0)}));
+  roads.emplace_back(12, IRoadGraph::RoadInfo(true /* bidir */, 3.0 /* speedKMPH */,
+                                              {m2::PointD(2, 0), m2::PointD(2, -1)}));
+  // Roads without speed aren't written.
+  roads.emplace_back(5, IRoadGraph::RoadInfo(true /* bidir */, 0.0 /* speedKMPH */,
+                                             {m2::PointD(0, 0), m2::PointD(0, 1)}));
+  return roads;
+}
+
+IRoadGraph::TEdgeVector LoadFromRoads(vector<RoadGraphSection::Road> const & roads,
+                                      m2::PointD const & cross)
+{
+  IRoadGraph::TEdgeVector edges;
+  IRoadGraph::CrossEdgesLoader loader(cross, edges);
+  for (auto const & road : roads)
+  {
+    if (road.m_info.m_speedKMPH > 0.0)
+      loader(FeatureID(MwmSet::MwmId(), road.m_featureIndex), road.m_info);
+  }
+  sort(edges.begin(), edges.end());
+  return edges;
+}
+
+IRoadGraph::TEdgeVector LoadFromSection(RoadGraphSection const & section, m2::PointD const & cross)
+{
+  IRoadGraph::TEdgeVector edges;
+  section.ForEachOutgoingEdge(cross, [&edges](uint32_t featureIndex, bool forward, uint32_t segId,
+                                              m2::PointD const & startPoint,
+                                              m2::PointD const & endPoint)
+  {
+    edges.emplace_back(FeatureID(MwmSet::MwmId(), featureIndex), forward, segId, startPoint,
+                       endPoint);
+  });
+  sort(edges.begin(), edges.end());
+  return edges;
+}
+}  // namespace
+
+UNIT_TEST(RoadGraphSection_Smoke)
+{
+  vector<RoadGraphSection::Road> const roads = MakeRoads();
+
+  vector<char> buffer;
+  {
+    vector<RoadGraphSection::Road> copy = MakeRoads();
+    MemWriter<vector<char>> writer(buffer);
+    RoadGraphSection::Serialize(copy, writer);
+  }
+
+  RoadGraphSection section;
+  TEST(section.Attach(buffer.data(), buffer.size()), ());
+  TEST_EQUAL(section.GetRoadsCount(), 3, ());
+  TEST_EQUAL(section.GetJunctionsCount(), 6, ());
+  TEST_EQUAL(section.GetEdgesCount(), 10, ());
+
+  vector<m2::PointD> const crosses = {m2::PointD(0, 0),  m2::PointD(1, 0), m2::PointD(1, 1),
+                                      m2::PointD(2, 0),  m2::PointD(3, 0), m2::PointD(2, -1),
+                                      m2::PointD(5, 5),  m2::PointD(2, 1e-7)};
+  for (auto const & cross : crosses)
+    TEST_EQUAL(LoadFromRoads(roads, cross), LoadFromSection(section, cross), (cross));
+
+  double speedKMPH = 0.0;
+  TEST(section.GetSpeedKMPH(7, speedKMPH), ());
+  TEST_ALMOST_EQUAL_ULPS(speedKMPH, 5.0, ());
+  TEST(section.GetSpeedKMPH(12, speedKMPH), ());
+  TEST_ALMOST_EQUAL_ULPS(speedKMPH, 3.0, ());
+  TEST(!section.GetSpeedKMPH(5, speedKMPH), ());
+  TEST(!section.GetSpeedKMPH(100, speedKMPH), ());
+}
+
+UNIT_TEST(RoadGraphSection_BadData)
+{
+  vector<char> buffer;
+  {
+    vector<RoadGraphSection::Road> roads = MakeRoads();
+    MemWriter<vector<char>> writer(buffer);
+    RoadGraphSection::Serialize(roads, writer);
+  }
+
+  RoadGraphSection section;
+  TEST(!section.Attach(buffer.data(), buffer.size() - 1), ());
+  TEST(!section.IsAttached(), ());
+  TEST(!section.Attach(buffer.data(), 3), ());
+
+  buffer[0] = 100;
+  TEST(!section.Attach(buffer.data(), buffer.size()), ());
+}
@@ -0,0 +1,126 @@
+#include "testing/testing.hpp"
+
+#include "routing/road_info_cache.hpp"
+
+#include "std/atomic.hpp"
+#include "std/thread.hpp"
+#include "std/vector.hpp"
+#include "std/weak_ptr.hpp"
+
+using namespace routing;
+
+namespace
+{
+IRoadGraph::RoadInfo MakeRoad(double x)
+{
+  return IRoadGraph::RoadInfo(true /* bidir */, 5.0 /* speedKMPH */,
+                              {m2::PointD(x, 0), m2::PointD(x, 1)});
+}
+
+uint64_t RoadBytes() { return SharedRoadInfoCache::GetRoadInfoBytes(MakeRoad(0)); }
+}  // namespace
+
+UNIT_TEST(SharedRoadInfoCache_Smoke)
+{
+  SharedRoadInfoCache cache(100 * RoadBytes(), 1 /* shardsCount */);
+
+  TEST(!cache.Find(FeatureID(MwmSet::MwmId(), 1)), ());
+
+  auto const road = cache.Insert(FeatureID(MwmSet::MwmId(), 1), MakeRoad(1));
+  TEST(road, ());
+  TEST_EQUAL(road->m_points.size(), 2, ());
+
+  // The first inserted road wins.
+  TEST_EQUAL(cache.Insert(FeatureID(MwmSet::MwmId(), 1), MakeRoad(2)), road, ());
+  TEST_EQUAL(cache.Find(FeatureID(MwmSet::MwmId(), 1)), road, ());
+
+  SharedRoadInfoCache::Stats const stats = cache.GetStats();
+  TEST_EQUAL(stats.m_hits, 1, ());
+  TEST_EQUAL(stats.m_misses, 1, ());
+  TEST_EQUAL(stats.m_roads, 1, ());
+  TEST_EQUAL(stats.m_bytes, RoadBytes(), ());
+
+  cache.Clear();
+  TEST(!cache.Find(FeatureID(MwmSet::MwmId(), 1)), ());
+  // Roads taken from the cache are alive after eviction.
+  TEST_EQUAL(road->m_points[0], m2::PointD(1, 0), ());
+}
+
+UNIT_TEST(SharedRoadInfoCache_Eviction)
+{
+  uint32_t constexpr kCapacity = 4;
+  SharedRoadInfoCache cache(kCapacity * RoadBytes(), 1 /* shardsCount */);
+
+  for (uint32_t i = 0; i < kCapacity; ++i)
+    cache.Insert(FeatureID(MwmSet::MwmId(), i), MakeRoad(i));
+
+  // Road 0 gets the second chance.
+  TEST(cache.Find(FeatureID(MwmSet::MwmId(), 0)), ());
+
+  cache.Insert(FeatureID(MwmSet::MwmId(), kCapacity), MakeRoad(kCapacity));
+  TEST(cache.Find(FeatureID(MwmSet::MwmId(), 0)), ());
+  TEST(!cache.Find(FeatureID(MwmSet::MwmId(), 1)), ());
+  TEST(cache.Find(FeatureID(MwmSet::MwmId(), kCapacity)), ());
+
+  SharedRoadInfoCache::Stats const stats = cache.GetStats();
+  TEST_EQUAL(stats.m_evictions, 1, ());
+  TEST_EQUAL(stats.m_roads, kCapacity, ());
+  TEST_LESS_OR_EQUAL(stats.m_bytes, kCapacity * RoadBytes(), ());
+}
+
+UNIT_TEST(SharedRoadInfoCache_Concurrent)
+{
+  uint32_t constexpr kThreadsCount = 4;
+  uint32_t constexpr kRoadsCount = 1000;
+  SharedRoadInfoCache cache(kRoadsCount / 2 * RoadBytes(), 4 /* shardsCount */);
+
+  atomic<uint32_t> wrongRoads(0);
+  vector<thread> threads;
+  for (uint32_t t = 0; t < kThreadsCount; ++t)
+  {
+    threads.emplace_back([&cache, &wrongRoads, t]()
+    {
+      for (uint32_t i = 0; i < 10 * kRoadsCount; ++i)
+      {
+        uint32_t const index = (i * 7 + t * 13) % kRoadsCount;
+        FeatureID const id(MwmSet::MwmId(), index);
+        auto road = cache.Find(id);
+        if (!road)
+          road = cache.Insert(id, MakeRoad(index));
+        if (road->m_points[0].x != index)
+          ++wrongRoads;
+      }
+    });
+  }
+  for (auto & t : threads)
+    t.join();
+
+  TEST_EQUAL(wrongRoads, 0, ());
+  SharedRoadInfoCache::Stats const stats = cache.GetStats();
+  TEST_EQUAL(stats.m_hits + stats.m_misses, kThreadsCount * 10 * kRoadsCount, ());
+  TEST_LESS_OR_EQUAL(stats.m_bytes, kRoadsCount / 2 * RoadBytes(), ());
+}
+
+UNIT_TEST(SharedRoadInfoCache_ReleasedMwm)
+{
+  SharedRoadInfoCache cache(100 * RoadBytes(), 1 /* shardsCount */);
+
+  auto info = make_shared<MwmInfo>();
+  weak_ptr<MwmInfo> const weakInfo = info;
+  {
+    MwmSet::MwmId const mwmId(info);
+    cache.Insert(FeatureID(mwmId, 1), MakeRoad(1));
+    TEST(cache.Find(FeatureID(mwmId, 1)), ());
+  }
+
+  // Cached roads don't keep MwmInfo alive.
+  info.reset();
+  TEST(weakInfo.expired(), ());
+
+  // Roads of the released mwm are evicted before the others.
+  uint32_t constexpr kCapacity = 100;
+  for (uint32_t i = 0; i < kCapacity; ++i)
+    cache.Insert(FeatureID(MwmSet::MwmId(), i), MakeRoad(i));
+  TEST_EQUAL(cache.GetStats().m_roads, kCapacity, ());
+  TEST(cache.Find(FeatureID(MwmSet::MwmId(), 0)), ());
+}
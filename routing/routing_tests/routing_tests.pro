@@ -25,6 +25,7 @@ SOURCES += \
   astar_progress_test.cpp \
   astar_router_test.cpp \
   async_router_test.cpp \
+  contraction_hierarchy_test.cpp \
   cross_routing_tests.cpp \
   followed_polyline_test.cpp \
   nearest_edge_finder_tests.cpp \
@@ -32,6 +33,8 @@ SOURCES += \
   osrm_router_test.cpp \
   road_graph_builder.cpp \
   road_graph_nearest_edges_test.cpp \
+  road_graph_section_test.cpp \
+  road_info_cache_test.cpp \
   route_tests.cpp \
   routing_mapping_test.cpp \
   turns_generator_test.cpp \
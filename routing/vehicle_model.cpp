@@ -72,4 +72,12 @@ bool VehicleModel::IsRoad(uint32_t type) const
          m_types.find(ftypes::BaseChecker::PrepareToMatch(type, 2)) != m_types.end();
 }
 
+string GetVehicleModelCountryName(string const & mwmName)
+{
+  size_t const pos = mwmName.find('_');
+  if (string::npos == pos)
+    return mwmName;
+  return mwmName.substr(0, pos);
+}
+
 }  // namespace routing
@@ -4,6 +4,7 @@
 #include "std/cstdint.hpp"
 #include "std/initializer_list.hpp"
 #include "std/shared_ptr.hpp"
+#include "std/string.hpp"
 #include "std/unordered_map.hpp"
 #include "std/utility.hpp"
 #include "std/vector.hpp"
@@ -44,6 +45,11 @@ public:
   virtual shared_ptr<IVehicleModel> GetVehicleModelForCountry(string const & country) const = 0;
 };
 
+/// @return Country name for IVehicleModelFactory::GetVehicleModelForCountry
+/// by mwm name, which is 'Country' or 'Country_Region'.
+/// @todo Rework this function when storage will provide information about mwm's country.
+string GetVehicleModelCountryName(string const & mwmName);
+
 class VehicleModel : public IVehicleModel
 {
 public:
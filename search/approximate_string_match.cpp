@@ -1,5 +1,10 @@
 #include "search/approximate_string_match.hpp"
 
+#include "base/assert.hpp"
+#include "base/bits.hpp"
+
+#include "std/algorithm.hpp"
+
 // TODO: Сделать модель ошибок.
 // Учитывать соседние кнопки на клавиатуре.
 // 1. Сосед вместо нужной
@@ -45,4 +50,82 @@ uint32_t DefaultMatchCost::SwapCost(UniChar, UniChar) const
   return 256;
 }
 
+size_t constexpr LevenshteinAutomaton::kMaxPatternSize;
+
+LevenshteinAutomaton::LevenshteinAutomaton(strings::UniString const & pattern, uint32_t maxErrors)
+  : m_size(static_cast<uint32_t>(pattern.size())), m_maxErrors(maxErrors)
+{
+  ASSERT_LESS_OR_EQUAL(pattern.size(), kMaxPatternSize, ());
+
+  m_mask = (m_size == kMaxPatternSize ? uint64_t(-1) : (uint64_t(1) << m_size) - 1);
+  m_last = (m_size == 0 ? 0 : uint64_t(1) << (m_size - 1));
+
+  for (uint32_t i = 0; i < m_size; ++i)
+    m_eqs.push_back(make_pair(pattern[i], uint64_t(1) << i));
+  sort(m_eqs.begin(), m_eqs.end());
+
+  // Merge the masks of equal symbols.
+  size_t j = 0;
+  for (size_t i = 0; i < m_eqs.size(); ++i)
+  {
+    if (j > 0 && m_eqs[j - 1].first == m_eqs[i].first)
+      m_eqs[j - 1].second |= m_eqs[i].second;
+    else
+      m_eqs[j++] = m_eqs[i];
+  }
+  m_eqs.resize(j);
+}
+
+LevenshteinAutomaton::State LevenshteinAutomaton::Start() const
+{
+  State s;
+  s.m_vp = m_mask;
+  s.m_vn = 0;
+  s.m_d0 = 0;
+  s.m_eq = 0;
+  s.m_length = 0;
+  s.m_distance = m_size;
+  return s;
+}
+
+bool LevenshteinAutomaton::CanMatch(State const & s) const
+{
+  // Distances in a column of the matrix never decrease further to the right
+  // (a transposition jumps over a column, but the cell it jumps over is not
+  // greater), so the minimum of the column is a lower bound for all continuations.
+  if (s.m_distance <= m_maxErrors || s.m_length <= m_maxErrors)
+    return true;
+
+  // The first row is s.m_length and the column can't go lower than by all its -1 deltas.
+  if (s.m_length > m_maxErrors + bits::popcount(s.m_vn))
+    return false;
+
+  uint32_t d = s.m_length;
+  for (uint32_t i = 0; i < m_size; ++i)
+  {
+    if ((s.m_vp >> i) & 1)
+      ++d;
+    else if ((s.m_vn >> i) & 1)
+      --d;
+    if (d <= m_maxErrors)
+      return true;
+  }
+  return false;
+}
+
+uint64_t LevenshteinAutomaton::GetEq(UniChar c) const
+{
+  auto const it = lower_bound(m_eqs.begin(), m_eqs.end(), make_pair(c, uint64_t(0)));
+  return (it != m_eqs.end() && it->first == c) ? it->second : 0;
+}
+
+uint32_t GetMaxErrorsForToken(strings::UniString const & token)
+{
+  if (token.size() < 4 || token.size() > LevenshteinAutomaton::kMaxPatternSize)
+    return 0;
+  if (token.size() < 8)
+    return 1;
+  return 2;
+}
+
 }  // namespace search
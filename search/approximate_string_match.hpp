@@ -3,6 +3,7 @@
 #include "base/base.hpp"
 #include "base/buffer_vector.hpp"
 #include "std/queue.hpp"
+#include "std/utility.hpp"
 
 namespace search
 {
@@ -85,4 +86,85 @@ uint32_t StringMatchCost(CharT const * sA, uint32_t sizeA,
   return maxCost + 1;
 }
 
+/// Levenshtein automaton of a pattern: accepts strings within maxErrors insertions,
+/// deletions, substitutions and transpositions of adjacent symbols from the pattern
+/// (i.e. DefaultMatchCost with equal costs). A state is a column of the dynamic
+/// programming matrix encoded by bit vectors of vertical deltas (Myers, Hyyro), so
+/// a step costs a few word operations. Patterns are at most kMaxPatternSize symbols.
+class LevenshteinAutomaton
+{
+public:
+  static size_t constexpr kMaxPatternSize = 64;
+
+  struct State
+  {
+    /// Rows with vertical deltas +1 and -1.
+    uint64_t m_vp, m_vn;
+    /// Rows with zero diagonal deltas and rows matching the last symbol,
+    /// both are needed for transpositions.
+    uint64_t m_d0, m_eq;
+    /// Number of consumed symbols and the distance between them and the pattern.
+    uint32_t m_length, m_distance;
+  };
+
+  LevenshteinAutomaton(strings::UniString const & pattern, uint32_t maxErrors);
+
+  State Start() const;
+
+  State Step(State const & s, strings::UniChar c) const
+  {
+    State r;
+    r.m_length = s.m_length + 1;
+    if (m_size == 0)
+    {
+      r.m_vp = r.m_vn = r.m_d0 = r.m_eq = 0;
+      r.m_distance = s.m_distance + 1;
+      return r;
+    }
+
+    uint64_t const eq = GetEq(c);
+    uint64_t const tr = (((~s.m_d0) & eq) << 1) & s.m_eq;
+    uint64_t const d0 = (tr | (((eq & s.m_vp) + s.m_vp) ^ s.m_vp) | eq | s.m_vn) & m_mask;
+    uint64_t hp = s.m_vn | ~(d0 | s.m_vp);
+    uint64_t hn = d0 & s.m_vp;
+
+    r.m_distance = s.m_distance;
+    if (hp & m_last)
+      ++r.m_distance;
+    else if (hn & m_last)
+      --r.m_distance;
+
+    // The first row is D[0][j] = j, so its horizontal delta is always +1.
+    hp = (hp << 1) | 1;
+    hn <<= 1;
+    r.m_vp = (hn | ~(d0 | hp)) & m_mask;
+    r.m_vn = d0 & hp & m_mask;
+    r.m_d0 = d0;
+    r.m_eq = eq;
+    return r;
+  }
+
+  /// @return True when the consumed string matches the pattern.
+  bool IsAccepting(State const & s) const { return s.m_distance <= m_maxErrors; }
+
+  /// @return False when no continuation of the consumed string matches the pattern,
+  /// so e.g. a trie subtree can be skipped.
+  bool CanMatch(State const & s) const;
+
+  uint32_t GetMaxErrors() const { return m_maxErrors; }
+
+private:
+  uint64_t GetEq(strings::UniChar c) const;
+
+  /// Sorted symbols of the pattern with the masks of their rows.
+  buffer_vector<pair<strings::UniChar, uint64_t>, 32> m_eqs;
+  uint64_t m_mask;
+  uint64_t m_last;
+  uint32_t m_size;
+  uint32_t m_maxErrors;
+};
+
+/// @return Number of typos that are allowed in a query token.
+uint32_t GetMaxErrorsForToken(strings::UniString const & token);
+
 }  // namespace search
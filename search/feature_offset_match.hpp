@@ -1,10 +1,14 @@
 #pragma once
+#include "search/approximate_string_match.hpp"
 #include "search/search_common.hpp"
 #include "search/search_query.hpp"
 #include "search/search_query_params.hpp"
 
+#include "indexer/index.hpp"
 #include "indexer/search_trie.hpp"
 
+#include "coding/reader_wrapper.hpp"
+
 #include "base/mutex.hpp"
 #include "base/scope_guard.hpp"
 #include "base/stl_add.hpp"
@@ -122,29 +126,13 @@ void FullMatchInTrie(trie::DefaultIterator const & trieRoot, strings::UniChar co
     f(pIter->m_value[i]);
 }
 
+// Calls f for all the values in the subtree of pRoot and deletes pRoot.
 template <typename F>
-void PrefixMatchInTrie(trie::DefaultIterator const & trieRoot, strings::UniChar const * rootPrefix,
-                       size_t rootPrefixSize, strings::UniString s, F & f)
+void ForEachValueInSubtree(trie::DefaultIterator * pRoot, F & f)
 {
-  if (!CheckMatchString(rootPrefix, rootPrefixSize, s))
-      return;
-
   using TQueue = vector<trie::DefaultIterator *>;
   TQueue trieQueue;
-  {
-    size_t symbolsMatched = 0;
-    bool bFullEdgeMatched;
-    trie::DefaultIterator * pRootIter =
-        MoveTrieIteratorToString(trieRoot, s, symbolsMatched, bFullEdgeMatched);
-
-    UNUSED_VALUE(symbolsMatched);
-    UNUSED_VALUE(bFullEdgeMatched);
-
-    if (!pRootIter)
-      return;
-
-    trieQueue.push_back(pRootIter);
-  }
+  trieQueue.push_back(pRoot);
 
   // 'f' can throw an exception. So be prepared to delete unprocessed elements.
   MY_SCOPE_GUARD(doDelete, GetRangeDeletor(trieQueue, DeleteFunctor()));
@@ -164,6 +152,147 @@ void PrefixMatchInTrie(trie::DefaultIterator const & trieRoot, strings::UniChar
   }
 }
 
+template <typename F>
+void PrefixMatchInTrie(trie::DefaultIterator const & trieRoot, strings::UniChar const * rootPrefix,
+                       size_t rootPrefixSize, strings::UniString s, F & f)
+{
+  if (!CheckMatchString(rootPrefix, rootPrefixSize, s))
+      return;
+
+  size_t symbolsMatched = 0;
+  bool bFullEdgeMatched;
+  trie::DefaultIterator * pRootIter =
+      MoveTrieIteratorToString(trieRoot, s, symbolsMatched, bFullEdgeMatched);
+
+  UNUSED_VALUE(symbolsMatched);
+  UNUSED_VALUE(bFullEdgeMatched);
+
+  if (!pRootIter)
+    return;
+
+  ForEachValueInSubtree(pRootIter, f);
+}
+
+template <typename F>
+void FullMatchInTrie(trie::TSuccinctIterator root, strings::UniString const & s, F & f)
+{
+  if (root.GoToString(s))
+    root.ForEachValue(f);
+}
+
+template <typename F>
+void PrefixMatchInTrie(trie::TSuccinctIterator root, strings::UniString const & s, F & f)
+{
+  if (root.GoToString(s))
+    root.ForEachValueInSubtree(f);
+}
+
+// Approximate matching walks the trie and feeds edges to the Levenshtein automaton
+// of the token, subtrees are skipped as soon as the automaton can't match.
+// In the prefix mode all the values of a subtree are taken as soon as the
+// automaton accepts the path to it.
+template <typename F>
+void ApproxMatchInTrie(trie::DefaultIterator const & node, LevenshteinAutomaton const & automaton,
+                       LevenshteinAutomaton::State const & state, bool isPrefix, F & f)
+{
+  if (automaton.IsAccepting(state))
+  {
+    if (isPrefix)
+    {
+      ForEachValueInSubtree(node.Clone(), f);
+      return;
+    }
+    for (size_t i = 0; i < node.m_value.size(); ++i)
+      f(node.m_value[i]);
+  }
+
+  for (uint32_t i = 0; i < node.m_edge.size(); ++i)
+  {
+    auto const & edge = node.m_edge[i].m_str;
+    LevenshteinAutomaton::State s = state;
+    bool subtreeMatched = false;
+    size_t j = 0;
+    for (; j < edge.size() && automaton.CanMatch(s); ++j)
+    {
+      s = automaton.Step(s, edge[j]);
+      if (isPrefix && automaton.IsAccepting(s))
+      {
+        subtreeMatched = true;
+        break;
+      }
+    }
+
+    if (subtreeMatched)
+      ForEachValueInSubtree(node.GoToEdge(i), f);
+    else if (j == edge.size() && automaton.CanMatch(s))
+      ApproxMatchInTrie(*unique_ptr<trie::DefaultIterator>(node.GoToEdge(i)), automaton, s,
+                        isPrefix, f);
+  }
+}
+
+template <typename F>
+void ApproxMatchInTrie(trie::DefaultIterator const & trieRoot, strings::UniChar const * rootPrefix,
+                       size_t rootPrefixSize, LevenshteinAutomaton const & automaton,
+                       bool isPrefix, F & f)
+{
+  LevenshteinAutomaton::State state = automaton.Start();
+  for (size_t i = 0; i < rootPrefixSize; ++i)
+  {
+    if (isPrefix && automaton.IsAccepting(state))
+      break;
+    state = automaton.Step(state, rootPrefix[i]);
+    if (!automaton.CanMatch(state))
+      return;
+  }
+  ApproxMatchInTrie(trieRoot, automaton, state, isPrefix, f);
+}
+
+// Edges of the succinct trie are bits of Huffman codes, |code| is the part of
+// the code of the next symbol between the last symbol and |node|.
+template <typename F>
+void ApproxMatchInTrie(trie::TSuccinctIterator const & node, coding::HuffmanCoder::Code const & code,
+                       LevenshteinAutomaton const & automaton,
+                       LevenshteinAutomaton::State const & state, bool isPrefix, F & f)
+{
+  if (code.len == 0 && automaton.IsAccepting(state))
+  {
+    if (isPrefix)
+    {
+      node.ForEachValueInSubtree(f);
+      return;
+    }
+    node.ForEachValue(f);
+  }
+
+  for (uint8_t edge = 0; edge < 2; ++edge)
+  {
+    trie::TSuccinctIterator child = node;
+    if (!child.GoToEdge(edge))
+      continue;
+
+    coding::HuffmanCoder::Code const childCode(code.bits | (uint32_t(edge) << code.len),
+                                               code.len + 1);
+    uint32_t symbol;
+    if (node.GetEncoding().Decode(childCode, symbol))
+    {
+      LevenshteinAutomaton::State const s = automaton.Step(state, symbol);
+      if (automaton.CanMatch(s))
+        ApproxMatchInTrie(child, coding::HuffmanCoder::Code(), automaton, s, isPrefix, f);
+    }
+    else
+    {
+      ApproxMatchInTrie(child, childCode, automaton, state, isPrefix, f);
+    }
+  }
+}
+
+template <typename F>
+void ApproxMatchInTrie(trie::TSuccinctIterator const & root, LevenshteinAutomaton const & automaton,
+                       bool isPrefix, F & f)
+{
+  ApproxMatchInTrie(root, coding::HuffmanCoder::Code(), automaton, automaton.Start(), isPrefix, f);
+}
+
 template <class TFilter>
 class OffsetIntersecter
 {
@@ -224,15 +353,56 @@ public:
 };
 }  // namespace search::impl
 
+/// Search index of an mwm: the memory-mapped succinct trie when the mwm has one,
+/// the classic trie otherwise.
+class SearchTrieRoot
+{
+public:
+  SearchTrieRoot(MwmValue const & value, serial::CodingParams const & cp)
+    : m_cp(cp), m_reader(nullptr)
+  {
+    if (value.m_searchTrie)
+    {
+      m_succinctRoot = value.m_searchTrie->GetRoot();
+      return;
+    }
+
+    m_reader = value.m_cont.GetReader(SEARCH_INDEX_FILE_TAG);
+    m_classicRoot.reset(trie::ReadTrie(SubReaderWrapper<Reader>(m_reader.GetPtr()),
+                                       trie::ValueReader(m_cp), trie::TEdgeValueReader()));
+  }
+
+  /// @return Null when the succinct trie is used.
+  trie::DefaultIterator const * GetClassicRoot() const { return m_classicRoot.get(); }
+  trie::TSuccinctIterator const & GetSuccinctRoot() const { return m_succinctRoot; }
+
+private:
+  serial::CodingParams const m_cp;
+  ModelReaderPtr m_reader;
+  unique_ptr<trie::DefaultIterator> m_classicRoot;
+  trie::TSuccinctIterator m_succinctRoot;
+};
+
+/// Root of a language subtree of the search index. For the classic trie it's the node
+/// at the end of the edge starting with the language code, and the rest of the edge
+/// is a prefix of all the tokens. For the succinct trie it's the node right after the
+/// language code.
 struct TrieRootPrefix
 {
-  trie::DefaultIterator const & m_root;
+  trie::DefaultIterator const * m_root;
   strings::UniChar const * m_prefix;
   size_t m_prefixSize;
 
+  trie::TSuccinctIterator m_succinctRoot;
+
+  explicit TrieRootPrefix(trie::TSuccinctIterator const & root)
+    : m_root(nullptr), m_prefix(0), m_prefixSize(0), m_succinctRoot(root)
+  {
+  }
+
   TrieRootPrefix(trie::DefaultIterator const & root,
                  trie::DefaultIterator::Edge::EdgeStrT const & edge)
-    : m_root(root)
+    : m_root(&root)
   {
     if (edge.size() == 1)
     {
@@ -289,7 +459,10 @@ void MatchTokenInTrie(SearchQueryParams::TSynonymsVector const & syns,
   for (auto const & syn : syns)
   {
     ASSERT(!syn.empty(), ());
-    impl::FullMatchInTrie(trieRoot.m_root, trieRoot.m_prefix, trieRoot.m_prefixSize, syn, toDo);
+    if (trieRoot.m_root)
+      impl::FullMatchInTrie(*trieRoot.m_root, trieRoot.m_prefix, trieRoot.m_prefixSize, syn, toDo);
+    else
+      impl::FullMatchInTrie(trieRoot.m_succinctRoot, syn, toDo);
   }
 }
 
@@ -303,7 +476,43 @@ void MatchTokenPrefixInTrie(SearchQueryParams::TSynonymsVector const & syns,
   for (auto const & syn : syns)
   {
     ASSERT(!syn.empty(), ());
-    impl::PrefixMatchInTrie(trieRoot.m_root, trieRoot.m_prefix, trieRoot.m_prefixSize, syn, toDo);
+    if (trieRoot.m_root)
+      impl::PrefixMatchInTrie(*trieRoot.m_root, trieRoot.m_prefix, trieRoot.m_prefixSize, syn, toDo);
+    else
+      impl::PrefixMatchInTrie(trieRoot.m_succinctRoot, syn, toDo);
+  }
+}
+
+// The same as MatchTokenInTrie and MatchTokenPrefixInTrie, but allows typos in
+// synonyms (see GetMaxErrorsForToken).
+template <typename ToDo>
+void MatchTokenInTrieWithTypos(SearchQueryParams::TSynonymsVector const & syns,
+                               TrieRootPrefix const & trieRoot, bool isPrefix, ToDo && toDo)
+{
+  for (auto const & syn : syns)
+  {
+    ASSERT(!syn.empty(), ());
+    uint32_t const maxErrors = GetMaxErrorsForToken(syn);
+    if (maxErrors == 0)
+    {
+      SearchQueryParams::TSynonymsVector const exact(1, syn);
+      if (isPrefix)
+        MatchTokenPrefixInTrie(exact, trieRoot, toDo);
+      else
+        MatchTokenInTrie(exact, trieRoot, toDo);
+      continue;
+    }
+
+    LevenshteinAutomaton const automaton(syn, maxErrors);
+    if (trieRoot.m_root)
+    {
+      impl::ApproxMatchInTrie(*trieRoot.m_root, trieRoot.m_prefix, trieRoot.m_prefixSize,
+                              automaton, isPrefix, toDo);
+    }
+    else
+    {
+      impl::ApproxMatchInTrie(trieRoot.m_succinctRoot, automaton, isPrefix, toDo);
+    }
   }
 }
 
@@ -340,26 +549,43 @@ void MatchTokensAndPrefixInTrie(vector<SearchQueryParams::TSynonymsVector> const
 // token from a search query.
 // *NOTE* query prefix will be treated as a complete token in the function.
 template <typename THolder>
-bool MatchCategoriesInTrie(SearchQueryParams const & params, trie::DefaultIterator const & trieRoot,
+void MatchCategoriesInTrie(SearchQueryParams const & params, TrieRootPrefix const & catRoot,
                            THolder && holder)
 {
-  ASSERT_LESS(trieRoot.m_edge.size(), numeric_limits<uint32_t>::max(), ());
-  uint32_t const numLangs = static_cast<uint32_t>(trieRoot.m_edge.size());
+  MatchTokensInTrie(params.m_tokens, catRoot, holder);
+
+  // Last token's prefix is used as a complete token here, to
+  // limit the number of features in the last bucket of a
+  // holder. Probably, this is a false optimization.
+  holder.Resize(params.m_tokens.size() + 1);
+  holder.SwitchTo(params.m_tokens.size());
+  MatchTokenInTrie(params.m_prefixTokens, catRoot, holder);
+}
+
+template <typename THolder>
+bool MatchCategoriesInTrie(SearchQueryParams const & params, SearchTrieRoot const & trieRoot,
+                           THolder && holder)
+{
+  trie::DefaultIterator const * root = trieRoot.GetClassicRoot();
+  if (!root)
+  {
+    trie::TSuccinctIterator catRoot = trieRoot.GetSuccinctRoot();
+    if (!catRoot.GoToSymbol(search::kCategoriesLang))
+      return false;
+    MatchCategoriesInTrie(params, TrieRootPrefix(catRoot), holder);
+    return true;
+  }
+
+  ASSERT_LESS(root->m_edge.size(), numeric_limits<uint32_t>::max(), ());
+  uint32_t const numLangs = static_cast<uint32_t>(root->m_edge.size());
   for (uint32_t langIx = 0; langIx < numLangs; ++langIx)
   {
-    auto const & edge = trieRoot.m_edge[langIx].m_str;
+    auto const & edge = root->m_edge[langIx].m_str;
     ASSERT_GREATER_OR_EQUAL(edge.size(), 1, ());
     if (edge[0] == search::kCategoriesLang)
     {
-      unique_ptr<trie::DefaultIterator> const catRoot(trieRoot.GoToEdge(langIx));
-      MatchTokensInTrie(params.m_tokens, TrieRootPrefix(*catRoot, edge), holder);
-
-      // Last token's prefix is used as a complete token here, to
-      // limit the number of features in the last bucket of a
-      // holder. Probably, this is a false optimization.
-      holder.Resize(params.m_tokens.size() + 1);
-      holder.SwitchTo(params.m_tokens.size());
-      MatchTokenInTrie(params.m_prefixTokens, TrieRootPrefix(*catRoot, edge), holder);
+      unique_ptr<trie::DefaultIterator> const catRoot(root->GoToEdge(langIx));
+      MatchCategoriesInTrie(params, TrieRootPrefix(*catRoot, edge), holder);
       return true;
     }
   }
@@ -369,19 +595,36 @@ bool MatchCategoriesInTrie(SearchQueryParams const & params, trie::DefaultIterat
 // Calls toDo with trie root prefix and language code on each language
 // allowed by params.
 template <typename ToDo>
-void ForEachLangPrefix(SearchQueryParams const & params, trie::DefaultIterator const & trieRoot,
+void ForEachLangPrefix(SearchQueryParams const & params, SearchTrieRoot const & trieRoot,
                        ToDo && toDo)
 {
-  ASSERT_LESS(trieRoot.m_edge.size(), numeric_limits<uint32_t>::max(), ());
-  uint32_t const numLangs = static_cast<uint32_t>(trieRoot.m_edge.size());
+  trie::DefaultIterator const * root = trieRoot.GetClassicRoot();
+  if (!root)
+  {
+    for (uint32_t lang = 0; lang < search::kCategoriesLang; ++lang)
+    {
+      if (!params.IsLangExist(static_cast<int8_t>(lang)))
+        continue;
+      trie::TSuccinctIterator langRoot = trieRoot.GetSuccinctRoot();
+      if (langRoot.GoToSymbol(lang))
+      {
+        TrieRootPrefix langPrefix(langRoot);
+        toDo(langPrefix, static_cast<int8_t>(lang));
+      }
+    }
+    return;
+  }
+
+  ASSERT_LESS(root->m_edge.size(), numeric_limits<uint32_t>::max(), ());
+  uint32_t const numLangs = static_cast<uint32_t>(root->m_edge.size());
   for (uint32_t langIx = 0; langIx < numLangs; ++langIx)
   {
-    auto const & edge = trieRoot.m_edge[langIx].m_str;
+    auto const & edge = root->m_edge[langIx].m_str;
     ASSERT_GREATER_OR_EQUAL(edge.size(), 1, ());
     int8_t const lang = static_cast<int8_t>(edge[0]);
     if (edge[0] < search::kCategoriesLang && params.IsLangExist(lang))
     {
-      unique_ptr<trie::DefaultIterator> const langRoot(trieRoot.GoToEdge(langIx));
+      unique_ptr<trie::DefaultIterator> const langRoot(root->GoToEdge(langIx));
       TrieRootPrefix langPrefix(*langRoot, edge);
       toDo(langPrefix, lang);
     }
@@ -391,7 +634,7 @@ void ForEachLangPrefix(SearchQueryParams const & params, trie::DefaultIterator c
 // Calls toDo for each feature whose description contains *ALL* tokens from a search query.
 // Each feature will be passed to toDo only once.
 template <typename TFilter, typename ToDo>
-void MatchFeaturesInTrie(SearchQueryParams const & params, trie::DefaultIterator const & trieRoot,
+void MatchFeaturesInTrie(SearchQueryParams const & params, SearchTrieRoot const & trieRoot,
                          TFilter const & filter, ToDo && toDo)
 {
   TrieValuesHolder<TFilter> categoriesHolder(filter);
@@ -402,7 +645,10 @@ void MatchFeaturesInTrie(SearchQueryParams const & params, trie::DefaultIterator
   {
     ForEachLangPrefix(params, trieRoot, [&](TrieRootPrefix & langRoot, int8_t lang)
     {
-      MatchTokenInTrie(params.m_tokens[i], langRoot, intersecter);
+      if (params.m_allowTypos)
+        MatchTokenInTrieWithTypos(params.m_tokens[i], langRoot, false /* isPrefix */, intersecter);
+      else
+        MatchTokenInTrie(params.m_tokens[i], langRoot, intersecter);
     });
     categoriesHolder.ForEachValue(i, intersecter);
     intersecter.NextStep();
@@ -412,7 +658,10 @@ void MatchFeaturesInTrie(SearchQueryParams const & params, trie::DefaultIterator
   {
     ForEachLangPrefix(params, trieRoot, [&](TrieRootPrefix & langRoot, int8_t /* lang */)
     {
-      MatchTokenPrefixInTrie(params.m_prefixTokens, langRoot, intersecter);
+      if (params.m_allowTypos)
+        MatchTokenInTrieWithTypos(params.m_prefixTokens, langRoot, true /* isPrefix */, intersecter);
+      else
+        MatchTokenPrefixInTrie(params.m_prefixTokens, langRoot, intersecter);
     });
     categoriesHolder.ForEachValue(params.m_tokens.size(), intersecter);
     intersecter.NextStep();
@@ -1,5 +1,6 @@
 #include "search/algos.hpp"
 #include "search/house_detector.hpp"
+#include "search/projection_on_street.hpp"
 #include "search/search_common.hpp"
 
 #include "indexer/classificator.hpp"
@@ -10,6 +11,7 @@
 
 #include "base/limited_priority_queue.hpp"
 #include "base/logging.hpp"
+#include "base/math.hpp"
 #include "base/stl_iterator.hpp"
 
 #include "std/bind.hpp"
@@ -513,91 +515,6 @@ int HouseDetector::MergeStreets()
   return m_streetNum;
 }
 
-namespace
-{
-
-class ProjectionCalcToStreet
-{
-  vector<m2::PointD> const & m_points;
-  double m_distanceMeters;
-
-  typedef m2::ProjectionToSection<m2::PointD> ProjectionT;
-  vector<ProjectionT> m_calcs;
-
-public:
-  ProjectionCalcToStreet(Street const * st, double distanceMeters)
-    : m_points(st->m_points), m_distanceMeters(distanceMeters)
-  {
-    ASSERT_GREATER(m_points.size(), 1, ());
-  }
-
-  void Initialize()
-  {
-    if (m_calcs.empty())
-    {
-      size_t const count = m_points.size() - 1;
-      m_calcs.resize(count);
-      for (size_t i = 0; i < count; ++i)
-        m_calcs[i].SetBounds(m_points[i], m_points[i+1]);
-    }
-  }
-
-  double GetLength(size_t ind) const
-  {
-    double length = 0.0;
-    for (size_t i = 0; i < ind; ++i)
-      length += m_calcs[i].GetLength();
-    return length;
-  }
-
-  double GetLength()
-  {
-    Initialize();
-    return GetLength(m_calcs.size());
-  }
-
-  void CalculateProjectionParameters(m2::PointD const & pt,
-                                     m2::PointD & resPt, double & dist, double & resDist, size_t & ind)
-  {
-    for (size_t i = 0; i < m_calcs.size(); ++i)
-    {
-      m2::PointD const proj = m_calcs[i](pt);
-      dist = GetDistanceMeters(pt, proj);
-      if (dist < resDist)
-      {
-        resPt = proj;
-        resDist = dist;
-        ind = i;
-      }
-    }
-  }
-
-  bool GetProjection(m2::PointD const & pt, HouseProjection & proj)
-  {
-    Initialize();
-
-    m2::PointD resPt;
-    double dist = numeric_limits<double>::max();
-    double resDist = numeric_limits<double>::max();
-    size_t ind;
-
-    CalculateProjectionParameters(pt, resPt, dist, resDist, ind);
-
-    if (resDist <= m_distanceMeters)
-    {
-      proj.m_proj = resPt;
-      proj.m_distance = resDist;
-      proj.m_streetDistance = GetLength(ind) + m_points[ind].Length(proj.m_proj);
-      proj.m_projectionSign = m2::GetOrientation(m_points[ind], m_points[ind+1], pt) >= 0;
-      return true;
-    }
-    else
-      return false;
-  }
-};
-
-}
-
 string const & MergedStreet::GetDbgName() const
 {
   ASSERT(!m_cont.empty(), ());
@@ -722,7 +639,7 @@ HouseProjection const * MergedStreet::GetHousePivot(bool isOdd, bool & sign) con
 }
 
 template <class ProjectionCalcT>
-void HouseDetector::ReadHouse(FeatureType const & f, Street * st, ProjectionCalcT & calc)
+void HouseDetector::ReadHouse(FeatureType const & f, ProjectionCalcT & calc)
 {
   string const houseNumber = f.GetHouseNumber();
 
@@ -734,53 +651,61 @@ void HouseDetector::ReadHouse(FeatureType const & f, Street * st, ProjectionCalc
 
     m2::PointD const pt = isNew ? f.GetLimitRect(FeatureType::BEST_GEOMETRY).Center() : it->second->GetPosition();
 
-    HouseProjection pr;
-    if (calc.GetProjection(pt, pr))
+    House * p = isNew ? 0 : it->second;
+    calc.ForEachProjection(pt, [&](Street * st, HouseProjection & pr)
     {
-      House * p;
-      if (isNew)
+      if (p == 0)
       {
         p = new House(houseNumber, pt);
         m_id2house[f.GetID()] = p;
       }
-      else
-      {
-        p = it->second;
-        ASSERT(p != 0, ());
-      }
 
       pr.m_house = p;
       st->m_houses.push_back(pr);
-    }
+    });
   }
 }
 
-void HouseDetector::ReadHouses(Street * st, double offsetMeters)
+void HouseDetector::ReadHouses(MergedStreet & st, double offsetMeters)
 {
-  if (st->m_housesReaded)
+  //offsetMeters = max(HN_MIN_READ_OFFSET_M, min(GetApprLengthMeters(st->m_number) / 2, offsetMeters));
+
+  vector<Street *> streets;
+  for (size_t i = 0; i < st.m_cont.size(); ++i)
+  {
+    if (!st.m_cont[i]->m_housesReaded)
+      streets.push_back(st.m_cont[i]);
+  }
+  if (streets.empty())
     return;
 
-  //offsetMeters = max(HN_MIN_READ_OFFSET_M, min(GetApprLengthMeters(st->m_number) / 2, offsetMeters));
+  ProjectionCalcToMergedStreet calcker(streets, offsetMeters);
 
-  ProjectionCalcToStreet calcker(st, offsetMeters);
-  m_loader.ForEachInRect(st->GetLimitRect(offsetMeters),
-                         bind(&HouseDetector::ReadHouse<ProjectionCalcToStreet>, this, _1, st, ref(calcker)));
+  // Rects of adjacent streets overlap, so read every feature only once.
+  set<FeatureID> processed;
+  for (size_t i = 0; i < streets.size(); ++i)
+  {
+    m_loader.ForEachInRect(streets[i]->GetLimitRect(offsetMeters), [&](FeatureType const & f)
+    {
+      if (processed.insert(f.GetID()).second)
+        ReadHouse(f, calcker);
+    });
+  }
 
-  st->m_length = calcker.GetLength();
-  st->SortHousesProjection();
+  calcker.FinishReading();
 }
 
 void HouseDetector::ReadAllHouses(double offsetMeters)
 {
   m_houseOffsetM = offsetMeters;
 
-  for (StreetMapT::iterator it = m_id2st.begin(); it != m_id2st.end(); ++it)
-    ReadHouses(it->second, offsetMeters);
-
   for (size_t i = 0; i < m_streets.size(); ++i)
   {
     if (!m_streets[i].IsHousesReaded())
+    {
+      ReadHouses(m_streets[i], offsetMeters);
       m_streets[i].FinishReadingHouses();
+    }
   }
 }
 
@@ -243,8 +243,9 @@ class HouseDetector
   void MergeStreets(Street * st);
 
   template <class ProjectionCalcT>
-  void ReadHouse(FeatureType const & f, Street * st, ProjectionCalcT & calc);
-  void ReadHouses(Street * st, double offsetMeters);
+  void ReadHouse(FeatureType const & f, ProjectionCalcT & calc);
+  /// Reads houses near all the not yet read streets of the merged street.
+  void ReadHouses(MergedStreet & st, double offsetMeters);
 
   void SetMetres2Mercator(double factor);
 
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "search/house_detector.hpp"
+
+#include "indexer/mercator.hpp"
+
+#include "geometry/distance.hpp"
+#include "geometry/point2d.hpp"
+#include "geometry/rect2d.hpp"
+
+#include "base/assert.hpp"
+#include "base/math.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/cmath.hpp"
+#include "std/limits.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+namespace search
+{
+/// Projects points to the sections of a street in the distance limit.
+class ProjectionCalcToStreet
+{
+  vector<m2::PointD> const & m_points;
+  double m_distanceMeters;
+
+  typedef m2::ProjectionToSection<m2::PointD> ProjectionT;
+  vector<ProjectionT> m_calcs;
+  /// Length of the street from the first point to the beginning of each section.
+  vector<double> m_lengths;
+
+public:
+  ProjectionCalcToStreet(Street const * st, double distanceMeters)
+    : m_points(st->m_points), m_distanceMeters(distanceMeters)
+  {
+    ASSERT_GREATER(m_points.size(), 1, ());
+
+    size_t const count = m_points.size() - 1;
+    m_calcs.resize(count);
+    m_lengths.resize(count + 1);
+    m_lengths[0] = 0.0;
+    for (size_t i = 0; i < count; ++i)
+    {
+      m_calcs[i].SetBounds(m_points[i], m_points[i+1]);
+      m_lengths[i + 1] = m_lengths[i] + m_calcs[i].GetLength();
+    }
+  }
+
+  size_t GetSectionsCount() const { return m_calcs.size(); }
+  m2::PointD const & GetPoint(size_t ind) const { return m_points[ind]; }
+
+  double GetLength(size_t ind) const { return m_lengths[ind]; }
+  double GetLength() const { return m_lengths.back(); }
+
+  /// Projects point to the nearest of the sections in [beg, end),
+  /// which should be sorted by index.
+  template <class IterT>
+  bool GetProjection(m2::PointD const & pt, IterT beg, IterT end, HouseProjection & proj) const
+  {
+    m2::PointD resPt;
+    double resDist = numeric_limits<double>::max();
+    size_t ind = 0;
+
+    for (; beg != end; ++beg)
+    {
+      m2::PointD const p = m_calcs[*beg](pt);
+      double const dist = MercatorBounds::DistanceOnEarth(pt, p);
+      if (dist < resDist)
+      {
+        resPt = p;
+        resDist = dist;
+        ind = *beg;
+      }
+    }
+
+    if (resDist <= m_distanceMeters)
+    {
+      proj.m_proj = resPt;
+      proj.m_distance = resDist;
+      proj.m_streetDistance = GetLength(ind) + m_points[ind].Length(proj.m_proj);
+      proj.m_projectionSign = m2::GetOrientation(m_points[ind], m_points[ind+1], pt) >= 0;
+      return true;
+    }
+    else
+      return false;
+  }
+};
+
+/// Projects houses to the streets of a merged street at once.
+/// Sections of all the streets are put to a uniform grid, so a house is projected
+/// only to the sections near it, instead of all the sections of every street.
+class ProjectionCalcToMergedStreet
+{
+  vector<Street *> m_streets;
+  vector<ProjectionCalcToStreet> m_calcs;
+  double m_distanceMeters;
+
+  /// Global section index is the index in m_sections, sections are ordered
+  /// by street and then by index in street.
+  vector<pair<uint32_t, uint32_t> > m_sections;
+
+  m2::RectD m_rect;
+  double m_cellSizeX, m_cellSizeY;
+  int m_cellsX, m_cellsY;
+  vector<vector<uint32_t> > m_cells;
+
+  vector<uint32_t> m_candidates;
+  vector<uint32_t> m_streetCandidates;
+
+  /// Limit for the number of grid cells for long streets.
+  static int const kMaxCells = 64 * 64;
+
+  int GetCellX(double x) const
+  {
+    return my::clamp(static_cast<int>((x - m_rect.minX()) / m_cellSizeX), 0, m_cellsX - 1);
+  }
+  int GetCellY(double y) const
+  {
+    return my::clamp(static_cast<int>((y - m_rect.minY()) / m_cellSizeY), 0, m_cellsY - 1);
+  }
+
+  /// Rect to look for sections near the point. It's twice as large as
+  /// the distance limit, to be sure that a projection in the limit isn't missed
+  /// because of a difference between mercator and the distance on earth.
+  m2::RectD GetNearRect(m2::PointD const & pt) const
+  {
+    return MercatorBounds::RectByCenterXYAndSizeInMeters(pt, 2 * m_distanceMeters);
+  }
+
+  template <class ToDo> void ForEachCell(m2::RectD const & rect, ToDo toDo)
+  {
+    int const maxX = GetCellX(rect.maxX());
+    int const maxY = GetCellY(rect.maxY());
+    for (int x = GetCellX(rect.minX()); x <= maxX; ++x)
+      for (int y = GetCellY(rect.minY()); y <= maxY; ++y)
+        toDo(m_cells[y * m_cellsX + x]);
+  }
+
+public:
+  ProjectionCalcToMergedStreet(vector<Street *> const & streets, double distanceMeters)
+    : m_streets(streets), m_distanceMeters(distanceMeters)
+  {
+    m_calcs.reserve(m_streets.size());
+    for (size_t i = 0; i < m_streets.size(); ++i)
+    {
+      m_calcs.push_back(ProjectionCalcToStreet(m_streets[i], m_distanceMeters));
+      m_rect.Add(m_streets[i]->GetLimitRect(m_distanceMeters));
+      for (size_t j = 0; j < m_calcs.back().GetSectionsCount(); ++j)
+        m_sections.push_back(make_pair(static_cast<uint32_t>(i), static_cast<uint32_t>(j)));
+    }
+
+    // A house is looked for in about 3x3 cells.
+    m2::RectD const cellRect = GetNearRect(m_rect.Center());
+    m_cellSizeX = max(cellRect.SizeX(), m_rect.SizeX() / sqrt(double(kMaxCells)));
+    m_cellSizeY = max(cellRect.SizeY(), m_rect.SizeY() / sqrt(double(kMaxCells)));
+    m_cellsX = max(1, static_cast<int>(ceil(m_rect.SizeX() / m_cellSizeX)));
+    m_cellsY = max(1, static_cast<int>(ceil(m_rect.SizeY() / m_cellSizeY)));
+    m_cells.resize(m_cellsX * m_cellsY);
+
+    for (size_t i = 0; i < m_sections.size(); ++i)
+    {
+      ProjectionCalcToStreet const & calc = m_calcs[m_sections[i].first];
+      size_t const j = m_sections[i].second;
+      m2::RectD rect(calc.GetPoint(j), calc.GetPoint(j + 1));
+      ForEachCell(rect, [i](vector<uint32_t> & cell)
+      {
+        cell.push_back(static_cast<uint32_t>(i));
+      });
+    }
+  }
+
+  /// Calls toDo(street, projection) for every street in the distance limit from the point.
+  template <class ToDo> void ForEachProjection(m2::PointD const & pt, ToDo && toDo)
+  {
+    m_candidates.clear();
+    ForEachCell(GetNearRect(pt), [this](vector<uint32_t> const & cell)
+    {
+      m_candidates.insert(m_candidates.end(), cell.begin(), cell.end());
+    });
+    sort(m_candidates.begin(), m_candidates.end());
+    m_candidates.erase(unique(m_candidates.begin(), m_candidates.end()), m_candidates.end());
+
+    for (size_t i = 0; i < m_candidates.size();)
+    {
+      uint32_t const street = m_sections[m_candidates[i]].first;
+      m_streetCandidates.clear();
+      for (; i < m_candidates.size() && m_sections[m_candidates[i]].first == street; ++i)
+        m_streetCandidates.push_back(m_sections[m_candidates[i]].second);
+
+      HouseProjection proj;
+      if (m_calcs[street].GetProjection(pt, m_streetCandidates.begin(), m_streetCandidates.end(),
+                                        proj))
+      {
+        toDo(m_streets[street], proj);
+      }
+    }
+  }
+
+  void FinishReading()
+  {
+    for (size_t i = 0; i < m_streets.size(); ++i)
+    {
+      m_streets[i]->m_length = m_calcs[i].GetLength();
+      m_streets[i]->SortHousesProjection();
+    }
+  }
+};
+}  // namespace search
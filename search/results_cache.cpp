@@ -0,0 +1,185 @@
+#include "search/results_cache.hpp"
+
+#include "search/params.hpp"
+
+#include "indexer/mercator.hpp"
+#include "indexer/scales.hpp"
+#include "indexer/search_string_utils.hpp"
+
+#include "base/assert.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/cmath.hpp"
+#include "std/cstring.hpp"
+#include "std/functional.hpp"
+#include "std/tuple.hpp"
+
+namespace search
+{
+namespace
+{
+// Number of cells along a side of a viewport of the same scale level.
+double constexpr kCellsPerViewport = 4.0;
+
+int64_t GetCell(double coord, double cellSize)
+{
+  return static_cast<int64_t>(floor(coord / cellSize));
+}
+
+size_t GetSize(Results const & results)
+{
+  size_t size = sizeof(Results);
+  for (auto it = results.Begin(); it != results.End(); ++it)
+  {
+    size += sizeof(Result) + strlen(it->GetString()) + strlen(it->GetRegionString()) +
+            strlen(it->GetFeatureType()) + strlen(it->GetCuisine());
+    if (it->IsSuggest())
+      size += strlen(it->GetSuggestionString());
+  }
+  return size;
+}
+}  // namespace
+
+bool ResultsCache::Key::operator<(Key const & rhs) const
+{
+  return tie(m_query, m_locale, m_mode, m_allowTypos, m_scale, m_cellX, m_cellY, m_hasPosition,
+             m_positionX, m_positionY) < tie(rhs.m_query, rhs.m_locale, rhs.m_mode,
+                                             rhs.m_allowTypos, rhs.m_scale, rhs.m_cellX,
+                                             rhs.m_cellY, rhs.m_hasPosition, rhs.m_positionX,
+                                             rhs.m_positionY);
+}
+
+size_t constexpr ResultsCache::kShardsCount;
+
+ResultsCache::ResultsCache(size_t maxBytes, steady_clock::duration ttl)
+  : m_generation(0), m_maxShardBytes(maxBytes / kShardsCount), m_ttl(ttl)
+{
+}
+
+// static
+ResultsCache::Key ResultsCache::MakeKey(SearchParams const & params, m2::RectD const & viewport,
+                                        bool allowTypos)
+{
+  Key key;
+  key.m_query = strings::ToUtf8(NormalizeAndSimplifyString(params.m_query));
+  key.m_locale = params.m_inputLocale;
+
+  int const modes[] = {SearchParams::IN_VIEWPORT_ONLY, SearchParams::SEARCH_WORLD,
+                       SearchParams::SEARCH_ADDRESS};
+  for (int mode : modes)
+  {
+    if (params.HasSearchMode(static_cast<SearchParams::SearchModeT>(mode)))
+      key.m_mode |= mode;
+  }
+  key.m_allowTypos = allowTypos;
+
+  // Viewports of the same scale level with close centers share the key.
+  key.m_scale = scales::GetScaleLevel(viewport);
+  double const cellSize =
+      (MercatorBounds::maxX - MercatorBounds::minX) / (1 << key.m_scale) / kCellsPerViewport;
+  m2::PointD const center = viewport.Center();
+  key.m_cellX = GetCell(center.x, cellSize);
+  key.m_cellY = GetCell(center.y, cellSize);
+
+  // Position changes ranking of the results.
+  if (params.IsValidPosition())
+  {
+    m2::PointD const pos = MercatorBounds::FromLatLon(params.m_lat, params.m_lon);
+    key.m_hasPosition = true;
+    key.m_positionX = GetCell(pos.x, cellSize);
+    key.m_positionY = GetCell(pos.y, cellSize);
+  }
+  return key;
+}
+
+bool ResultsCache::Get(Key const & key, Results & results)
+{
+  Shard & shard = GetShard(key);
+  lock_guard<mutex> lock(shard.m_mutex);
+
+  auto const it = shard.m_entries.find(key);
+  if (it == shard.m_entries.end())
+    return false;
+
+  if (it->second.m_expiration <= steady_clock::now())
+  {
+    Erase(shard, it);
+    return false;
+  }
+
+  shard.m_lru.splice(shard.m_lru.begin(), shard.m_lru, it->second.m_lruIt);
+  results = it->second.m_results;
+  return true;
+}
+
+void ResultsCache::Put(Key const & key, Results const & results)
+{
+  Put(key, results, GetGeneration());
+}
+
+void ResultsCache::Put(Key const & key, Results const & results, uint64_t generation)
+{
+  size_t const bytes = GetSize(results) + sizeof(Entry) + 2 * sizeof(Key) + key.m_query.size();
+  if (bytes > m_maxShardBytes)
+    return;
+
+  Shard & shard = GetShard(key);
+  lock_guard<mutex> lock(shard.m_mutex);
+
+  // Clear() changes the generation before it clears shards, so results stored
+  // before the change are cleared too.
+  if (generation != m_generation)
+    return;
+
+  auto const it = shard.m_entries.find(key);
+  if (it != shard.m_entries.end())
+    Erase(shard, it);
+
+  shard.m_lru.push_front(key);
+  Entry & entry = shard.m_entries[key];
+  entry.m_results = results;
+  entry.m_bytes = bytes;
+  entry.m_expiration = steady_clock::now() + m_ttl;
+  entry.m_lruIt = shard.m_lru.begin();
+  shard.m_bytes += bytes;
+
+  Shrink(shard);
+}
+
+void ResultsCache::Clear()
+{
+  ++m_generation;
+  for (Shard & shard : m_shards)
+  {
+    lock_guard<mutex> lock(shard.m_mutex);
+    shard.m_entries.clear();
+    shard.m_lru.clear();
+    shard.m_bytes = 0;
+  }
+}
+
+ResultsCache::Shard & ResultsCache::GetShard(Key const & key)
+{
+  size_t const h = hash<string>()(key.m_query) ^ static_cast<size_t>(key.m_cellX * 31 + key.m_cellY);
+  return m_shards[h % kShardsCount];
+}
+
+// static
+void ResultsCache::Erase(Shard & shard, map<Key, Entry>::iterator it)
+{
+  ASSERT_GREATER_OR_EQUAL(shard.m_bytes, it->second.m_bytes, ());
+  shard.m_bytes -= it->second.m_bytes;
+  shard.m_lru.erase(it->second.m_lruIt);
+  shard.m_entries.erase(it);
+}
+
+void ResultsCache::Shrink(Shard & shard)
+{
+  while (shard.m_bytes > m_maxShardBytes && !shard.m_lru.empty())
+  {
+    auto const it = shard.m_entries.find(shard.m_lru.back());
+    ASSERT(it != shard.m_entries.end(), ());
+    Erase(shard, it);
+  }
+}
+}  // namespace search
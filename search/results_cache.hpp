@@ -0,0 +1,93 @@
+#pragma once
+
+#include "search/result.hpp"
+
+#include "geometry/rect2d.hpp"
+
+#include "std/array.hpp"
+#include "std/atomic.hpp"
+#include "std/chrono.hpp"
+#include "std/cstdint.hpp"
+#include "std/list.hpp"
+#include "std/map.hpp"
+#include "std/mutex.hpp"
+#include "std/string.hpp"
+
+namespace search
+{
+class SearchParams;
+
+/// Thread-safe cache of final search results, which can be shared by several engines.
+/// Results are keyed by the normalized query, input locale, search mode, typos mode and
+/// the cells of the viewport and of the user's position, so the same query from about
+/// the same place is answered without searching.
+/// Keys are split into shards with separate locks. A shard drops its least recently
+/// used entries when it's over its part of the memory limit, and expired entries
+/// are dropped on lookup.
+class ResultsCache
+{
+public:
+  struct Key
+  {
+    string m_query;
+    string m_locale;
+    int m_mode = 0;
+    bool m_allowTypos = false;
+    int m_scale = 0;
+    int64_t m_cellX = 0, m_cellY = 0;
+    bool m_hasPosition = false;
+    int64_t m_positionX = 0, m_positionY = 0;
+
+    bool operator<(Key const & rhs) const;
+  };
+
+  /// @param maxBytes approximate memory limit for all the cached results.
+  /// @param ttl time to live of an entry.
+  ResultsCache(size_t maxBytes, steady_clock::duration ttl);
+
+  static Key MakeKey(SearchParams const & params, m2::RectD const & viewport, bool allowTypos);
+
+  /// @return False when there are no results for the key or they are expired.
+  bool Get(Key const & key, Results & results);
+  void Put(Key const & key, Results const & results);
+  /// Drops results when the cache was cleared after GetGeneration() returned generation,
+  /// so results of a search which started before Clear() aren't stored.
+  void Put(Key const & key, Results const & results, uint64_t generation);
+
+  /// @return Number of Clear() calls.
+  uint64_t GetGeneration() const { return m_generation; }
+
+  void Clear();
+
+private:
+  struct Entry
+  {
+    Results m_results;
+    size_t m_bytes;
+    steady_clock::time_point m_expiration;
+    list<Key>::iterator m_lruIt;
+  };
+
+  struct Shard
+  {
+    mutex m_mutex;
+    map<Key, Entry> m_entries;
+    /// Keys from the most to the least recently used.
+    list<Key> m_lru;
+    size_t m_bytes = 0;
+  };
+
+  static size_t constexpr kShardsCount = 16;
+
+  Shard & GetShard(Key const & key);
+
+  // Following methods should be called with the shard lock held.
+  static void Erase(Shard & shard, map<Key, Entry>::iterator it);
+  void Shrink(Shard & shard);
+
+  array<Shard, kShardsCount> m_shards;
+  atomic<uint64_t> m_generation;
+  size_t const m_maxShardBytes;
+  steady_clock::duration const m_ttl;
+};
+}  // namespace search
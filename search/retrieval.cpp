@@ -7,8 +7,6 @@
 #include "indexer/index.hpp"
 #include "indexer/search_trie.hpp"
 
-#include "coding/reader_wrapper.hpp"
-
 #include "base/logging.hpp"
 
 #include "std/algorithm.hpp"
@@ -31,21 +29,18 @@ struct EmptyFilter
 // Retrieves from the search index corresponding to |handle| all
 // features matching to |params|.
 void RetrieveAddressFeatures(MwmSet::MwmHandle const & handle, SearchQueryParams const & params,
-                             vector<uint32_t> & featureIds)
+                             ChunkedBitVector & featureIds)
 {
   auto * value = handle.GetValue<MwmValue>();
   ASSERT(value, ());
   serial::CodingParams codingParams(trie::GetCodingParams(value->GetHeader().GetDefCodingParams()));
-  ModelReaderPtr searchReader = value->m_cont.GetReader(SEARCH_INDEX_FILE_TAG);
-  unique_ptr<trie::DefaultIterator> const trieRoot(
-      trie::ReadTrie(SubReaderWrapper<Reader>(searchReader.GetPtr()),
-                     trie::ValueReader(codingParams), trie::TEdgeValueReader()));
+  SearchTrieRoot const trieRoot(*value, codingParams);
 
   auto collector = [&](trie::ValueReader::ValueType const & value)
   {
-    featureIds.push_back(value.m_featureId);
+    featureIds.Set(value.m_featureId);
   };
-  MatchFeaturesInTrie(params, *trieRoot, EmptyFilter(), collector);
+  MatchFeaturesInTrie(params, trieRoot, EmptyFilter(), collector);
 }
 
 // Retrieves from the geomery index corresponding to handle all
@@ -135,15 +130,9 @@ class SlowPathStrategy : public Retrieval::Strategy
 {
 public:
   SlowPathStrategy(MwmSet::MwmHandle & handle, m2::RectD const & viewport,
-                   SearchQueryParams const & params, vector<uint32_t> const & addressFeatures)
-    : Strategy(handle, viewport), m_params(params)
+                   SearchQueryParams const & params, ChunkedBitVector const & addressFeatures)
+    : Strategy(handle, viewport), m_params(params), m_nonReported(addressFeatures)
   {
-    if (addressFeatures.empty())
-      return;
-
-    m_nonReported.resize(*max_element(addressFeatures.begin(), addressFeatures.end()) + 1);
-    for (auto const & featureId : addressFeatures)
-      m_nonReported[featureId] = true;
   }
 
   // Retrieval::Strategy overrides:
@@ -160,14 +149,10 @@ public:
     m2::RectD currViewport = m_viewport;
     currViewport.Scale(scale);
 
-    vector<uint32_t> geometryFeatures;
+    ChunkedBitVector geometryFeatures;
     auto collector = [&](uint32_t feature)
     {
-      if (feature < m_nonReported.size() && m_nonReported[feature])
-      {
-        geometryFeatures.push_back(feature);
-        m_nonReported[feature] = false;
-      }
+      geometryFeatures.Set(feature);
     };
 
     if (m_prevScale < 0)
@@ -190,7 +175,13 @@ public:
       LONG_OP(RetrieveGeometryFeatures(m_handle, d, m_params, collector));
     }
 
-    callback(geometryFeatures);
+    // Matching features, which were not reported yet.
+    geometryFeatures.And(m_nonReported);
+    m_nonReported.AndNot(geometryFeatures);
+
+    vector<uint32_t> features;
+    geometryFeatures.ToVector(features);
+    callback(features);
 #undef LONG_OP
     return true;
   }
@@ -198,7 +189,7 @@ public:
 private:
   SearchQueryParams const & m_params;
 
-  vector<bool> m_nonReported;
+  ChunkedBitVector m_nonReported;
 };
 }  // namespace
 
@@ -254,6 +245,7 @@ bool Retrieval::Strategy::Retrieve(double scale, my::Cancellable const & cancell
 // Retrieval::Bucket -------------------------------------------------------------------------------
 Retrieval::Bucket::Bucket(MwmSet::MwmHandle && handle)
   : m_handle(move(handle))
+  , m_numAddressFeatures(0)
   , m_featuresReported(0)
   , m_intersectsWithViewport(false)
   , m_finished(false)
@@ -345,10 +337,13 @@ bool Retrieval::RetrieveForScale(double scale, Callback & callback)
       RetrieveAddressFeatures(bucket.m_handle, m_params, bucket.m_addressFeatures);
       if (IsCancelled())
         return false;
-      if (bucket.m_addressFeatures.size() < kFastPathThreshold)
+      bucket.m_numAddressFeatures = bucket.m_addressFeatures.PopCount();
+      if (bucket.m_numAddressFeatures < kFastPathThreshold)
       {
+        vector<uint32_t> addressFeatures;
+        bucket.m_addressFeatures.ToVector(addressFeatures);
         bucket.m_strategy.reset(
-            new FastPathStrategy(*m_index, bucket.m_handle, m_viewport, bucket.m_addressFeatures));
+            new FastPathStrategy(*m_index, bucket.m_handle, m_viewport, addressFeatures));
       }
       else
       {
@@ -359,8 +354,8 @@ bool Retrieval::RetrieveForScale(double scale, Callback & callback)
       bucket.m_intersectsWithViewport = true;
     }
 
-    ASSERT_LESS_OR_EQUAL(bucket.m_featuresReported, bucket.m_addressFeatures.size(), ());
-    if (bucket.m_featuresReported == bucket.m_addressFeatures.size())
+    ASSERT_LESS_OR_EQUAL(bucket.m_featuresReported, bucket.m_numAddressFeatures, ());
+    if (bucket.m_featuresReported == bucket.m_numAddressFeatures)
     {
       ASSERT(bucket.m_intersectsWithViewport, ());
       // All features were reported for the bucket.
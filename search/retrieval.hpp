@@ -6,6 +6,8 @@
 
 #include "geometry/rect2d.hpp"
 
+#include "coding/chunked_bit_vector.hpp"
+
 #include "base/cancellable.hpp"
 #include "base/macros.hpp"
 
@@ -113,7 +115,8 @@ private:
 
     MwmSet::MwmHandle m_handle;
     m2::RectD m_bounds;
-    vector<uint32_t> m_addressFeatures;
+    ChunkedBitVector m_addressFeatures;
+    uint64_t m_numAddressFeatures;
 
     // The order matters here - strategy may contain references to the
     // fields above, thus it must be destructed before them.
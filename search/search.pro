@@ -21,8 +21,10 @@ HEADERS += \
     latlon_match.hpp \
     locality_finder.hpp \
     params.hpp \
+    projection_on_street.hpp \
     query_saver.hpp \
     result.hpp \
+    results_cache.hpp \
     retrieval.hpp \
     search_common.hpp \
     search_engine.hpp \
@@ -44,6 +46,7 @@ SOURCES += \
     params.cpp \
     query_saver.cpp \
     result.cpp \
+    results_cache.cpp \
     retrieval.cpp \
     search_engine.cpp \
     search_query.cpp \
@@ -15,6 +15,7 @@
 
 #include "geometry/distance_on_sphere.hpp"
 
+#include "base/scope_guard.hpp"
 #include "base/stl_add.hpp"
 
 #include "std/map.hpp"
@@ -29,6 +30,9 @@ namespace search
 
 double const DIST_EQUAL_QUERY = 100.0;
 
+// Default number of queries for SearchConcurrently().
+size_t const kMaxPoolQueries = 4;
+
 using TSuggestsContainer = vector<Suggest>;
 
 class EngineData
@@ -75,6 +79,14 @@ Engine::Engine(Index & index, Reader * categoriesR, storage::CountryInfoGetter c
                string const & locale, unique_ptr<SearchQueryFactory> && factory)
   : m_factory(move(factory))
   , m_data(make_unique<EngineData>(categoriesR))
+  , m_index(index)
+  , m_infoGetter(infoGetter)
+  , m_locale(locale)
+  , m_supportOldFormat(false)
+  , m_allowTypos(false)
+  , m_numPoolQueries(0)
+  , m_maxPoolQueries(kMaxPoolQueries)
+  , m_poolGeneration(0)
 {
   m_isReadyThread.clear();
 
@@ -93,9 +105,93 @@ Engine::~Engine()
 
 void Engine::SupportOldFormat(bool b)
 {
+  m_supportOldFormat = b;
   m_query->SupportOldFormat(b);
 }
 
+void Engine::AllowTypos(bool b)
+{
+  m_allowTypos = b;
+  m_query->AllowTypos(b);
+}
+
+void Engine::SetResultsCache(shared_ptr<ResultsCache> const & cache)
+{
+  threads::MutexGuard guard(m_updateMutex);
+  m_resultsCache = cache;
+}
+
+shared_ptr<ResultsCache> Engine::GetResultsCache()
+{
+  threads::MutexGuard guard(m_updateMutex);
+  return m_resultsCache;
+}
+
+void Engine::SetMaxConcurrentQueries(size_t maxQueries)
+{
+  ASSERT_GREATER(maxQueries, 0, ());
+  lock_guard<mutex> lock(m_poolMutex);
+  m_maxPoolQueries = maxQueries;
+  m_poolCondition.notify_all();
+}
+
+unique_ptr<Query> Engine::AcquireQuery(uint64_t & generation)
+{
+  unique_ptr<Query> query;
+  {
+    unique_lock<mutex> lock(m_poolMutex);
+    m_poolCondition.wait(lock, [this]()
+    {
+      return !m_freeQueries.empty() || m_numPoolQueries < m_maxPoolQueries;
+    });
+    generation = m_poolGeneration;
+
+    if (!m_freeQueries.empty())
+    {
+      query = move(m_freeQueries.back());
+      m_freeQueries.pop_back();
+    }
+    else
+    {
+      ++m_numPoolQueries;
+    }
+  }
+
+  if (!query)
+  {
+    query = m_factory->BuildSearchQuery(m_index, m_data->m_categories, m_data->m_suggests,
+                                        m_infoGetter);
+    query->SetPreferredLocale(m_locale);
+  }
+
+  query->SupportOldFormat(m_supportOldFormat);
+  query->AllowTypos(m_allowTypos);
+  return query;
+}
+
+void Engine::ReleaseQuery(unique_ptr<Query> && query, uint64_t generation)
+{
+  lock_guard<mutex> lock(m_poolMutex);
+  if (m_numPoolQueries > m_maxPoolQueries)
+  {
+    --m_numPoolQueries;
+  }
+  else
+  {
+    // Caches were cleared while the query was busy.
+    if (generation != m_poolGeneration)
+      query->ClearCaches();
+    m_freeQueries.push_back(move(query));
+  }
+  m_poolCondition.notify_one();
+}
+
+void Engine::SetSearchThreadsCount(size_t threadsCount)
+{
+  threads::MutexGuard guard(m_searchMutex);
+  m_query->SetSearchThreadsCount(threadsCount);
+}
+
 void Engine::PrepareSearch(m2::RectD const & viewport)
 {
   // bind does copy of all rects
@@ -160,7 +256,7 @@ void Engine::EmitResults(SearchParams const & params, Results & res)
   params.m_callback(res);
 }
 
-void Engine::SetRankPivot(SearchParams const & params,
+void Engine::SetRankPivot(Query & query, SearchParams const & params,
                           m2::RectD const & viewport, bool viewportSearch)
 {
   if (!viewportSearch && params.IsValidPosition())
@@ -168,12 +264,12 @@ void Engine::SetRankPivot(SearchParams const & params,
     m2::PointD const pos = MercatorBounds::FromLatLon(params.m_lat, params.m_lon);
     if (m2::Inflate(viewport, viewport.SizeX() / 4.0, viewport.SizeY() / 4.0).IsPointInside(pos))
     {
-      m_query->SetRankPivot(pos);
+      query.SetRankPivot(pos);
       return;
     }
   }
 
-  m_query->SetRankPivot(viewport.Center());
+  query.SetRankPivot(viewport.Center());
 }
 
 void Engine::SearchAsync()
@@ -204,27 +300,67 @@ void Engine::SearchAsync()
       viewport = m_viewport;
   }
 
+  // Initialize query.
+  m_query->Init(params.HasSearchMode(SearchParams::IN_VIEWPORT_ONLY));
+
+  DoSearch(*m_query, params, viewport, oneTimeSearch);
+}
+
+void Engine::SearchConcurrently(SearchParams const & params, m2::RectD const & viewport)
+{
+  m2::RectD searchRect;
+  bool const oneTimeSearch = params.GetSearchRect(searchRect);
+
+  uint64_t generation;
+  unique_ptr<Query> query = AcquireQuery(generation);
+  MY_SCOPE_GUARD(releaseQuery, [&]()
+  {
+    ReleaseQuery(move(query), generation);
+  });
+
+  query->Init(params.HasSearchMode(SearchParams::IN_VIEWPORT_ONLY));
+  DoSearch(*query, params, oneTimeSearch ? searchRect : viewport, oneTimeSearch);
+}
+
+void Engine::DoSearch(Query & query, SearchParams const & params, m2::RectD viewport,
+                      bool oneTimeSearch)
+{
   bool const viewportSearch = params.HasSearchMode(SearchParams::IN_VIEWPORT_ONLY);
 
-  // Initialize query.
-  m_query->Init(viewportSearch);
+  // Results of viewport search are shown on the map, they're not cached.
+  shared_ptr<ResultsCache> const cache = viewportSearch ? nullptr : GetResultsCache();
+  ResultsCache::Key key;
+  uint64_t cacheGeneration = 0;
+  if (cache)
+  {
+    key = ResultsCache::MakeKey(params, viewport, query.AreTyposAllowed());
+    cacheGeneration = cache->GetGeneration();
 
-  SetRankPivot(params, viewport, viewportSearch);
+    Results res;
+    if (cache->Get(key, res))
+    {
+      EmitResults(params, res);
+      params.m_callback(Results::GetEndMarker(false /* isCancelled */));
+      return;
+    }
+  }
+
+  SetRankPivot(query, params, viewport, viewportSearch);
 
-  m_query->SetSearchInWorld(params.HasSearchMode(SearchParams::SEARCH_WORLD));
+  query.SetSearchInWorld(params.HasSearchMode(SearchParams::SEARCH_WORLD));
 
   // Language validity is checked inside
-  m_query->SetInputLocale(params.m_inputLocale);
+  query.SetInputLocale(params.m_inputLocale);
 
   ASSERT(!params.m_query.empty(), ());
-  m_query->SetQuery(params.m_query);
+  query.SetQuery(params.m_query);
 
   Results res;
 
-  // Call m_query->IsCancelled() everywhere it needed without storing
+  // Call query.IsCancelled() everywhere it needed without storing
   // return value.  This flag can be changed from another thread.
 
-  m_query->SearchCoordinates(params.m_query, res);
+  query.SearchCoordinates(params.m_query, res);
 
   try
   {
@@ -233,21 +369,21 @@ void Engine::SearchAsync()
 
     if (viewportSearch)
     {
-      m_query->SetViewport(viewport, true);
-      m_query->SearchViewportPoints(res);
+      query.SetViewport(viewport, true);
+      query.SearchViewportPoints(res);
 
       if (res.GetCount() > 0)
         EmitResults(params, res);
     }
     else
     {
-      while (!m_query->IsCancelled())
+      while (!query.IsCancelled())
       {
         bool const isInflated = GetInflatedViewport(viewport);
         size_t const oldCount = res.GetCount();
 
-        m_query->SetViewport(viewport, oneTimeSearch);
-        m_query->Search(res, RESULTS_COUNT);
+        query.SetViewport(viewport, oneTimeSearch);
+        query.Search(res, RESULTS_COUNT);
 
         size_t const newCount = res.GetCount();
         bool const exit = (oneTimeSearch || !isInflated || newCount >= RESULTS_COUNT);
@@ -266,11 +402,11 @@ void Engine::SearchAsync()
 
   // Make additional search in whole mwm when not enough results (only for non-empty query).
   size_t const count = res.GetCount();
-  if (!viewportSearch && !m_query->IsCancelled() && count < RESULTS_COUNT)
+  if (!viewportSearch && !query.IsCancelled() && count < RESULTS_COUNT)
   {
     try
     {
-      m_query->SearchAdditional(res, RESULTS_COUNT);
+      query.SearchAdditional(res, RESULTS_COUNT);
     }
     catch (Query::CancelException const &)
     {
@@ -281,8 +417,12 @@ void Engine::SearchAsync()
       EmitResults(params, res);
   }
 
+  // Results aren't stored if the cache was cleared during the search.
+  if (cache && !query.IsCancelled())
+    cache->Put(key, res, cacheGeneration);
+
   // Emit finish marker to client.
-  params.m_callback(Results::GetEndMarker(m_query->IsCancelled()));
+  params.m_callback(Results::GetEndMarker(query.IsCancelled()));
 }
 
 bool Engine::GetNameByType(uint32_t type, int8_t locale, string & name) const
@@ -306,9 +446,12 @@ bool Engine::GetNameByType(uint32_t type, int8_t locale, string & name) const
 
 void Engine::ClearViewportsCache()
 {
-  threads::MutexGuard guard(m_searchMutex);
+  {
+    threads::MutexGuard guard(m_searchMutex);
+    m_query->ClearCaches();
+  }
 
-  m_query->ClearCaches();
+  ClearPoolAndResultsCaches();
 }
 
 void Engine::ClearAllCaches()
@@ -323,6 +466,23 @@ void Engine::ClearAllCaches()
 
     m_searchMutex.Unlock();
   }
+
+  ClearPoolAndResultsCaches();
+}
+
+void Engine::ClearPoolAndResultsCaches()
+{
+  {
+    lock_guard<mutex> lock(m_poolMutex);
+    // Busy queries are cleared when they are released.
+    ++m_poolGeneration;
+    for (auto & query : m_freeQueries)
+      query->ClearCaches();
+  }
+
+  shared_ptr<ResultsCache> const cache = GetResultsCache();
+  if (cache)
+    cache->Clear();
 }
 
 }  // namespace search
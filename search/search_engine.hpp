@@ -2,6 +2,7 @@
 
 #include "params.hpp"
 #include "result.hpp"
+#include "results_cache.hpp"
 #include "search_query_factory.hpp"
 
 #include "geometry/rect2d.hpp"
@@ -11,9 +12,13 @@
 #include "base/mutex.hpp"
 
 #include "std/unique_ptr.hpp"
+#include "std/shared_ptr.hpp"
 #include "std/string.hpp"
 #include "std/function.hpp"
 #include "std/atomic.hpp"
+#include "std/condition_variable.hpp"
+#include "std/mutex.hpp"
+#include "std/vector.hpp"
 
 
 class Index;
@@ -39,10 +44,25 @@ public:
   ~Engine();
 
   void SupportOldFormat(bool b);
+  /// Allows typos in query tokens, see Query::AllowTypos.
+  void AllowTypos(bool b);
+  /// Sets number of threads used to search maps concurrently, 1 means sequential search.
+  void SetSearchThreadsCount(size_t threadsCount);
+
+  /// Sets the cache of final results, it can be shared by several engines.
+  /// Null cache (default) disables caching.
+  void SetResultsCache(shared_ptr<ResultsCache> const & cache);
 
   void PrepareSearch(m2::RectD const & viewport);
   bool Search(SearchParams const & params, m2::RectD const & viewport);
 
+  /// Runs the search in the calling thread and passes results to params.m_callback
+  /// as Search() does, but doesn't cancel other searches. Searches run in parallel
+  /// on a pool of queries, calls over the pool size wait for a free query.
+  void SearchConcurrently(SearchParams const & params, m2::RectD const & viewport);
+  /// Sets the size of the pool of queries for SearchConcurrently(), 4 by default.
+  void SetMaxConcurrentQueries(size_t maxQueries);
+
   int8_t GetCurrentLanguage() const;
 
   bool GetNameByType(uint32_t type, int8_t lang, string & name) const;
@@ -53,13 +73,23 @@ public:
 private:
   static const int RESULTS_COUNT = 30;
 
-  void SetRankPivot(SearchParams const & params,
+  void SetRankPivot(Query & query, SearchParams const & params,
                     m2::RectD const & viewport, bool viewportSearch);
   void SetViewportAsync(m2::RectD const & viewport);
   void SearchAsync();
+  void DoSearch(Query & query, SearchParams const & params, m2::RectD viewport,
+                bool oneTimeSearch);
 
   void EmitResults(SearchParams const & params, Results & res);
 
+  /// Clears caches of the pooled queries and the results cache.
+  void ClearPoolAndResultsCaches();
+
+  /// @param generation Is set to the generation of the pool, which is passed to ReleaseQuery().
+  unique_ptr<Query> AcquireQuery(uint64_t & generation);
+  void ReleaseQuery(unique_ptr<Query> && query, uint64_t generation);
+  shared_ptr<ResultsCache> GetResultsCache();
+
   threads::Mutex m_searchMutex;
   threads::Mutex m_updateMutex;
   atomic_flag m_isReadyThread;
@@ -70,6 +100,26 @@ private:
   unique_ptr<Query> m_query;
   unique_ptr<SearchQueryFactory> m_factory;
   unique_ptr<EngineData> const m_data;
+
+  Index & m_index;
+  storage::CountryInfoGetter const & m_infoGetter;
+  string const m_locale;
+  atomic<bool> m_supportOldFormat;
+  atomic<bool> m_allowTypos;
+
+  /// Guarded by m_updateMutex.
+  shared_ptr<ResultsCache> m_resultsCache;
+
+  /// Pool of queries for SearchConcurrently(), guarded by m_poolMutex.
+  //@{
+  mutex m_poolMutex;
+  condition_variable m_poolCondition;
+  vector<unique_ptr<Query>> m_freeQueries;
+  size_t m_numPoolQueries;
+  size_t m_maxPoolQueries;
+  /// Number of the pool caches clearings.
+  uint64_t m_poolGeneration;
+  //@}
 };
 
 }  // namespace search
@@ -17,6 +17,8 @@
 #include "base/scope_guard.hpp"
 #include "base/string_utils.hpp"
 
+#include "std/algorithm.hpp"
+
 namespace
 {
 void InitParams(string const & query, search::SearchQueryParams & params)
@@ -84,7 +86,9 @@ private:
 };
 }  // namespace
 
-UNIT_TEST(Retrieval_Smoke)
+namespace
+{
+void TestRetrievalSmoke(bool buildSuccinctIndex)
 {
   classificator::Load();
   Platform & platform = GetPlatform();
@@ -97,7 +101,7 @@ UNIT_TEST(Retrieval_Smoke)
 
   // Create a test mwm with 100 whiskey bars.
   {
-    TestMwmBuilder builder(file);
+    TestMwmBuilder builder(file, buildSuccinctIndex);
     for (int x = 0; x < 10; ++x)
     {
       for (int y = 0; y < 10; ++y)
@@ -111,6 +115,10 @@ UNIT_TEST(Retrieval_Smoke)
   auto & id = p.first;
   TEST(id.IsAlive(), ());
   TEST_EQUAL(p.second, MwmSet::RegResult::Success, ());
+  {
+    MwmSet::MwmHandle const handle = index.GetMwmHandleById(id);
+    TEST_EQUAL(buildSuccinctIndex, handle.GetValue<MwmValue>()->m_searchTrie != nullptr, ());
+  }
 
   search::SearchQueryParams params;
   InitParams("whiskey bar", params);
@@ -161,8 +169,100 @@ UNIT_TEST(Retrieval_Smoke)
     TEST_EQUAL(callback.Offsets().size(), 8, ());
   }
 }
+}  // namespace
 
-UNIT_TEST(Retrieval_3Mwms)
+UNIT_TEST(Retrieval_Smoke)
+{
+  TestRetrievalSmoke(false /* buildSuccinctIndex */);
+}
+
+UNIT_TEST(Retrieval_Smoke_SuccinctIndex)
+{
+  TestRetrievalSmoke(true /* buildSuccinctIndex */);
+}
+
+UNIT_TEST(Retrieval_Typos)
+{
+  classificator::Load();
+  Platform & platform = GetPlatform();
+
+  // The same mwm with the classic search index only and with the succinct one too,
+  // the classic and the succinct tries are walked by different typo matchers.
+  platform::LocalCountryFile classic(platform.WritableDir(), platform::CountryFile("TyposTown"), 0);
+  platform::LocalCountryFile succinct(platform.WritableDir(),
+                                      platform::CountryFile("TyposTownSuccinct"), 0);
+  MY_SCOPE_GUARD(deleteFiles, [&]()
+  {
+    classic.DeleteFromDisk(MapOptions::Map);
+    succinct.DeleteFromDisk(MapOptions::Map);
+  });
+
+  for (auto * file : {&classic, &succinct})
+  {
+    TestMwmBuilder builder(*file, file == &succinct /* buildSuccinctIndex */);
+    builder.AddPOI(m2::PointD(0, 0), "Whiskey bar", "en");
+    builder.AddPOI(m2::PointD(1, 0), "Whisky bar", "en");
+    builder.AddPOI(m2::PointD(0, 1), "Vodka bar", "en");
+    builder.AddPOI(m2::PointD(1, 1), "Whiskey shop", "en");
+  }
+
+  Index classicIndex;
+  auto const classicP = classicIndex.RegisterMap(classic);
+  TEST_EQUAL(classicP.second, MwmSet::RegResult::Success, ());
+  Index succinctIndex;
+  auto const succinctP = succinctIndex.RegisterMap(succinct);
+  TEST_EQUAL(succinctP.second, MwmSet::RegResult::Success, ());
+
+  auto retrieve = [](Index & index, MwmSet::MwmId const & id,
+                     search::SearchQueryParams const & params)
+  {
+    vector<shared_ptr<MwmInfo>> infos;
+    index.GetMwmsInfo(infos);
+
+    TestCallback callback(id);
+    search::Retrieval retrieval;
+    retrieval.Init(index, infos, m2::RectD(m2::PointD(0, 0), m2::PointD(1, 1)), params,
+                   search::Retrieval::Limits());
+    retrieval.Go(callback);
+    sort(callback.Offsets().begin(), callback.Offsets().end());
+    return callback.Offsets();
+  };
+
+  // Both tries should match the same features.
+  auto count = [&](search::SearchQueryParams const & params)
+  {
+    vector<uint32_t> const offsets = retrieve(classicIndex, classicP.first, params);
+    TEST_EQUAL(offsets, retrieve(succinctIndex, succinctP.first, params), ());
+    return offsets.size();
+  };
+
+  search::SearchQueryParams params;
+  InitParams("wihskey bar", params);
+  TEST_EQUAL(0, count(params), ());
+
+  // "wihskey" is one transposition away from "whiskey" and two edits away from "whisky".
+  params.m_allowTypos = true;
+  TEST_EQUAL(1, count(params), ());
+
+  // Short tokens are matched exactly.
+  InitParams("whiskey bsr", params);
+  params.m_allowTypos = true;
+  TEST_EQUAL(0, count(params), ());
+
+  InitParams("whiskey", params);
+  params.m_prefixTokens.push_back(strings::MakeUniString("sjop"));
+  params.m_allowTypos = true;
+  TEST_EQUAL(1, count(params), ());
+
+  InitParams("", params);
+  params.m_prefixTokens.push_back(strings::MakeUniString("wisk"));
+  params.m_allowTypos = true;
+  TEST_EQUAL(3, count(params), ());
+}
+
+namespace
+{
+void TestRetrieval3Mwms(bool buildSuccinctIndex)
 {
   classificator::Load();
   Platform & platform = GetPlatform();
@@ -178,15 +278,15 @@ UNIT_TEST(Retrieval_3Mwms)
   });
 
   {
-    TestMwmBuilder builder(msk);
+    TestMwmBuilder builder(msk, buildSuccinctIndex);
     builder.AddPOI(m2::PointD(0, 0), "Cafe MTV", "en");
   }
   {
-    TestMwmBuilder builder(mtv);
+    TestMwmBuilder builder(mtv, buildSuccinctIndex);
     builder.AddPOI(m2::PointD(10, 0), "MTV", "en");
   }
   {
-    TestMwmBuilder builder(zrh);
+    TestMwmBuilder builder(zrh, buildSuccinctIndex);
     builder.AddPOI(m2::PointD(0, 10), "Bar MTV", "en");
   }
 
@@ -247,3 +347,14 @@ UNIT_TEST(Retrieval_3Mwms)
     TEST_EQUAL(3, callback.GetNumFeatures(), ());
   }
 }
+}  // namespace
+
+UNIT_TEST(Retrieval_3Mwms)
+{
+  TestRetrieval3Mwms(false /* buildSuccinctIndex */);
+}
+
+UNIT_TEST(Retrieval_3Mwms_SuccinctIndex)
+{
+  TestRetrieval3Mwms(true /* buildSuccinctIndex */);
+}
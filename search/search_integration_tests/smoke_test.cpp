@@ -13,6 +13,17 @@
 #include "platform/local_country_file_utils.hpp"
 #include "platform/platform.hpp"
 
+#include "search/params.hpp"
+#include "search/results_cache.hpp"
+
+#include "base/string_utils.hpp"
+
+#include "std/chrono.hpp"
+#include "std/shared_ptr.hpp"
+#include "std/thread.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
+
 namespace
 {
 class ScopedMapFile
@@ -130,3 +141,148 @@ UNIT_TEST(GenerateTestMwm_NotPrefixFreeNames)
     TEST_EQUAL(3, request.Results().size(), ());
   }
 }
+
+UNIT_TEST(GenerateTestMwm_ConcurrentSearch)
+{
+  classificator::Load();
+  ScopedMapFile scopedFile("BuzzCity");
+  platform::LocalCountryFile & file = scopedFile.GetFile();
+
+  {
+    TestMwmBuilder builder(file);
+    builder.AddPOI(m2::PointD(0, 0), "Wine shop", "en");
+    builder.AddPOI(m2::PointD(1, 0), "Tequila shop", "en");
+    builder.AddPOI(m2::PointD(0, 1), "Brandy shop", "en");
+    builder.AddPOI(m2::PointD(1, 1), "Russian vodka shop", "en");
+  }
+
+  TestSearchEngine engine("en" /* locale */);
+  auto ret = engine.RegisterMap(file);
+  TEST_EQUAL(MwmSet::RegResult::Success, ret.second, ("Can't register generated map."));
+
+  size_t const kThreadsCount = 8;
+  vector<size_t> counts(kThreadsCount);
+  vector<thread> threads;
+  for (size_t i = 0; i < kThreadsCount; ++i)
+  {
+    threads.emplace_back([&engine, &counts, i]()
+    {
+      search::SearchParams params;
+      params.m_query = (i % 2 == 0 ? "wine " : "shop ");
+      params.m_inputLocale = "en";
+      params.m_callback = [&counts, i](search::Results const & results)
+      {
+        counts[i] += results.GetCount();
+      };
+      params.SetSearchMode(search::SearchParams::IN_VIEWPORT_ONLY);
+      engine.SearchConcurrently(params, m2::RectD(m2::PointD(0, 0), m2::PointD(100, 100)));
+    });
+  }
+  for (auto & t : threads)
+    t.join();
+
+  for (size_t i = 0; i < kThreadsCount; ++i)
+    TEST_EQUAL(i % 2 == 0 ? 1 : 4, counts[i], (i));
+}
+
+UNIT_TEST(GenerateTestMwm_SearchThreadsCount)
+{
+  classificator::Load();
+
+  vector<unique_ptr<ScopedMapFile>> files;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    files.emplace_back(new ScopedMapFile("BuzzTown" + strings::to_string(i)));
+    TestMwmBuilder builder(files.back()->GetFile());
+    for (size_t j = 0; j < 10; ++j)
+    {
+      m2::PointD const p(i * 2 + (j % 3) * 0.1, (j / 3) * 0.1);
+      builder.AddPOI(p, "Cafe " + strings::to_string(j), "en");
+      builder.AddPOI(p + m2::PointD(0.01, 0.01), "Cafe shop " + strings::to_string(i), "en");
+    }
+  }
+
+  // Engine skips the same query in the same viewport, so each threads count has its own engine.
+  TestSearchEngine sequentialEngine("en" /* locale */);
+  TestSearchEngine concurrentEngine("en" /* locale */);
+  concurrentEngine.SetSearchThreadsCount(4);
+  for (auto const & file : files)
+  {
+    auto ret = sequentialEngine.RegisterMap(file->GetFile());
+    TEST_EQUAL(MwmSet::RegResult::Success, ret.second, ("Can't register generated map."));
+    ret = concurrentEngine.RegisterMap(file->GetFile());
+    TEST_EQUAL(MwmSet::RegResult::Success, ret.second, ("Can't register generated map."));
+  }
+
+  m2::RectD const viewport(m2::PointD(0, 0), m2::PointD(100, 100));
+  auto search = [&viewport](TestSearchEngine & engine, string const & query)
+  {
+    TestSearchRequest request(engine, query, "en", viewport);
+    request.Wait();
+    return request.Results();
+  };
+
+  char const * queries[] = {"cafe ", "cafe", "shop ", "cafe 5 ", "cafe shop 3 "};
+  for (char const * query : queries)
+  {
+    vector<search::Result> const expected = search(sequentialEngine, query);
+    TEST(!expected.empty(), (query));
+    vector<search::Result> const actual = search(concurrentEngine, query);
+
+    // Results don't depend on the threads count, including their order.
+    TEST_EQUAL(expected.size(), actual.size(), (query));
+    for (size_t i = 0; i < min(expected.size(), actual.size()); ++i)
+    {
+      TEST_EQUAL(string(expected[i].GetString()), string(actual[i].GetString()), (query, i));
+      TEST_EQUAL(expected[i].GetFeatureCenter(), actual[i].GetFeatureCenter(), (query, i));
+    }
+  }
+}
+
+UNIT_TEST(GenerateTestMwm_ResultsCache)
+{
+  classificator::Load();
+  ScopedMapFile scopedFile("BuzzVillage");
+  platform::LocalCountryFile & file = scopedFile.GetFile();
+
+  {
+    TestMwmBuilder builder(file);
+    builder.AddPOI(m2::PointD(0, 0), "Wine shop", "en");
+    builder.AddPOI(m2::PointD(1, 0), "Tequila shop", "en");
+  }
+
+  TestSearchEngine engine("en" /* locale */);
+  auto ret = engine.RegisterMap(file);
+  TEST_EQUAL(MwmSet::RegResult::Success, ret.second, ("Can't register generated map."));
+
+  auto cache = make_shared<search::ResultsCache>(1 << 20, seconds(100));
+  engine.SetResultsCache(cache);
+
+  m2::RectD const viewport(m2::PointD(0, 0), m2::PointD(1, 1));
+  search::SearchParams params;
+  params.m_query = "shop ";
+  params.m_inputLocale = "en";
+  params.SetSearchMode(search::SearchParams::SEARCH_ADDRESS);
+
+  auto search = [&]()
+  {
+    size_t count = 0;
+    params.m_callback = [&count](search::Results const & results)
+    {
+      if (!results.IsEndMarker())
+        count = results.GetCount();
+    };
+    engine.SearchConcurrently(params, viewport);
+    return count;
+  };
+
+  TEST_EQUAL(2, search(), ());
+
+  search::Results results;
+  TEST(cache->Get(search::ResultsCache::MakeKey(params, viewport, false /* allowTypos */), results), ());
+  TEST_EQUAL(2, results.GetCount(), ());
+
+  // The second search is answered from the cache.
+  cache->Put(search::ResultsCache::MakeKey(params, viewport, false /* allowTypos */), search::Results());
+  TEST_EQUAL(0, search(), ());
+}
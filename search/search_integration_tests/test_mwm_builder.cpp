@@ -15,11 +15,12 @@
 
 #include "defines.hpp"
 
-TestMwmBuilder::TestMwmBuilder(platform::LocalCountryFile & file)
+TestMwmBuilder::TestMwmBuilder(platform::LocalCountryFile & file, bool buildSuccinctIndex)
     : m_file(file),
       m_collector(
           make_unique<feature::FeaturesCollector>(file.GetPath(MapOptions::Map) + EXTENSION_TMP)),
-      m_classificator(classif())
+      m_classificator(classif()),
+      m_buildSuccinctIndex(buildSuccinctIndex)
 {
 }
 
@@ -54,7 +55,8 @@ void TestMwmBuilder::Finish()
                                        m_file.GetPath(MapOptions::Map)),
         ("Can't build geometry index."));
   CHECK(indexer::BuildSearchIndexFromDatFile(m_file.GetPath(MapOptions::Map),
-                                             true /* forceRebuild */),
+                                             true /* forceRebuild */, 1 /* threadsCount */,
+                                             m_buildSuccinctIndex),
         ("Can't build search index."));
   m_file.SyncWithDisk();
 }
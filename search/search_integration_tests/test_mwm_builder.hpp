@@ -19,7 +19,9 @@ class LocalCountryFile;
 class TestMwmBuilder
 {
 public:
-  TestMwmBuilder(platform::LocalCountryFile & file);
+  /// @param buildSuccinctIndex Whether to add the succinct search index section besides
+  ///                           the classic one, see indexer::BuildSearchIndexFromDatFile().
+  TestMwmBuilder(platform::LocalCountryFile & file, bool buildSuccinctIndex = false);
 
   ~TestMwmBuilder();
 
@@ -31,4 +33,5 @@ private:
   platform::LocalCountryFile & m_file;
   unique_ptr<feature::FeaturesCollector> m_collector;
   Classificator const & m_classificator;
+  bool const m_buildSuccinctIndex;
 };
@@ -52,3 +52,19 @@ bool TestSearchEngine::Search(search::SearchParams const & params, m2::RectD con
 {
   return m_engine.Search(params, viewport);
 }
+
+void TestSearchEngine::SearchConcurrently(search::SearchParams const & params,
+                                          m2::RectD const & viewport)
+{
+  m_engine.SearchConcurrently(params, viewport);
+}
+
+void TestSearchEngine::SetResultsCache(shared_ptr<search::ResultsCache> const & cache)
+{
+  m_engine.SetResultsCache(cache);
+}
+
+void TestSearchEngine::SetSearchThreadsCount(size_t threadsCount)
+{
+  m_engine.SetSearchThreadsCount(threadsCount);
+}
@@ -23,6 +23,9 @@ public:
   TestSearchEngine(std::string const & locale);
 
   bool Search(search::SearchParams const & params, m2::RectD const & viewport);
+  void SearchConcurrently(search::SearchParams const & params, m2::RectD const & viewport);
+  void SetResultsCache(shared_ptr<search::ResultsCache> const & cache);
+  void SetSearchThreadsCount(size_t threadsCount);
 
 private:
   Platform & m_platform;
@@ -23,7 +23,6 @@
 #include "platform/preferred_languages.hpp"
 
 #include "coding/multilang_utf8_string.hpp"
-#include "coding/reader_wrapper.hpp"
 
 #include "base/logging.hpp"
 #include "base/stl_add.hpp"
@@ -81,6 +80,7 @@ Query::Query(Index & index, CategoriesHolder const & categories, vector<Suggest>
   , m_locality(&index)
 #endif
   , m_worldSearch(true)
+  , m_allowTypos(false)
 {
   // m_viewport is initialized as empty rects
 
@@ -954,7 +954,7 @@ void Query::ProcessSuggestions(vector<T> & vec, Results & res) const
 }
 
 void Query::AddResultFromTrie(TTrieValue const & val, MwmSet::MwmId const & mwmID,
-                              ViewportID vID /*= DEFAULT_V*/)
+                              ViewportID vID /*= DEFAULT_V*/, TQueue * results /*= nullptr*/)
 {
   // If we are in viewport search mode, check actual "point-in-viewport" criteria.
   if (m_queuesCount == 1 && !m_viewport[CURRENT_V].IsPointInside(val.m_pt))
@@ -962,12 +962,19 @@ void Query::AddResultFromTrie(TTrieValue const & val, MwmSet::MwmId const & mwmI
 
   impl::PreResult1 res(FeatureID(mwmID, val.m_featureId), val.m_rank,
                        val.m_pt, GetPosition(vID), vID);
+  AddPreResult1(res, results);
+}
+
+void Query::AddPreResult1(impl::PreResult1 const & res, TQueue * results)
+{
+  if (results == nullptr)
+    results = m_results;
 
   for (size_t i = 0; i < m_queuesCount; ++i)
   {
     // here can be the duplicates because of different language match (for suggest token)
-    if (m_results[i].end() == find_if(m_results[i].begin(), m_results[i].end(), EqualFeatureID(res)))
-      m_results[i].push(res);
+    if (results[i].end() == find_if(results[i].begin(), results[i].end(), EqualFeatureID(res)))
+      results[i].push(res);
   }
 }
 
@@ -1283,6 +1290,8 @@ void Query::InitParams(bool localitySearch, SearchQueryParams & params)
 
   for (int i = 0; i < LANG_COUNT; ++i)
     params.m_langs.insert(GetLanguage(i));
+
+  params.m_allowTypos = m_allowTypos;
 }
 
 namespace impl
@@ -1762,14 +1771,9 @@ void Query::SearchLocality(MwmValue const * pMwm, impl::Locality & res1, impl::R
   InitParams(true /* localitySearch */, params);
 
   serial::CodingParams cp(trie::GetCodingParams(pMwm->GetHeader().GetDefCodingParams()));
+  SearchTrieRoot const trieRoot(*pMwm, cp);
 
-  ModelReaderPtr searchReader = pMwm->m_cont.GetReader(SEARCH_INDEX_FILE_TAG);
-
-  unique_ptr<trie::DefaultIterator> const trieRoot(
-      trie::ReadTrie(SubReaderWrapper<Reader>(searchReader.GetPtr()), trie::ValueReader(cp),
-                     trie::TEdgeValueReader()));
-
-  ForEachLangPrefix(params, *trieRoot, [&](TrieRootPrefix & langRoot, int8_t lang)
+  ForEachLangPrefix(params, trieRoot, [&](TrieRootPrefix & langRoot, int8_t lang)
   {
     impl::DoFindLocality doFind(*this, pMwm, lang);
     MatchTokensInTrie(params.m_tokens, langRoot, doFind);
@@ -1850,6 +1854,12 @@ namespace
 void Query::SearchFeatures(SearchQueryParams const & params, TMWMVector const & mwmsInfo,
                            ViewportID vID)
 {
+  if (m_searchPool)
+  {
+    SearchFeaturesConcurrently(params, mwmsInfo, vID);
+    return;
+  }
+
   for (shared_ptr<MwmInfo> const & info : mwmsInfo)
   {
     // Search only mwms that intersect with viewport (world always does).
@@ -1858,8 +1868,55 @@ void Query::SearchFeatures(SearchQueryParams const & params, TMWMVector const &
   }
 }
 
+void Query::SearchFeaturesConcurrently(SearchQueryParams const & params,
+                                       TMWMVector const & mwmsInfo, ViewportID vID)
+{
+  vector<Index::MwmHandle> handles;
+  for (shared_ptr<MwmInfo> const & info : mwmsInfo)
+  {
+    // Search only mwms that intersect with viewport (world always does).
+    if (m_viewport[vID].IsIntersect(info->m_limitRect))
+      handles.push_back(m_index.GetMwmHandleById(info));
+  }
+  if (handles.empty())
+    return;
+
+  // Every map is searched into its own queues, so workers don't share any
+  // mutable state. Queues are merged in the order of maps, which makes results
+  // the same as for the sequential search.
+  vector<TQueue> results(handles.size() * m_queuesCount);
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    results[i] = m_results[i % m_queuesCount];
+    results[i].clear();
+  }
+
+  m_searchPool->ForEach(handles.size(), [&](size_t i)
+  {
+    SearchInMWM(handles[i], params, vID, &results[i * m_queuesCount]);
+  });
+
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    for (impl::PreResult1 const & res : results[i])
+    {
+      TQueue & queue = m_results[i % m_queuesCount];
+      if (queue.end() == find_if(queue.begin(), queue.end(), EqualFeatureID(res)))
+        queue.push(res);
+    }
+  }
+}
+
+void Query::SetSearchThreadsCount(size_t threadsCount)
+{
+  if (threadsCount > 1)
+    m_searchPool.reset(new threads::WorkStealingPool(threadsCount));
+  else
+    m_searchPool.reset();
+}
+
 void Query::SearchInMWM(Index::MwmHandle const & mwmHandle, SearchQueryParams const & params,
-                        ViewportID viewportId /*= DEFAULT_V*/)
+                        ViewportID viewportId /*= DEFAULT_V*/, TQueue * results /*= nullptr*/)
 {
   MwmValue const * const value = mwmHandle.GetValue<MwmValue>();
   if (!value || !value->m_cont.IsExist(SEARCH_INDEX_FILE_TAG))
@@ -1872,16 +1929,21 @@ void Query::SearchInMWM(Index::MwmHandle const & mwmHandle, SearchQueryParams co
     return;
 
   serial::CodingParams cp(trie::GetCodingParams(header.GetDefCodingParams()));
-  ModelReaderPtr searchReader = value->m_cont.GetReader(SEARCH_INDEX_FILE_TAG);
-  unique_ptr<trie::DefaultIterator> const trieRoot(
-      trie::ReadTrie(SubReaderWrapper<Reader>(searchReader.GetPtr()), trie::ValueReader(cp),
-                     trie::TEdgeValueReader()));
+  SearchTrieRoot const trieRoot(*value, cp);
   MwmSet::MwmId const mwmId = mwmHandle.GetId();
-  FeaturesFilter filter(
-      (viewportId == DEFAULT_V || isWorld) ? 0 : &m_offsetsInViewport[viewportId][mwmId], *this);
-  MatchFeaturesInTrie(params, *trieRoot, filter, [&](TTrieValue const & value)
+
+  // Offsets are looked up without insertion, since maps may be searched concurrently.
+  vector<uint32_t> const * offsets = nullptr;
+  if (viewportId != DEFAULT_V && !isWorld)
+  {
+    static vector<uint32_t> const kEmptyOffsets;
+    auto const it = m_offsetsInViewport[viewportId].find(mwmId);
+    offsets = (it == m_offsetsInViewport[viewportId].end() ? &kEmptyOffsets : &it->second);
+  }
+  FeaturesFilter filter(offsets, *this);
+  MatchFeaturesInTrie(params, trieRoot, filter, [&](TTrieValue const & value)
   {
-    AddResultFromTrie(value, mwmId, viewportId);
+    AddResultFromTrie(value, mwmId, viewportId, results);
   });
 }
 
@@ -13,9 +13,11 @@
 #include "base/cancellable.hpp"
 #include "base/limited_priority_queue.hpp"
 #include "base/string_utils.hpp"
+#include "base/work_stealing_pool.hpp"
 
 #include "std/map.hpp"
 #include "std/string.hpp"
+#include "std/unique_ptr.hpp"
 #include "std/unordered_set.hpp"
 #include "std/vector.hpp"
 
@@ -60,6 +62,13 @@ public:
         storage::CountryInfoGetter const & infoGetter);
 
   inline void SupportOldFormat(bool b) { m_supportOldFormat = b; }
+  /// Allows typos in tokens of the features search.
+  inline void AllowTypos(bool b) { m_allowTypos = b; }
+  inline bool AreTyposAllowed() const { return m_allowTypos; }
+
+  /// Maps are searched concurrently on threadsCount threads, when it's greater than 1.
+  /// Results don't depend on the threads count.
+  void SetSearchThreadsCount(size_t threadsCount);
 
   void Init(bool viewportSearch);
 
@@ -121,6 +130,25 @@ private:
   using TOffsetsVector = map<MwmSet::MwmId, vector<uint32_t>>;
   using TFHeader = feature::DataHeader;
 
+  template <class TParam>
+  class TCompare
+  {
+    using TFunction = function<bool(TParam const &, TParam const &)>;
+    TFunction m_fn;
+
+  public:
+    TCompare() : m_fn(0) {}
+    explicit TCompare(TFunction const & fn) : m_fn(fn) {}
+
+    template <class T> bool operator() (T const & v1, T const & v2) const
+    {
+      return m_fn(v1, v2);
+    }
+  };
+
+  using TQueueCompare = TCompare<impl::PreResult1>;
+  using TQueue = my::limited_priority_queue<impl::PreResult1, TQueueCompare>;
+
   void SetViewportByIndex(TMWMVector const & mwmsInfo, m2::RectD const & viewport, size_t idx,
                           bool forceUpdate);
   void UpdateViewportOffsets(TMWMVector const & mwmsInfo, m2::RectD const & rect,
@@ -135,8 +163,10 @@ private:
     COUNT_V = 2     // Should always be the last
   };
 
+  /// @param results Queues for the result, m_results if nullptr.
   void AddResultFromTrie(TTrieValue const & val, MwmSet::MwmId const & mwmID,
-                         ViewportID vID = DEFAULT_V);
+                         ViewportID vID = DEFAULT_V, TQueue * results = nullptr);
+  void AddPreResult1(impl::PreResult1 const & res, TQueue * results);
 
   template <class T> void MakePreResult2(vector<T> & cont, vector<FeatureID> & streets);
   void FlushHouses(Results & res, bool allMWMs, vector<FeatureID> const & streets);
@@ -164,8 +194,12 @@ private:
   void SearchFeatures(SearchQueryParams const & params, TMWMVector const & mwmsInfo,
                       ViewportID vID);
   /// Do search in particular map (mwmHandle).
+  /// @param results Queues for the results, m_results if nullptr.
   void SearchInMWM(Index::MwmHandle const & mwmHandle, SearchQueryParams const & params,
-                   ViewportID viewportId = DEFAULT_V);
+                   ViewportID viewportId = DEFAULT_V, TQueue * results = nullptr);
+  /// Do search in maps from mwmsInfo on m_searchPool threads.
+  void SearchFeaturesConcurrently(SearchQueryParams const & params, TMWMVector const & mwmsInfo,
+                                  ViewportID vID);
   //@}
 
   void SuggestStrings(Results & res);
@@ -216,25 +250,7 @@ private:
 
   TOffsetsVector m_offsetsInViewport[COUNT_V];
   bool m_supportOldFormat;
-
-  template <class TParam>
-  class TCompare
-  {
-    using TFunction = function<bool(TParam const &, TParam const &)>;
-    TFunction m_fn;
-
-  public:
-    TCompare() : m_fn(0) {}
-    explicit TCompare(TFunction const & fn) : m_fn(fn) {}
-
-    template <class T> bool operator() (T const & v1, T const & v2) const
-    {
-      return m_fn(v1, v2);
-    }
-  };
-
-  using TQueueCompare = TCompare<impl::PreResult1>;
-  using TQueue = my::limited_priority_queue<impl::PreResult1, TQueueCompare>;
+  bool m_allowTypos;
 
   /// @name Intermediate result queues sorted by different criterias.
   //@{
@@ -255,6 +271,8 @@ private:
   TQueue m_results[kQueuesCount];
   size_t m_queuesCount;
   //@}
+
+  unique_ptr<threads::WorkStealingPool> m_searchPool;
 };
 
 }  // namespace search
@@ -57,7 +57,7 @@ private:
 };
 }  // namespace
 
-SearchQueryParams::SearchQueryParams() : m_scale(scales::GetUpperScale()) {}
+SearchQueryParams::SearchQueryParams() : m_scale(scales::GetUpperScale()), m_allowTypos(false) {}
 
 void SearchQueryParams::Clear()
 {
@@ -65,6 +65,7 @@ void SearchQueryParams::Clear()
   m_prefixTokens.clear();
   m_langs.clear();
   m_scale = scales::GetUpperScale();
+  m_allowTypos = false;
 }
 
 void SearchQueryParams::EraseTokens(vector<size_t> & eraseInds)
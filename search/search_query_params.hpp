@@ -18,6 +18,8 @@ struct SearchQueryParams
   TSynonymsVector m_prefixTokens;
   TLangsSet m_langs;
   int m_scale;
+  /// Match tokens with typos (see GetMaxErrorsForToken), it's much slower.
+  bool m_allowTypos;
 
   SearchQueryParams();
 
@@ -1,11 +1,13 @@
 #include "testing/testing.hpp"
 
 #include "search/house_detector.hpp"
+#include "search/projection_on_street.hpp"
 
 #include "indexer/classificator_loader.hpp"
 #include "indexer/data_header.hpp"
 #include "indexer/ftypes_matcher.hpp"
 #include "indexer/index.hpp"
+#include "indexer/mercator.hpp"
 #include "indexer/scales.hpp"
 
 #include "platform/platform.hpp"
@@ -19,6 +21,9 @@
 
 #include "std/iostream.hpp"
 #include "std/fstream.hpp"
+#include "std/map.hpp"
+#include "std/numeric.hpp"
+#include "std/random.hpp"
 
 
 using platform::LocalCountryFile;
@@ -490,3 +495,111 @@ UNIT_TEST(HS_MWMSearch)
   LOG(LINFO, ("Matched =", matched, "Not matched =", notMatched, "Not found =", all - matched - notMatched));
   LOG(LINFO, ("All count =", all, "Percent matched =", matched / double(all)));
 }
+
+namespace
+{
+/// Projections of the point to every section of every street, which are in the distance limit.
+map<search::Street const *, search::HouseProjection> ProjectToAllSections(
+    vector<search::Street *> const & streets, m2::PointD const & pt, double distanceMeters)
+{
+  map<search::Street const *, search::HouseProjection> res;
+  for (search::Street const * st : streets)
+  {
+    search::ProjectionCalcToStreet calc(st, distanceMeters);
+    vector<size_t> sections(calc.GetSectionsCount());
+    iota(sections.begin(), sections.end(), 0);
+
+    search::HouseProjection proj;
+    if (calc.GetProjection(pt, sections.begin(), sections.end(), proj))
+      res[st] = proj;
+  }
+  return res;
+}
+
+map<search::Street const *, search::HouseProjection> ProjectThroughGrid(
+    search::ProjectionCalcToMergedStreet & calc, m2::PointD const & pt)
+{
+  map<search::Street const *, search::HouseProjection> res;
+  calc.ForEachProjection(pt, [&res](search::Street * st, search::HouseProjection const & proj)
+  {
+    TEST(res.insert(make_pair(st, proj)).second, ("Street is passed twice."));
+  });
+  return res;
+}
+
+void TestSameProjections(map<search::Street const *, search::HouseProjection> const & expected,
+                         map<search::Street const *, search::HouseProjection> const & actual,
+                         m2::PointD const & pt)
+{
+  TEST_EQUAL(expected.size(), actual.size(), (pt));
+  for (auto const & p : expected)
+  {
+    auto const it = actual.find(p.first);
+    TEST(it != actual.end(), (pt, p.first->GetName()));
+    TEST_EQUAL(p.second.m_proj, it->second.m_proj, (pt));
+    TEST_EQUAL(p.second.m_distance, it->second.m_distance, (pt));
+    TEST_EQUAL(p.second.m_streetDistance, it->second.m_streetDistance, (pt));
+    TEST_EQUAL(p.second.m_projectionSign, it->second.m_projectionSign, (pt));
+  }
+}
+}  // namespace
+
+UNIT_TEST(HS_ProjectionToMergedStreet)
+{
+  double const kDistanceMeters = 50.0;
+  m2::PointD const origin = MercatorBounds::FromLatLon(53.9, 27.55);
+  auto const makePoint = [&origin](double eastMeters, double northMeters)
+  {
+    return MercatorBounds::GetSmPoint(origin, eastMeters, northMeters);
+  };
+
+  // Zig-zag street to the east, the second street overlaps its eastern half
+  // at 60 meters to the north, the third one crosses both of them.
+  search::Street first, second, third;
+  first.SetName("First");
+  second.SetName("Second");
+  third.SetName("Third");
+  for (int i = 0; i <= 40; ++i)
+    first.m_points.push_back(makePoint(50.0 * i, (i % 2 == 0) ? 0.0 : 10.0));
+  for (int i = 0; i <= 20; ++i)
+    second.m_points.push_back(makePoint(1000.0 + 60.0 * i, 60.0 + 5.0 * (i % 3)));
+  for (int i = 0; i <= 10; ++i)
+    third.m_points.push_back(makePoint(1500.0 - 20.0 * i, -200.0 + 50.0 * i));
+
+  vector<search::Street *> const streets = {&first, &second, &third};
+  search::ProjectionCalcToMergedStreet calc(streets, kDistanceMeters);
+
+  // The house between overlapping streets is projected to both of them.
+  m2::PointD const between = makePoint(1230.0, 30.0);
+  auto const betweenProjections = ProjectThroughGrid(calc, between);
+  TEST_EQUAL(betweenProjections.size(), 2, ());
+  TEST_EQUAL(betweenProjections.count(&first), 1, ());
+  TEST_EQUAL(betweenProjections.count(&second), 1, ());
+  TestSameProjections(ProjectToAllSections(streets, between, kDistanceMeters),
+                      betweenProjections, between);
+
+  // The house is only in the rect of the second street, so it's read through
+  // the rect of the neighbouring street, and it's projected to that street only.
+  m2::PointD const north = makePoint(1900.0, 100.0);
+  TEST(!first.GetLimitRect(kDistanceMeters).IsPointInside(north), ());
+  TEST(second.GetLimitRect(kDistanceMeters).IsPointInside(north), ());
+  auto const northProjections = ProjectThroughGrid(calc, north);
+  TEST_EQUAL(northProjections.size(), 1, ());
+  TEST_EQUAL(northProjections.count(&second), 1, ());
+  TestSameProjections(ProjectToAllSections(streets, north, kDistanceMeters), northProjections,
+                      north);
+
+  // Random houses around all the streets.
+  mt19937 rng(0);
+  uniform_real_distribution<double> eastDist(-100.0, 2400.0);
+  uniform_real_distribution<double> northDist(-250.0, 350.0);
+  size_t projected = 0;
+  for (size_t i = 0; i < 10000; ++i)
+  {
+    m2::PointD const pt = makePoint(eastDist(rng), northDist(rng));
+    auto const expected = ProjectToAllSections(streets, pt, kDistanceMeters);
+    TestSameProjections(expected, ProjectThroughGrid(calc, pt), pt);
+    projected += expected.size();
+  }
+  TEST_GREATER(projected, 1000, ());
+}
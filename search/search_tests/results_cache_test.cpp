@@ -0,0 +1,138 @@
+#include "testing/testing.hpp"
+
+#include "search/params.hpp"
+#include "search/results_cache.hpp"
+
+#include "base/string_utils.hpp"
+
+#include "std/thread.hpp"
+#include "std/vector.hpp"
+
+using namespace search;
+
+namespace
+{
+m2::RectD const kViewport(m2::PointD(10, 10), m2::PointD(11, 11));
+
+Results MakeResults(string const & name, size_t count)
+{
+  Results results;
+  for (size_t i = 0; i < count; ++i)
+    results.AddResultNoChecks(Result(name + strings::to_string(i), name));
+  return results;
+}
+
+ResultsCache::Key MakeKey(string const & query, m2::RectD const & viewport = kViewport,
+                          bool allowTypos = false)
+{
+  SearchParams params;
+  params.m_query = query;
+  params.m_inputLocale = "en";
+  return ResultsCache::MakeKey(params, viewport, allowTypos);
+}
+}  // namespace
+
+UNIT_TEST(ResultsCache_Smoke)
+{
+  ResultsCache cache(1 << 20, seconds(100));
+
+  Results results;
+  TEST(!cache.Get(MakeKey("cafe"), results), ());
+
+  cache.Put(MakeKey("cafe"), MakeResults("cafe", 3));
+  TEST(cache.Get(MakeKey("cafe"), results), ());
+  TEST_EQUAL(3, results.GetCount(), ());
+  TEST_EQUAL(string("cafe2"), results.GetResult(2).GetString(), ());
+
+  // The query is normalized.
+  TEST(cache.Get(MakeKey("Cafe"), results), ());
+
+  // Close viewports share results, far ones don't.
+  TEST(cache.Get(MakeKey("cafe", m2::Offset(kViewport, m2::PointD(0.01, 0.01))), results), ());
+  TEST(!cache.Get(MakeKey("cafe", m2::Offset(kViewport, m2::PointD(5, 5))), results), ());
+  TEST(!cache.Get(MakeKey("cafe", m2::Inflate(kViewport, m2::PointD(10, 10))), results), ());
+
+  // The last token is a prefix unless it's followed by a space.
+  TEST(!cache.Get(MakeKey("cafe "), results), ());
+
+  // Results with typos are different.
+  TEST(!cache.Get(MakeKey("cafe", kViewport, true /* allowTypos */), results), ());
+
+  cache.Clear();
+  TEST(!cache.Get(MakeKey("cafe"), results), ());
+}
+
+UNIT_TEST(ResultsCache_ClearDuringSearch)
+{
+  ResultsCache cache(1 << 20, seconds(100));
+
+  // Results of a search, which started before Clear(), are dropped.
+  uint64_t const generation = cache.GetGeneration();
+  cache.Clear();
+  cache.Put(MakeKey("cafe"), MakeResults("cafe", 3), generation);
+  Results results;
+  TEST(!cache.Get(MakeKey("cafe"), results), ());
+
+  cache.Put(MakeKey("cafe"), MakeResults("cafe", 3), cache.GetGeneration());
+  TEST(cache.Get(MakeKey("cafe"), results), ());
+}
+
+UNIT_TEST(ResultsCache_Expiration)
+{
+  ResultsCache cache(1 << 20, milliseconds(0));
+  cache.Put(MakeKey("cafe"), MakeResults("cafe", 3));
+
+  Results results;
+  TEST(!cache.Get(MakeKey("cafe"), results), ());
+}
+
+UNIT_TEST(ResultsCache_MemoryLimit)
+{
+  ResultsCache cache(1 << 16, seconds(100));
+
+  // Too big results are not cached at all.
+  cache.Put(MakeKey("big"), MakeResults("big", 1000));
+  Results results;
+  TEST(!cache.Get(MakeKey("big"), results), ());
+
+  size_t const kQueries = 1000;
+  for (size_t i = 0; i < kQueries; ++i)
+    cache.Put(MakeKey(strings::to_string(i)), MakeResults("cafe", 3));
+
+  // Only the most recently used queries are kept.
+  size_t numCached = 0;
+  for (size_t i = 0; i < kQueries; ++i)
+  {
+    if (cache.Get(MakeKey(strings::to_string(i)), results))
+      ++numCached;
+  }
+  TEST_GREATER(numCached, 0, ());
+  TEST_LESS(numCached, kQueries / 2, ());
+  TEST(cache.Get(MakeKey(strings::to_string(kQueries - 1)), results), ());
+}
+
+UNIT_TEST(ResultsCache_Concurrency)
+{
+  ResultsCache cache(1 << 20, seconds(100));
+
+  vector<thread> threads;
+  for (size_t t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&cache]()
+    {
+      Results results;
+      for (size_t i = 0; i < 1000; ++i)
+      {
+        ResultsCache::Key const key = MakeKey(strings::to_string(i % 50));
+        if (!cache.Get(key, results))
+          cache.Put(key, MakeResults("cafe", i % 5));
+      }
+    });
+  }
+  for (auto & t : threads)
+    t.join();
+
+  Results results;
+  TEST(cache.Get(MakeKey("7"), results), ());
+  TEST_EQUAL(2, results.GetCount(), ());
+}
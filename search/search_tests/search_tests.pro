@@ -23,6 +23,7 @@ SOURCES += \
     latlon_match_test.cpp \
     locality_finder_test.cpp \
     query_saver_tests.cpp \
+    results_cache_test.cpp \
     string_intersection_test.cpp \
     string_match_test.cpp \
 
@@ -7,7 +7,10 @@
 
 #include "base/stl_add.hpp"
 
+#include "std/algorithm.hpp"
+#include "std/cstdlib.hpp"
 #include "std/cstring.hpp"
+#include "std/vector.hpp"
 
 
 using namespace search;
@@ -79,6 +82,123 @@ UNIT_TEST(StringMatchCost_PrefixMatch)
 namespace
 {
 
+// Optimal string alignment distance, i.e. Levenshtein distance with transpositions
+// of adjacent symbols. Fills the last column of the matrix too.
+uint32_t Distance(UniString const & a, UniString const & b, vector<uint32_t> & column)
+{
+  vector<vector<uint32_t>> d(a.size() + 1, vector<uint32_t>(b.size() + 1));
+  for (size_t i = 0; i <= a.size(); ++i)
+    d[i][0] = i;
+  for (size_t j = 0; j <= b.size(); ++j)
+    d[0][j] = j;
+  for (size_t i = 1; i <= a.size(); ++i)
+  {
+    for (size_t j = 1; j <= b.size(); ++j)
+    {
+      d[i][j] = min(min(d[i - 1][j], d[i][j - 1]) + 1,
+                    d[i - 1][j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1));
+      if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1])
+        d[i][j] = min(d[i][j], d[i - 2][j - 2] + 1);
+    }
+  }
+
+  column.clear();
+  for (size_t i = 0; i <= a.size(); ++i)
+    column.push_back(d[i][b.size()]);
+  return d[a.size()][b.size()];
+}
+
+LevenshteinAutomaton::State Run(LevenshteinAutomaton const & automaton, UniString const & s)
+{
+  LevenshteinAutomaton::State state = automaton.Start();
+  for (UniChar c : s)
+    state = automaton.Step(state, c);
+  return state;
+}
+
+bool Matches(char const * pattern, char const * s, uint32_t maxErrors)
+{
+  LevenshteinAutomaton const automaton(MakeUniString(pattern), maxErrors);
+  return automaton.IsAccepting(Run(automaton, MakeUniString(s)));
+}
+
+UniString RandomString(size_t maxSize, char alphabetSize)
+{
+  UniString s(rand() % (maxSize + 1));
+  for (auto & c : s)
+    c = 'a' + rand() % alphabetSize;
+  return s;
+}
+
+}  // namespace
+
+UNIT_TEST(LevenshteinAutomaton_Smoke)
+{
+  TEST(Matches("", "", 0), ());
+  TEST(!Matches("", "a", 0), ());
+  TEST(Matches("", "a", 1), ());
+  TEST(Matches("moscow", "moscow", 0), ());
+  TEST(!Matches("moscow", "moskow", 0), ());
+  TEST(Matches("moscow", "moskow", 1), ());
+  TEST(Matches("moscow", "mocsow", 1), ());
+  TEST(Matches("moscow", "mosow", 1), ());
+  TEST(Matches("moscow", "mosccow", 1), ());
+  TEST(!Matches("moscow", "mscwo", 1), ());
+  TEST(Matches("moscow", "mscwo", 2), ());
+  TEST(Matches("ab", "ba", 1), ());
+  TEST(!Matches("abc", "ca", 2), ());
+}
+
+UNIT_TEST(LevenshteinAutomaton_LongPattern)
+{
+  string const pattern(LevenshteinAutomaton::kMaxPatternSize, 'a');
+  string text = pattern;
+  text[0] = text[40] = 'b';
+  TEST(Matches(pattern.c_str(), pattern.c_str(), 0), ());
+  TEST(Matches(pattern.c_str(), text.c_str(), 2), ());
+  TEST(!Matches(pattern.c_str(), text.c_str(), 1), ());
+  TEST(Matches(pattern.c_str(), (text + "a").c_str(), 3), ());
+}
+
+UNIT_TEST(LevenshteinAutomaton_MatchesBruteForce)
+{
+  vector<uint32_t> column;
+  for (size_t test = 0; test < 3000; ++test)
+  {
+    UniString const pattern = RandomString(12, 4);
+    UniString const text = RandomString(14, 4);
+    uint32_t const maxErrors = rand() % 4;
+    LevenshteinAutomaton const automaton(pattern, maxErrors);
+
+    LevenshteinAutomaton::State state = automaton.Start();
+    for (size_t j = 0; j <= text.size(); ++j)
+    {
+      UniString const prefix(text.begin(), text.begin() + j);
+      uint32_t const distance = Distance(pattern, prefix, column);
+      TEST_EQUAL(state.m_distance, distance, (pattern, prefix));
+      TEST_EQUAL(automaton.IsAccepting(state), distance <= maxErrors, (pattern, prefix));
+      TEST_EQUAL(automaton.CanMatch(state), *min_element(column.begin(), column.end()) <= maxErrors,
+                 (pattern, prefix, maxErrors));
+      if (j < text.size())
+        state = automaton.Step(state, text[j]);
+    }
+
+    // No continuation of a string rejected by CanMatch() matches.
+    if (Distance(pattern, text, column) <= maxErrors)
+    {
+      state = automaton.Start();
+      for (UniChar c : text)
+      {
+        TEST(automaton.CanMatch(state), (pattern, text));
+        state = automaton.Step(state, c);
+      }
+    }
+  }
+}
+
+namespace
+{
+
 void TestEqual(vector<UniString> const v, char const * arr[])
 {
   for (size_t i = 0; i < v.size(); ++i)
@@ -8,6 +8,7 @@
 
 using std::lock_guard;
 using std::mutex;
+using std::recursive_mutex;
 using std::unique_lock;
 
 #ifdef DEBUG_NEW
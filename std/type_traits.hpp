@@ -9,6 +9,7 @@
 
 using std::conditional;
 using std::enable_if;
+using std::false_type;
 using std::is_arithmetic;
 using std::is_floating_point;
 using std::is_integral;
@@ -18,6 +19,7 @@ using std::is_signed;
 using std::is_unsigned;
 using std::make_signed;
 using std::make_unsigned;
+using std::true_type;
 using std::underlying_type;
 
 /// @todo clang on linux doesn't have is_trivially_copyable.
@@ -9,6 +9,7 @@ using std::pair;
 using std::make_pair;
 using std::move;
 using std::forward;
+using std::declval;
 
 #ifdef DEBUG_NEW
 #define new DEBUG_NEW